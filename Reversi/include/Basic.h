@@ -19,4 +19,27 @@ namespace Reversi
 		Black,
 		White
 	};
+
+	//相手側を取得する
+	constexpr Side GetOpponentSide(const Side side)
+	{
+		return side == Side::Black ? Side::White : Side::Black;
+	}
+
+	//探索で使用する評価関数
+	enum class EvaluatorType : unsigned char
+	{
+		Handcrafted,
+		Neural,
+	};
+
+	//敵AIの探索方式
+	enum class EngineMode : unsigned char
+	{
+		//評価関数を使うアルファベータ探索
+		AlphaBeta,
+
+		//ランダムなプレイアウトによるモンテカルロ木探索
+		MonteCarlo,
+	};
 }
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <bit>
+#include "Basic.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 64マスを超える盤面用の128ビットの盤面情報
+	/// コンパイラ固有の128ビット整数は使わず、64ビットの上位・下位で表す
+	/// </summary>
+	struct Bitboard128
+	{
+		u64 low;
+		u64 high;
+
+		constexpr Bitboard128() : low(0), high(0) {}
+		constexpr Bitboard128(const u64 low, const u64 high = 0) : low(low), high(high) {}
+
+		constexpr Bitboard128 operator&(const Bitboard128& other) const { return { low & other.low, high & other.high }; }
+		constexpr Bitboard128 operator|(const Bitboard128& other) const { return { low | other.low, high | other.high }; }
+		constexpr Bitboard128 operator^(const Bitboard128& other) const { return { low ^ other.low, high ^ other.high }; }
+		constexpr Bitboard128 operator~() const { return { ~low, ~high }; }
+
+		constexpr Bitboard128& operator&=(const Bitboard128& other) { low &= other.low; high &= other.high; return *this; }
+		constexpr Bitboard128& operator|=(const Bitboard128& other) { low |= other.low; high |= other.high; return *this; }
+		constexpr Bitboard128& operator^=(const Bitboard128& other) { low ^= other.low; high ^= other.high; return *this; }
+
+		constexpr Bitboard128 operator<<(const int shift) const
+		{
+			if (shift == 0)
+				return *this;
+			if (shift >= 64)
+				return { 0, low << (shift - 64) };
+
+			return { low << shift, (high << shift) | (low >> (64 - shift)) };
+		}
+
+		constexpr Bitboard128 operator>>(const int shift) const
+		{
+			if (shift == 0)
+				return *this;
+			if (shift >= 64)
+				return { high >> (shift - 64), 0 };
+
+			return { (low >> shift) | (high << (64 - shift)), high >> shift };
+		}
+
+		constexpr bool operator==(const Bitboard128& other) const = default;
+
+		constexpr explicit operator bool() const
+		{
+			return (low | high) != 0ull;
+		}
+	};
+
+	//64ビットと128ビットの盤面情報を同じ書き方で扱うための関数
+
+	//指定したマスだけが立った盤面情報
+	template <typename Bits>
+	constexpr Bits SquareBit(const int index)
+	{
+		return Bits(1) << index;
+	}
+
+	constexpr int PopCount(const u64 bits)
+	{
+		return std::popcount(bits);
+	}
+
+	constexpr int PopCount(const Bitboard128& bits)
+	{
+		return std::popcount(bits.low) + std::popcount(bits.high);
+	}
+
+	constexpr int CountTrailingZeros(const u64 bits)
+	{
+		return std::countr_zero(bits);
+	}
+
+	constexpr int CountTrailingZeros(const Bitboard128& bits)
+	{
+		return bits.low != 0ull ? std::countr_zero(bits.low) : 64 + std::countr_zero(bits.high);
+	}
+
+	//一番下のビットだけを取り出す
+	constexpr u64 LowestBit(const u64 bits)
+	{
+		return bits & (~bits + 1);
+	}
+
+	constexpr Bitboard128 LowestBit(const Bitboard128& bits)
+	{
+		return bits.low != 0ull ? Bitboard128(bits.low & (~bits.low + 1), 0) : Bitboard128(0, bits.high & (~bits.high + 1));
+	}
+
+	//一番下のビットを消す
+	constexpr u64 ResetLowestBit(const u64 bits)
+	{
+		return bits & (bits - 1);
+	}
+
+	constexpr Bitboard128 ResetLowestBit(const Bitboard128& bits)
+	{
+		return bits.low != 0ull ? Bitboard128(bits.low & (bits.low - 1), bits.high) : Bitboard128(0, bits.high & (bits.high - 1));
+	}
+
+	//条件を満たす時だけ盤面情報を残す(分岐しない)
+	constexpr u64 MaskIf(const bool condition, const u64 bits)
+	{
+		return bits & -(long long)condition;
+	}
+
+	constexpr Bitboard128 MaskIf(const bool condition, const Bitboard128& bits)
+	{
+		u64 mask = 0ull - (u64)condition;
+		return { bits.low & mask, bits.high & mask };
+	}
+}
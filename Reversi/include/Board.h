@@ -1,7 +1,7 @@
 #pragma once
 
 #include "Basic.h"
-#include <intrin.h>
+#include "Position.h"
 #include <bit>
 #include <bitset>
 #include <cstdint>
@@ -15,17 +15,22 @@ namespace Reversi
 	/// <summary>
 	/// 盤面を管理するクラス
 	/// </summary>
-	class Board
+	/// <typeparam name="size">盤面の一辺のマス数</typeparam>
+	template <int size>
+	class BasicBoard
 	{
 	public:
-		Board();
+		using Position = BasicPosition<size>;
+		using Bits = typename Position::Bits;
+
+		BasicBoard();
 
 		/// <summary>
 		/// 盤面に石をセットします
 		/// </summary>
 		/// <param name="input">セット位置</param>
 		/// <param name="side">セットする側</param>
-		void Set(u64 input, Side side);
+		void Set(Bits input, Side side);
 
 		/// <summary>
 		/// 指定した位置の石を反転し、反転位置を取得します。
@@ -33,20 +38,20 @@ namespace Reversi
 		/// <param name="input">設置位置</param>
 		/// <param name="side">反転する側</param>
 		/// <returns>反転位置</returns>
-		u64 Flip(u64 input, Side side);
+		Bits Flip(Bits input, Side side);
 
 		/// <summary>
 		/// 指定した位置の石情報を巻き戻します
 		/// </summary>
 		/// <param name="input">巻き戻す位置</param>
 		/// <param name="side">セットした側</param>
-		void Undo(u64 input, Side side);
+		void Undo(Bits input, Side side);
 
 		/// <summary>
 		/// 指定した場所を空にします
 		/// </summary>
 		/// <param name="input">空にする位置</param>
-		void SetEmpty(u64 input);
+		void SetEmpty(Bits input);
 
 		/// <summary>
 		/// 石の数を取得します
@@ -64,14 +69,14 @@ namespace Reversi
 		/// 石が置かれている位置を取得します
 		/// </summary>
 		/// <returns>石が置かれている位置</returns>
-		u64 GetAllBoard() const;
+		Bits GetAllBoard() const;
 
 		/// <summary>
 		/// 着手可能位置を取得します
 		/// </summary>
 		/// <param name="side">着手可能側</param>
 		/// <returns>着手可能位置</returns>
-		u64 GetLegalMoves(Side side) const;
+		Bits GetLegalMoves(Side side) const;
 
 		/// <summary>
 		/// 指定した位置から十字に繋がったマスを取得します
@@ -79,13 +84,19 @@ namespace Reversi
 		/// <param name="input">基準位置</param>
 		/// <param name="others">取得する側</param>
 		/// <returns>繋がったマスの情報</returns>
-		u64 GetCrossFloods(u64 input, u64 others) const;
+		Bits GetCrossFloods(Bits input, Bits others) const;
 
 		/// <summary>
 		/// 盤面情報を取得します
 		/// </summary>
 		/// <returns>黒番と白番の盤面情報</returns>
-		std::pair<u64, u64> GetFieldData() const;
+		std::pair<Bits, Bits> GetFieldData() const;
+
+		/// <summary>
+		/// 盤面情報を設定します
+		/// </summary>
+		/// <param name="field_data">黒番と白番の盤面情報</param>
+		void SetFieldData(std::pair<Bits, Bits> field_data);
 
 		/// <summary>
 		/// 盤面情報のリセットを行います
@@ -96,29 +107,71 @@ namespace Reversi
 		/// 盤面情報を上書きします
 		/// </summary>
 		/// <param name="board">上書きする情報</param>
-		void Overwrite(const Board& board);
-
-	private:
-		u64 black_board;
-		u64 white_board;
-
-		// ビット演算に使用する定数
-		static constexpr int SHIFT_VERTICAL = 8;
-		static constexpr int SHIFT_HORIZONTAL = 1;
+		void Overwrite(const BasicBoard& board);
 
-		static constexpr u64 horizontal_mask = 0x7e7e7e7e7e7e7e7e;
-		static constexpr u64 vertical_mask = 0x00FFFFFFFFFFFF00;
-		static constexpr u64 allSide_mask = horizontal_mask & vertical_mask;
-
-		u64 GetVerticalMoves(u64 mine, u64 others, u64 empties) const;
-		u64 GetHorizontalMoves(u64 mine, u64 others, u64 empties) const;
-		u64 GetCrossMoves(u64 mine, u64 others, u64 empties) const;
-
-		u64 GetVerticalFlips(u64 input, u64 mine, u64 others) const;
-		u64 GetHorizontalFlips(u64 input, u64 mine, u64 others) const;
-		u64 GetDiagonalCrossFlips(u64 input, u64 mine, u64 others) const;
+		/// <summary>
+		/// 指定した側から見た局面を取得します
+		/// </summary>
+		/// <param name="side">手番側</param>
+		/// <returns>手番側から見た局面</returns>
+		Position GetPosition(Side side) const;
+
+		//手番をコンパイル時に決めた版(引数でSideを受け取る版はこちらに振り分ける)
+		template <Side side>
+		void Set(const Bits input)
+		{
+			GetSideBoard<side>() |= input;
+		}
+
+		template <Side side>
+		Bits Flip(const Bits input)
+		{
+			Bits& mine = GetSideBoard<side>();
+			Bits& others = GetSideBoard<GetOpponentSide(side)>();
+			Bits flips = Position::ComputeFlips(input, mine, others);
+
+			mine |= flips;
+			others ^= flips;
+
+			return flips;
+		}
+
+		template <Side side>
+		void Undo(const Bits input)
+		{
+			GetSideBoard<side>() &= ~input;
+			GetSideBoard<GetOpponentSide(side)>() |= input;
+		}
+
+		template <Side side>
+		Bits GetLegalMoves() const
+		{
+			return Position::ComputeLegalMoves(GetSideBoard<side>(), GetSideBoard<GetOpponentSide(side)>());
+		}
 
-		u64 GetShiftedMoves(const u64 mine, const u64 others, const u64 empties, const int shift) const;
-		u64 GetShiftedFlips(const u64 input, const u64 mine, const u64 others, const int shift) const;
+	private:
+		Bits black_board;
+		Bits white_board;
+
+		template <Side side>
+		Bits& GetSideBoard()
+		{
+			if constexpr (side == Side::Black)
+				return black_board;
+			else
+				return white_board;
+		}
+
+		template <Side side>
+		const Bits& GetSideBoard() const
+		{
+			if constexpr (side == Side::Black)
+				return black_board;
+			else
+				return white_board;
+		}
 	};
-}
\ No newline at end of file
+
+	//対局で使う8x8の盤面
+	using Board = BasicBoard<DEFAULT_BOARD_SIZE>;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+#include "Basic.h"
+#include "Board.h"
+#include "CpuFeatures.h"
+#include "Position.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 多数の独立した盤面(8x8)を手番側から見た自分・相手の配列で持ち、着手処理をまとめて行うクラス
+	/// 自己対局やプレイアウトのように同じ処理を盤面ごとに繰り返す場面で、AVX2では4面、AVX-512では8面を1命令で処理する
+	/// 結果はどの命令の種類でもBoard・Positionで1面ずつ処理したものと同じになる
+	/// </summary>
+	class BoardBatch
+	{
+	public:
+		/// <param name="count">盤面の数(すべて空の盤面で初期化する)</param>
+		explicit BoardBatch(const size_t count = 0);
+
+		//盤面の数を変える(増えた分は空の盤面)
+		void Resize(const size_t count);
+
+		size_t GetCount() const;
+
+		/// <summary>
+		/// 盤面を設定します
+		/// </summary>
+		/// <param name="index">盤面の番号</param>
+		/// <param name="board">盤面</param>
+		/// <param name="side">手番</param>
+		void Set(const size_t index, const Board& board, const Side side);
+
+		void Set(const size_t index, const Position& position);
+
+		//手番側から見た盤面を取得する
+		Position GetPosition(const size_t index) const;
+
+		/// <summary>
+		/// すべての盤面について手番側の着手可能位置を計算します
+		/// </summary>
+		/// <param name="moves">着手可能位置の格納先(盤面の数に合わせる)</param>
+		void ComputeLegalMoves(std::vector<u64>& moves) const;
+
+		/// <summary>
+		/// すべての盤面について反転位置を計算します
+		/// </summary>
+		/// <param name="inputs">盤面ごとの着手位置(0なら反転なし)</param>
+		/// <param name="flips">反転位置の格納先(盤面の数に合わせる)</param>
+		void ComputeFlips(const std::vector<u64>& inputs, std::vector<u64>& flips) const;
+
+		/// <summary>
+		/// すべての盤面に着手し、手番を相手側に移します
+		/// 着手位置が0の盤面はパスになります
+		/// </summary>
+		/// <param name="inputs">盤面ごとの着手位置</param>
+		/// <param name="flips">反転位置の格納先(盤面の数に合わせる)</param>
+		void Play(const std::vector<u64>& inputs, std::vector<u64>& flips);
+
+		/// <summary>
+		/// すべての盤面の石の数を数えます
+		/// </summary>
+		/// <param name="player_counts">手番側の石の数の格納先</param>
+		/// <param name="opponent_counts">相手側の石の数の格納先</param>
+		void CountStones(std::vector<int>& player_counts, std::vector<int>& opponent_counts) const;
+
+		/// <summary>
+		/// すべての盤面について終局しているか(両者とも打てないか)を調べます
+		/// </summary>
+		/// <param name="is_terminal">終局なら1、続くなら0の格納先</param>
+		void ComputeTerminals(std::vector<unsigned char>& is_terminal) const;
+
+		//使用する命令の種類(CPUが対応していなければ対応している中で最も幅の広いものにする)
+		void SetSimdLevel(const SimdLevel level);
+		SimdLevel GetSimdLevel() const;
+
+	private:
+		//手番側・相手側の石
+		std::vector<u64> players;
+		std::vector<u64> opponents;
+
+		SimdLevel simd_level;
+
+		//まとめて処理できる盤面の数を返し、端数は呼び出し元が1面ずつ処理する
+		size_t ComputeLegalMovesSimd(const u64* mine, const u64* others, u64* moves, const size_t count) const;
+		size_t ComputeFlipsSimd(const u64* inputs, u64* flips, const size_t count) const;
+		size_t PopCountSimd(const u64* bits, int* counts, const size_t count) const;
+
+#ifdef REVERSI_X86
+		static size_t ComputeLegalMovesAvx2(const u64* mine, const u64* others, u64* moves, const size_t count);
+		static size_t ComputeFlipsAvx2(const u64* inputs, const u64* mine, const u64* others, u64* flips, const size_t count);
+		static size_t PopCountAvx2(const u64* bits, int* counts, const size_t count);
+
+		static size_t ComputeLegalMovesAvx512(const u64* mine, const u64* others, u64* moves, const size_t count);
+		static size_t ComputeFlipsAvx512(const u64* inputs, const u64* mine, const u64* others, u64* flips, const size_t count);
+		static size_t PopCountAvx512(const u64* bits, int* counts, const size_t count);
+#endif
+	};
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <type_traits>
+#include "Basic.h"
+#include "Bitboard.h"
+
+//盤面の大きさで展開する着手処理を、呼び出し元に必ず展開させる属性
+//(テンプレートにすると展開後の大きさで見積もられ、8x8でも関数呼び出しが残るため)
+#if defined(_MSC_VER)
+#define REVERSI_FORCE_INLINE __forceinline
+#else
+#define REVERSI_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace Reversi
+{
+	//既定の盤面の大きさ
+	constexpr int DEFAULT_BOARD_SIZE = 8;
+
+	//盤面上の長方形の範囲のビットを立てる(行・列とも始まりを含み終わりを含まない)
+	template <typename Bits>
+	constexpr Bits MakeRectangleMask(const int size, const int row_begin, const int row_end, const int column_begin, const int column_end)
+	{
+		Bits mask = Bits(0);
+
+		for (int row = row_begin; row < row_end; ++row)
+		{
+			for (int column = column_begin; column < column_end; ++column)
+			{
+				mask |= SquareBit<Bits>(row * size + column);
+			}
+		}
+
+		return mask;
+	}
+
+	/// <summary>
+	/// 盤面の大きさごとの定数
+	/// 8x8までは64ビット、それより大きい盤面は128ビットで盤面情報を持つ(マスの番号は 行 * size + 列)
+	/// </summary>
+	/// <typeparam name="size">一辺のマス数</typeparam>
+	template <int size>
+	struct BoardGeometry
+	{
+		static_assert(4 <= size && size <= 10 && size % 2 == 0, "board size must be even and between 4 and 10");
+
+		using Bits = std::conditional_t<(size * size <= 64), u64, Bitboard128>;
+
+		static constexpr int SIZE = size;
+		static constexpr int SQUARE_COUNT = size * size;
+
+		// ビット演算に使用する定数
+		static constexpr int SHIFT_VERTICAL = size;
+		static constexpr int SHIFT_HORIZONTAL = 1;
+
+		//盤面上のすべてのマス
+		static constexpr Bits BOARD_MASK = MakeRectangleMask<Bits>(size, 0, size, 0, size);
+
+		//左右端・上下端・すべての端のマスを除く
+		static constexpr Bits HORIZONTAL_MASK = MakeRectangleMask<Bits>(size, 0, size, 1, size - 1);
+		static constexpr Bits VERTICAL_MASK = MakeRectangleMask<Bits>(size, 1, size - 1, 0, size);
+		static constexpr Bits ALL_SIDE_MASK = HORIZONTAL_MASK & VERTICAL_MASK;
+
+		//初期配置(中央の4マスに斜めに並べる)
+		static constexpr Bits INITIAL_BLACK = SquareBit<Bits>((size / 2 - 1) * size + size / 2) | SquareBit<Bits>((size / 2) * size + size / 2 - 1);
+		static constexpr Bits INITIAL_WHITE = SquareBit<Bits>((size / 2 - 1) * size + size / 2 - 1) | SquareBit<Bits>((size / 2) * size + size / 2);
+	};
+}
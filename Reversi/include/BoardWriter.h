@@ -1,10 +1,9 @@
 #pragma once
 
+#include <array>
 #include <string>
+#include <string_view>
 #include <iostream>
-#include <fcntl.h>
-#include <io.h>
-#include <Windows.h>
 
 #include "Basic.h"
 
@@ -12,6 +11,7 @@ namespace Reversi
 {
 	/// <summary>
 	/// 盤面を描画するクラス
+	/// 初回は枠ごと画面上部に描画し、以降は前回から変わったマスだけをカーソル指定で書き換える
 	/// </summary>
 	class BoardWriter
 	{
@@ -27,19 +27,68 @@ namespace Reversi
 		/// <param name="input">入力マス</param>
 		void Write(std::pair<u64, u64> field_data, u64 legal_moves, u64 input = 0xFFFFFFFFFFFFFFFF);
 
+		/// <summary>
+		/// 次回の書き込みで枠ごと描画し直します(画面が崩れた時用)
+		/// </summary>
+		void Invalidate();
+
 	private:
+		/// <summary>
+		/// マスの表示の種類
+		/// </summary>
+		enum CellKind : unsigned char
+		{
+			Empty,
+			Black,
+			White,
+			Legal,
+			CELL_KIND_COUNT,
+
+			//直前の着手マスは背景色を変えるので種類を倍にする
+			HIGHLIGHT_OFFSET = CELL_KIND_COUNT,
+			CELL_GLYPH_COUNT = CELL_KIND_COUNT * 2,
+
+			//まだ描画していないマス
+			NOT_DRAWN = 0xFF,
+		};
+
+		//盤面の枠の行数
+		static constexpr int FRAME_HEIGHT = 20;
+
 		const int board_size;
-		std::wstring write_buffer;
+
+		//UTF-8で書き出す内容を貯めるバッファ(使い回す)
+		std::string write_buffer;
+
+		//事前にUTF-8に変換した枠・マス・カーソル移動のバイト列
+		std::string frame_bytes;
+		std::array<std::string, CELL_GLYPH_COUNT> cell_glyphs;
+		std::array<std::string, 64> cell_positions;
+
+		//前回描画したマスの種類
+		std::array<unsigned char, 64> drawn_cells;
+		bool is_frame_drawn;
+
+#ifdef _WIN32
 		std::wstring defaultFontName;
+#endif
 
 		//色情報を変更する文字列を取得する
-		std::wstring GetBackColorCode(const int id) const;
-		std::wstring GetFrontColorCode(const int id) const;
+		static std::wstring GetBackColorCode(const int id);
+		static std::wstring GetFrontColorCode(const int id);
+
+		//指定した位置の石情報をマスの種類に変換する
+		static unsigned char ToCellKind(const u64 black_data, const u64 white_data, const u64 legal_moves, const int offset, const u64 input);
+
+		//UTF-16の文字列をUTF-8に変換して追加する
+		static void AppendUtf8(std::string& buffer, std::wstring_view text);
 
-		//指定した位置の石情報を文字列に変換する
-		std::wstring ToStone(const u64 black_data, const u64 white_data, const u64 legal_moves, const int offset, const u64 input) const;
+		void BuildFrame();
+		void BuildCellGlyphs();
+		void WriteAlphabets(std::wstring& frame) const;
+		void WriteParts(std::wstring& frame, const wchar_t& l_side, const wchar_t& m_side, const wchar_t& r_side) const;
 
-		void WriteAlphabets();
-		void WriteParts(const wchar_t& l_side, const wchar_t& m_side, const wchar_t& r_side);
+		//バッファの内容を一度の書き込みで出力する
+		void Flush();
 	};
 }
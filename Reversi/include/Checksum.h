@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Reversi
+{
+	/// <summary>
+	/// ファイルの破損検出に使うFNV-1aハッシュを計算します
+	/// </summary>
+	/// <param name="data">対象のデータ</param>
+	/// <param name="size">データのバイト数</param>
+	/// <param name="hash">続きから計算する場合の途中のハッシュ値</param>
+	/// <returns>ハッシュ値</returns>
+	inline uint32_t ComputeChecksum(const void* data, const size_t size, uint32_t hash = 2166136261u)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 16777619u;
+		}
+
+		return hash;
+	}
+}
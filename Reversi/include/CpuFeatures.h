@@ -0,0 +1,42 @@
+#pragma once
+
+//x86系のCPUではSIMD命令を使用する
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define REVERSI_X86 1
+#include <immintrin.h>
+#endif
+
+//AVX2・AVX-512命令を使う関数に付ける属性(MSVCは属性なしで組み込み関数を使える)
+#if defined(REVERSI_X86) && !defined(_MSC_VER)
+#define REVERSI_TARGET_AVX2 __attribute__((target("avx2,popcnt,bmi,bmi2")))
+#define REVERSI_TARGET_AVX512 __attribute__((target("avx512f,avx512vpopcntdq,avx2,popcnt,bmi,bmi2")))
+#else
+#define REVERSI_TARGET_AVX2
+#define REVERSI_TARGET_AVX512
+#endif
+
+namespace Reversi
+{
+	//まとめて処理する時に使う命令の種類
+	enum class SimdLevel : unsigned char
+	{
+		Scalar,
+		Avx2,
+
+		//AVX-512F と VPOPCNTDQ
+		Avx512,
+	};
+
+	/// <summary>
+	/// 実行中のCPUとOSがAVX2命令に対応しているかを取得します
+	/// </summary>
+	bool IsAvx2Supported();
+
+	/// <summary>
+	/// 実行中のCPUとOSがAVX-512命令(AVX-512F と VPOPCNTDQ)に対応しているかを取得します
+	/// </summary>
+	bool IsAvx512Supported();
+
+	//使える中で最も幅の広い命令の種類を取得する
+	SimdLevel GetSupportedSimdLevel();
+}
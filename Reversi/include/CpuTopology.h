@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "HardwarePolicy.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// NUMAノードと論理コアの構成を調べ、スレッドを論理コアに固定するクラス
+	/// LinuxはsysfsのノードとSMTの兄弟コアの一覧、WindowsはGetLogicalProcessorInformationExから調べ、
+	/// プロセスに許された論理コアだけを使う。ノード内では物理コアごとに1つ目の論理コアを先に並べる
+	/// Windowsの論理コアの番号は プロセッサグループ * 64 + グループ内の番号 とする
+	/// </summary>
+	class CpuTopology
+	{
+	public:
+		//実行中のマシンの構成(最初に呼んだ時に一度だけ調べる)
+		static const CpuTopology& Get();
+
+		int GetNodeCount() const;
+		int GetCpuCount() const;
+
+		//ノードの論理コア(nodeは0からの並び順で、OSのノード番号ではない)
+		const std::vector<int>& GetNodeCpus(const int node) const;
+
+		//メモリを持つノードのOSの番号
+		const std::vector<int>& GetMemoryNodeIds() const;
+
+		/// <summary>
+		/// 番号indexのスレッドを固定する論理コアを取得します
+		/// </summary>
+		/// <param name="index">スレッドの番号</param>
+		/// <param name="placement">固定する方法</param>
+		/// <returns>論理コアの番号(固定しなければ-1)</returns>
+		int GetCpu(const int index, const ThreadPlacement placement) const;
+
+		//番号0からcount個のスレッドを固定する論理コア(固定しなければ空)
+		std::vector<int> GetCpus(const int count, const ThreadPlacement placement) const;
+
+		/// <summary>
+		/// 呼んだスレッドを1つの論理コアに固定します
+		/// </summary>
+		/// <param name="cpu">論理コアの番号</param>
+		/// <returns>固定できたか</returns>
+		static bool PinCurrentThread(const int cpu);
+
+		//ノードごとの論理コア数を並べた説明
+		std::string Describe() const;
+
+	private:
+		CpuTopology();
+
+		/// <summary>
+		/// 論理コアを持つノード1つ分
+		/// </summary>
+		struct Node
+		{
+			int id;
+			std::vector<int> cpus;
+		};
+
+		std::vector<Node> nodes;
+		std::vector<int> memory_node_ids;
+		int cpu_count;
+
+		void Detect();
+
+		//"0-3,8,10-11"の形式の一覧を読む
+		static std::vector<int> ParseCpuList(const std::string& text);
+	};
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Basic.h"
+#include "Position.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 終局まで読み切る探索(8x8)
+	/// 対局中の完全読みと、教師局面のラベル付けの両方で使う
+	/// </summary>
+	class EndgameSolver
+	{
+	public:
+		/// <summary>
+		/// 終局まで完全に読み切り、手番側から見た最終石差を取得します
+		/// </summary>
+		/// <param name="position">手番側から見た局面</param>
+		/// <param name="alpha">α値</param>
+		/// <param name="beta">β値</param>
+		/// <param name="passed">直前の手がパスか</param>
+		/// <returns>手番側から見た最終石差</returns>
+		static int Solve(const Position position, int alpha, const int beta, const bool passed);
+
+		/// <summary>
+		/// 最終石差を、評価関数の勝ち・負けの値に石差を足した評価値に直します
+		/// (完全読みの結果を、読み切れなかった深さの評価値と並べて比べられるようにする)
+		/// </summary>
+		/// <param name="disc_difference">手番側から見た最終石差</param>
+		/// <returns>手番側から見た評価値</returns>
+		static int ToEvaluatorScore(const int disc_difference);
+	};
+}
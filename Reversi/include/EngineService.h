@@ -0,0 +1,196 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Basic.h"
+#include "Board.h"
+#include "HardwarePolicy.h"
+#include "LatencyHistogram.h"
+#include "LocalSocket.h"
+#include "MetricsExporter.h"
+#include "SearchSystem.h"
+#include "TranspositionTable.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// Unixドメインソケットで待ち受け、多数の独立した対局(セッション)の探索を受け付ける常駐サービス
+	/// すべてのセッションで探索スレッドと大きさを決めた置換表を1つずつ共有し、
+	/// 探索を待っているセッションを順に回して1件ずつ取り出すので、依頼の多いセッションが他を待たせない
+	///
+	/// 1行1コマンドのテキストで、応答の先頭にはセッション番号が付く
+	///   new                          -> session <id>
+	///   set <id> <黒16進> <白16進> <b|w> -> ok <id>
+	///   play <id> <a1~h8|pass>       -> ok <id>
+	///   go <id> <最大深さ> <期限ms>    -> bestmove <id> <a1~h8|pass> <評価値> <深さ> <待ちms> <探索ms>
+	///   close <id>                   -> ok <id>
+	///   shutdown                     -> サービスを止める
+	/// 失敗した時は error <id> <理由> を返す。goの応答は探索が終わってから、届いた順とは限らない順で返る
+	/// </summary>
+	class EngineService
+	{
+	public:
+		/// <param name="worker_count">探索スレッド数</param>
+		/// <param name="table_megabytes">すべてのセッションで共有する置換表の大きさ</param>
+		EngineService(const int worker_count, const size_t table_megabytes);
+		~EngineService();
+
+		/// <summary>
+		/// 待ち受けを始め、Stopされるかshutdownコマンドが届くまで接続を受け付けます
+		/// </summary>
+		/// <param name="path">ソケットファイルのパス</param>
+		/// <returns>待ち受けを始められたか</returns>
+		bool Run(const std::string& path);
+
+		//待ち受けを止め、接続と探索スレッドを終わらせる(別スレッドから呼んでも良い)
+		void Stop();
+
+		/// <summary>
+		/// 待ち受けている間、探索時間・最初の手までの時間・ノード数・待ち時間のヒストグラムを
+		/// Prometheusのテキスト形式で一定間隔でファイルに書き出します。Runの前に呼んでください
+		/// </summary>
+		/// <param name="path">書き出すファイル</param>
+		void SetMetricsFile(const std::string& path);
+
+		/// <summary>
+		/// 探索スレッドを論理コアに固定する方法と、置換表のページの種類・NUMAノードへの配置を指定します
+		/// 置換表は確保し直します。Runの前に呼んでください
+		/// </summary>
+		void SetHardwarePolicy(const HardwarePolicy& policy);
+
+		//待ち受けを始めるまで待つ(Runを別スレッドで呼んだ時に使う)
+		bool WaitUntilListening(const std::chrono::milliseconds timeout);
+
+		//既定のソケットファイル
+		static constexpr const char* SOCKET_PATH = "/tmp/reversi-engine.sock";
+
+		//マスの表記に変換する(a1が最下位ビット、0はpass)
+		static std::string ToSquareName(const u64 input);
+
+		//マスの表記を読む(読めなければ0、passも0)
+		static u64 ParseSquareName(const std::string& name);
+
+	private:
+		/// <summary>
+		/// 1つの接続。探索スレッドからも応答を書くので書き込みは排他する
+		/// </summary>
+		struct Connection
+		{
+			LocalSocket socket;
+			std::mutex write_mutex;
+
+			//この接続で作ったセッション(切断したら閉じる)
+			std::vector<u64> session_ids;
+
+			//コマンドを読むスレッドと、それが終わったか(終わった接続は次の接続を受け付けた時に片付ける)
+			std::thread thread;
+			std::atomic<bool> is_finished{ false };
+
+			void Send(const std::string& line);
+		};
+
+		/// <summary>
+		/// 探索の依頼
+		/// </summary>
+		struct Request
+		{
+			int max_depth;
+			std::chrono::steady_clock::time_point received;
+			std::chrono::steady_clock::time_point deadline;
+		};
+
+		/// <summary>
+		/// 1つの対局。盤面は探索していない間だけ書き換えられる
+		/// </summary>
+		struct Session
+		{
+			u64 id;
+			std::weak_ptr<Connection> connection;
+			Board board;
+			Side side;
+
+			//まだ取り出されていない依頼と、探索中か(サービスのmutexで守る)
+			std::deque<Request> pending;
+			bool is_running;
+			bool is_closed;
+		};
+
+		/// <summary>
+		/// 探索スレッドごとの状態。見張りのスレッドが期限を過ぎた探索の中断フラグを立てる
+		/// </summary>
+		struct Worker
+		{
+			SearchSystem search_system;
+			std::atomic<bool> stop_requested;
+
+			//探索中の依頼の期限(steady_clockのナノ秒、探索していなければ0)
+			std::atomic<long long> deadline;
+
+			//期限と中断フラグを一緒に変える(見張りが前の依頼の期限で次の依頼を中断しないようにする)
+			std::mutex deadline_mutex;
+
+			//スレッドを固定する論理コア(-1なら固定しない)
+			int cpu;
+
+			std::thread thread;
+		};
+
+		const int worker_count;
+		std::shared_ptr<TranspositionTable> transposition_table;
+		std::shared_ptr<ProbCutTable> probcut_table;
+		std::shared_ptr<ReductionTable> reduction_table;
+		std::shared_ptr<EvaluationWeights> evaluation_weights;
+		std::vector<std::unique_ptr<Worker>> workers;
+
+		LocalSocket listener;
+		std::atomic<bool> is_stopping;
+		bool is_listening;
+
+		//セッションと、探索を待っているセッションの順番
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::unordered_map<u64, std::shared_ptr<Session>> sessions;
+		std::deque<std::shared_ptr<Session>> ready_sessions;
+		u64 next_session_id;
+
+		//取り出した依頼の数(探索スレッドの数ごとに置換表の世代を進める)
+		std::atomic<u64> search_count;
+
+		std::vector<std::shared_ptr<Connection>> connections;
+		std::thread watchdog;
+
+		//依頼ごとの記録(時間はナノ秒)
+		LatencyHistogram queue_histogram;
+		LatencyHistogram search_histogram;
+		LatencyHistogram first_move_histogram;
+		LatencyHistogram node_histogram;
+		MetricsExporter metrics;
+		std::string metrics_path;
+
+		//1つの接続のコマンドを読み続ける
+		void ServeConnection(const std::shared_ptr<Connection> connection);
+
+		//1行のコマンドを処理し、すぐ返す応答を返す(goの応答は探索スレッドが送る)
+		std::string HandleCommand(const std::shared_ptr<Connection>& connection, const std::string& line);
+
+		//探索を待っているセッションから順に依頼を取り出して探索する
+		void RunWorker(Worker& worker);
+
+		//期限を過ぎた探索を中断させる
+		void RunWatchdog();
+
+		//期限まで反復深化で探索し、セッションの盤面に着手して応答を返す
+		std::string Search(Worker& worker, Session& session, const Request& request);
+
+		//セッションを探す(無いか閉じていればnullptr)
+		std::shared_ptr<Session> FindSession(const u64 id);
+	};
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <future>
+#include <iostream>
+#include "Evaluator.h"
+#include "EvaluationWeights.h"
+#include "TrainingData.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 教師局面から進行度ごとの評価パラメータを最小二乗法で求めるクラス
+	/// </summary>
+	class EvaluationTuner
+	{
+	public:
+		/// <param name="score_scale">石差1つあたりの評価値</param>
+		/// <param name="regularization">リッジ回帰の正則化の強さ</param>
+		explicit EvaluationTuner(const double score_scale = 100.0, const double regularization = 1.0);
+
+		/// <summary>
+		/// 教師局面を読み込んでパラメータを求め、ウェイトファイルに書き出します
+		/// </summary>
+		/// <param name="dataset_path">教師局面のファイル</param>
+		/// <param name="output_path">書き出すウェイトファイル</param>
+		/// <returns>成功したか</returns>
+		bool Run(const std::string& dataset_path, const std::string& output_path) const;
+
+	private:
+		//対称性で纏めたマスの種類数 + 確定石 + 着手可能数
+		static constexpr int SQUARE_CLASS_COUNT = 10;
+		static constexpr int FEATURE_COUNT = SQUARE_CLASS_COUNT + 2;
+
+		/// <summary>
+		/// 正規方程式の集計値
+		/// </summary>
+		struct NormalEquation
+		{
+			std::array<double, FEATURE_COUNT * FEATURE_COUNT> xx = {};
+			std::array<double, FEATURE_COUNT> xy = {};
+			double n = 0.0;
+
+			void Merge(const NormalEquation& other);
+		};
+
+		using NormalEquations = std::array<NormalEquation, EvaluationWeights::STAGE_COUNT>;
+
+		const double score_scale;
+		const double regularization;
+
+		//割り当てられた範囲の教師局面を集計する
+		NormalEquations Accumulate(const TrainingData& dataset, const size_t begin, const size_t end) const;
+
+		//正規方程式を解く
+		std::array<double, FEATURE_COUNT> Solve(const NormalEquation& equation) const;
+
+		//盤面の対称性で同じ種類になるマスの番号を取得する
+		static int GetSquareClass(const int index);
+	};
+}
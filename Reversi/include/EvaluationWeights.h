@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "Basic.h"
+#include "MappedFile.h"
+#include "Checksum.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 一つの進行度に対する評価パラメータ
+	/// </summary>
+	struct StageWeights
+	{
+		//それぞれのマスに対する評価ウェイト
+		int32_t squares[64];
+
+		//確定石の係数
+		int32_t confirm;
+
+		//着手可能数の係数
+		int32_t mobility;
+	};
+
+	/// <summary>
+	/// 評価関数のパラメータを管理するクラス
+	/// 調整済みのバイナリファイルがあればメモリマップして使用する
+	/// </summary>
+	class EvaluationWeights
+	{
+	public:
+		//石数で分割する進行度の数
+		static constexpr int STAGE_COUNT = 6;
+
+		//ウェイトファイルの識別子とバージョン
+		static constexpr uint32_t FILE_MAGIC = 0x54575652; // "RVWT"
+		static constexpr uint32_t FILE_VERSION = 1;
+
+		/// <summary>
+		/// ウェイトファイルのヘッダー
+		/// </summary>
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t stage_count;
+			uint32_t checksum;
+		};
+
+		EvaluationWeights();
+
+		/// <summary>
+		/// ウェイトファイルをメモリマップします。不正なファイルの場合は既定値のままになります
+		/// </summary>
+		/// <param name="path">ウェイトファイル</param>
+		/// <returns>読み込みに成功したか</returns>
+		bool Load(const std::string& path);
+
+		/// <summary>
+		/// ウェイトファイルを書き出します
+		/// </summary>
+		/// <param name="path">書き出すファイル</param>
+		/// <param name="stages">進行度ごとのパラメータ</param>
+		/// <returns>書き出しに成功したか</returns>
+		static bool Save(const std::string& path, const StageWeights (&stages)[STAGE_COUNT]);
+
+		const StageWeights& Get(const int stage) const
+		{
+			return stages[stage];
+		}
+
+		//石数から進行度を取得する
+		static int GetStage(const int stone_count)
+		{
+			int stage = (stone_count - 4) / 10;
+			return stage < 0 ? 0 : (stage >= STAGE_COUNT ? STAGE_COUNT - 1 : stage);
+		}
+
+		//組み込みの既定値を共有する
+		static const std::shared_ptr<const EvaluationWeights>& GetDefault();
+
+	private:
+		MappedFile file;
+		const StageWeights* stages;
+	};
+}
@@ -1,54 +1,116 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <limits>
 #include <memory>
-#include <intrin.h>
 #include "Basic.h"
-#include "Board.h"
+#include "Position.h"
+#include "EvaluationWeights.h"
 
 namespace Reversi
 {
+	/// <summary>
+	/// 評価関数が使用する特徴量
+	/// </summary>
+	struct EvaluationFeatures
+	{
+		//相手側と評価側の盤面情報
+		std::pair<u64, u64> field;
+
+		//確定石の評価値
+		int confirm;
+
+		//着手可能数
+		int mobility;
+
+		//盤面上の石の数
+		int stone_count;
+	};
+
 	/// <summary>
 	/// 盤面評価を行うクラス
+	/// 8x8以外の盤面では、端からの距離が同じ8x8のマスのウェイトを使い、進行度は石の割合で決める
 	/// </summary>
-	class Evaluator
+	/// <typeparam name="size">盤面の一辺のマス数</typeparam>
+	template <int size>
+	class BasicEvaluator
 	{
 	public:
-		explicit Evaluator(std::shared_ptr<Board>& board);
+		using Position = BasicPosition<size>;
+		using Geometry = typename Position::Geometry;
+		using Bits = typename Position::Bits;
+
+		BasicEvaluator();
+
+		/// <summary>
+		/// 評価関数
+		/// </summary>
+		/// <typeparam name="is_max">手番側が評価側か</typeparam>
+		/// <param name="position">手番側から見た局面</param>
+		/// <returns>評価側から見た評価値</returns>
+		template <bool is_max>
+		int Evaluate(const Position& position) const
+		{
+			//盤面情報は相手側・評価側の順に並べる
+			if constexpr (is_max)
+				return EvaluateField({ position.opponent, position.player });
+			else
+				return EvaluateField({ position.player, position.opponent });
+		}
+
+		//評価に使う特徴量を取得する(評価パラメータの調整用、8x8のみ)
+		EvaluationFeatures GetFeatures(const Position& position, bool is_max) const requires (size == DEFAULT_BOARD_SIZE);
 
-		//評価関数
-		int Evaluate(Side side) const;
+		//評価パラメータを設定する
+		void SetWeights(const std::shared_ptr<const EvaluationWeights>& weights);
+
+		//終局時に評価側が勝っている時の評価値(負けは符号を反転する)
+		static constexpr int WIN_SCORE = 15000;
+
+		//ゲーム終了時に対する評価関数(countsは相手側・評価側の順)
+		static int EvaluateGameEnd(std::pair<int, int> counts, int legal_count_black, int legal_count_white);
 
 	private:
-		std::shared_ptr<Board> board;
-
-		//それぞれのマスに対する評価ウェイト
-		static constexpr int weights[64] = {
-				45, -11, 4, -1, -1, 4, -11, 45,
-				-11, -16, -1, -3, -3, 2, -16, -11,
-				4, -1, 2, -1, -1, 2, -1, 4,
-				-1, -3, -1, 0, 0, -1, -3, -1,
-				-1, -3, -1, 0, 0, -1, -3, -1,
-				4, -1, 2, -1, -1, 2, -1, 4,
-				-11, -16, -1, -3, -3, 2, -16, -11,
-				45, -11, 4, -1, -1, 4, -11, 45,
-		};
+		//評価の部分ごとに計測する
+		friend class KernelBenchmark;
+
+		std::shared_ptr<const EvaluationWeights> weights;
 
 		//角のマス情報
-		static constexpr u64 corners[4] = {
-			0x0000000000000001, 0x0000000000000080, 0x0100000000000000, 0x8000000000000000
+		static constexpr Bits corners[4] = {
+			SquareBit<Bits>(0), SquareBit<Bits>(size - 1), SquareBit<Bits>(size * (size - 1)), SquareBit<Bits>(size * size - 1)
 		};
 
-
-		//ゲーム終了時に対する評価関数
-		int EvaluateGameEnd(std::pair<int, int> counts, int legal_count_black, int legal_count_white) const;
+		//相手側・評価側の順に並べた盤面に対する評価関数
+		int EvaluateField(std::pair<Bits, Bits> field_data) const;
 
 		//マスのウェイトに対する評価関数
-		int EvaluateWeight(std::pair<u64, u64> field) const;
+		int EvaluateWeight(std::pair<Bits, Bits> field, const StageWeights& stage_weights) const;
 
 		//確定石に対する評価関数
-		int EvaluateConfirm(std::pair<u64, u64> field) const;
-	};
-}
+		int EvaluateConfirm(std::pair<Bits, Bits> field) const;
+
+		//マスに対応する8x8のウェイトの番号(端からの距離が同じマスを使う)
+		static constexpr std::array<int, Geometry::SQUARE_COUNT> WEIGHT_SQUARES = []()
+			{
+				auto to_weight_line = [](const int line)
+					{
+						constexpr int HALF = DEFAULT_BOARD_SIZE / 2;
+						int distance = std::min(std::min(line, size - 1 - line), HALF - 1);
+						return line < size / 2 ? distance : DEFAULT_BOARD_SIZE - 1 - distance;
+					};
 
+				std::array<int, Geometry::SQUARE_COUNT> squares{};
+				for (int square = 0; square < Geometry::SQUARE_COUNT; ++square)
+				{
+					squares[square] = to_weight_line(square / size) * DEFAULT_BOARD_SIZE + to_weight_line(square % size);
+				}
 
+				return squares;
+			}();
+	};
+
+	//対局で使う8x8の評価関数
+	using Evaluator = BasicEvaluator<DEFAULT_BOARD_SIZE>;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+
+#include "Basic.h"
+
+namespace Reversi
+{
+	//UIスレッドに届くイベントの種類
+	enum class GameEventType : unsigned char
+	{
+		//ユーザーの入力
+		Input,
+
+		//バックグラウンドの探索が終わった
+		SearchFinished,
+	};
+
+	/// <summary>
+	/// UIスレッドに届くイベント
+	/// </summary>
+	struct GameEvent
+	{
+		GameEventType type;
+
+		//入力された文字列(Input)
+		std::wstring text;
+
+		//どの探索の結果か(SearchFinished)
+		int search_id;
+
+		//探索の最善手(SearchFinished)
+		u64 point;
+	};
+
+	/// <summary>
+	/// 入力スレッドや探索スレッドからUIスレッドへイベントを渡すキュー
+	/// </summary>
+	class EventQueue
+	{
+	public:
+		//イベントを追加する(どのスレッドからでも呼べる)
+		void Push(GameEvent event);
+
+		/// <summary>
+		/// イベントを取り出します。届いていなければ指定時間まで待ちます
+		/// </summary>
+		/// <param name="event">取り出したイベント</param>
+		/// <param name="timeout">待つ時間</param>
+		/// <returns>取り出せたか</returns>
+		bool Pop(GameEvent& event, std::chrono::milliseconds timeout);
+
+		//イベントが届くまで待って取り出す
+		GameEvent Pop();
+
+	private:
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<GameEvent> events;
+	};
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "Basic.h"
+#include "Bitboard.h"
+#include "BoardGeometry.h"
+#include "CpuFeatures.h"
+
+//8x8の着手処理で使う反転位置の計算方法(既定は表引き)
+//REVERSI_FLIP_SHIFTを定義するとシフト、REVERSI_FLIP_SIMDを定義するとAVX2(/arch:AVX2か-mavx2でビルドした時だけ)を使う
+#if defined(REVERSI_FLIP_SIMD) && !defined(__AVX2__)
+#error "REVERSI_FLIP_SIMD requires a build that targets AVX2 (/arch:AVX2 or -mavx2)"
+#endif
+
+namespace Reversi
+{
+	//反転位置の計算方法
+	enum class FlipKernel : unsigned char
+	{
+		//8方向それぞれに石をシフトして広げる
+		Shift,
+
+		//置いたマスを通る4本の列を8ビットに取り出し、コンパイル時に作った表を引く
+		Lookup,
+
+		//4方向をAVX2の4つのレーンで同時にシフトする
+		Simd,
+	};
+
+#if defined(REVERSI_FLIP_SIMD)
+	constexpr FlipKernel DEFAULT_FLIP_KERNEL = FlipKernel::Simd;
+#elif defined(REVERSI_FLIP_SHIFT)
+	constexpr FlipKernel DEFAULT_FLIP_KERNEL = FlipKernel::Shift;
+#else
+	constexpr FlipKernel DEFAULT_FLIP_KERNEL = FlipKernel::Lookup;
+#endif
+
+	/// <summary>
+	/// 8x8の反転位置を表引きで計算するための表(すべてコンパイル時に作るので、起動時には何もしない)
+	/// 列は置いたマスの位置(0~7)と8ビットの石の並びで表し、
+	/// 相手の石が続いた先にある「挟める位置」と、挟んだ時に反転する位置を引く
+	/// </summary>
+	struct FlipTable
+	{
+		//[置いた位置][両端を除いた相手の石6ビット] 相手の石が続いた先の位置(自分の石があれば挟める)
+		std::array<std::array<uint8_t, 64>, 8> outflanks;
+
+		//[置いた位置][挟める位置] 反転する位置
+		std::array<std::array<uint8_t, 256>, 8> flips;
+
+		//[列の8ビット] a列(ビット0, 8, ..., 56)に並べたもの
+		std::array<u64, 256> file_deposits;
+
+		//[マス] マスを通る右下がり・左下がりの斜めの線
+		std::array<u64, 64> diagonal_masks;
+		std::array<u64, 64> anti_diagonal_masks;
+
+		//a列の石を上の行から順に8ビットに集める乗数(行ごとの位置が重ならないので桁上がりしない)
+		static constexpr u64 FILE_GATHER = 0x0102040810204080ull;
+
+		//1つの列に1マスずつしか無い線を8ビットに集める・8ビットを全行に写す乗数
+		static constexpr u64 ROW_SPREAD = 0x0101010101010101ull;
+
+		static constexpr u64 FILE_A = 0x0101010101010101ull;
+
+		static constexpr FlipTable Build()
+		{
+			FlipTable table = {};
+
+			for (int position = 0; position < 8; ++position)
+			{
+				for (int inner = 0; inner < 64; ++inner)
+				{
+					//両端のマスは反転しないので、相手の石は1~6だけを見る
+					int others = inner << 1;
+					int outflank = 0;
+
+					int square = position + 1;
+					while (square <= 6 && (others >> square & 1))
+						++square;
+					if (square > position + 1 && square <= 7)
+						outflank |= 1 << square;
+
+					square = position - 1;
+					while (square >= 1 && (others >> square & 1))
+						--square;
+					if (square < position - 1 && square >= 0)
+						outflank |= 1 << square;
+
+					table.outflanks[position][inner] = (uint8_t)outflank;
+				}
+
+				for (int outflank = 0; outflank < 256; ++outflank)
+				{
+					int flip = 0;
+
+					for (int square = 0; square < 8; ++square)
+					{
+						if (!(outflank >> square & 1))
+							continue;
+
+						for (int between = std::min(square, position) + 1; between < std::max(square, position); ++between)
+						{
+							flip |= 1 << between;
+						}
+					}
+
+					table.flips[position][outflank] = (uint8_t)flip;
+				}
+			}
+
+			for (int line = 0; line < 256; ++line)
+			{
+				u64 deposit = 0;
+				for (int row = 0; row < 8; ++row)
+				{
+					if (line >> row & 1)
+						deposit |= 1ull << (row * 8);
+				}
+				table.file_deposits[line] = deposit;
+			}
+
+			for (int square = 0; square < 64; ++square)
+			{
+				int row = square / 8;
+				int column = square % 8;
+				u64 diagonal = 0;
+				u64 anti_diagonal = 0;
+
+				for (int other = 0; other < 64; ++other)
+				{
+					if (other / 8 - other % 8 == row - column)
+						diagonal |= 1ull << other;
+					if (other / 8 + other % 8 == row + column)
+						anti_diagonal |= 1ull << other;
+				}
+
+				table.diagonal_masks[square] = diagonal;
+				table.anti_diagonal_masks[square] = anti_diagonal;
+			}
+
+			return table;
+		}
+
+		//列の中で位置positionに置いた時の反転位置(8ビット)
+		REVERSI_FORCE_INLINE uint8_t GetLineFlips(const int position, const unsigned int mine, const unsigned int others) const
+		{
+			return flips[position][outflanks[position][(others >> 1) & 63] & mine];
+		}
+	};
+
+	inline constexpr FlipTable FLIP_TABLE = FlipTable::Build();
+
+	/// <summary>
+	/// 表引きで反転位置を計算します(8x8)
+	/// </summary>
+	/// <param name="input">着手位置</param>
+	/// <param name="mine">手番側の石</param>
+	/// <param name="others">相手側の石</param>
+	/// <returns>反転位置(着手位置が0なら0)</returns>
+	REVERSI_FORCE_INLINE u64 ComputeFlipsByLookup(const u64 input, const u64 mine, const u64 others)
+	{
+		//パスした盤面をまとめて処理する時など、着手位置の無い呼び出しもシフトと同じく0を返す
+		if (input == 0ull)
+			return 0ull;
+
+		const FlipTable& table = FLIP_TABLE;
+		int square = CountTrailingZeros(input);
+		int row = square >> 3;
+		int column = square & 7;
+
+		//横: 行の8ビットをそのまま使う
+		int shift = row * 8;
+		u64 flips = (u64)table.GetLineFlips(column, (unsigned int)(mine >> shift) & 0xFF, (unsigned int)(others >> shift) & 0xFF) << shift;
+
+		//縦: 列を上の行から8ビットに集め、反転位置をa列に並べてから戻す
+		unsigned int file_mine = (unsigned int)((((mine >> column) & FlipTable::FILE_A) * FlipTable::FILE_GATHER) >> 56);
+		unsigned int file_others = (unsigned int)((((others >> column) & FlipTable::FILE_A) * FlipTable::FILE_GATHER) >> 56);
+		flips |= table.file_deposits[table.GetLineFlips(row, file_mine, file_others)] << column;
+
+		//斜め: 線上のマスは列ごとに1つなので、全行を重ねると列の番号の8ビットになる
+		u64 mask = table.diagonal_masks[square];
+		unsigned int line_mine = (unsigned int)(((mine & mask) * FlipTable::ROW_SPREAD) >> 56);
+		unsigned int line_others = (unsigned int)(((others & mask) * FlipTable::ROW_SPREAD) >> 56);
+		flips |= ((u64)table.GetLineFlips(column, line_mine, line_others) * FlipTable::ROW_SPREAD) & mask;
+
+		mask = table.anti_diagonal_masks[square];
+		line_mine = (unsigned int)(((mine & mask) * FlipTable::ROW_SPREAD) >> 56);
+		line_others = (unsigned int)(((others & mask) * FlipTable::ROW_SPREAD) >> 56);
+		flips |= ((u64)table.GetLineFlips(column, line_mine, line_others) * FlipTable::ROW_SPREAD) & mask;
+
+		return flips;
+	}
+
+#ifdef REVERSI_X86
+	/// <summary>
+	/// AVX2で反転位置を計算します(8x8)。横・縦・2つの斜めを4つのレーンに割り当て、左右へのシフトを同時に行う
+	/// 呼ぶ前にIsAvx2Supportedで確かめること
+	/// </summary>
+	/// <param name="input">着手位置</param>
+	/// <param name="mine">手番側の石</param>
+	/// <param name="others">相手側の石</param>
+	/// <returns>反転位置</returns>
+	REVERSI_TARGET_AVX2 inline u64 ComputeFlipsBySimd(const u64 input, const u64 mine, const u64 others)
+	{
+		using Geometry = BoardGeometry<8>;
+
+		const __m256i shifts = _mm256_set_epi64x(Geometry::SHIFT_VERTICAL + 1, Geometry::SHIFT_VERTICAL - 1, Geometry::SHIFT_VERTICAL, Geometry::SHIFT_HORIZONTAL);
+		const __m256i masks = _mm256_set_epi64x((long long)Geometry::ALL_SIDE_MASK, (long long)Geometry::ALL_SIDE_MASK, (long long)Geometry::VERTICAL_MASK, (long long)Geometry::HORIZONTAL_MASK);
+		const __m256i player = _mm256_set1_epi64x((long long)mine);
+		const __m256i cells = _mm256_and_si256(_mm256_set1_epi64x((long long)others), masks);
+		const __m256i put = _mm256_set1_epi64x((long long)input);
+
+		__m256i left = _mm256_and_si256(cells, _mm256_sllv_epi64(put, shifts));
+		__m256i right = _mm256_and_si256(cells, _mm256_srlv_epi64(put, shifts));
+
+		//挟める相手の石は最大6個なので、最初の1個に続けて5回広げる
+		for (int i = 0; i < 5; ++i)
+		{
+			left = _mm256_or_si256(left, _mm256_and_si256(cells, _mm256_sllv_epi64(left, shifts)));
+			right = _mm256_or_si256(right, _mm256_and_si256(cells, _mm256_srlv_epi64(right, shifts)));
+		}
+
+		//先に自分の石が無い向きは反転しない
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i left_open = _mm256_cmpeq_epi64(_mm256_and_si256(player, _mm256_sllv_epi64(left, shifts)), zero);
+		__m256i right_open = _mm256_cmpeq_epi64(_mm256_and_si256(player, _mm256_srlv_epi64(right, shifts)), zero);
+		__m256i flips = _mm256_or_si256(_mm256_andnot_si256(left_open, left), _mm256_andnot_si256(right_open, right));
+
+		//4つのレーンをまとめる
+		__m128i half = _mm_or_si128(_mm256_castsi256_si128(flips), _mm256_extracti128_si256(flips, 1));
+		half = _mm_or_si128(half, _mm_unpackhi_epi64(half, half));
+		return (u64)_mm_cvtsi128_si64(half);
+	}
+#endif
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "Basic.h"
+
+namespace Reversi
+{
+	//対局者の種類
+	enum class PlayerType : unsigned char
+	{
+		Human,
+		Engine,
+
+		//モンテカルロ木探索の敵AI(depthは強さ)
+		MonteCarloEngine,
+	};
+
+	/// <summary>
+	/// 対局者の設定
+	/// </summary>
+	struct PlayerSetting
+	{
+		PlayerType type;
+
+		//探索深さ(人間の場合は0)
+		unsigned char depth;
+
+		EvaluatorType evaluator;
+	};
+
+	/// <summary>
+	/// 一手分の記録
+	/// </summary>
+	struct MoveRecord
+	{
+		//着手位置(0~63、パスはGameRecord::PASS_SQUARE)
+		unsigned char square;
+
+		//探索にかかった時間(マイクロ秒)と探索ノード数(人間の手は0)
+		uint32_t microseconds;
+		u64 nodes;
+	};
+
+	/// <summary>
+	/// 一局分の棋譜
+	/// </summary>
+	struct GameRecord
+	{
+		//パスを表す着手位置
+		static constexpr unsigned char PASS_SQUARE = 64;
+
+		PlayerSetting black;
+		PlayerSetting white;
+
+		//終局時の石の数
+		unsigned char black_count;
+		unsigned char white_count;
+
+		//黒番から交互に並べた手(パスも1手とする)
+		std::vector<MoveRecord> moves;
+	};
+}
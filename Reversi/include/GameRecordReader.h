@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include "Basic.h"
+#include "Board.h"
+#include "GameRecord.h"
+#include "MappedFile.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 棋譜ファイルをメモリマップして読み込むクラス
+	/// 1局は「本体のバイト数2・チェックサム4」の見出しと、次の本体からなる
+	///   対局者の設定6・石の数2・手数1・着手位置(1手1バイト)・手ごとの探索時間とノード数(可変長整数)
+	/// 書き込み途中で切れた局や壊れた局が見つかったら、それ以降は読まない
+	/// </summary>
+	class GameRecordReader
+	{
+	public:
+		static constexpr uint32_t FILE_MAGIC = 0x52475652; // "RVGR"
+		static constexpr uint32_t FILE_VERSION = 1;
+		static constexpr size_t HEADER_SIZE = 8;
+
+		//1局ごとの見出しと、本体の固定長部分のバイト数
+		static constexpr size_t RECORD_HEADER_SIZE = 6;
+		static constexpr size_t RECORD_FIXED_SIZE = 9;
+
+		/// <summary>
+		/// ファイルをメモリマップし、正常に読める局の位置を調べます
+		/// </summary>
+		/// <param name="path">棋譜ファイル</param>
+		/// <returns>開くのに成功したか</returns>
+		bool Open(const std::string& path);
+
+		size_t GetCount() const;
+
+		/// <summary>
+		/// 正常に読める範囲のバイト数を取得します(ファイルサイズより小さければ末尾が壊れている)
+		/// </summary>
+		size_t GetValidSize() const;
+
+		/// <summary>
+		/// 一局分の棋譜を取得します
+		/// </summary>
+		/// <param name="index">局の番号</param>
+		/// <returns>棋譜</returns>
+		GameRecord Get(const size_t index) const;
+
+		//局のファイル先頭からの位置(見出しの位置)を取得する
+		size_t GetOffset(const size_t index) const;
+
+		//局の着手位置の並びを取得する(ファイルを直接指すのでコピーしない)
+		std::span<const unsigned char> GetSquares(const size_t index) const;
+
+		//終局時の黒番と白番の石の数を取得する
+		std::pair<int, int> GetResult(const size_t index) const;
+
+		/// <summary>
+		/// 初期局面から棋譜の手を順に打ち、終局の盤面を作ります
+		/// 探索時間などは読まずに着手位置だけを辿ります
+		/// </summary>
+		/// <param name="index">局の番号</param>
+		/// <param name="board">終局の盤面を受け取る盤面</param>
+		/// <returns>すべての手が合法で、石の数が記録と一致したか</returns>
+		bool Replay(const size_t index, Board& board) const;
+
+	private:
+		MappedFile file;
+
+		//各局の本体の開始位置
+		std::vector<size_t> offsets;
+		size_t valid_size = 0;
+
+		//本体のバイト数を取得する
+		size_t GetPayloadSize(const size_t index) const;
+	};
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include "GameRecord.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 棋譜ファイルに対局を追記していくクラス
+	/// 書き込みはバッファに貯めてまとめて行い、ファイルはGameRecordReaderで読む
+	/// </summary>
+	class GameRecordWriter
+	{
+	public:
+		GameRecordWriter() = default;
+		~GameRecordWriter();
+
+		GameRecordWriter(const GameRecordWriter&) = delete;
+		GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+
+		/// <summary>
+		/// 追記するファイルを開きます。末尾に途中で切れた局があれば切り捨ててから続けます
+		/// </summary>
+		/// <param name="path">棋譜ファイル</param>
+		/// <returns>開くのに成功したか(別の形式のファイルなら失敗する)</returns>
+		bool Open(const std::string& path);
+
+		/// <summary>
+		/// 書き込んでいない内容を書き出して閉じます
+		/// </summary>
+		void Close();
+
+		bool IsOpen() const;
+
+		/// <summary>
+		/// 一局分の棋譜を追記します。バッファが溜まるまでファイルには書き込みません
+		/// </summary>
+		/// <param name="record">棋譜</param>
+		/// <returns>書き込みに失敗していないか</returns>
+		bool Write(const GameRecord& record);
+
+		/// <summary>
+		/// バッファの内容をファイルに書き出します
+		/// </summary>
+		/// <returns>書き込みに成功したか</returns>
+		bool Flush();
+
+		//本体をバイト列にして追加する
+		static void Encode(const GameRecord& record, std::vector<unsigned char>& buffer);
+
+	private:
+		//この大きさを超えたらファイルに書き出す
+		static constexpr size_t FLUSH_SIZE = 1 << 20;
+
+		std::ofstream stream;
+		std::vector<unsigned char> buffer;
+	};
+}
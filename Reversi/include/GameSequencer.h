@@ -5,10 +5,15 @@
 #include <thread>
 
 #include "Board.h"
+#include "EventQueue.h"
+#include "GameRecord.h"
+#include "GameRecordWriter.h"
 #include "ReversiEngine.h"
 #include "BoardWriter.h"
 #include "InputReader.h"
+#include "LatencyHistogram.h"
 #include "MessageWriter.h"
+#include "MetricsExporter.h"
 #include "ReversiBenchmark.h"
 
 namespace Reversi
@@ -32,6 +37,33 @@ namespace Reversi
 		GameSequencer(std::shared_ptr<Board>& board, std::shared_ptr<BoardWriter>& board_writer, std::shared_ptr<MessageWriter>& message_writer);
 	
 		void Start();
+
+		//敵AIが使用する評価関数を設定する
+		void SetEvaluatorType(const EvaluatorType type);
+
+		//敵AIの探索方式を設定する
+		void SetEngineMode(const EngineMode mode);
+
+		//敵AIの置換表の大きさ(MB)と、共有する共有メモリの名前を設定する(空なら共有しない)
+		bool SetTranspositionTable(const size_t megabytes, const std::string& shared_name);
+
+		//敵AIの探索結果を引き継ぐファイルを設定する(終局ごとと終了時に保存する)
+		bool SetSearchCache(const std::string& path);
+
+		//敵AIの探索をトレースし、手を打つごとに書き出すファイルを設定する
+		void SetTracePath(const std::string& path);
+
+		//敵AIの探索スレッド数を設定する
+		void SetThreadCount(const int count);
+
+		//敵AIの探索スレッドの固定と、置換表のページの種類・NUMAノードへの配置を設定する
+		void SetHardwarePolicy(const HardwarePolicy& policy);
+
+		//敵AIの一手の思考時間とノード数のヒストグラムを、Prometheusのテキスト形式で一定間隔で書き出すファイルを設定する
+		void SetMetricsFile(const std::string& path);
+
+		//終局した対局を追記する棋譜ファイル
+		static constexpr const char* RECORD_FILE = "games.rvgr";
 	
 	private:
 		// 敵AIの強さ（探索の深さ）の定数
@@ -41,22 +73,42 @@ namespace Reversi
 		const int MIN_STRENGTH = 1;
 		const int MAX_STRENGTH = 10;
 
+		//敵AIの考え中に途中経過を更新する間隔
+		static constexpr std::chrono::milliseconds PROGRESS_INTERVAL{ 100 };
+
 		std::shared_ptr<Board> board;
 		std::shared_ptr<BoardWriter> board_writer;
 		std::shared_ptr<MessageWriter> message_writer;
 		ReversiBenchmark reversiBenchmark;
 		ReversiEngine engine;
 		InputReader reader;
+		std::shared_ptr<EventQueue> events;
+		GameRecordWriter record_writer;
+		GameRecord game_record;
 		State current_state;
 		Side player_turn;
 		Side current_turn;
 		u64 prev_input;
+		std::string trace_path;
+
+		//敵AIの一手ごとの記録(時間はナノ秒)
+		LatencyHistogram move_histogram;
+		LatencyHistogram node_histogram;
+		MetricsExporter metrics;
 
 		std::mt19937 rand_module;
 
 		void EnemyTurn();
 		void PlayerTurn();
 
+		//次のユーザー入力が届くまで待つ
+		std::wstring WaitInput();
+
+		//棋譜の記録
+		void BeginRecord();
+		void RecordMove(const u64 input, const uint32_t microseconds = 0, const u64 nodes = 0);
+		void EndRecord(const BoardInfo& board_info);
+
 		void ChangeTurn();
 		BoardInfo GetBoardInfo() const;
 		u64 GetRandomInput();
@@ -0,0 +1,55 @@
+#pragma once
+
+namespace Reversi
+{
+	//探索スレッドを論理コアに固定する方法
+	enum class ThreadPlacement : unsigned char
+	{
+		//固定しない(OSに任せる)
+		None,
+
+		//NUMAノードを1つずつ埋める(ノード間の通信が少ない)
+		Compact,
+
+		//NUMAノードに順番に振り分ける(メモリ帯域と共有キャッシュを全ノード分使う)
+		Spread,
+	};
+
+	//置換表に使うページの種類
+	enum class HugePageMode : unsigned char
+	{
+		//要求しない(OSの設定に任せる)
+		Off,
+
+		//透過的なヒュージページを要求する(Linuxはmadvise、使えなければ通常のページ)
+		Transparent,
+
+		//予約されたヒュージページを使う(LinuxはMAP_HUGETLB、Windowsはラージページ。使えなければTransparent)
+		Explicit,
+	};
+
+	//置換表のページをどのNUMAノードに置くか
+	enum class NodeMemoryPolicy : unsigned char
+	{
+		//OSに任せる(最初に書いたスレッドのノード)
+		Local,
+
+		//すべてのノードにページ単位で交互に置く
+		Interleave,
+
+		//探索スレッドと同じ配置のスレッドで区間ごとに最初に書き、スレッドの数に応じてノードに分ける
+		FirstTouch,
+	};
+
+	/// <summary>
+	/// 探索スレッドと置換表のメモリの配置の指定
+	/// </summary>
+	struct HardwarePolicy
+	{
+		ThreadPlacement thread_placement = ThreadPlacement::None;
+		HugePageMode huge_pages = HugePageMode::Off;
+		NodeMemoryPolicy node_memory = NodeMemoryPolicy::Local;
+
+		bool operator==(const HardwarePolicy&) const = default;
+	};
+}
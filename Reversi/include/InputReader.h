@@ -2,7 +2,10 @@
 
 #include <string>
 #include <iostream>
+#include <memory>
+#include <thread>
 #include "Basic.h"
+#include "EventQueue.h"
 
 namespace Reversi
 {
@@ -23,12 +26,21 @@ namespace Reversi
 	class InputReader
 	{
 	public:
-		//プレイヤーの入力コマンドを取得する
-		Command ReadCommand() const;
+		/// <summary>
+		/// 標準入力を別スレッドで読み込み、入力ごとにキューへInputイベントを送ります
+		/// 入力が閉じられたら終了コマンド(s)を送ります
+		/// </summary>
+		/// <param name="queue">入力を送るキュー</param>
+		void StartAsync(const std::shared_ptr<EventQueue>& queue) const;
+
+		//入力された文字列をコマンドに変換する
+		Command ParseCommand(std::wstring input) const;
+
+		//コマンド入力を促すメッセージを表示する
+		void WriteInitialMessage() const;
 
 	private:
 		u64 CommandToBoard(const std::wstring& command) const;
-		void WriteInitialMessage() const;
 		bool IsLegalCommand(const std::wstring& command) const;
 	};
 }
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "Basic.h"
+#include "Evaluator.h"
+#include "Position.h"
+#include "SearchResult.h"
+#include "TranspositionTable.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 1つのスレッドで多数の独立した探索を切り替えながら進めるクラス
+	/// 再帰の代わりに探索ごとの明示的なスタックで状態を持ち、置換表を引くノードに入ったら先読みだけ出して次の探索に切り替える
+	/// 他の探索を進めている間にキャッシュラインが届くので、表を引く時のメモリ待ちを隠せる
+	/// 探索の内容は手書きの評価関数・全幅探索のSearchSystemと同じ(ニューラルネットワークとMulti-ProbCutは使わない)
+	/// </summary>
+	class InterleavedSearch
+	{
+	public:
+		/// <param name="table">探索で共有する置換表</param>
+		/// <param name="slot_count">同時に進める探索の数</param>
+		InterleavedSearch(const std::shared_ptr<TranspositionTable>& table, const size_t slot_count);
+
+		/// <summary>
+		/// 評価関数のパラメータを設定します
+		/// </summary>
+		/// <param name="weights">評価パラメータ</param>
+		void SetEvaluationWeights(const std::shared_ptr<const EvaluationWeights>& weights);
+
+		/// <summary>
+		/// 空いている枠に探索を入れます
+		/// </summary>
+		/// <param name="position">手番側から見た局面(評価側)</param>
+		/// <param name="depth">探索深さ</param>
+		/// <param name="tag">終わった時に返す識別子</param>
+		/// <returns>空いている枠があったか</returns>
+		bool Add(const Position& position, const int depth, const u64 tag);
+
+		/// <summary>
+		/// いずれかの探索が終わるまで、すべての探索を順に少しずつ進めます
+		/// </summary>
+		/// <param name="tag">終わった探索の識別子</param>
+		/// <param name="result">終わった探索の結果</param>
+		/// <returns>探索が1つも無ければfalse</returns>
+		bool RunUntilComplete(u64& tag, SearchResult& result);
+
+		//進めている探索の数
+		size_t GetActiveCount() const;
+
+		//探索したノード数
+		u64 GetNodeCount() const;
+		void ResetNodeCount();
+
+	private:
+		//スタックの1段で次に行う処理
+		enum class FrameState : unsigned char
+		{
+			//ノードに入った
+			Enter,
+
+			//先読みした置換表を引く
+			Probe,
+
+			//次の子を探索する
+			Next,
+		};
+
+		/// <summary>
+		/// SearchSystem::Searchの1回の呼び出しにあたる状態
+		/// </summary>
+		struct Frame
+		{
+			Position position;
+			u64 point;
+			int depth;
+			int alpha;
+			int beta;
+			bool is_max;
+			FrameState state;
+
+			//未探索の着手可能位置と、先に探索する手
+			u64 rest;
+			u64 first;
+
+			//探索中の子への着手
+			u64 input;
+
+			//置換表を引くか(引かないノードはhashを使わない)
+			bool use_table;
+			u64 hash;
+			int original_alpha;
+			int original_beta;
+
+			SearchResult best;
+		};
+
+		/// <summary>
+		/// 1つの探索
+		/// </summary>
+		struct Slot
+		{
+			std::vector<Frame> frames;
+			u64 tag;
+			bool is_active;
+		};
+
+		std::shared_ptr<TranspositionTable> transposition_table;
+		Evaluator evaluator;
+		std::vector<Slot> slots;
+		size_t active_count;
+
+		//次に進める枠
+		size_t cursor;
+
+		u64 node_count;
+
+		//先読みを出して切り替えるか、探索が終わるまで進める(終わったらtrue)
+		bool Step(Slot& slot, SearchResult& result);
+
+		//スタックの一番上を結果とともに取り除き、親に結果を渡す(根ならtrue)
+		bool Return(Slot& slot, const SearchResult& result, SearchResult& root_result);
+
+		//子の局面をスタックに積む
+		static void PushFrame(Slot& slot, const Position& position, const u64 point, const int depth, const int alpha, const int beta, const bool is_max);
+	};
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Basic.h"
+#include "Board.h"
+#include "Evaluator.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// BoardとEvaluatorの処理を1つずつ、実際の対局の局面で繰り返し計測するクラス
+	/// 予熱の後に局面の集合を何周も回し、1周を1標本として外れ値を除いた中央値を1回あたりの時間にする
+	/// 結果はビルド間で比べられるようにJSONでも書き出す
+	/// </summary>
+	class KernelBenchmark
+	{
+	public:
+		/// <param name="position_count">計測に使う局面数</param>
+		/// <param name="repetition_count">標本の数(局面の集合を回す回数)</param>
+		KernelBenchmark(const int position_count, const int repetition_count);
+
+		/// <summary>
+		/// 棋譜ファイルの局を打ち直して局面を集めます。足りない分は固定の乱数の自己対局で補います
+		/// </summary>
+		/// <param name="record_path">棋譜ファイル(無くても良い)</param>
+		void LoadCorpus(const std::string& record_path);
+
+		//すべての処理を計測して結果を表示する
+		void Run();
+
+		/// <summary>
+		/// 結果をJSONで書き出します
+		/// </summary>
+		/// <param name="path">書き出すファイル</param>
+		/// <returns>書き出せたか</returns>
+		bool WriteJson(const std::string& path) const;
+
+		//予熱で回す回数
+		static constexpr int WARMUP_COUNT = 3;
+
+		//中央値からの差が、絶対偏差の中央値のこの倍数を超える標本は外れ値とする
+		static constexpr double OUTLIER_THRESHOLD = 3.0;
+
+	private:
+		/// <summary>
+		/// 計測に使う局面1つ分
+		/// </summary>
+		struct Sample
+		{
+			Board board;
+			Side side;
+			Position position;
+
+			//着手可能位置の1つ
+			u64 move;
+
+			//確定石の評価と同じく、石のある角と、そこから繋がりを止める側の石
+			u64 corner;
+			u64 obstacle;
+
+			//評価関数の部分の入力(相手側・評価側の順)
+			std::pair<u64, u64> field;
+			const StageWeights* stage_weights;
+			std::pair<int, int> counts;
+			std::pair<int, int> legal_counts;
+		};
+
+		/// <summary>
+		/// 1つの処理の計測結果
+		/// </summary>
+		struct Result
+		{
+			std::string name;
+			double median;
+			double mean;
+			double deviation;
+			double minimum;
+
+			//TSCで数えた1回あたりのサイクル数(x86以外は0)
+			double cycles;
+
+			int kept_count;
+
+			//最適化で処理が消えていないことの確認と、ビルド間で結果が同じことの確認に使う
+			u64 checksum;
+		};
+
+		const int position_count;
+		const int repetition_count;
+		std::vector<Sample> samples;
+		std::string corpus_source;
+		Evaluator evaluator;
+		std::vector<Result> results;
+
+		//局面を1つ加える(打てる手が無ければ加えない)
+		void AddSample(const Board& board, const Side side);
+
+		//処理を計測して結果に加える
+		template <typename Kernel>
+		void Measure(const std::string& name, Kernel kernel);
+
+		//標本から外れ値を除いて集計する
+		static Result Summarize(const std::string& name, std::vector<double> nanoseconds, const double cycles_per_nanosecond, const u64 checksum);
+
+		//時間の計測と同時に読むTSC(x86以外は0)
+		static u64 ReadTimestampCounter();
+	};
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "HardwarePolicy.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 大きな表のために、ヒュージページとNUMAノードへの配置を指定してメモリを確保するクラス
+	/// Linuxはmmapした領域にMAP_HUGETLBかmadviseでヒュージページを要求し、交互配置はmbindで指定する
+	/// WindowsはVirtualAllocのラージページ(SeLockMemoryPrivilegeが必要)と、VirtualAllocExNumaによるノードの指定を使う
+	/// 確保した領域は0で埋まっていて、返す前にすべてのページに書き込んで物理メモリを割り当てておく
+	/// </summary>
+	class LargePageMemory
+	{
+	public:
+		LargePageMemory();
+		~LargePageMemory();
+
+		LargePageMemory(const LargePageMemory&) = delete;
+		LargePageMemory& operator=(const LargePageMemory&) = delete;
+
+		/// <summary>
+		/// 領域を確保します。既に確保していれば解放してから確保します
+		/// ヒュージページやノードの指定が使えない時は、使える中で近いものに落として確保します
+		/// </summary>
+		/// <param name="size">大きさ</param>
+		/// <param name="huge_pages">ページの種類</param>
+		/// <param name="node_memory">ノードへの配置</param>
+		/// <param name="touch_cpus">FirstTouchで区間ごとに最初に書き込む論理コア(空なら呼んだスレッドが書く)</param>
+		/// <returns>確保できたか</returns>
+		bool Allocate(const size_t size, const HugePageMode huge_pages, const NodeMemoryPolicy node_memory, const std::vector<int>& touch_cpus);
+
+		void Free();
+
+		unsigned char* GetData() const;
+		size_t GetSize() const;
+
+		//実際に使えたページの種類と、ノードに交互に置けたか
+		HugePageMode GetHugePageMode() const;
+		bool IsInterleaved() const;
+
+		//ヒュージページに載っている大きさ(Linuxの透過的なヒュージページは/proc/self/smapsから数える)
+		size_t GetHugePageBytes() const;
+
+		//ヒュージページの大きさ(これに揃えて確保する)
+		static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+	private:
+		unsigned char* data;
+		size_t size;
+		HugePageMode huge_page_mode;
+		bool is_interleaved;
+
+		//OSから受け取った領域(揃えるために余分に取った分は返してある)
+		size_t mapped_size;
+
+		//すべてのページに書き込んで物理メモリを割り当てる
+		void Touch(const std::vector<int>& cpus);
+	};
+}
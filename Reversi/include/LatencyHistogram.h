@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "Basic.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 値の分布を固定の大きさで数えるヒストグラム(HDRヒストグラムと同じ対数・線形の区間)
+	/// 2の冪ごとの範囲をさらに等分するので、どの大きさの値も相対誤差が1/SUB_BUCKET_COUNT以下になる
+	/// 記録はロックなしで複数のスレッドから行える。いくら記録してもメモリは増えない
+	/// </summary>
+	class LatencyHistogram
+	{
+	public:
+		//値を区別する有効ビット数
+		static constexpr int PRECISION_BITS = 7;
+
+		//2の冪ごとの範囲を分ける数
+		static constexpr int SUB_BUCKET_COUNT = 1 << (PRECISION_BITS - 1);
+
+		//u64のすべての値を数えられる区間の数
+		static constexpr int BUCKET_COUNT = (64 - PRECISION_BITS + 2) * SUB_BUCKET_COUNT;
+
+		/// <summary>
+		/// ある時点の区間ごとの数。記録中に取っても良い(各区間の数はその時点のどこかの値になる)
+		/// </summary>
+		struct Snapshot
+		{
+			std::vector<u64> counts;
+			u64 count;
+			u64 sum;
+			u64 minimum;
+			u64 maximum;
+
+			double GetMean() const;
+
+			//指定した割合(0~1)の値(区間の上端を最大値で抑えたもの、記録が無ければ0)
+			u64 GetPercentile(const double ratio) const;
+
+			//指定した値と同じ区間までの数
+			u64 CountAtOrBelow(const u64 value) const;
+		};
+
+		LatencyHistogram();
+
+		void Record(const u64 value);
+
+		//記録を消す(記録中には呼ばないこと)
+		void Reset();
+
+		Snapshot GetSnapshot() const;
+
+		static int GetIndex(const u64 value);
+		static u64 GetLowerBound(const int index);
+		static u64 GetUpperBound(const int index);
+
+	private:
+		std::atomic<u64> counts[BUCKET_COUNT];
+		std::atomic<u64> sum;
+		std::atomic<u64> minimum;
+		std::atomic<u64> maximum;
+	};
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Reversi
+{
+	/// <summary>
+	/// 同じマシンのプロセス間で使うUnixドメインソケットを、1行ずつ読み書きできるようにするクラス
+	/// WindowsではWinsockのAF_UNIX(Windows 10以降)を使う
+	/// </summary>
+	class LocalSocket
+	{
+	public:
+		LocalSocket();
+		~LocalSocket();
+
+		LocalSocket(const LocalSocket&) = delete;
+		LocalSocket& operator=(const LocalSocket&) = delete;
+		LocalSocket(LocalSocket&& other) noexcept;
+		LocalSocket& operator=(LocalSocket&& other) noexcept;
+
+		/// <summary>
+		/// 指定したパスで接続を待ち受けます(残っている古いソケットファイルは消す)
+		/// </summary>
+		/// <param name="path">ソケットファイルのパス</param>
+		/// <returns>待ち受けを始められたか</returns>
+		bool Listen(const std::string& path);
+
+		/// <summary>
+		/// 接続を1つ受け付けます。Shutdownされるか失敗すると開いていないソケットを返します
+		/// </summary>
+		LocalSocket Accept() const;
+
+		/// <summary>
+		/// 待ち受けているソケットに接続します
+		/// </summary>
+		/// <param name="path">ソケットファイルのパス</param>
+		/// <returns>接続できたか</returns>
+		bool Connect(const std::string& path);
+
+		/// <summary>
+		/// 改行までを1行として読みます(改行は含めない)
+		/// </summary>
+		/// <param name="line">読んだ行</param>
+		/// <returns>読めたか(相手が閉じたらfalse)</returns>
+		bool ReadLine(std::string& line);
+
+		//1行を改行を付けて送る
+		bool WriteLine(const std::string& line);
+
+		//別スレッドで待っている受け付けや読み込みを終わらせる
+		void Shutdown();
+
+		void Close();
+		bool IsOpen() const;
+
+	private:
+		//ソケットの記述子(WindowsではSOCKET)
+		std::intptr_t descriptor;
+
+		//読み込んだが、まだ行として返していない分
+		std::string buffer;
+
+		//待ち受けているソケットファイルのパス(閉じる時に消す)
+		std::string listen_path;
+	};
+}
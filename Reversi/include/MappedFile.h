@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace Reversi
+{
+	/// <summary>
+	/// 読み取り専用でファイルをメモリにマップするクラス
+	/// </summary>
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/// <summary>
+		/// ファイルをメモリにマップします
+		/// </summary>
+		/// <param name="path">マップするファイル</param>
+		/// <returns>マップに成功したか</returns>
+		bool Open(const std::string& path);
+
+		/// <summary>
+		/// マップを解除します
+		/// </summary>
+		void Close();
+
+		bool IsOpen() const;
+		const unsigned char* GetData() const;
+		size_t GetSize() const;
+
+	private:
+		const unsigned char* data;
+		size_t size;
+
+#ifdef _WIN32
+		void* file_handle;
+		void* mapping_handle;
+#else
+		int descriptor;
+#endif
+	};
+}
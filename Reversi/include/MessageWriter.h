@@ -1,10 +1,13 @@
 #pragma once
 
+#include <bit>
 #include <string>
 #include <iostream>
-#include <thread>
+#include <limits>
 
 #include "Basic.h"
+#include "SearchProgress.h"
+#include "PositionIndex.h"
 
 namespace Reversi
 {
@@ -24,6 +27,18 @@ namespace Reversi
 		void WriteTurnMessage(const Side player_turn, const int max_depth);
 		void WriteSelectStrengthMessage(const bool invalid, const int min_strength, const int max_strength);
 		void WriteGameStartMessage();
+
+		/// <summary>
+		/// 探索の途中経過を同じ行に上書きして表示します
+		/// </summary>
+		/// <param name="progress">探索の途中経過</param>
+		void WriteSearchProgress(const SearchProgress& progress);
+
+		//探索中に受け付けないコマンドが入力された
+		void WriteSearchingCommandMessage();
+
+		//局面の索引から引いた過去の対局の勝敗を表示する
+		void WritePositionStats(const PositionStats& stats);
 	};
 }
 
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "LatencyHistogram.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// ヒストグラムをPrometheusのテキスト形式で書き出すクラス
+	/// 一定間隔でファイルを置き換えるので、node_exporterのtextfileコレクタなどから読める
+	/// 区間の境界は1, 2, 5の繰り返しで、ヒストグラムの細かい区間を境界ごとに合計する
+	/// </summary>
+	class MetricsExporter
+	{
+	public:
+		MetricsExporter();
+		~MetricsExporter();
+
+		/// <summary>
+		/// 書き出すヒストグラムを加えます。書き出しを始める前に呼んでください
+		/// </summary>
+		/// <param name="name">メトリクス名</param>
+		/// <param name="help">説明</param>
+		/// <param name="histogram">記録するヒストグラム(書き出しを止めるまで残すこと)</param>
+		/// <param name="scale">記録した値を単位(秒など)に直す倍率</param>
+		/// <param name="min_bound">最も小さい区間の境界(単位に直した値)</param>
+		/// <param name="max_bound">最も大きい区間の境界(これより大きい値は+Infにだけ数える)</param>
+		void AddHistogram(const std::string& name, const std::string& help, const LatencyHistogram& histogram,
+			const double scale, const double min_bound, const double max_bound);
+
+		//今の値をテキスト形式にする
+		std::string Format() const;
+
+		/// <summary>
+		/// 一時ファイルに書いてから置き換えます(読む側が書き込み途中のファイルを読まない)
+		/// </summary>
+		/// <returns>書き出せたか</returns>
+		bool WriteFile(const std::string& path) const;
+
+		/// <summary>
+		/// 一定間隔で書き出すスレッドを始めます
+		/// </summary>
+		/// <param name="path">書き出すファイル</param>
+		/// <param name="interval">書き出す間隔</param>
+		void Start(const std::string& path, const std::chrono::milliseconds interval);
+
+		//書き出すスレッドを止め、最後の値を書き出す
+		void Stop();
+
+		//既定の書き出す間隔
+		static constexpr std::chrono::milliseconds EXPORT_INTERVAL{ 5000 };
+
+	private:
+		/// <summary>
+		/// 書き出すヒストグラム1つ分
+		/// </summary>
+		struct Metric
+		{
+			std::string name;
+			std::string help;
+			const LatencyHistogram* histogram;
+			double scale;
+			std::vector<double> bounds;
+		};
+
+		std::vector<Metric> metrics;
+
+		//一定間隔の書き出し
+		std::string path;
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool is_stopping;
+
+		void Run(const std::chrono::milliseconds interval);
+	};
+}
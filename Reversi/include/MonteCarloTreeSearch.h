@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "Basic.h"
+#include "Board.h"
+#include "SearchResult.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// UCTで木を伸ばし、ランダムなプレイアウトの勝率で最善手を選ぶモンテカルロ木探索を行うクラス
+	/// ノードはあらかじめ確保した配列から切り出し、木の操作は不可分操作だけで行う(ロックを使わない)
+	/// 複数のスレッドは同じ木を共有し、探索中のノードに仮想的な負けを足して別の枝に分散させる
+	/// </summary>
+	class MonteCarloTreeSearch
+	{
+	public:
+		/// <param name="node_capacity">確保するノード数(使い切ると葉を展開せずにプレイアウトだけ続ける)</param>
+		explicit MonteCarloTreeSearch(const size_t node_capacity = (size_t)1 << 21);
+
+		/// <summary>
+		/// 時間かプレイアウト数の上限まで探索し、最も多く訪れた手を返します
+		/// </summary>
+		/// <param name="board">探索する盤面</param>
+		/// <param name="side">手番</param>
+		/// <param name="time_limit">探索時間</param>
+		/// <param name="thread_count">探索するスレッド数</param>
+		/// <param name="max_playouts">プレイアウト数の上限(0で時間だけで止める)</param>
+		/// <returns>最善手と、その手の勝率(千分率)</returns>
+		SearchResult Search(const Board& board, const Side side, const std::chrono::milliseconds time_limit, const int thread_count, const u64 max_playouts = 0);
+
+		//行ったプレイアウト数(探索中に別スレッドから読んでも良い)
+		u64 GetPlayoutCount() const;
+
+		//使用したノード数
+		size_t GetNodeCount() const;
+
+		/// <summary>
+		/// 探索を中断するフラグを設定します。立っている間は探索をすぐに打ち切ります
+		/// </summary>
+		/// <param name="flag">中断フラグ</param>
+		void SetStopFlag(const std::atomic<bool>* flag);
+
+		/// <summary>
+		/// 着手可能位置の中から一様に1つを選びます
+		/// 配列に並べてシャッフルせず、選んだ番号の数だけ下位のビットを消して取り出す
+		/// </summary>
+		/// <param name="bits">着手可能位置(0以外)</param>
+		/// <param name="random">64ビットの乱数</param>
+		/// <returns>選んだ位置</returns>
+		static u64 SelectRandomBit(u64 bits, const u64 random)
+		{
+			//上位32ビットを個数倍して範囲に収める(剰余を使わない)
+			int index = (int)(((random >> 32) * (u64)PopCount(bits)) >> 32);
+
+			for (; index > 0; --index)
+			{
+				bits = ResetLowestBit(bits);
+			}
+
+			return LowestBit(bits);
+		}
+
+	private:
+		//ノードの展開状態
+		enum class NodeState : unsigned char
+		{
+			//子を持たない
+			Leaf,
+
+			//いずれかのスレッドが子を作っている
+			Expanding,
+
+			//子を作り終えた(子が0個なら終局)
+			Expanded,
+		};
+
+		/// <summary>
+		/// 木のノード。子は配列上に連続して並べる
+		/// </summary>
+		struct Node
+		{
+			//このノードに至った着手(パスは0)
+			u64 move;
+
+			//子の先頭の番号と数(stateがExpandedになってから読む)
+			uint32_t first_child;
+			uint32_t child_count;
+
+			//訪問数と、この手を打った側から見た報酬(勝ち2、引き分け1、負け0)
+			std::atomic<uint32_t> visits;
+			std::atomic<uint32_t> rewards;
+
+			//探索中のスレッド数(訪問して負けたものとして扱う)
+			std::atomic<uint32_t> virtual_losses;
+
+			std::atomic<NodeState> state;
+		};
+
+		/// <summary>
+		/// プレイアウト用の軽い乱数(xorshift64*)
+		/// </summary>
+		struct Random
+		{
+			u64 state;
+
+			u64 Next()
+			{
+				state ^= state >> 12;
+				state ^= state << 25;
+				state ^= state >> 27;
+				return state * 0x2545F4914F6CDD1Dull;
+			}
+		};
+
+		//UCTの探索項の係数
+		static constexpr double EXPLORATION = 1.0;
+
+		//この訪問数に達した葉を展開する
+		static constexpr uint32_t EXPAND_VISITS = 2;
+
+		//時間と中断を確かめる間隔(プレイアウト数)
+		static constexpr int CHECK_INTERVAL = 64;
+
+		//ノードの領域と、切り出した数
+		std::vector<Node> nodes;
+		std::atomic<size_t> node_count;
+
+		std::atomic<u64> playout_count;
+		const std::atomic<bool>* stop_flag;
+
+		//探索の開始局面
+		Board root_board;
+		Side root_side;
+
+		//1スレッド分の探索を、時刻か上限に達するまで繰り返す
+		void Run(const std::chrono::steady_clock::time_point deadline, const u64 max_playouts, const u64 seed);
+
+		//根から葉まで選択・展開・プレイアウト・逆伝播を1回行う
+		void RunOnce(Random& random);
+
+		//ノードを切り出せなかったことを表す番号
+		static constexpr uint32_t INVALID_NODE = UINT32_MAX;
+
+		//ノードを初期化して連続で切り出す(足りなければINVALID_NODEを返す)
+		uint32_t Allocate(const uint32_t count);
+
+		//葉を展開する(他のスレッドが展開中なら何もしない)
+		void Expand(Node& node, const Board& board, const Side side);
+
+		//UCBが最大の子を選ぶ
+		Node& SelectChild(const Node& node);
+
+		//終局までランダムに打ち、黒番から見た石の差を返す
+		static int Playout(Board board, Side side, Random& random);
+	};
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include "Basic.h"
+#include "Position.h"
+#include "NeuralNetwork.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// ニューラルネットワークで盤面評価を行うクラス
+	/// 隠れ層1の累積値を着手・反転したマスから差分更新する
+	/// </summary>
+	class NeuralEvaluator
+	{
+	public:
+		//差分更新で保持する手数の上限
+		static constexpr int MAX_PLY = 96;
+
+		NeuralEvaluator();
+
+		//使用するネットワークを設定する
+		void SetNetwork(const std::shared_ptr<const NeuralNetwork>& network);
+
+		//ネットワークが読み込まれているか
+		bool IsAvailable() const;
+
+		/// <summary>
+		/// 着手するときに呼び出し、累積値を差分更新します
+		/// </summary>
+		/// <param name="position">着手前の局面</param>
+		/// <param name="input">着手位置</param>
+		/// <param name="flips">反転位置</param>
+		void Push(const Position& position, u64 input, u64 flips);
+
+		/// <summary>
+		/// 着手した局面の探索を終えた後に呼び出し、累積値を一手前に戻します
+		/// </summary>
+		void Pop();
+
+		//評価関数(手番側の視点で推論し、is_maxでなければ評価側の視点に反転する)
+		template <bool is_max>
+		int Evaluate(const Position& position);
+
+	private:
+		/// <summary>
+		/// 手番側・相手側それぞれを自分とした視点での隠れ層1の累積値
+		/// </summary>
+		struct alignas(32) Accumulator
+		{
+			int16_t values[2][NeuralNetwork::HIDDEN1_SIZE];
+			Position position;
+		};
+
+		std::shared_ptr<const NeuralNetwork> network;
+		std::unique_ptr<Accumulator[]> stack;
+		int ply;
+		int overflow_count;
+
+		//盤面全体から累積値を計算し直す
+		void Refresh(Accumulator& accumulator, const Position& position) const;
+
+		//特徴量のウェイトを累積値に加算・減算する
+		void AddFeature(int16_t* values, int feature) const;
+		void SubtractFeature(int16_t* values, int feature) const;
+	};
+}
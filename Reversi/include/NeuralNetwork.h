@@ -0,0 +1,99 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include "Basic.h"
+#include "MappedFile.h"
+#include "Checksum.h"
+#include "CpuFeatures.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 量子化された小さなニューラルネットワーク(NNUE形式)
+	/// 入力: 評価側128(自分64 + 相手64) → 隠れ層64(int16累積) → 32(int8) → 1
+	/// </summary>
+	class NeuralNetwork
+	{
+	public:
+		static constexpr int INPUT_SIZE = 128;
+		static constexpr int HIDDEN1_SIZE = 64;
+		static constexpr int HIDDEN2_SIZE = 32;
+
+		//活性化関数の上限(1.0を127で表す)
+		static constexpr int ACTIVATION_MAX = 127;
+
+		//int8ウェイトの量子化ビット数(1.0を64で表す)
+		static constexpr int WEIGHT_SHIFT = 6;
+
+		//ネットワークファイルの識別子とバージョン
+		static constexpr uint32_t FILE_MAGIC = 0x4E4E5652; // "RVNN"
+		static constexpr uint32_t FILE_VERSION = 1;
+
+		/// <summary>
+		/// 量子化済みのパラメータ。ファイルにはこのままの形式で保存する
+		/// </summary>
+		struct Parameters
+		{
+			alignas(32) int16_t feature_weights[INPUT_SIZE][HIDDEN1_SIZE];
+			alignas(32) int16_t feature_biases[HIDDEN1_SIZE];
+			alignas(32) int8_t hidden_weights[HIDDEN2_SIZE][HIDDEN1_SIZE];
+			alignas(32) int32_t hidden_biases[HIDDEN2_SIZE];
+			alignas(32) int8_t output_weights[HIDDEN2_SIZE];
+			int32_t output_bias;
+
+			//出力1.0あたりの評価値
+			int32_t score_scale;
+		};
+
+		/// <summary>
+		/// ネットワークファイルのヘッダー(パラメータの整列のため32バイト)
+		/// </summary>
+		struct FileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t parameter_size;
+			uint32_t checksum;
+			uint32_t reserved[4];
+		};
+
+		NeuralNetwork();
+
+		/// <summary>
+		/// ネットワークファイルをメモリマップします
+		/// </summary>
+		/// <param name="path">ネットワークファイル</param>
+		/// <returns>読み込みに成功したか</returns>
+		bool Load(const std::string& path);
+
+		/// <summary>
+		/// ネットワークファイルを書き出します
+		/// </summary>
+		/// <param name="path">書き出すファイル</param>
+		/// <param name="parameters">量子化済みのパラメータ</param>
+		/// <returns>書き出しに成功したか</returns>
+		static bool Save(const std::string& path, const Parameters& parameters);
+
+		bool IsLoaded() const;
+		const Parameters& GetParameters() const;
+
+		/// <summary>
+		/// 隠れ層の累積値から評価値を計算します
+		/// </summary>
+		/// <param name="accumulator">評価側から見た隠れ層の累積値</param>
+		/// <returns>評価値</returns>
+		int Propagate(const int16_t* accumulator) const;
+
+	private:
+		MappedFile file;
+		const Parameters* parameters;
+		bool use_avx2;
+
+		int PropagateScalar(const int16_t* accumulator) const;
+
+#ifdef REVERSI_X86
+		int PropagateAvx2(const int16_t* accumulator) const;
+#endif
+	};
+}
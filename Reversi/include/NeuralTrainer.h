@@ -0,0 +1,67 @@
+#pragma once
+
+#include <random>
+#include <vector>
+#include <memory>
+#include "NeuralNetwork.h"
+#include "TrainingData.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 教師局面からニューラルネットワークを学習し、量子化して書き出すクラス
+	/// </summary>
+	class NeuralTrainer
+	{
+	public:
+		/// <param name="epochs">学習の周回数</param>
+		/// <param name="learning_rate">学習率</param>
+		/// <param name="seed">初期値とシャッフルに使う乱数シード</param>
+		NeuralTrainer(const int epochs = 10, const float learning_rate = 0.005f, const unsigned int seed = 1234);
+
+		/// <summary>
+		/// 教師局面を読み込んで学習し、ネットワークファイルに書き出します
+		/// </summary>
+		/// <param name="dataset_path">教師局面のファイル</param>
+		/// <param name="output_path">書き出すネットワークファイル</param>
+		/// <returns>成功したか</returns>
+		bool Run(const std::string& dataset_path, const std::string& output_path);
+
+	private:
+		static constexpr int INPUT_SIZE = NeuralNetwork::INPUT_SIZE;
+		static constexpr int HIDDEN1_SIZE = NeuralNetwork::HIDDEN1_SIZE;
+		static constexpr int HIDDEN2_SIZE = NeuralNetwork::HIDDEN2_SIZE;
+
+		//ネットワークの出力1.0が表す石差
+		static constexpr float DISCS_PER_OUTPUT = 16.0f;
+
+		//石差1つあたりの評価値(EvaluationTunerと揃える)
+		static constexpr int SCORE_PER_DISC = 100;
+
+		/// <summary>
+		/// 浮動小数点のパラメータ
+		/// </summary>
+		struct FloatParameters
+		{
+			float feature_weights[INPUT_SIZE][HIDDEN1_SIZE];
+			float feature_biases[HIDDEN1_SIZE];
+			float hidden_weights[HIDDEN2_SIZE][HIDDEN1_SIZE];
+			float hidden_biases[HIDDEN2_SIZE];
+			float output_weights[HIDDEN2_SIZE];
+			float output_bias;
+		};
+
+		const int epochs;
+		const float learning_rate;
+		std::mt19937 rand_module;
+		std::unique_ptr<FloatParameters> model;
+
+		void Initialize();
+
+		//一局面で順伝播・逆伝播を行い、二乗誤差を返す
+		float Train(const TrainingRecord& record, const float rate);
+
+		//量子化したパラメータを作る
+		std::unique_ptr<NeuralNetwork::Parameters> Quantize() const;
+	};
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include "Basic.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 探索スレッド1つ分の稼働の記録
+	/// </summary>
+	struct ThreadStatistics
+	{
+		//探索したルートの手の数とノード数
+		u64 root_moves;
+		u64 nodes;
+
+		//ルートの手を探索していた時間
+		double busy_seconds;
+
+		//手を割り当ててから探索を始めるまでの時間(スレッドの起動を待つ時間)
+		double dispatch_seconds;
+	};
+
+	/// <summary>
+	/// 並列探索1回分の稼働の記録
+	/// </summary>
+	struct ParallelStatistics
+	{
+		//探索全体の経過時間
+		double wall_seconds;
+
+		//割り当てたどのスレッドも終わっていない間、結果を待っていた時間
+		double wait_seconds;
+
+		std::vector<ThreadStatistics> threads;
+	};
+}
@@ -0,0 +1,296 @@
+#pragma once
+
+#include "Basic.h"
+#include "BoardGeometry.h"
+#include "FlipKernel.h"
+#include <bit>
+#include <utility>
+
+namespace Reversi
+{
+	/// <summary>
+	/// 手番側から見た盤面(自分・相手)を表す値型(8x8では16バイト)
+	/// 探索ではコピーして渡し、着手すると新しい局面を返すので巻き戻しが不要
+	/// </summary>
+	/// <typeparam name="size">盤面の一辺のマス数</typeparam>
+	template <int size>
+	struct BasicPosition
+	{
+		using Geometry = BoardGeometry<size>;
+		using Bits = typename Geometry::Bits;
+
+		//手番側の石
+		Bits player;
+
+		//相手側の石
+		Bits opponent;
+
+		/// <summary>
+		/// 黒番・白番の盤面情報から局面を作ります
+		/// </summary>
+		/// <param name="field_data">黒番と白番の盤面情報</param>
+		/// <param name="side">手番</param>
+		/// <returns>手番側から見た局面</returns>
+		static BasicPosition FromFieldData(const std::pair<Bits, Bits> field_data, const Side side)
+		{
+			return side == Side::Black ? BasicPosition{ field_data.first, field_data.second } : BasicPosition{ field_data.second, field_data.first };
+		}
+
+		//着手可能位置を取得する
+		Bits GetLegalMoves() const
+		{
+			return ComputeLegalMoves(player, opponent);
+		}
+
+		//相手の着手可能位置を取得する
+		Bits GetOpponentLegalMoves() const
+		{
+			return ComputeLegalMoves(opponent, player);
+		}
+
+		//指定した位置に置いた時の反転位置を取得する
+		Bits GetFlips(const Bits input) const
+		{
+			return ComputeFlips(input, player, opponent);
+		}
+
+		/// <summary>
+		/// 着手後の局面を取得します。手番は相手側に移ります
+		/// </summary>
+		/// <param name="input">着手位置</param>
+		/// <param name="flips">反転位置</param>
+		/// <returns>相手側から見た着手後の局面</returns>
+		BasicPosition Play(const Bits input, const Bits flips) const
+		{
+			return { opponent ^ flips, player | input | flips };
+		}
+
+		//パスした局面を取得する
+		BasicPosition Pass() const
+		{
+			return { opponent, player };
+		}
+
+		//石が置かれている位置を取得する
+		Bits GetAllBoard() const
+		{
+			return player | opponent;
+		}
+
+		//盤面上の石の数を取得する
+		int CountStones() const
+		{
+			return PopCount(player | opponent);
+		}
+
+		bool operator==(const BasicPosition& other) const = default;
+
+		//盤面の対称変換の数(回転・反転)
+		static constexpr int SYMMETRY_COUNT = 8;
+
+		/// <summary>
+		/// 対称変換した局面を取得します(8x8のみ)
+		/// </summary>
+		/// <param name="symmetry">変換の番号(0~7、0は変換しない)</param>
+		/// <returns>変換後の局面</returns>
+		BasicPosition GetSymmetry(const int symmetry) const requires (size == 8)
+		{
+			return { TransformBits(player, symmetry), TransformBits(opponent, symmetry) };
+		}
+
+		/// <summary>
+		/// 対称な局面の中で(player, opponent)が最小のものを取得します(8x8のみ)
+		/// 回転・反転しただけの局面は同じ値になるので、局面の索引に使えます
+		/// </summary>
+		/// <returns>正規化した局面</returns>
+		BasicPosition GetCanonical() const requires (size == 8)
+		{
+			//GetSymmetryと同じ番号順に、上下・左右の反転を使い回して8通りを作る
+			u64 players[SYMMETRY_COUNT];
+			u64 opponents[SYMMETRY_COUNT];
+
+			players[0] = player;
+			players[1] = FlipVertical(player);
+			players[2] = MirrorHorizontal(player);
+			players[3] = MirrorHorizontal(players[1]);
+			opponents[0] = opponent;
+			opponents[1] = FlipVertical(opponent);
+			opponents[2] = MirrorHorizontal(opponent);
+			opponents[3] = MirrorHorizontal(opponents[1]);
+
+			for (int symmetry = 0; symmetry < 4; ++symmetry)
+			{
+				players[symmetry + 4] = FlipDiagonal(players[symmetry]);
+				opponents[symmetry + 4] = FlipDiagonal(opponents[symmetry]);
+			}
+
+			BasicPosition canonical = { players[0], opponents[0] };
+
+			for (int symmetry = 1; symmetry < SYMMETRY_COUNT; ++symmetry)
+			{
+				if (players[symmetry] < canonical.player || (players[symmetry] == canonical.player && opponents[symmetry] < canonical.opponent))
+					canonical = { players[symmetry], opponents[symmetry] };
+			}
+
+			return canonical;
+		}
+
+		//上下を反転する(8x8)
+		static u64 FlipVertical(u64 bits)
+		{
+			bits = ((bits >> 8) & 0x00FF00FF00FF00FFull) | ((bits & 0x00FF00FF00FF00FFull) << 8);
+			bits = ((bits >> 16) & 0x0000FFFF0000FFFFull) | ((bits & 0x0000FFFF0000FFFFull) << 16);
+			return (bits >> 32) | (bits << 32);
+		}
+
+		//左右を反転する(8x8)
+		static u64 MirrorHorizontal(u64 bits)
+		{
+			bits = ((bits >> 1) & 0x5555555555555555ull) | ((bits & 0x5555555555555555ull) << 1);
+			bits = ((bits >> 2) & 0x3333333333333333ull) | ((bits & 0x3333333333333333ull) << 2);
+			return ((bits >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((bits & 0x0F0F0F0F0F0F0F0Full) << 4);
+		}
+
+		//a1-h8の対角線で反転する(行と列を入れ替える、8x8)
+		static u64 FlipDiagonal(u64 bits)
+		{
+			u64 t = 0x0F0F0F0F00000000ull & (bits ^ (bits << 28));
+			bits ^= t ^ (t >> 28);
+			t = 0x3333000033330000ull & (bits ^ (bits << 14));
+			bits ^= t ^ (t >> 14);
+			t = 0x5500550055005500ull & (bits ^ (bits << 7));
+			bits ^= t ^ (t >> 7);
+			return bits;
+		}
+
+		//番号のビットごとに上下・左右・対角線の反転を組み合わせる(8x8)
+		static u64 TransformBits(u64 bits, const int symmetry)
+		{
+			if (symmetry & 1)
+				bits = FlipVertical(bits);
+			if (symmetry & 2)
+				bits = MirrorHorizontal(bits);
+			if (symmetry & 4)
+				bits = FlipDiagonal(bits);
+
+			return bits;
+		}
+
+		/// <summary>
+		/// 着手可能位置を計算します
+		/// </summary>
+		/// <param name="mine">手番側の石</param>
+		/// <param name="others">相手側の石</param>
+		/// <returns>着手可能位置</returns>
+		REVERSI_FORCE_INLINE static Bits ComputeLegalMoves(const Bits mine, const Bits others)
+		{
+			//盤面の外のビットは空きマスにしない(8x8では何もしない)
+			Bits empties = ~(mine | others) & Geometry::BOARD_MASK;
+
+			//上下端・左右端・すべての端のマスを除く
+			Bits vertical_cells = others & Geometry::VERTICAL_MASK;
+			Bits horizontal_cells = others & Geometry::HORIZONTAL_MASK;
+			Bits cross_cells = others & Geometry::ALL_SIDE_MASK;
+
+			return GetShiftedMoves(mine, vertical_cells, empties, SHIFT_VERTICAL) |
+				GetShiftedMoves(mine, horizontal_cells, empties, SHIFT_HORIZONTAL) |
+				GetShiftedMoves(mine, cross_cells, empties, SHIFT_VERTICAL + SHIFT_HORIZONTAL) |
+				GetShiftedMoves(mine, cross_cells, empties, SHIFT_VERTICAL - SHIFT_HORIZONTAL);
+		}
+
+		/// <summary>
+		/// 反転位置を計算します(8x8ではビルド時に選んだDEFAULT_FLIP_KERNELを使う)
+		/// </summary>
+		/// <param name="input">着手位置</param>
+		/// <param name="mine">手番側の石</param>
+		/// <param name="others">相手側の石</param>
+		/// <returns>反転位置</returns>
+		REVERSI_FORCE_INLINE static Bits ComputeFlips(const Bits input, const Bits mine, const Bits others)
+		{
+			return ComputeFlipsWith<DEFAULT_FLIP_KERNEL>(input, mine, others);
+		}
+
+		/// <summary>
+		/// 指定した方法で反転位置を計算します
+		/// 表引きとAVX2は8x8だけで、他の大きさとx86以外ではシフトを使う。AVX2は呼ぶ前にIsAvx2Supportedで確かめること
+		/// </summary>
+		/// <typeparam name="kernel">計算方法</typeparam>
+		template <FlipKernel kernel>
+		REVERSI_FORCE_INLINE static Bits ComputeFlipsWith(const Bits input, const Bits mine, const Bits others)
+		{
+#ifdef REVERSI_X86
+			if constexpr (size == 8 && kernel == FlipKernel::Simd)
+				return ComputeFlipsBySimd(input, mine, others);
+#endif
+			if constexpr (size == 8 && kernel == FlipKernel::Lookup)
+				return ComputeFlipsByLookup(input, mine, others);
+
+			Bits vertical_cells = others & Geometry::VERTICAL_MASK;
+			Bits horizontal_cells = others & Geometry::HORIZONTAL_MASK;
+			Bits cross_cells = others & Geometry::ALL_SIDE_MASK;
+
+			return GetShiftedFlips(input, mine, horizontal_cells, SHIFT_HORIZONTAL) |
+				GetShiftedFlips(input, mine, vertical_cells, SHIFT_VERTICAL) |
+				GetShiftedFlips(input, mine, cross_cells, SHIFT_VERTICAL - SHIFT_HORIZONTAL) |
+				GetShiftedFlips(input, mine, cross_cells, SHIFT_VERTICAL + SHIFT_HORIZONTAL);
+		}
+
+		/// <summary>
+		/// 指定した位置から十字に繋がったマスを取得します
+		/// </summary>
+		/// <param name="input">基準位置</param>
+		/// <param name="others">取得する側</param>
+		/// <returns>繋がったマスの情報</returns>
+		static Bits GetCrossFloods(const Bits input, const Bits others);
+
+	private:
+		// ビット演算に使用する定数
+		static constexpr int SHIFT_VERTICAL = Geometry::SHIFT_VERTICAL;
+		static constexpr int SHIFT_HORIZONTAL = Geometry::SHIFT_HORIZONTAL;
+
+		//石をシフトして同じ向きに繋がったマスへ広げる(回数はコンパイル時に展開する)
+		template <int count, bool is_left>
+		REVERSI_FORCE_INLINE static Bits Spread(const Bits bits, const Bits cells, const int shift)
+		{
+			if constexpr (count == 0)
+				return bits;
+			else if constexpr (is_left)
+				return Spread<count - 1, is_left>(bits | (cells & (bits << shift)), cells, shift);
+			else
+				return Spread<count - 1, is_left>(bits | (cells & (bits >> shift)), cells, shift);
+		}
+
+		//挟める石は最大で(size - 2)個
+		REVERSI_FORCE_INLINE static Bits GetShiftedMoves(const Bits mine, const Bits cells, const Bits empties, const int shift)
+		{
+			Bits moves;
+
+			//シフトして配置可能マスを絞る
+			Bits tmp = Spread<size - 3, true>(cells & (mine << shift), cells, shift);
+			moves = empties & (tmp << shift);
+
+			tmp = Spread<size - 3, false>(cells & (mine >> shift), cells, shift);
+			moves |= empties & (tmp >> shift);
+
+			return moves;
+		}
+
+		REVERSI_FORCE_INLINE static Bits GetShiftedFlips(const Bits input, const Bits mine, const Bits cells, const int shift)
+		{
+			Bits flips;
+
+			Bits flip = Spread<size - 2, false>(cells & (input >> shift), cells, shift);
+			flips = MaskIf((bool)(mine & (flip >> shift)), flip);
+
+			flip = Spread<size - 2, true>(cells & (input << shift), cells, shift);
+			flips |= MaskIf((bool)(mine & (flip << shift)), flip);
+
+			return flips;
+		}
+	};
+
+	//対局で使う8x8の局面
+	using Position = BasicPosition<DEFAULT_BOARD_SIZE>;
+
+	static_assert(sizeof(Position) == 16, "Position must stay a 16-byte value type");
+}
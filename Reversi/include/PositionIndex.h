@@ -0,0 +1,109 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Basic.h"
+#include "Position.h"
+#include "MappedFile.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 局面の索引から引いた対局の統計
+	/// 勝ち・引き分け・負けは手番側から見た数
+	/// </summary>
+	struct PositionStats
+	{
+		uint32_t wins;
+		uint32_t draws;
+		uint32_t losses;
+
+		//この局面を通った局の棋譜ファイル内の位置(先頭から最大max_postings局分)
+		std::vector<u64> game_offsets;
+	};
+
+	/// <summary>
+	/// 棋譜ファイルから作った局面の索引をメモリマップして引くクラス
+	/// 局面は回転・反転で正規化してからハッシュし、ハッシュの上位ビットのバケットから探す
+	/// ファイルは見出し・バケットごとの開始番号・ハッシュ順に並べた項目・局の位置の一覧からなる
+	/// </summary>
+	class PositionIndex
+	{
+	public:
+		static constexpr uint32_t FILE_MAGIC = 0x49505652; // "RVPI"
+		static constexpr uint32_t FILE_VERSION = 1;
+
+		/// <summary>
+		/// ファイルの見出し
+		/// </summary>
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t bucket_bits;
+			uint32_t max_plies;
+			uint32_t max_postings;
+			uint32_t reserved;
+			u64 entry_count;
+			u64 posting_count;
+			u64 game_count;
+		};
+
+		/// <summary>
+		/// 局面1つ分の項目
+		/// </summary>
+		struct Entry
+		{
+			u64 player;
+			u64 opponent;
+			uint32_t wins;
+			uint32_t draws;
+			uint32_t losses;
+			uint32_t posting_count;
+			u64 posting_index;
+		};
+
+		/// <summary>
+		/// 索引ファイルをメモリマップします
+		/// </summary>
+		/// <param name="path">索引ファイル</param>
+		/// <returns>開くのに成功したか</returns>
+		bool Open(const std::string& path);
+
+		bool IsOpen() const;
+
+		/// <summary>
+		/// 局面の統計を引きます。回転・反転した局面も同じ局面として扱います
+		/// </summary>
+		/// <param name="position">手番側から見た局面</param>
+		/// <param name="stats">統計を受け取る</param>
+		/// <returns>索引に局面があったか(索引の範囲が壊れていればfalse)</returns>
+		bool Find(const Position& position, PositionStats& stats) const;
+
+		const Header& GetHeader() const;
+		size_t GetFileSize() const;
+
+		//正規化した局面のハッシュ値を取得する
+		static u64 Hash(const Position& canonical);
+
+		//バケットの開始番号の並びの位置
+		static constexpr size_t GetBucketOffset()
+		{
+			return sizeof(Header);
+		}
+
+		//項目の並びの位置
+		static size_t GetEntryOffset(const uint32_t bucket_bits)
+		{
+			return sizeof(Header) + (((size_t)1 << bucket_bits) + 1) * sizeof(u64);
+		}
+
+	private:
+		MappedFile file;
+		Header header = {};
+	};
+
+	static_assert(sizeof(PositionIndex::Header) == 48, "index header layout must not change");
+	static_assert(sizeof(PositionIndex::Entry) == 40, "index entry layout must not change");
+}
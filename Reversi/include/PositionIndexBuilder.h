@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <future>
+#include "Basic.h"
+#include "Position.h"
+#include "GameRecordReader.h"
+#include "PositionIndex.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 棋譜ファイルを再生して局面の索引を作るクラス
+	/// 局面をハッシュの範囲で分割し、分割ごとに全局を再生して集める(メモリ使用量を抑えるため)
+	/// 分割の中では局の範囲をスレッドに割り当て、各スレッドで並べ替えてから合流させる
+	/// </summary>
+	class PositionIndexBuilder
+	{
+	public:
+		/// <param name="max_plies">索引に入れる手数(この手数までに現れた局面を入れる)</param>
+		/// <param name="max_postings">局面ごとに記録する局の位置の最大数(勝敗の数はすべて数える)</param>
+		/// <param name="memory_limit">1回の分割で集める局面に使うメモリの目安(バイト)</param>
+		PositionIndexBuilder(const int max_plies = 20, const int max_postings = 16, const size_t memory_limit = (size_t)1 << 30);
+
+		/// <summary>
+		/// 棋譜ファイルから索引ファイルを作ります
+		/// </summary>
+		/// <param name="archive_path">棋譜ファイル</param>
+		/// <param name="output_path">書き出す索引ファイル</param>
+		/// <returns>成功したか</returns>
+		bool Run(const std::string& archive_path, const std::string& output_path) const;
+
+	private:
+		/// <summary>
+		/// 局に現れた局面1つ分
+		/// </summary>
+		struct Occurrence
+		{
+			u64 hash;
+			Position position;
+			u64 game_offset;
+
+			//手番側から見た勝敗(1: 勝ち, 0: 引き分け, -1: 負け)
+			signed char result;
+
+			bool operator<(const Occurrence& other) const
+			{
+				if (hash != other.hash)
+					return hash < other.hash;
+				if (position.player != other.position.player)
+					return position.player < other.position.player;
+				if (position.opponent != other.position.opponent)
+					return position.opponent < other.position.opponent;
+				return game_offset < other.game_offset;
+			}
+		};
+
+		//まとめた項目をファイルに書き出す単位
+		static constexpr size_t WRITE_CHUNK_SIZE = 1 << 16;
+
+		const int max_plies;
+		const int max_postings;
+		const size_t memory_limit;
+
+		//局の範囲を再生し、指定した分割に入る局面を並べ替えて返す(partition_widthが0なら分割しない)
+		std::vector<Occurrence> Collect(const GameRecordReader& reader, const size_t begin, const size_t end,
+			const u64 partition_width, const u64 partition, const size_t reserve) const;
+	};
+}
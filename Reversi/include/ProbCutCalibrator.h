@@ -0,0 +1,74 @@
+#pragma once
+
+#include <random>
+#include <vector>
+#include <future>
+#include <iostream>
+#include "Board.h"
+#include "SearchSystem.h"
+#include "ProbCutTable.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// サンプル局面を実際に探索してProbCutのパラメータを求めるクラス
+	/// </summary>
+	class ProbCutCalibrator
+	{
+	public:
+		/// <param name="position_count">サンプル局面数</param>
+		/// <param name="max_depth">計測する最大の深さ</param>
+		/// <param name="seed">局面生成に使う乱数シード</param>
+		ProbCutCalibrator(const int position_count, const int max_depth, const unsigned int seed = 1234);
+
+		/// <summary>
+		/// キャリブレーションを実行し、結果をパラメータ表に書き込みます
+		/// </summary>
+		/// <param name="table">書き込むパラメータ表</param>
+		void Run(ProbCutTable& table);
+
+	private:
+		/// <summary>
+		/// 浅い探索と深い探索の結果の単回帰に使う集計値
+		/// </summary>
+		struct Regression
+		{
+			double n = 0.0;
+			double sum_x = 0.0;
+			double sum_y = 0.0;
+			double sum_xx = 0.0;
+			double sum_xy = 0.0;
+			double sum_yy = 0.0;
+
+			void Add(const double x, const double y);
+			void Merge(const Regression& other);
+			ProbCutParameter Fit() const;
+		};
+
+		/// <summary>
+		/// サンプル局面
+		/// </summary>
+		struct Sample
+		{
+			Board board;
+			Side side;
+		};
+
+		using RegressionTable = std::vector<Regression>;
+
+		//一つのパラメータを求めるのに必要な最小のサンプル数
+		static constexpr int MIN_SAMPLE_COUNT = 16;
+
+		const int position_count;
+		const int max_depth;
+		std::mt19937 rand_module;
+
+		//ランダムに打ち進めてサンプル局面を生成する
+		std::vector<Sample> CollectSamples();
+
+		//割り当てられたサンプルを探索して集計する
+		RegressionTable Measure(const std::vector<Sample>& samples, const size_t begin, const size_t end) const;
+
+		int GetIndex(const int stage, const int depth) const;
+	};
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include "Basic.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 浅い探索の結果から深い探索の結果を予測する回帰パラメータ
+	/// deep = slope * shallow + offset, 誤差の標準偏差が sigma
+	/// </summary>
+	struct ProbCutParameter
+	{
+		double slope;
+		double offset;
+		double sigma;
+	};
+
+	/// <summary>
+	/// Multi-ProbCutで使用する進行度・深さごとのパラメータ表
+	/// </summary>
+	class ProbCutTable
+	{
+	public:
+		//石数で分割する進行度の数
+		static constexpr int STAGE_COUNT = 6;
+
+		//ProbCutを試す最小・最大の深さ
+		static constexpr int MIN_DEPTH = 3;
+		static constexpr int MAX_DEPTH = 12;
+
+		//組み込みの既定値を計測した最大の深さ(これより深い深さは、計測したファイルを読み込まない限りProbCutを行わない)
+		static constexpr int DEFAULT_MAX_DEPTH = 7;
+
+		//選択度レベルの数(0は全幅探索)
+		static constexpr int SELECTIVITY_COUNT = 5;
+
+		ProbCutTable();
+
+		/// <summary>
+		/// パラメータを取得します
+		/// </summary>
+		/// <param name="stage">進行度</param>
+		/// <param name="depth">深い探索の深さ</param>
+		/// <returns>回帰パラメータ</returns>
+		const ProbCutParameter& Get(const int stage, const int depth) const;
+
+		/// <summary>
+		/// 計測したパラメータがあるかを取得します(無い進行度・深さではProbCutを行わない)
+		/// </summary>
+		/// <param name="stage">進行度</param>
+		/// <param name="depth">深い探索の深さ</param>
+		bool IsCalibrated(const int stage, const int depth) const;
+
+		/// <summary>
+		/// 計測したパラメータを設定します
+		/// </summary>
+		/// <param name="stage">進行度</param>
+		/// <param name="depth">深い探索の深さ</param>
+		/// <param name="parameter">回帰パラメータ</param>
+		void Set(const int stage, const int depth, const ProbCutParameter& parameter);
+
+		/// <summary>
+		/// ファイルからパラメータを読み込みます(ファイルに無い進行度・深さは今までのまま)
+		/// </summary>
+		/// <param name="path">読み込むファイル</param>
+		/// <returns>読み込みに成功したか</returns>
+		bool Load(const std::string& path);
+
+		/// <summary>
+		/// 計測したパラメータをファイルに書き込みます
+		/// </summary>
+		/// <param name="path">書き込むファイル</param>
+		/// <returns>書き込みに成功したか</returns>
+		bool Save(const std::string& path) const;
+
+		//石数から進行度を取得する
+		static int GetStage(const int stone_count);
+
+		//深い探索の深さから予測に使う浅い探索の深さを取得する
+		static int GetShallowDepth(const int depth);
+
+		//選択度レベルから枝刈りの閾値(何σ外れたら刈るか)を取得する
+		static double GetThreshold(const int selectivity);
+
+	private:
+		ProbCutParameter parameters[STAGE_COUNT][MAX_DEPTH + 1];
+		bool calibrated[STAGE_COUNT][MAX_DEPTH + 1];
+
+		//選択度ごとの閾値。小さいほど積極的に枝刈りする
+		static constexpr double thresholds[SELECTIVITY_COUNT] = {
+			0.0, 2.0, 1.5, 1.0, 0.6
+		};
+	};
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Basic.h"
+#include "Position.h"
+
+namespace Reversi
+{
+	//手番側から見た終局時の勝敗
+	enum class GameOutcome : unsigned char
+	{
+		//時間内に証明できなかった
+		Unknown,
+
+		Loss,
+		Draw,
+		Win,
+	};
+
+	/// <summary>
+	/// 勝敗の証明結果
+	/// </summary>
+	struct ProofResult
+	{
+		GameOutcome outcome;
+
+		//勝ちか引き分けを証明した手(負けや証明できなかった時、パスの時は0)
+		u64 move;
+	};
+
+	/// <summary>
+	/// 証明数探索(df-pn)で、手番側の勝ち・引き分け・負けを証明するクラス
+	/// 「石差1以上」を証明できなければ「石差0以上」を証明し直して、勝敗を決める
+	/// 証明数・反証数は局面と目標の石差を鍵にした表に置き、表が埋まると探索量の少ない項目から消す(ガベージコレクション)
+	/// 空きマスが少なくなった局面は、表を使わずにアルファベータ探索で読み切る
+	/// 複数のスレッドは同じ表を共有し、探索中の局面の証明数・反証数を大きく見せて別の枝に分散させる
+	/// </summary>
+	class ProofNumberSearch
+	{
+	public:
+		/// <param name="megabytes">表の大きさ(2の累乗のバケット数に切り下げる)</param>
+		explicit ProofNumberSearch(const size_t megabytes = 256);
+
+		/// <summary>
+		/// 時間の上限まで探索し、手番側の勝敗を証明します
+		/// </summary>
+		/// <param name="position">手番側から見た局面</param>
+		/// <param name="time_limit">探索時間</param>
+		/// <param name="thread_count">探索するスレッド数</param>
+		/// <returns>勝敗と、それを証明した手</returns>
+		ProofResult Solve(const Position& position, const std::chrono::milliseconds time_limit, const int thread_count);
+
+		/// <summary>
+		/// 比較のため、表を使わないアルファベータ探索だけで勝敗を読み切ります(1スレッド)
+		/// </summary>
+		/// <param name="position">手番側から見た局面</param>
+		/// <param name="time_limit">探索時間</param>
+		/// <returns>勝敗と最善手</returns>
+		ProofResult SolveByAlphaBeta(const Position& position, const std::chrono::milliseconds time_limit);
+
+		//この空きマス数以下の局面はアルファベータ探索で読み切る
+		int GetAlphaBetaEmpties() const;
+		void SetAlphaBetaEmpties(const int empties);
+
+		//直前の探索のノード数(アルファベータ探索のノードを含む。探索中に別スレッドから読んでも良い)
+		u64 GetNodeCount() const;
+
+		//直前の探索でガベージコレクションを行った回数
+		int GetCollectionCount() const;
+
+		//表に入っている項目の数と、入れられる項目の数
+		size_t GetEntryCount() const;
+		size_t GetCapacity() const;
+
+		/// <summary>
+		/// 探索を中断するフラグを設定します。立っている間は探索をすぐに打ち切ります
+		/// </summary>
+		/// <param name="flag">中断フラグ</param>
+		void SetStopFlag(const std::atomic<bool>* flag);
+
+		//証明数・反証数の無限大(証明済み・反証済み)
+		static constexpr uint32_t INFINITE_NUMBER = 0x3FFFFFFF;
+
+	private:
+		/// <summary>
+		/// 表の項目
+		/// 目標は「手番側の石差がthreshold以上」(0か1)で、証明数が0なら達成できる、反証数が0なら達成できない
+		/// </summary>
+		struct Entry
+		{
+			u64 player;
+			u64 opponent;
+			uint32_t proof;
+			uint32_t disproof;
+
+			//この局面の証明に使ったノード数(ガベージコレクションで小さいものから消す)
+			uint32_t work;
+
+			//この局面を探索中のスレッド数
+			uint16_t busy;
+
+			uint8_t threshold;
+			bool is_used;
+		};
+
+		static constexpr int BUCKET_SIZE = 4;
+
+		struct Bucket
+		{
+			Entry entries[BUCKET_SIZE];
+		};
+
+		//1スレッドの探索の状態
+		struct SearchContext
+		{
+			u64 nodes;
+
+			//node_countに足し終えたノード数
+			u64 reported_nodes;
+
+			std::chrono::steady_clock::time_point deadline;
+			int check_count;
+		};
+
+		//バケットを守るロックの数(バケットの番号の下位ビットで選ぶ)
+		static constexpr size_t LOCK_COUNT = 1024;
+
+		//探索中のスレッド1つあたりに足す証明数・反証数
+		static constexpr uint32_t VIRTUAL_NUMBER = 4;
+
+		//表の項目がこの割合を超えたらガベージコレクションを行い、この割合まで減らす
+		static constexpr double COLLECT_RATIO = 0.85;
+		static constexpr double RETAIN_RATIO = 0.5;
+
+		//アルファベータ探索で、この空きマス数より多ければ相手の着手可能数の少ない手から調べる
+		static constexpr int ORDERING_EMPTIES = 6;
+
+		//時間と中断を確かめる間隔(ノード数)
+		static constexpr int CHECK_INTERVAL = 4096;
+
+		std::vector<Bucket> buckets;
+		size_t bucket_mask;
+		std::unique_ptr<std::mutex[]> locks;
+
+		std::atomic<size_t> entry_count;
+		std::atomic<bool> is_collecting;
+		std::atomic<int> collection_count;
+
+		std::atomic<u64> node_count;
+		std::atomic<bool> is_stopped;
+		std::atomic<bool> is_finished;
+		const std::atomic<bool>* stop_flag;
+
+		int alpha_beta_empties;
+
+		//すべての項目を消す
+		void Clear();
+
+		//1スレッド分の探索を、根が証明・反証されるか中断されるまで繰り返す
+		void Run(const Position root, const int threshold, const std::chrono::steady_clock::time_point deadline);
+
+		/// <summary>
+		/// 証明数か反証数がしきい値に達するまで局面を展開します(Multiple Iterative Deepening)
+		/// </summary>
+		/// <returns>探索したノード数</returns>
+		u64 MultipleIterativeDeepening(SearchContext& context, const Position& position, const int threshold, const uint32_t proof_limit, const uint32_t disproof_limit);
+
+		/// <summary>
+		/// アルファベータ探索で終局まで読み、手番側から見た石差を返します(fail-soft)
+		/// </summary>
+		int AlphaBeta(SearchContext& context, const Position& position, int alpha, const int beta, const bool passed);
+
+		//中断するか(時間と外部のフラグはCHECK_INTERVALごとに確かめる)
+		bool IsStopped(SearchContext& context);
+
+		/// <summary>
+		/// 表を引きます。他のスレッドが探索中なら証明数・反証数を大きくして返します
+		/// </summary>
+		/// <returns>見つかったか(見つからなければ何も書き込まない)</returns>
+		bool Lookup(const Position& position, const int threshold, uint32_t& proof, uint32_t& disproof);
+
+		/// <summary>
+		/// 証明数・反証数を記録し、探索量を足して、探索中のスレッド数を変えます
+		/// バケットが埋まっていれば、探索中でない最も探索量の少ない項目を置き換えます
+		/// </summary>
+		void Store(const Position& position, const int threshold, const uint32_t proof, const uint32_t disproof, const u64 work, const int busy_delta);
+
+		//探索量の少ない項目から消し、表の項目をRETAIN_RATIOまで減らす
+		void Collect();
+
+		//局面のバケットの番号
+		size_t GetBucketIndex(const Position& position, const int threshold) const;
+	};
+}
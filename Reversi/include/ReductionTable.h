@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <algorithm>
+#include "Basic.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 探索深さの削減量と延長量を決めるパラメータ
+	/// 削減量は base + log(残りの深さ) * log(手の順番 + 1) / divisor を偶数に切り下げたもの
+	/// </summary>
+	struct ReductionParameters
+	{
+		//これより浅いノードでは削減しない
+		int min_depth = 3;
+
+		//これより前に探索する手(置換表の最善手を含む)は削減しない
+		int min_move_index = 3;
+
+		double base = 0.5;
+		double divisor = 2.0;
+
+		//打てる手が1つしか無い局面で延長する深さ(偶奇を変えないよう偶数にする)
+		int single_move_extension = 2;
+
+		//パスした局面を、深さを減らさずに相手番として探索するか(しなければその場で評価する)
+		bool is_pass_extended = true;
+	};
+
+	/// <summary>
+	/// Late Move Reductionで使う、残りの深さと手の順番ごとの削減量の表
+	/// 評価値は最後に打った側に偏るので、深さの偶奇を変えないよう削減量と延長量は偶数にする
+	/// </summary>
+	class ReductionTable
+	{
+	public:
+		//表に持つ最大の深さと手の順番(超えた分は最大のものを使う)
+		static constexpr int MAX_DEPTH = 32;
+		static constexpr int MAX_MOVE_INDEX = 32;
+
+		ReductionTable();
+
+		/// <summary>
+		/// 削減量を取得します
+		/// </summary>
+		/// <param name="depth">残りの探索深さ</param>
+		/// <param name="move_index">ノードの中で何番目に探索する手か(0から)</param>
+		/// <returns>子の探索深さから減らす深さ(子を少なくとも深さ1で探索できる量まで)</returns>
+		int GetReduction(const int depth, const int move_index) const
+		{
+			return reductions[std::min(depth, MAX_DEPTH)][std::min(move_index, MAX_MOVE_INDEX)];
+		}
+
+		const ReductionParameters& GetParameters() const;
+
+		//パラメータを設定して表を作り直す
+		void SetParameters(const ReductionParameters& parameters);
+
+		/// <summary>
+		/// ファイルからパラメータを読み込みます
+		/// </summary>
+		/// <param name="path">読み込むファイル</param>
+		/// <returns>読み込みに成功したか(失敗すれば今までのパラメータのまま)</returns>
+		bool Load(const std::string& path);
+
+		/// <summary>
+		/// パラメータをファイルに書き込みます
+		/// </summary>
+		/// <param name="path">書き込むファイル</param>
+		/// <returns>書き込みに成功したか</returns>
+		bool Save(const std::string& path) const;
+
+	private:
+		ReductionParameters parameters;
+		unsigned char reductions[MAX_DEPTH + 1][MAX_MOVE_INDEX + 1];
+
+		//パラメータから表を作る
+		void Build();
+	};
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include "Board.h"
+#include "ReductionTable.h"
+#include "SearchSystem.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 削減量のパラメータの候補を、同じ思考時間で削減しない探索と対局させて選ぶクラス
+	/// 序盤をランダムに打った同じ局面から先後を入れ替えて打ち、勝率と到達した深さを比べる
+	/// </summary>
+	class ReductionTuner
+	{
+	public:
+		/// <summary>
+		/// 対局の結果(勝敗は候補から見たもの)と、両者の探索の記録([0]が候補、[1]が相手)
+		/// </summary>
+		struct MatchResult
+		{
+			int wins = 0;
+			int draws = 0;
+			int losses = 0;
+			u64 nodes[2] = {};
+			double seconds[2] = {};
+			int depth_sum[2] = {};
+			int move_counts[2] = {};
+
+			//引き分けを半分の勝ちとした勝率
+			double GetScore() const;
+
+			//一手あたりに探索し終えた深さの平均
+			double GetAverageDepth(const int index) const;
+		};
+
+		/// <param name="game_count">1つの候補あたりの対局数(同じ序盤を先後入れ替えて打つ)</param>
+		/// <param name="milliseconds">一手の思考時間</param>
+		ReductionTuner(const int game_count, const int milliseconds);
+
+		/// <summary>
+		/// 2つの削減量の表で対局させます。どちらもMulti-ProbCutの既定の選択度で探索します
+		/// </summary>
+		/// <param name="candidate">候補の表</param>
+		/// <param name="opponent">相手の表(nullptrなら削減も延長もしない)</param>
+		MatchResult PlayMatch(const std::shared_ptr<const ReductionTable>& candidate, const std::shared_ptr<const ReductionTable>& opponent) const;
+
+		/// <summary>
+		/// 今のパラメータから割る数と削減し始める手の順番を変えた候補を、削減しない探索と対局させ、
+		/// 最も勝率の高いもの(同じなら深く読めたもの)をtableに書き込みます
+		/// どの候補も負け越せば、延長だけを残して削減しないパラメータを書き込みます
+		/// </summary>
+		/// <param name="table">書き込む表</param>
+		void Run(ReductionTable& table) const;
+
+	private:
+		int game_count;
+		std::chrono::milliseconds time_limit;
+
+		//序盤にランダムに打つ手数
+		static constexpr int RANDOM_PLIES = 8;
+
+		//候補の割る数と、削減し始める手の順番
+		static constexpr double DIVISORS[] = { 1.5, 2.0, 2.5, 3.0 };
+		static constexpr int MIN_MOVE_INDICES[] = { 2, 4 };
+	};
+}
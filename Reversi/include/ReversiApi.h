@@ -0,0 +1,121 @@
+#pragma once
+
+/*
+ * 探索エンジンをプロセス内から呼ぶためのC API
+ * 盤面は64ビットの石の配置(a1が最下位ビット)で渡し、結果は呼び出し側の構造体に書くので、呼び出しごとに確保やコピーをしない
+ *
+ * スレッドについて
+ *   別々のエンジンは、別々のスレッドから同時に使って良い
+ *   同じエンジンへの呼び出しは順に処理する(探索中に盤面を設定すると、探索が終わるまで待つ)
+ *   reversi_engine_cancelだけは、探索中に別のスレッドから呼んで良い
+ *
+ * 互換性について
+ *   構造体には項目を末尾にだけ追加し、追加した時はREVERSI_API_VERSIONを上げる
+ */
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(REVERSI_BUILD_LIBRARY)
+#define REVERSI_API __declspec(dllexport)
+#elif defined(REVERSI_STATIC_LIBRARY)
+#define REVERSI_API
+#else
+#define REVERSI_API __declspec(dllimport)
+#endif
+#else
+#define REVERSI_API __attribute__((visibility("default")))
+#endif
+
+#define REVERSI_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+	typedef struct reversi_engine reversi_engine;
+
+	typedef enum reversi_status
+	{
+		REVERSI_OK = 0,
+
+		//引数が正しくない(nullptrや置けない盤面など)
+		REVERSI_INVALID_ARGUMENT = 1,
+
+		//手番側も相手も打てない(終局している)
+		REVERSI_GAME_OVER = 2,
+
+		//1つの深さも読み終える前に中断された(結果は最初の合法手)
+		REVERSI_CANCELLED = 3,
+
+		//エンジンの内部で失敗した(メモリ不足など)
+		REVERSI_INTERNAL_ERROR = 4
+	} reversi_status;
+
+	typedef enum reversi_side
+	{
+		REVERSI_BLACK = 0,
+		REVERSI_WHITE = 1
+	} reversi_side;
+
+	/// 探索の制限(0の項目は制限しない。ただし深さは少なくとも1)
+	typedef struct reversi_limits
+	{
+		//最大の探索深さ
+		int32_t max_depth;
+
+		//思考時間の上限(ミリ秒)。過ぎると読み終えた深さまでの結果を返す
+		int32_t time_limit_ms;
+
+		//ProbCutの選択度(0で全幅探索、負なら既定値)
+		int32_t selectivity;
+	} reversi_limits;
+
+	/// 探索の結果
+	typedef struct reversi_result
+	{
+		//最善手のマスの番号(a1が0、h8が63)。パスは-1
+		int32_t move;
+
+		//手番側から見た評価値(終局まで読み切った時は、勝ちなら15000+石差、負けなら-15000+石差、引き分けなら0)
+		int32_t score;
+
+		//読み終えた深さ
+		int32_t depth;
+
+		//最大深さまで読み終えたか(時間切れや中断なら0)
+		int32_t is_complete;
+
+		//探索したノード数と経過時間
+		uint64_t nodes;
+		double seconds;
+	} reversi_result;
+
+	//ライブラリのREVERSI_API_VERSION
+	REVERSI_API uint32_t reversi_api_version(void);
+
+	/// エンジンを作る(評価パラメータなどは作業ディレクトリのファイルを読む)
+	/// thread_countが0なら論理コア数、table_megabytesが0なら既定の大きさ。失敗すればNULL
+	REVERSI_API reversi_engine* reversi_engine_create(int32_t thread_count, int32_t table_megabytes);
+
+	//探索中なら中断してから破棄する
+	REVERSI_API void reversi_engine_destroy(reversi_engine* engine);
+
+	/// 盤面と手番を設定する
+	REVERSI_API reversi_status reversi_engine_set_position(reversi_engine* engine, uint64_t black, uint64_t white, reversi_side side_to_move);
+
+	/// 設定した盤面を反復深化で探索し、結果をresultに書く(終わるまで戻らない)
+	/// 打てる手が無ければパス(move = -1)を返す
+	REVERSI_API reversi_status reversi_engine_search(reversi_engine* engine, const reversi_limits* limits, reversi_result* result);
+
+	//探索中なら中断させる(すぐ戻り、探索は読み終えた深さまでの結果を返す)
+	//これより前に呼ばれて、まだ始まっていない探索も中断させる(後から呼ばれた探索は中断しない)
+	REVERSI_API void reversi_engine_cancel(reversi_engine* engine);
+
+	//手番側の合法手(エンジンを作らずに使える)
+	REVERSI_API uint64_t reversi_legal_moves(uint64_t player, uint64_t opponent);
+
+#ifdef __cplusplus
+}
+#endif
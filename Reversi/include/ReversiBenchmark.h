@@ -4,6 +4,19 @@
 #include <vector>
 #include <algorithm>
 #include <iostream>
+#include <format>
+#include <random>
+#include "Board.h"
+#include "BoardBatch.h"
+#include "SearchSystem.h"
+#include "InterleavedSearch.h"
+#include "LatencyHistogram.h"
+#include "MonteCarloTreeSearch.h"
+#include "GameRecordReader.h"
+#include "GameRecordWriter.h"
+#include "HardwarePolicy.h"
+#include "PositionIndex.h"
+#include "SearchCache.h"
 
 namespace Reversi
 {
@@ -28,10 +41,186 @@ namespace Reversi
 		/// </summary>
 		void WriteResult();
 		void Clear();
+
+		/// <summary>
+		/// 手書きの評価関数とニューラルネットワークを対局させ、探索速度と勝率を比較します
+		/// </summary>
+		/// <param name="game_count">対局数(同じ序盤を先後入れ替えて打つ)</param>
+		/// <param name="depth">探索深さ</param>
+		/// <param name="network">ニューラルネットワーク</param>
+		static void CompareEvaluators(const int game_count, const int depth, const std::shared_ptr<const NeuralNetwork>& network);
+
+		/// <summary>
+		/// モンテカルロ木探索のスレッド数ごとのプレイアウト速度を計測し、
+		/// 同じ思考時間で反復深化のアルファベータ探索と対局させて勝率を比較します(対局はどちらも1スレッド)
+		/// </summary>
+		/// <param name="game_count">対局数(同じ序盤を先後入れ替えて打つ)</param>
+		/// <param name="milliseconds">一手の思考時間</param>
+		/// <param name="thread_count">速度を計測する最大のスレッド数</param>
+		static void CompareMonteCarlo(const int game_count, const int milliseconds, const int thread_count);
+
+		/// <summary>
+		/// 削減量のパラメータファイル(無ければ既定値)の探索と、削減も延長もしない探索を同じ思考時間で対局させ、
+		/// 勝率と一手あたりに探索し終えた深さ・ノード数・探索速度を比較します
+		/// </summary>
+		/// <param name="game_count">対局数(同じ序盤を先後入れ替えて打つ)</param>
+		/// <param name="milliseconds">一手の思考時間</param>
+		static void CompareReductions(const int game_count, const int milliseconds);
+
+		/// <summary>
+		/// ProbCutのパラメータファイル(無ければ既定値)を使う既定の選択度の探索と全幅探索で、同じ中盤の局面を同じ時間だけ反復深化し、
+		/// 探索し終えた深さ・ノード数を比較します
+		/// </summary>
+		/// <param name="position_count">局面数(序盤はランダムに打つ)</param>
+		/// <param name="milliseconds">一局面あたりの思考時間</param>
+		static void CompareProbCut(const int position_count, const int milliseconds);
+
+		/// <summary>
+		/// 置換表を使う全幅探索で自己対局し、1局ずつ再帰で探索する場合と、多数の局を1スレッドで切り替えながら探索する場合の
+		/// 1コアあたりの対局速度を比較します(先に同じ局面の探索結果が一致することを確かめる)
+		/// </summary>
+		/// <param name="game_count">対局数(序盤はランダムに打つ)</param>
+		/// <param name="depth">探索深さ</param>
+		/// <param name="slot_count">同時に進める探索の数</param>
+		/// <param name="megabytes">置換表の大きさ</param>
+		/// <returns>探索結果が一致したか</returns>
+		static bool CompareInterleavedSearch(const int game_count, const int depth, const int slot_count, const int megabytes);
+
+		/// <summary>
+		/// 空の置換表で反復深化した時(起動直後)と、保存した探索結果を読み込んでから反復深化した時(再起動後)の
+		/// 深さごとの到達時間を、同じ局面と新しい局面で比較します。壊れたファイルや古いファイルを使わないことも確かめます
+		/// </summary>
+		/// <param name="position_count">局面数</param>
+		/// <param name="depth">最大の探索深さ</param>
+		/// <param name="path">探索結果を保存するファイル(計測後に消す)</param>
+		/// <param name="megabytes">置換表の大きさ</param>
+		/// <returns>壊れたファイルと古いファイルを使わなかったか</returns>
+		static bool CompareSearchCache(const int position_count, const int depth, const std::string& path, const int megabytes);
+
+		/// <summary>
+		/// 同じ局面の最善手探索を、トレースを無効にしたエンジンと有効にしたエンジンで交互に行い、記録による遅れを表示します
+		/// 有効にした方の記録はトレースファイルに書き出します
+		/// </summary>
+		/// <param name="position_count">局面数</param>
+		/// <param name="depth">探索深さ</param>
+		/// <param name="path">書き出すトレースファイル</param>
+		/// <returns>書き出せたか</returns>
+		static bool CompareSearchTrace(const int position_count, const int depth, const std::string& path);
+
+		/// <summary>
+		/// 同じ局面の最善手探索をスレッド数を1, 2, 4, ...と倍にしながら行い、1スレッドに対する速度向上率と効率、
+		/// 余分に探索したノードの割合、スレッドごとの稼働時間・待ち時間を表示します
+		/// </summary>
+		/// <param name="position_count">局面数</param>
+		/// <param name="depth">探索深さ</param>
+		/// <param name="max_threads">最大のスレッド数(2の冪でなくても最後に計測する)</param>
+		static void RunParallelScaling(const int position_count, const int depth, const int max_threads);
+
+		/// <summary>
+		/// 同じ局面の最善手探索を、スレッドとメモリの配置を指定しない場合と指定した場合で交互に行い、
+		/// それぞれの探索速度(ノード/秒)と、置換表のうちヒュージページに載った大きさを表示します
+		/// </summary>
+		/// <param name="position_count">局面数</param>
+		/// <param name="depth">探索深さ</param>
+		/// <param name="thread_count">探索スレッド数</param>
+		/// <param name="megabytes">置換表の大きさ(MB)</param>
+		/// <param name="policy">比べる配置</param>
+		static void CompareHardwarePolicy(const int position_count, const int depth, const int thread_count, const int megabytes, const HardwarePolicy& policy);
+
+		/// <summary>
+		/// 浅い探索の自己対局で作った空きマス数の局面を、証明数探索とアルファベータ探索だけの場合で同じ時間まで読み、
+		/// 勝敗を証明できた局面の数と時間・ノード数を比べます。両方が読み切った局面は勝敗が一致することを確かめます
+		/// </summary>
+		/// <param name="position_count">局面数</param>
+		/// <param name="empties">局面の空きマス数</param>
+		/// <param name="thread_count">証明数探索のスレッド数</param>
+		/// <param name="megabytes">証明数探索の表の大きさ(MB)</param>
+		/// <param name="seconds">1局面あたりの探索時間の上限</param>
+		/// <returns>勝敗が一致したか</returns>
+		static bool CompareProofSearch(const int position_count, const int empties, const int thread_count, const int megabytes, const int seconds);
+
+		/// <summary>
+		/// 固定の乱数で作った局面を全幅探索し、探索ノード数と速度を表示します
+		/// </summary>
+		/// <param name="depth">探索深さ</param>
+		/// <param name="position_count">局面数</param>
+		/// <param name="size">盤面の一辺のマス数(8か10)</param>
+		static void RunSearchBenchmark(const int depth, const int position_count, const int size = DEFAULT_BOARD_SIZE);
+
+		/// <summary>
+		/// 初期局面から指定した深さまでの局面数を数え(パスも1手とする)、着手処理の実装ごとの速度を表示します
+		/// 8x8では反転位置の計算方法(シフト・表引き・AVX2)ごとにも数えます
+		/// </summary>
+		/// <param name="depth">深さ</param>
+		/// <param name="size">盤面の一辺のマス数(8か10)</param>
+		static void RunPerft(const int depth, const int size = DEFAULT_BOARD_SIZE);
+
+		/// <summary>
+		/// 多数の盤面を同時にランダムに終局まで打ち、BoardBatchの命令の種類ごとの速度を表示します
+		/// すべての局の終局面と石数を、Boardで1局ずつ打った結果と照合します
+		/// </summary>
+		/// <param name="board_count">同時に打つ盤面の数</param>
+		/// <param name="round_count">繰り返す回数</param>
+		/// <returns>すべての命令の種類でBoardと一致したか</returns>
+		static bool RunBatchBenchmark(const int board_count, const int round_count);
+
+		/// <summary>
+		/// ランダムな対局を棋譜ファイルに書き出してから読み直して再生し、書き込みと再生の速度を表示します
+		/// </summary>
+		/// <param name="game_count">対局数</param>
+		/// <param name="path">書き出すファイル(既存の内容は消える)</param>
+		static void RunRecordBenchmark(const int game_count, const std::string& path);
+
+		/// <summary>
+		/// 棋譜ファイルのすべての局を再生して検証し、結果を表示します
+		/// </summary>
+		/// <param name="path">棋譜ファイル</param>
+		/// <returns>すべての局を正しく再生できたか</returns>
+		static bool ReplayRecords(const std::string& path);
+
+		/// <summary>
+		/// 棋譜ファイルの局から局面を選び、回転・反転してから索引を引いて、引く時間と索引の大きさを表示します
+		/// </summary>
+		/// <param name="index_path">索引ファイル</param>
+		/// <param name="archive_path">索引を作った棋譜ファイル</param>
+		/// <param name="query_count">引く回数</param>
+		static void RunIndexBenchmark(const std::string& index_path, const std::string& archive_path, const int query_count);
+
+		/// <summary>
+		/// 時間切れまで1手ずつ深くして探索し、最後に探索し終えた深さの最善手を返します(思考時間を揃えた対局に使う)
+		/// </summary>
+		/// <param name="search_system">探索に使うクラス(中断フラグはここで設定する)</param>
+		/// <param name="position">手番側から見た局面</param>
+		/// <param name="time_limit">思考時間</param>
+		/// <param name="reached_depth">探索し終えた深さを受け取る</param>
+		/// <returns>最善手</returns>
+		static u64 SearchWithTimeLimit(SearchSystem& search_system, const Position& position, const std::chrono::milliseconds time_limit, int& reached_depth);
+
 	private:
-		std::chrono::system_clock::time_point start;
-		std::chrono::system_clock::time_point end;
-		std::vector<double> milliseconds;
-		int move_count = 0;
+		//盤面の大きさを決めた探索のベンチマーク
+		template <int size>
+		static void RunSearchBenchmarkBySize(const int depth, const int position_count);
+
+		//盤面の大きさを決めたPerft
+		template <int size>
+		static void RunPerftBySize(const int depth);
+
+		//実行時に手番を分岐するBoardの着手処理で数える
+		template <int size>
+		static u64 PerftDynamic(BasicBoard<size>& board, Side side, int depth, bool passed);
+
+		//コンパイル時に手番を決めたBoardの着手処理で数える
+		template <int size, Side side>
+		static u64 PerftStatic(BasicBoard<size>& board, int depth, bool passed);
+
+		//手番側から見た局面のコピー&メイクで、指定した方法で反転位置を計算して数える
+		template <int size, FlipKernel kernel>
+		static u64 PerftPosition(const BasicPosition<size>& position, int depth, bool passed);
+
+		std::chrono::steady_clock::time_point start;
+		std::chrono::steady_clock::time_point end;
+
+		//一手の思考時間(ナノ秒)。何手記録してもメモリは増えない
+		LatencyHistogram move_histogram;
 	};
 }
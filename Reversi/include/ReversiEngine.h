@@ -1,12 +1,21 @@
 #pragma once
 
+#include <atomic>
+#include <mutex>
 #include <thread>
 #include <vector>
 #include <queue>
 #include "Basic.h"
 #include "Board.h"
 #include "Evaluator.h"
+#include "HardwarePolicy.h"
+#include "EventQueue.h"
+#include "MonteCarloTreeSearch.h"
+#include "ParallelStatistics.h"
+#include "PositionIndex.h"
+#include "SearchCache.h"
 #include "SearchFuture.h"
+#include "SearchProgress.h"
 #include "SearchResult.h"
 
 namespace Reversi
@@ -18,6 +27,7 @@ namespace Reversi
 	{
 	public:
 		explicit ReversiEngine(std::shared_ptr<Board>& board);
+		~ReversiEngine();
 
 		//最善手を探索して取得する
 		u64 MakeBestMove();
@@ -28,22 +38,180 @@ namespace Reversi
 		//マルチスレッドで探索する関数
 		u64 MakeBestMove_Parallel();
 
+		//モンテカルロ木探索で探索する関数
+		u64 MakeBestMove_MonteCarlo();
+
+		//終盤を最終石差で完全に読み切る関数(途中経過は評価関数の勝ち・負けの値に石差を足した値で出す)
+		u64 MakeBestMove_Endgame();
+
+		/// <summary>
+		/// 最善手の探索をバックグラウンドで開始します。終わるとqueueにSearchFinishedが届きます
+		/// 探索中は盤面を変更しないでください
+		/// </summary>
+		/// <param name="queue">結果を送るキュー</param>
+		/// <returns>探索の番号(SearchFinishedのsearch_idと一致する)</returns>
+		int StartSearch(const std::shared_ptr<EventQueue>& queue);
+
+		//バックグラウンドの探索を中断し、終わるまで待つ
+		void CancelSearch();
+
+		//MakeBestMoveを呼んでいる探索を中断させる(別スレッドから呼んでも良い)
+		void RequestStop();
+
+		//中断の要求を取り消す(次の探索の前に呼ぶ)
+		void ClearStopRequest();
+
+		//中断が要求されているか(MakeBestMoveの結果が途中までのものか)
+		bool IsStopRequested() const;
+
+		//探索の途中経過を取得する(別スレッドから呼んでも良い)
+		SearchProgress GetProgress() const;
+
 		int GetSearchDepth() const;
 		void SetSearchDepth(const int depth);
 
 		void SetEvaluateSide(const Reversi::Side side);
+
+		int GetSelectivity() const;
+		void SetSelectivity(const int level);
+
+		//評価関数の切り替え(ネットワークが無い場合は手書きの評価関数のまま)
+		EvaluatorType GetEvaluatorType() const;
+		void SetEvaluatorType(const EvaluatorType type);
+
+		//探索方式の切り替え(モンテカルロ木探索では探索深さを強さとして思考時間に換算する)
+		EngineMode GetEngineMode() const;
+		void SetEngineMode(const EngineMode mode);
+
+		/// <summary>
+		/// 現在の局面を局面の索引から引きます
+		/// </summary>
+		/// <param name="side">手番</param>
+		/// <param name="stats">過去の対局の統計を受け取る</param>
+		/// <returns>索引があり、局面が見つかったか</returns>
+		bool QueryPosition(const Side side, PositionStats& stats) const;
+
+		/// <summary>
+		/// 置換表を名前付きの共有メモリに置き、同じ名前を指定した他のエンジンのプロセスと共有します
+		/// 評価関数やパラメータ、探索の設定が違うプロセスの表には接続しません(探索結果のファイルと同じ値で判定する)
+		/// </summary>
+		/// <param name="name">共有メモリの名前</param>
+		/// <returns>共有できたか(できなければ自分だけの置換表を使い続ける)</returns>
+		bool ShareTranspositionTable(const std::string& name);
+
+		//置換表の大きさを変える(MB。探索結果のファイルを開いていれば読み直す)
+		void SetTranspositionTableSize(const size_t megabytes);
+
+		/// <summary>
+		/// 探索に使うスレッド数を変えます(1ならシングルスレッド版で探索する)。探索中は呼ばないこと
+		/// 既定は論理コア数(最大64)。置換表をFirstTouchで配置していれば、置換表は確保し直して内容が消えます(探索結果のファイルを開いていれば読み直す)
+		/// </summary>
+		void SetThreadCount(const int count);
+		int GetThreadCount() const;
+
+		/// <summary>
+		/// 探索スレッドを論理コアに固定する方法と、置換表のページの種類・NUMAノードへの配置を変えます
+		/// 置換表は確保し直すので内容は消えます(探索結果のファイルを開いていれば読み直す)。探索中は呼ばないこと
+		/// </summary>
+		void SetHardwarePolicy(const HardwarePolicy& policy);
+		const HardwarePolicy& GetHardwarePolicy() const;
+
+		//置換表のうちヒュージページに載っている大きさ(バイト)
+		size_t GetTranspositionTableHugePageBytes() const;
+
+		//直前のマルチスレッド版の探索で、スレッドごとに稼働していた時間と待っていた時間を取得する(探索中は呼ばないこと)
+		ParallelStatistics GetParallelStatistics() const;
+
+		/// <summary>
+		/// 前回保存した探索結果のファイルを開き、置換表への読み込みをバックグラウンドで始めます(すぐに戻る)
+		/// 保存する時もこのファイルに書き出します
+		/// </summary>
+		/// <param name="path">ファイル</param>
+		/// <returns>使える探索結果があったか(無くても保存先には設定する)</returns>
+		bool AttachSearchCache(const std::string& path);
+
+		//置換表と完全読みの結果を探索結果のファイルに保存する(探索中は呼ばないこと)
+		bool SaveSearchCache();
+
+		//ProbCutのパラメータファイル
+		static constexpr const char* PROBCUT_FILE = "probcut.txt";
+
+		//探索深さの削減量のパラメータファイル
+		static constexpr const char* REDUCTION_FILE = "reductions.txt";
+
+		//評価パラメータのファイル
+		static constexpr const char* EVALUATION_FILE = "eval.bin";
+
+		//ニューラルネットワークのファイル
+		static constexpr const char* NEURAL_NETWORK_FILE = "nnue.bin";
+
+		//局面の索引のファイル
+		static constexpr const char* POSITION_INDEX_FILE = "positions.rvpi";
+
+		//モンテカルロ木探索で強さ1あたりに使う思考時間
+		static constexpr std::chrono::milliseconds MONTE_CARLO_TIME_PER_STRENGTH{ 200 };
+
+		//置換表の既定の大きさ(MB)
+		static constexpr size_t TRANSPOSITION_TABLE_MEGABYTES = 64;
+
+		//探索深さが空きマス数に届いていれば、この空きマス数から最終石差で完全に読み切る
+		static constexpr int ENDGAME_SOLVE_EMPTIES = 10;
 	private:
 
 		std::shared_ptr<Board> board;
-		std::vector<SearchFuture> tasks;
+		std::vector<std::unique_ptr<SearchFuture>> tasks;
 		std::queue<u64> input_queue;
 		std::future<SearchResult> futures[64];
 		SearchSystem search_system;
+		std::shared_ptr<ProbCutTable> probcut_table;
+		std::shared_ptr<ReductionTable> reduction_table;
+		std::shared_ptr<EvaluationWeights> evaluation_weights;
+		std::shared_ptr<NeuralNetwork> neural_network;
+		std::shared_ptr<PositionIndex> position_index;
+		std::shared_ptr<TranspositionTable> transposition_table;
+		size_t transposition_table_megabytes;
+
+		//再起動後に引き継ぐ探索結果と、その読み込み
+		std::shared_ptr<SearchCache> search_cache;
+		std::string search_cache_path;
+		u64 search_cache_fingerprint;
+		std::future<void> search_cache_task;
+		std::unique_ptr<MonteCarloTreeSearch> monte_carlo;
+		EngineMode engine_mode;
+		int thread_count;
+		HardwarePolicy hardware_policy;
 		Side evaluateSide;
 		unsigned long long future_count;
 
+		//バックグラウンドの探索
+		std::future<void> search_task;
+		std::atomic<bool> stop_requested;
+		int search_id;
+
+		//探索の途中経過
+		mutable std::mutex progress_mutex;
+		SearchProgress progress;
+		std::chrono::steady_clock::time_point search_start;
+		std::chrono::steady_clock::time_point search_end;
+
+		//マルチスレッド版で結果を待っていた時間
+		double parallel_wait_seconds;
+
+		//ルートの手を1つ探索し終えたら途中経過に反映する
+		void UpdateProgress(const SearchResult& result);
+
+		//探索結果の読み込みが終わるのを待つ(置換表を確保し直す前に呼ぶ)
+		void WaitSearchCache();
+
+		//開いている探索結果を置換表へ読み込み始める(確保し直して空になった置換表にも読み直す)
+		void LoadSearchCache();
+
+		//今のパラメータと探索の設定から、探索結果のファイルや共有する置換表を使えるかを判定する値を計算する
+		u64 ComputeSearchCacheFingerprint() const;
+
 		bool is_support_multi_thread;
 		int max_depth;
+		int selectivity;
 	};
 }
 
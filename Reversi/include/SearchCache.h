@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Basic.h"
+#include "MappedFile.h"
+#include "Position.h"
+#include "TranspositionTable.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 置換表と完全読みした終盤の結果を保存し、再起動後の探索に引き継ぐファイル
+	/// 開く時は見出しだけを確かめてメモリマップするので、すぐに終わる
+	/// 置換表はバケットを固定数ずつの塊に分けて塊ごとにチェックサムを持ち、読み込む時に一致した塊だけを使う
+	/// ファイルは見出し・塊ごとのチェックサム・バケット・局面順に並べた完全読みの結果からなる
+	/// </summary>
+	class SearchCache
+	{
+	public:
+		static constexpr uint32_t FILE_MAGIC = 0x43535652; // "RVSC"
+		static constexpr uint32_t FILE_VERSION = 2;
+
+		//チェックサムを計算するバケットの数(64KB)
+		static constexpr u64 CHUNK_BUCKETS = 1024;
+
+		/// <summary>
+		/// ファイルの見出し
+		/// </summary>
+		struct Header
+		{
+			uint32_t magic;
+			uint32_t version;
+
+			//見出しの他の項目のチェックサム
+			uint32_t header_checksum;
+
+			//完全読みの結果のチェックサム
+			uint32_t solved_checksum;
+
+			u64 bucket_count;
+			u64 solved_count;
+
+			//探索結果に影響するパラメータのファイルから計算した値(一致しなければ古いファイル)
+			u64 fingerprint;
+		};
+
+		/// <summary>
+		/// 完全読みした局面1つ分の結果
+		/// </summary>
+		struct SolvedEntry
+		{
+			u64 player;
+			u64 opponent;
+
+			//手番側から見た最終石差と最善手のマスの番号
+			int32_t score;
+			int32_t move;
+		};
+
+		SearchCache();
+
+		/// <summary>
+		/// ファイルをメモリマップし、見出しを確かめます。形式やパラメータが違うファイルは使いません
+		/// </summary>
+		/// <param name="path">ファイル</param>
+		/// <param name="fingerprint">今のパラメータから計算した値</param>
+		/// <returns>使えるファイルを開けたか</returns>
+		bool Open(const std::string& path, const u64 fingerprint);
+
+		void Close();
+		bool IsOpen() const;
+
+		/// <summary>
+		/// 保存した置換表の項目を、チェックサムが一致した塊の分だけ置換表の空いている場所に読み込みます
+		/// 探索中に呼んでも良い
+		/// </summary>
+		/// <param name="table">読み込む置換表</param>
+		/// <param name="corrupted_chunks">一致しなかった塊の数を受け取る</param>
+		/// <returns>読み込んだ項目の数</returns>
+		size_t LoadTranspositionTable(TranspositionTable& table, u64& corrupted_chunks) const;
+
+		/// <summary>
+		/// 完全読みした結果を探します。ファイルの結果は最初に引いた時にチェックサムを確かめます
+		/// </summary>
+		/// <param name="position">手番側から見た局面</param>
+		/// <param name="score">手番側から見た最終石差</param>
+		/// <param name="move">最善手のマスの番号</param>
+		/// <returns>見つかったか</returns>
+		bool FindSolved(const Position& position, int& score, int& move);
+
+		//完全読みした結果を追加する(次に保存する時に書き出す)
+		void AddSolved(const Position& position, const int score, const int move);
+
+		/// <summary>
+		/// 置換表と完全読みの結果を書き出します。一時ファイルに書いてから置き換えるので、途中で落ちても元のファイルは壊れません
+		/// 開いているファイルに保存すると、書き出した後に開き直します
+		/// </summary>
+		/// <param name="path">ファイル</param>
+		/// <param name="table">保存する置換表</param>
+		/// <param name="fingerprint">今のパラメータから計算した値</param>
+		/// <returns>保存できたか</returns>
+		bool Save(const std::string& path, const TranspositionTable& table, const u64 fingerprint);
+
+		/// <summary>
+		/// パラメータのファイルの内容と探索の設定から、保存した探索結果を使えるかを判定する値を計算します(無いファイルも区別する)
+		/// </summary>
+		/// <param name="paths">パラメータのファイル</param>
+		/// <param name="settings">ファイルに無い探索の設定(評価関数の種類や選択度など)</param>
+		static u64 ComputeFingerprint(const std::vector<std::string>& paths, const std::vector<u64>& settings = {});
+
+		const Header& GetHeader() const;
+
+	private:
+		MappedFile file;
+		Header header;
+		std::string opened_path;
+
+		//ファイルの完全読みの結果を確かめたか、その結果が使えるか
+		bool is_solved_checked;
+		bool is_solved_valid;
+
+		//開いてから追加した完全読みの結果
+		std::mutex solved_mutex;
+		std::unordered_map<u64, SolvedEntry> added_solved;
+
+		static u64 GetChunkCount(const u64 bucket_count);
+		static u64 GetBucketOffset(const u64 bucket_count);
+		static u64 GetSolvedOffset(const u64 bucket_count);
+		static uint32_t ComputeHeaderChecksum(const Header& header);
+
+		//局面の並び順(完全読みの結果はこの順に並べて二分探索する)
+		static bool IsLess(const SolvedEntry& entry, const u64 player, const u64 opponent);
+		static u64 HashSolved(const u64 player, const u64 opponent);
+
+		//ファイルの完全読みの結果(チェックサムが合わなければnullptr)
+		const SolvedEntry* GetFileSolved();
+
+		//ファイルの完全読みの結果を二分探索する
+		const SolvedEntry* FindFileSolved(const u64 player, const u64 opponent);
+	};
+}
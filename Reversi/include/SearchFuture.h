@@ -1,33 +1,93 @@
 #pragma once
 
+#include <condition_variable>
 #include <thread>
 #include <functional>
 #include <future>
+#include <mutex>
+#include <queue>
 #include "Board.h"
+#include "ParallelStatistics.h"
 #include "SearchSystem.h"
 
 namespace Reversi
 {
 	/// <summary>
 	/// 1スレッドに対する探索を行うクラス
+	/// 探索スレッドは作った時に1つだけ起動して論理コアに固定し、割り当てられたルートの手を順に探索する
 	/// </summary>
 	class SearchFuture
 	{
 	public:
 		explicit SearchFuture();
+		~SearchFuture();
+
+		//探索スレッドが自分を指しているので移動できない
+		SearchFuture(const SearchFuture&) = delete;
+		SearchFuture& operator=(const SearchFuture&) = delete;
 
 		void Initialize(const Board& origin, const Side side);
 		void SetSearchDepth(const int depth);
+		void SetProbCut(const std::shared_ptr<const ProbCutTable>& table, const int selectivity);
+		void SetReductions(const std::shared_ptr<const ReductionTable>& table);
+		void SetEvaluationWeights(const std::shared_ptr<const EvaluationWeights>& weights);
+		void SetEvaluator(const EvaluatorType type, const std::shared_ptr<const NeuralNetwork>& network);
+		void SetStopFlag(const std::atomic<bool>* flag);
+		void SetTranspositionTable(const std::shared_ptr<TranspositionTable>& table);
+
+		//探索するスレッドを固定する論理コア(-1なら固定しない。変わったらスレッドを作り直して固定し直す。探索していない時に呼ぶこと)
+		void SetCpu(const int cpu);
+
+		//探索したノード数
+		u64 GetNodeCount() const;
+		void ResetNodeCount();
 
-		//スレッドにスケジュールする関数
+		//探索したルートの手の数と稼働時間(探索していない時に読むこと)
+		ThreadStatistics GetStatistics() const;
+		void ResetStatistics();
+
+		//探索スレッドの待ち行列に手を入れる関数
 		std::future<SearchResult> Schedule(const u64 input);
 
 		//実際に探索を行う関数
 		SearchResult SearchBestMove();
 	private:
+		/// <summary>
+		/// 割り当てられた手と、手を割り当てた時刻
+		/// </summary>
+		struct Job
+		{
+			u64 input;
+			std::chrono::steady_clock::time_point scheduled_time;
+			std::promise<SearchResult> result;
+		};
+
 		int depth;
+		int cpu;
 		u64 assigned_input;
 		std::unique_ptr<SearchSystem> search_system;
-		std::shared_ptr<Board> board_buffer;
+
+		//探索スレッドと、まだ探索していない手(探索スレッドとはmutexで受け渡す)
+		std::thread thread;
+		std::mutex job_mutex;
+		std::condition_variable job_condition;
+		std::queue<Job> jobs;
+		bool is_stopping;
+
+		//探索中の手を割り当てた時刻と、これまでの稼働の記録
+		std::chrono::steady_clock::time_point scheduled_time;
+		u64 root_move_count;
+		double busy_seconds;
+		double dispatch_seconds;
+
+		//評価側から見た探索開始局面
+		Position root_position;
+
+		//探索スレッドを起動する・止めて終わるのを待つ
+		void StartThread();
+		void StopThread();
+
+		//探索スレッドの本体(論理コアに固定してから、手が届くたびに探索する)
+		void Run();
 	};
 }
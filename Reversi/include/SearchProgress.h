@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Basic.h"
+#include "SearchResult.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 探索の途中経過
+	/// </summary>
+	struct SearchProgress
+	{
+		//探索深さ
+		int depth;
+
+		//探索し終えた手の数と着手可能数
+		int completed_moves;
+		int total_moves;
+
+		//ここまでの最善手
+		SearchResult best;
+
+		//探索したノード数と経過時間
+		u64 nodes;
+		double seconds;
+
+		//探索が終わっているか
+		bool is_finished;
+	};
+}
@@ -7,9 +7,14 @@ namespace Reversi
 	/// <summary>
 	/// 探索結果
 	/// </summary>
-	struct SearchResult
+	/// <typeparam name="Bits">盤面情報の型</typeparam>
+	template <typename Bits>
+	struct BasicSearchResult
 	{
 		int Score;
-		u64 Point;
+		Bits Point;
 	};
+
+	//8x8の盤面の探索結果
+	using SearchResult = BasicSearchResult<u64>;
 }
@@ -1,22 +1,130 @@
 #pragma once
 
+#include <atomic>
 #include "Evaluator.h"
+#include "NeuralEvaluator.h"
+#include "ProbCutTable.h"
+#include "ReductionTable.h"
 #include "SearchResult.h"
+#include "TranspositionTable.h"
 
 namespace Reversi
 {
 	/// <summary>
 	/// アルファベータ法で最善手探索を行うクラス
+	/// ニューラルネットワークの評価関数とMulti-ProbCutは8x8の盤面でのみ使用する
+	/// Late Move ReductionはMulti-ProbCutと同じく前向き枝刈りを行うノードだけで使う(選択度0では削減しない)
 	/// </summary>
-	class SearchSystem
+	/// <typeparam name="size">盤面の一辺のマス数</typeparam>
+	template <int size>
+	class BasicSearchSystem
 	{
 	public:
-		Side evaluateSide;
+		using Position = BasicPosition<size>;
+		using Bits = typename Position::Bits;
+		using SearchResult = BasicSearchResult<Bits>;
 
-		SearchSystem(std::shared_ptr<Board>& board);
-		SearchResult AlphaBetaSearch(u64 point, int depth, int alpha, int beta, Side side);
+		BasicSearchSystem();
+
+		/// <summary>
+		/// アルファベータ法で探索します。局面は値で受け取り、着手した局面を子に渡すので巻き戻しは行いません
+		/// </summary>
+		/// <param name="position">手番側から見た局面</param>
+		/// <param name="point">この局面に至った着手位置</param>
+		/// <param name="depth">残りの探索深さ</param>
+		/// <param name="alpha">α値</param>
+		/// <param name="beta">β値</param>
+		/// <param name="is_max">手番側が評価側か</param>
+		/// <returns>評価側から見た評価値と最善手</returns>
+		SearchResult AlphaBetaSearch(Position position, Bits point, int depth, int alpha, int beta, bool is_max);
+
+		/// <summary>
+		/// Multi-ProbCutの設定を行います
+		/// </summary>
+		/// <param name="table">回帰パラメータ表</param>
+		/// <param name="selectivity">選択度レベル(0で全幅探索)</param>
+		void SetProbCut(const std::shared_ptr<const ProbCutTable>& table, const int selectivity);
+
+		/// <summary>
+		/// 後から探索する手の深さを減らす量と、1手しか無い局面やパスの延長を設定します
+		/// 削減した手がα値(最小化側はβ値)を超えたら、元の深さで探索し直します
+		/// </summary>
+		/// <param name="table">削減量の表(nullptrなら削減も延長もせず、パスした局面はその場で評価する)</param>
+		void SetReductions(const std::shared_ptr<const ReductionTable>& table);
+
+		/// <summary>
+		/// 評価関数のパラメータを設定します
+		/// </summary>
+		/// <param name="weights">評価パラメータ</param>
+		void SetEvaluationWeights(const std::shared_ptr<const EvaluationWeights>& weights);
+
+		/// <summary>
+		/// 使用する評価関数を設定します。ネットワークが無い場合は手書きの評価関数を使います
+		/// </summary>
+		/// <param name="type">評価関数の種類</param>
+		/// <param name="network">ニューラルネットワーク</param>
+		void SetEvaluator(const EvaluatorType type, const std::shared_ptr<const NeuralNetwork>& network);
+		EvaluatorType GetEvaluatorType() const;
+
+		//探索したノード数(探索中に別スレッドから読んでも良い)
+		u64 GetNodeCount() const;
+		void ResetNodeCount();
+
+		/// <summary>
+		/// 探索を中断するフラグを設定します。立っている間は探索をすぐに打ち切ります(結果は使えません)
+		/// </summary>
+		/// <param name="flag">中断フラグ</param>
+		void SetStopFlag(const std::atomic<bool>* flag);
+
+		/// <summary>
+		/// 置換表を設定します。同じ深さで探索した局面の結果を使い、記録した最善手から先に探索します
+		/// </summary>
+		/// <param name="table">置換表(nullptrで使わない)</param>
+		void SetTranspositionTable(const std::shared_ptr<TranspositionTable>& table);
 	private:
-		std::shared_ptr<Board> board;
-		Evaluator evaluator;
+		BasicEvaluator<size> evaluator;
+		NeuralEvaluator neural_evaluator;
+		EvaluatorType evaluator_type;
+		std::atomic<u64> node_count;
+		const std::atomic<bool>* stop_flag;
+		std::shared_ptr<TranspositionTable> transposition_table;
+
+		std::shared_ptr<const ProbCutTable> probcut_table;
+		double probcut_threshold;
+		std::shared_ptr<const ReductionTable> reduction_table;
+
+		/// <summary>
+		/// 探索ノードの種類
+		/// </summary>
+		enum class NodeType : unsigned char
+		{
+			//前向き枝刈りを行わない(ProbCutの浅い探索もこちら)
+			FullWidth,
+
+			//Multi-ProbCutによる前向き枝刈りを行う
+			Selective,
+		};
+
+		/// <summary>
+		/// 評価関数・手番・ノードの種類をコンパイル時に決めた探索
+		/// 実行時の分岐はAlphaBetaSearchで一度だけ行い、各組み合わせごとに分岐の無いコードを生成させる
+		/// </summary>
+		template <EvaluatorType evaluation, bool is_max, NodeType node_type>
+		SearchResult Search(Position position, Bits point, int depth, int alpha, int beta);
+
+		//手番で振り分ける
+		template <EvaluatorType evaluation, NodeType node_type>
+		SearchResult Search(const Position& position, Bits point, int depth, int alpha, int beta, bool is_max);
+
+		//浅い探索で深い探索の結果を予測し、窓の外に出ると判断できれば枝刈りする
+		template <EvaluatorType evaluation, bool is_max>
+		bool TryProbCut(const Position& position, int depth, int alpha, int beta, int& score);
+
+		//選択された評価関数で評価する
+		template <EvaluatorType evaluation, bool is_max>
+		int Evaluate(const Position& position);
 	};
+
+	//対局で使う8x8の探索
+	using SearchSystem = BasicSearchSystem<DEFAULT_BOARD_SIZE>;
 }
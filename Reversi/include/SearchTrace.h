@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace Reversi
+{
+	/// <summary>
+	/// 探索の流れをスレッドごとのリングバッファに記録し、Chromeのトレース形式(JSON)で書き出すクラス
+	/// 書き出したファイルはPerfetto(ui.perfetto.dev)やchrome://tracingでオフラインで開ける
+	/// 無効な間は記録する関数の先頭で1回読むだけで戻り、REVERSI_NO_TRACEを定義するとコンパイル時に消える
+	/// </summary>
+	class SearchTrace
+	{
+	public:
+		//1スレッドのリングバッファに残す記録の数(古いものから上書きする)
+		static constexpr size_t BUFFER_EVENTS = 1 << 14;
+
+		static void Enable(const bool is_enabled);
+
+		static bool IsEnabled()
+		{
+#ifdef REVERSI_NO_TRACE
+			return false;
+#else
+			return enabled.load(std::memory_order_relaxed);
+#endif
+		}
+
+		/// <summary>
+		/// 区間の始まりを記録します。同じスレッドで対応するEndを呼んでください
+		/// </summary>
+		/// <param name="name">区間の名前(文字列リテラルなど、書き出すまで残る文字列)</param>
+		/// <param name="value">区間に付ける値(着手位置や深さなど)</param>
+		static void Begin(const char* name, const long long value = 0)
+		{
+			if (IsEnabled())
+				Record(name, 'B', value);
+		}
+
+		static void End(const char* name, const long long value = 0)
+		{
+			if (IsEnabled())
+				Record(name, 'E', value);
+		}
+
+		//一瞬の出来事を記録する
+		static void Instant(const char* name, const long long value = 0)
+		{
+			if (IsEnabled())
+				Record(name, 'i', value);
+		}
+
+		/// <summary>
+		/// すべてのスレッドの記録を書き出します。探索していない時に呼んでください
+		/// </summary>
+		/// <param name="path">書き出すファイル</param>
+		/// <returns>書き出せたか</returns>
+		static bool Export(const std::string& path);
+
+		//すべての記録を消す
+		static void Clear();
+
+		/// <summary>
+		/// スコープの間を1つの区間として記録する
+		/// </summary>
+		class Scope
+		{
+		public:
+			Scope(const char* name, const long long value = 0) : name(name), is_recorded(IsEnabled())
+			{
+				if (is_recorded)
+					Record(name, 'B', value);
+			}
+
+			~Scope()
+			{
+				//途中で無効にしても区間を閉じる
+				if (is_recorded)
+					Record(name, 'E', 0);
+			}
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			const char* name;
+			bool is_recorded;
+		};
+
+	private:
+		static inline std::atomic<bool> enabled{ false };
+
+		static void Record(const char* name, const char phase, const long long value);
+	};
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Basic.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// EngineServiceに多数のセッションから同時に探索を依頼し、セッションごとの応答時間の分布を表示するクラス
+	/// セッションごとに1本の接続とスレッドを使い、ランダムな手を打ってはエンジンに次の手を依頼して終局まで打つことを繰り返す
+	/// </summary>
+	class ServiceLoadGenerator
+	{
+	public:
+		/// <param name="path">サービスのソケットファイル</param>
+		/// <param name="session_count">同時に打つセッションの数</param>
+		/// <param name="seconds">負荷をかける時間</param>
+		/// <param name="max_depth">依頼する最大の探索深さ</param>
+		/// <param name="deadline_milliseconds">依頼する探索の期限</param>
+		ServiceLoadGenerator(const std::string& path, const int session_count, const int seconds, const int max_depth, const int deadline_milliseconds);
+
+		/// <summary>
+		/// 負荷をかけて結果を表示します
+		/// </summary>
+		/// <returns>すべてのセッションがエラー無く終わったか</returns>
+		bool Run();
+
+	private:
+		/// <summary>
+		/// 1つのセッションの結果
+		/// </summary>
+		struct SessionResult
+		{
+			//依頼してから応答を受け取るまでの時間(ミリ秒)
+			std::vector<double> latencies;
+
+			//期限までに1手も読めなかった応答の数
+			int timeout_count = 0;
+
+			int game_count = 0;
+			bool is_failed = false;
+		};
+
+		std::string path;
+		int session_count;
+		int seconds;
+		int max_depth;
+		int deadline_milliseconds;
+
+		//1つのセッションで時間まで対局を繰り返す
+		void RunSession(const int index, SessionResult& result) const;
+
+		//並べ替えた応答時間からパーセンタイルを求める
+		static double GetPercentile(const std::vector<double>& sorted, const double percent);
+
+		//件数とパーセンタイルを1行にまとめる
+		static std::wstring FormatLatencies(std::vector<double> latencies);
+	};
+}
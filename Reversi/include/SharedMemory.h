@@ -0,0 +1,63 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+namespace Reversi
+{
+	/// <summary>
+	/// 名前付きの共有メモリを読み書きできるようにマップするクラス
+	/// POSIXではshm_open、Windowsではページファイルを使う名前付きのファイルマッピングを使う
+	/// </summary>
+	class SharedMemory
+	{
+	public:
+		SharedMemory();
+		~SharedMemory();
+
+		SharedMemory(const SharedMemory&) = delete;
+		SharedMemory& operator=(const SharedMemory&) = delete;
+
+		/// <summary>
+		/// 共有メモリを新しく作ってマップします。作った直後の内容は0で埋まっています
+		/// </summary>
+		/// <param name="name">共有メモリの名前</param>
+		/// <param name="size">大きさ</param>
+		/// <returns>作れたか(同じ名前が既にあれば失敗する)</returns>
+		bool Create(const std::string& name, const size_t size);
+
+		/// <summary>
+		/// 既存の共有メモリをマップします
+		/// </summary>
+		/// <param name="name">共有メモリの名前</param>
+		/// <returns>マップできたか(まだ大きさが決まっていなければ失敗する)</returns>
+		bool Open(const std::string& name);
+
+		/// <summary>
+		/// マップを解除します。共有メモリ自体は他のプロセスのために残ります
+		/// </summary>
+		void Close();
+
+		/// <summary>
+		/// 共有メモリの名前を消します。マップ中のプロセスはそのまま使い続けられ、すべて解除されると解放されます
+		/// (Windowsでは最後のハンドルを閉じた時に消えるので何もしない)
+		/// </summary>
+		/// <param name="name">共有メモリの名前</param>
+		static void Remove(const std::string& name);
+
+		bool IsOpen() const;
+		unsigned char* GetData() const;
+		size_t GetSize() const;
+
+	private:
+		unsigned char* data;
+		size_t size;
+
+#ifdef _WIN32
+		void* mapping_handle;
+#endif
+
+		//OSごとの名前の決まりに合わせる
+		static std::string GetSystemName(const std::string& name);
+	};
+}
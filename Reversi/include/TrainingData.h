@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include "Basic.h"
+#include "MappedFile.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 教師局面。手番側から見た最終石差をラベルに持つ
+	/// </summary>
+	struct TrainingRecord
+	{
+		u64 black;
+		u64 white;
+		Side side;
+		int8_t score;
+	};
+
+	/// <summary>
+	/// 教師局面のバイナリファイルを扱うクラス
+	/// 1局面を18バイト(黒8・白8・手番1・石差1)で保存する
+	/// </summary>
+	class TrainingData
+	{
+	public:
+		static constexpr uint32_t FILE_MAGIC = 0x44545652; // "RVTD"
+		static constexpr uint32_t FILE_VERSION = 1;
+		static constexpr size_t HEADER_SIZE = 8;
+		static constexpr size_t RECORD_SIZE = 18;
+
+		/// <summary>
+		/// 教師局面をファイルに追記します
+		/// </summary>
+		/// <param name="path">書き出すファイル</param>
+		/// <param name="records">教師局面</param>
+		/// <returns>書き出しに成功したか</returns>
+		static bool Append(const std::string& path, const std::vector<TrainingRecord>& records);
+
+		/// <summary>
+		/// ファイルをメモリマップして開きます
+		/// </summary>
+		/// <param name="path">教師局面のファイル</param>
+		/// <returns>開くのに成功したか</returns>
+		bool Open(const std::string& path);
+
+		size_t GetCount() const;
+		TrainingRecord Get(const size_t index) const;
+
+	private:
+		MappedFile file;
+		size_t count = 0;
+	};
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <random>
+#include <vector>
+#include <future>
+#include "Board.h"
+#include "SearchSystem.h"
+#include "TrainingData.h"
+
+namespace Reversi
+{
+	/// <summary>
+	/// 自己対局と終盤の完全読みで教師局面を集めるクラス
+	/// </summary>
+	class TrainingDataGenerator
+	{
+	public:
+		/// <param name="game_count">自己対局数</param>
+		/// <param name="search_depth">自己対局の探索深さ</param>
+		/// <param name="random_plies">序盤にランダムに打つ手数</param>
+		/// <param name="solve_empties">完全読みでラベルを付ける空きマス数</param>
+		/// <param name="seed">乱数シード</param>
+		TrainingDataGenerator(const int game_count, const int search_depth, const int random_plies = 10,
+			const int solve_empties = 10, const unsigned int seed = 1234);
+
+		/// <summary>
+		/// 自己対局を行い、教師局面をファイルに追記します
+		/// </summary>
+		/// <param name="path">書き出すファイル</param>
+		/// <returns>書き出しに成功したか</returns>
+		bool Run(const std::string& path) const;
+
+	private:
+		const int game_count;
+		const int search_depth;
+		const int random_plies;
+		const int solve_empties;
+		const unsigned int seed;
+
+		//割り当てられた数の自己対局を行う
+		std::vector<TrainingRecord> PlayGames(const int count, const unsigned int game_seed) const;
+	};
+}
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Basic.h"
+#include "Bitboard.h"
+#include "CpuFeatures.h"
+#include "HardwarePolicy.h"
+#include "LargePageMemory.h"
+#include "SharedMemory.h"
+
+namespace Reversi
+{
+	//置換表に記録した評価値の意味
+	enum class TranspositionBound : unsigned char
+	{
+		//正確な値
+		Exact,
+
+		//本当の値はこれ以上(βカット)
+		Lower,
+
+		//本当の値はこれ以下(すべての手がα以下)
+		Upper,
+	};
+
+	/// <summary>
+	/// 置換表から読み出した内容
+	/// </summary>
+	struct TranspositionEntry
+	{
+		int score;
+		int depth;
+		TranspositionBound bound;
+
+		//最善手のマスの番号(無ければNO_MOVE)
+		int move;
+
+		//前向き枝刈り(ProbCut・LMR)をしたノードの結果か
+		bool is_selective;
+	};
+
+	/// <summary>
+	/// 探索した局面の評価値の範囲と最善手を記録するハッシュ表
+	/// 1つのキャッシュラインに4つの項目を入れたバケットを並べ、局面のハッシュ値でバケットを選ぶ
+	/// 項目は「ハッシュ値 ^ 内容」と「内容」の2語で書き、読む時に一致を確かめるのでロックを使わない(壊れた項目は無視される)
+	/// 名前付きの共有メモリに置くと、同じマシンの複数のプロセスで表を共有できる
+	/// 自分だけの表はヒュージページとNUMAノードへの配置を指定して確保できる
+	/// </summary>
+	class TranspositionTable
+	{
+	public:
+		//これより浅いノードは表を引かない(葉の近くは引く手間の方が大きい)
+		static constexpr int MIN_DEPTH = 2;
+
+		//最善手が無いことを表すマスの番号
+		static constexpr int NO_MOVE = 127;
+
+		/// <param name="megabytes">表の大きさ(2の累乗のバケット数に切り下げる)</param>
+		explicit TranspositionTable(const size_t megabytes = 64);
+
+		//表の大きさを変える(内容は消える。共有中は共有メモリを作り直し、他のプロセスは次の探索から新しい表に移る)
+		void Resize(const size_t megabytes);
+
+		//すべての項目を消す(共有中は他のプロセスの分も消える)
+		void Clear();
+
+		//新しい探索を始める(古い探索の項目を優先して置き換える。共有メモリが作り直されていれば接続し直す)
+		void NewSearch();
+
+		//世代だけを進める(探索中の別スレッドから呼んでも良い。共有メモリは接続し直さない)
+		void AdvanceGeneration();
+
+		/// <summary>
+		/// 表を名前付きの共有メモリに置きます。既にあれば接続してその大きさを使い、無ければ作ります
+		/// 作成中のプロセスが落ちて初期化されないまま残った共有メモリは、しばらく待ってから作り直します
+		/// </summary>
+		/// <param name="name">共有メモリの名前</param>
+		/// <param name="megabytes">新しく作る時の大きさ</param>
+		/// <param name="fingerprint">評価関数やパラメータ、探索の設定から計算した値(違う値のプロセスが作った表には接続しない)</param>
+		/// <returns>共有できたか(できなければ今までの表を使い続ける)</returns>
+		bool AttachShared(const std::string& name, const size_t megabytes, const u64 fingerprint);
+
+		//共有をやめて、同じ大きさの自分だけの表に戻す(共有メモリは他のプロセスのために残す)
+		void DetachShared();
+
+		bool IsShared() const;
+
+		/// <summary>
+		/// 自分だけの表の領域をヒュージページとNUMAノードへの配置を指定して確保し直します(内容は消える)
+		/// 共有中は共有メモリのまま使い、共有をやめた時から使います
+		/// </summary>
+		/// <param name="policy">ページの種類とノードへの配置(FirstTouchは探索スレッドの配置に合わせて書き込む)</param>
+		/// <param name="thread_count">表を使う探索スレッドの数</param>
+		void SetMemoryPolicy(const HardwarePolicy& policy, const int thread_count);
+
+		//表のうちヒュージページに載っている大きさ(共有中は0)
+		size_t GetHugePageBytes() const;
+
+		//共有メモリの名前を消す(接続中のプロセスは使い続けられる)
+		static void RemoveShared(const std::string& name);
+
+		/// <summary>
+		/// 局面の項目を探します
+		/// </summary>
+		/// <param name="hash">局面のハッシュ値</param>
+		/// <param name="entry">見つかった内容</param>
+		/// <returns>見つかったか</returns>
+		bool Probe(const u64 hash, TranspositionEntry& entry) const;
+
+		/// <summary>
+		/// 探索結果を記録します。評価値と探索窓から値の意味を決めます
+		/// </summary>
+		/// <param name="hash">局面のハッシュ値</param>
+		/// <param name="score">探索結果</param>
+		/// <param name="depth">残りの探索深さ</param>
+		/// <param name="alpha">探索開始時のα値</param>
+		/// <param name="beta">探索開始時のβ値</param>
+		/// <param name="move">最善手のマスの番号</param>
+		/// <param name="is_selective">前向き枝刈りをしたノードの結果か</param>
+		void Store(const u64 hash, const int score, const int depth, const int alpha, const int beta, const int move, const bool is_selective);
+
+		/// <summary>
+		/// 局面の項目があるキャッシュラインを先読みします(結果は待たない)
+		/// </summary>
+		/// <param name="hash">局面のハッシュ値</param>
+		void Prefetch(const u64 hash) const
+		{
+			const Bucket* bucket = &buckets[hash & bucket_mask];
+#ifdef REVERSI_X86
+			_mm_prefetch(reinterpret_cast<const char*>(bucket), _MM_HINT_T0);
+#elif defined(__GNUC__)
+			__builtin_prefetch(bucket);
+#else
+			(void)bucket;
+#endif
+		}
+
+		/// <summary>
+		/// 探索窓の中で、記録した値をそのまま探索結果にできるかを調べます
+		/// 前向き枝刈りをしたノードの値は、全幅探索のノードでは使わない(全幅探索の値はどちらでも使える)
+		/// </summary>
+		/// <param name="is_selective">引いたノードが前向き枝刈りをするか</param>
+		static bool IsCutoff(const TranspositionEntry& entry, const int alpha, const int beta, const bool is_selective)
+		{
+			if (entry.is_selective && !is_selective)
+				return false;
+
+			return entry.bound == TranspositionBound::Exact ||
+				(entry.bound == TranspositionBound::Lower && entry.score >= beta) ||
+				(entry.bound == TranspositionBound::Upper && entry.score <= alpha);
+		}
+
+		/// <summary>
+		/// 手番側から見た局面と評価側かどうかからハッシュ値を計算します
+		/// </summary>
+		static u64 ComputeHash(const u64 player, const u64 opponent, const bool is_max)
+		{
+			u64 hash = player * 0x9E3779B97F4A7C15ull ^ std::rotl(opponent * 0xC2B2AE3D27D4EB4Full, 31);
+			hash ^= is_max ? 0x165667B19E3779F9ull : 0ull;
+
+			//下位ビットでバケットを選ぶので全体を混ぜる
+			hash ^= hash >> 29;
+			hash *= 0xBF58476D1CE4E5B9ull;
+			return hash ^ (hash >> 32);
+		}
+
+		static u64 ComputeHash(const Bitboard128& player, const Bitboard128& opponent, const bool is_max)
+		{
+			return ComputeHash(player.low ^ std::rotl(player.high, 17), opponent.low ^ std::rotl(opponent.high, 41), is_max);
+		}
+
+		//記録できる項目の数
+		size_t GetEntryCount() const;
+
+		//バケットの数と、1つのバケットを書き出した時の語数(照合用の語4つと内容4つ)
+		u64 GetBucketCount() const;
+		static constexpr size_t BUCKET_WORDS = 8;
+
+		/// <summary>
+		/// バケットの内容を書き出します(探索中に呼んでも良い。書き込み途中の項目は読む時に無視される)
+		/// </summary>
+		/// <param name="first">最初のバケットの番号</param>
+		/// <param name="count">バケットの数</param>
+		/// <param name="output">count * BUCKET_WORDS語の書き出し先</param>
+		void Export(const u64 first, const u64 count, u64* output) const;
+
+		/// <summary>
+		/// 書き出したバケットの項目を、空いている場所にだけ読み込みます(表の大きさが違っても良い)
+		/// 読み込んだ項目は1つ前の探索のものとして扱うので、今の探索の項目より先に置き換えられる
+		/// </summary>
+		/// <param name="input">Exportで書き出した内容</param>
+		/// <param name="count">バケットの数</param>
+		/// <returns>読み込んだ項目の数</returns>
+		size_t Import(const u64* input, const u64 count);
+
+	private:
+		static constexpr int BUCKET_SIZE = 4;
+
+		/// <summary>
+		/// 項目を並べたキャッシュライン
+		/// 内容は 評価値(32ビット)・深さ(8)・値の意味(2)・最善手(7)・世代(8)・前向き枝刈り(1) を1語に詰める
+		/// </summary>
+		struct alignas(64) Bucket
+		{
+			std::atomic<u64> checks[BUCKET_SIZE];
+			std::atomic<u64> data[BUCKET_SIZE];
+		};
+
+		/// <summary>
+		/// 共有メモリの先頭に置く情報。作ったプロセスが初期化を終えてからmagicを書く
+		/// </summary>
+		struct alignas(64) SharedHeader
+		{
+			std::atomic<u64> magic;
+			uint32_t version;
+
+			//大きさを変えるために作り直された(接続し直す)
+			std::atomic<uint32_t> is_retired;
+
+			u64 bucket_count;
+
+			//作ったプロセスの設定から計算した値(違う設定の評価値で枝刈りしないよう、一致するプロセスだけが使う)
+			u64 fingerprint;
+		};
+
+		static constexpr u64 SHARED_MAGIC = 0x4C42545456455352ull;
+		static constexpr uint32_t SHARED_VERSION = 3;
+
+		//作成中のプロセスが初期化を終えるのを待つ時間(ミリ秒)
+		static constexpr int SHARED_INIT_TIMEOUT = 1000;
+
+		//自分だけの表の領域と、その確保の方法
+		LargePageMemory storage;
+		HugePageMode huge_pages;
+		NodeMemoryPolicy node_memory;
+		std::vector<int> touch_cpus;
+
+		//共有メモリと、その先頭の情報(共有していなければnullptr)
+		SharedMemory shared_memory;
+		SharedHeader* shared_header;
+		std::string shared_name;
+
+		//接続した時の設定の値(作り直された共有メモリに接続し直す時にも使う)
+		u64 shared_fingerprint;
+
+		Bucket* buckets;
+		u64 bucket_mask;
+
+		//大きさからバケット数を決める
+		static size_t GetBucketCount(const size_t megabytes);
+
+		//自分だけの表の領域を確保する(確保できなければstd::bad_alloc)
+		void AllocateStorage(const size_t bucket_count);
+
+		//接続した共有メモリが同じ形式で、同じ設定のプロセスが作った表か
+		bool IsValidShared() const;
+
+		//共有メモリを解除する(表の領域は呼び出し元が用意し直す)
+		void ReleaseShared();
+
+		//探索ごとに進める世代(探索スレッドが読む間に進めることがある)
+		std::atomic<unsigned char> generation;
+
+		static u64 Pack(const int score, const int depth, const TranspositionBound bound, const int move, const bool is_selective, const unsigned char generation);
+		static TranspositionEntry Unpack(const u64 data);
+		static unsigned char GetGeneration(const u64 data);
+	};
+}
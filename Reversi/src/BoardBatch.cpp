@@ -0,0 +1,419 @@
+#include "../include/BoardBatch.h"
+#include <algorithm>
+
+namespace Reversi
+{
+	BoardBatch::BoardBatch(const size_t count) :
+		players(count, 0ull),
+		opponents(count, 0ull),
+		simd_level(GetSupportedSimdLevel())
+	{
+
+	}
+
+	void BoardBatch::Resize(const size_t count)
+	{
+		players.resize(count, 0ull);
+		opponents.resize(count, 0ull);
+	}
+
+	size_t BoardBatch::GetCount() const
+	{
+		return players.size();
+	}
+
+	void BoardBatch::Set(const size_t index, const Board& board, const Side side)
+	{
+		Set(index, board.GetPosition(side));
+	}
+
+	void BoardBatch::Set(const size_t index, const Position& position)
+	{
+		players[index] = position.player;
+		opponents[index] = position.opponent;
+	}
+
+	Position BoardBatch::GetPosition(const size_t index) const
+	{
+		return { players[index], opponents[index] };
+	}
+
+	void BoardBatch::ComputeLegalMoves(std::vector<u64>& moves) const
+	{
+		const size_t count = players.size();
+		moves.resize(count);
+
+		for (size_t i = ComputeLegalMovesSimd(players.data(), opponents.data(), moves.data(), count); i < count; ++i)
+		{
+			moves[i] = Position::ComputeLegalMoves(players[i], opponents[i]);
+		}
+	}
+
+	void BoardBatch::ComputeFlips(const std::vector<u64>& inputs, std::vector<u64>& flips) const
+	{
+		const size_t count = players.size();
+		flips.resize(count);
+
+		for (size_t i = ComputeFlipsSimd(inputs.data(), flips.data(), count); i < count; ++i)
+		{
+			flips[i] = Position::ComputeFlips(inputs[i], players[i], opponents[i]);
+		}
+	}
+
+	void BoardBatch::Play(const std::vector<u64>& inputs, std::vector<u64>& flips)
+	{
+		ComputeFlips(inputs, flips);
+
+		//Position::Playと同じ式(着手位置が0ならPassと同じになる)
+		for (size_t i = 0; i < players.size(); ++i)
+		{
+			u64 player = players[i];
+			players[i] = opponents[i] ^ flips[i];
+			opponents[i] = player | inputs[i] | flips[i];
+		}
+	}
+
+	void BoardBatch::CountStones(std::vector<int>& player_counts, std::vector<int>& opponent_counts) const
+	{
+		const size_t count = players.size();
+		player_counts.resize(count);
+		opponent_counts.resize(count);
+
+		for (size_t i = PopCountSimd(players.data(), player_counts.data(), count); i < count; ++i)
+		{
+			player_counts[i] = PopCount(players[i]);
+		}
+
+		for (size_t i = PopCountSimd(opponents.data(), opponent_counts.data(), count); i < count; ++i)
+		{
+			opponent_counts[i] = PopCount(opponents[i]);
+		}
+	}
+
+	void BoardBatch::ComputeTerminals(std::vector<unsigned char>& is_terminal) const
+	{
+		const size_t count = players.size();
+		std::vector<u64> moves(count);
+		std::vector<u64> opponent_moves(count);
+
+		for (size_t i = ComputeLegalMovesSimd(players.data(), opponents.data(), moves.data(), count); i < count; ++i)
+		{
+			moves[i] = Position::ComputeLegalMoves(players[i], opponents[i]);
+		}
+
+		for (size_t i = ComputeLegalMovesSimd(opponents.data(), players.data(), opponent_moves.data(), count); i < count; ++i)
+		{
+			opponent_moves[i] = Position::ComputeLegalMoves(opponents[i], players[i]);
+		}
+
+		is_terminal.resize(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			is_terminal[i] = (moves[i] | opponent_moves[i]) == 0ull;
+		}
+	}
+
+	void BoardBatch::SetSimdLevel(const SimdLevel level)
+	{
+		simd_level = std::min(level, GetSupportedSimdLevel());
+	}
+
+	SimdLevel BoardBatch::GetSimdLevel() const
+	{
+		return simd_level;
+	}
+
+	size_t BoardBatch::ComputeLegalMovesSimd(const u64* mine, const u64* others, u64* moves, const size_t count) const
+	{
+#ifdef REVERSI_X86
+		if (simd_level == SimdLevel::Avx512)
+			return ComputeLegalMovesAvx512(mine, others, moves, count);
+		if (simd_level == SimdLevel::Avx2)
+			return ComputeLegalMovesAvx2(mine, others, moves, count);
+#endif
+
+		return 0;
+	}
+
+	size_t BoardBatch::ComputeFlipsSimd(const u64* inputs, u64* flips, const size_t count) const
+	{
+#ifdef REVERSI_X86
+		if (simd_level == SimdLevel::Avx512)
+			return ComputeFlipsAvx512(inputs, players.data(), opponents.data(), flips, count);
+		if (simd_level == SimdLevel::Avx2)
+			return ComputeFlipsAvx2(inputs, players.data(), opponents.data(), flips, count);
+#endif
+
+		return 0;
+	}
+
+	size_t BoardBatch::PopCountSimd(const u64* bits, int* counts, const size_t count) const
+	{
+#ifdef REVERSI_X86
+		if (simd_level == SimdLevel::Avx512)
+			return PopCountAvx512(bits, counts, count);
+		if (simd_level == SimdLevel::Avx2)
+			return PopCountAvx2(bits, counts, count);
+#endif
+
+		return 0;
+	}
+
+#ifdef REVERSI_X86
+	namespace
+	{
+		using Geometry = Position::Geometry;
+
+		//Position::GetShiftedMovesと同じく、挟める石は最大で(size - 2)個
+		constexpr int MOVE_SPREAD_COUNT = Geometry::SIZE - 3;
+		constexpr int FLIP_SPREAD_COUNT = Geometry::SIZE - 2;
+
+		//Position::GetShiftedMovesを4面ずつ行う(シフト量は即値にする)
+		template <int shift>
+		REVERSI_TARGET_AVX2 inline __m256i GetShiftedMovesAvx2(const __m256i mine, const __m256i cells, const __m256i empties)
+		{
+			__m256i left = _mm256_and_si256(cells, _mm256_slli_epi64(mine, shift));
+			__m256i right = _mm256_and_si256(cells, _mm256_srli_epi64(mine, shift));
+
+			for (int i = 0; i < MOVE_SPREAD_COUNT; ++i)
+			{
+				left = _mm256_or_si256(left, _mm256_and_si256(cells, _mm256_slli_epi64(left, shift)));
+				right = _mm256_or_si256(right, _mm256_and_si256(cells, _mm256_srli_epi64(right, shift)));
+			}
+
+			return _mm256_and_si256(empties, _mm256_or_si256(_mm256_slli_epi64(left, shift), _mm256_srli_epi64(right, shift)));
+		}
+
+		//Position::GetShiftedFlipsを4面ずつ行う
+		template <int shift>
+		REVERSI_TARGET_AVX2 inline __m256i GetShiftedFlipsAvx2(const __m256i input, const __m256i mine, const __m256i cells)
+		{
+			__m256i left = _mm256_and_si256(cells, _mm256_slli_epi64(input, shift));
+			__m256i right = _mm256_and_si256(cells, _mm256_srli_epi64(input, shift));
+
+			for (int i = 0; i < FLIP_SPREAD_COUNT; ++i)
+			{
+				left = _mm256_or_si256(left, _mm256_and_si256(cells, _mm256_slli_epi64(left, shift)));
+				right = _mm256_or_si256(right, _mm256_and_si256(cells, _mm256_srli_epi64(right, shift)));
+			}
+
+			//先に自分の石が無い向きは反転しない(MaskIfの代わりに比較結果のマスクを使う)
+			const __m256i zero = _mm256_setzero_si256();
+			__m256i left_open = _mm256_cmpeq_epi64(_mm256_and_si256(mine, _mm256_slli_epi64(left, shift)), zero);
+			__m256i right_open = _mm256_cmpeq_epi64(_mm256_and_si256(mine, _mm256_srli_epi64(right, shift)), zero);
+
+			return _mm256_or_si256(_mm256_andnot_si256(left_open, left), _mm256_andnot_si256(right_open, right));
+		}
+
+		template <int shift>
+		REVERSI_TARGET_AVX512 inline __m512i GetShiftedMovesAvx512(const __m512i mine, const __m512i cells, const __m512i empties)
+		{
+			__m512i left = _mm512_and_si512(cells, _mm512_slli_epi64(mine, shift));
+			__m512i right = _mm512_and_si512(cells, _mm512_srli_epi64(mine, shift));
+
+			for (int i = 0; i < MOVE_SPREAD_COUNT; ++i)
+			{
+				left = _mm512_or_si512(left, _mm512_and_si512(cells, _mm512_slli_epi64(left, shift)));
+				right = _mm512_or_si512(right, _mm512_and_si512(cells, _mm512_srli_epi64(right, shift)));
+			}
+
+			return _mm512_and_si512(empties, _mm512_or_si512(_mm512_slli_epi64(left, shift), _mm512_srli_epi64(right, shift)));
+		}
+
+		template <int shift>
+		REVERSI_TARGET_AVX512 inline __m512i GetShiftedFlipsAvx512(const __m512i input, const __m512i mine, const __m512i cells)
+		{
+			__m512i left = _mm512_and_si512(cells, _mm512_slli_epi64(input, shift));
+			__m512i right = _mm512_and_si512(cells, _mm512_srli_epi64(input, shift));
+
+			for (int i = 0; i < FLIP_SPREAD_COUNT; ++i)
+			{
+				left = _mm512_or_si512(left, _mm512_and_si512(cells, _mm512_slli_epi64(left, shift)));
+				right = _mm512_or_si512(right, _mm512_and_si512(cells, _mm512_srli_epi64(right, shift)));
+			}
+
+			//AVX-512は比較結果をマスクレジスタで受け取り、そのまま選択に使える
+			__mmask8 left_closed = _mm512_test_epi64_mask(mine, _mm512_slli_epi64(left, shift));
+			__mmask8 right_closed = _mm512_test_epi64_mask(mine, _mm512_srli_epi64(right, shift));
+
+			return _mm512_or_si512(_mm512_maskz_mov_epi64(left_closed, left), _mm512_maskz_mov_epi64(right_closed, right));
+		}
+	}
+
+	REVERSI_TARGET_AVX2 size_t BoardBatch::ComputeLegalMovesAvx2(const u64* mine, const u64* others, u64* moves, const size_t count)
+	{
+		constexpr size_t LANES = 4;
+		const size_t end = count - count % LANES;
+
+		const __m256i board_mask = _mm256_set1_epi64x((long long)Geometry::BOARD_MASK);
+		const __m256i vertical_mask = _mm256_set1_epi64x((long long)Geometry::VERTICAL_MASK);
+		const __m256i horizontal_mask = _mm256_set1_epi64x((long long)Geometry::HORIZONTAL_MASK);
+		const __m256i all_side_mask = _mm256_set1_epi64x((long long)Geometry::ALL_SIDE_MASK);
+
+		for (size_t i = 0; i < end; i += LANES)
+		{
+			__m256i player = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mine + i));
+			__m256i opponent = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(others + i));
+
+			__m256i empties = _mm256_andnot_si256(_mm256_or_si256(player, opponent), board_mask);
+			__m256i vertical_cells = _mm256_and_si256(opponent, vertical_mask);
+			__m256i horizontal_cells = _mm256_and_si256(opponent, horizontal_mask);
+			__m256i cross_cells = _mm256_and_si256(opponent, all_side_mask);
+
+			__m256i result = _mm256_or_si256(
+				_mm256_or_si256(
+					GetShiftedMovesAvx2<Geometry::SHIFT_VERTICAL>(player, vertical_cells, empties),
+					GetShiftedMovesAvx2<Geometry::SHIFT_HORIZONTAL>(player, horizontal_cells, empties)),
+				_mm256_or_si256(
+					GetShiftedMovesAvx2<Geometry::SHIFT_VERTICAL + Geometry::SHIFT_HORIZONTAL>(player, cross_cells, empties),
+					GetShiftedMovesAvx2<Geometry::SHIFT_VERTICAL - Geometry::SHIFT_HORIZONTAL>(player, cross_cells, empties)));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(moves + i), result);
+		}
+
+		return end;
+	}
+
+	REVERSI_TARGET_AVX2 size_t BoardBatch::ComputeFlipsAvx2(const u64* inputs, const u64* mine, const u64* others, u64* flips, const size_t count)
+	{
+		constexpr size_t LANES = 4;
+		const size_t end = count - count % LANES;
+
+		const __m256i vertical_mask = _mm256_set1_epi64x((long long)Geometry::VERTICAL_MASK);
+		const __m256i horizontal_mask = _mm256_set1_epi64x((long long)Geometry::HORIZONTAL_MASK);
+		const __m256i all_side_mask = _mm256_set1_epi64x((long long)Geometry::ALL_SIDE_MASK);
+
+		for (size_t i = 0; i < end; i += LANES)
+		{
+			__m256i input = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inputs + i));
+			__m256i player = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mine + i));
+			__m256i opponent = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(others + i));
+
+			__m256i vertical_cells = _mm256_and_si256(opponent, vertical_mask);
+			__m256i horizontal_cells = _mm256_and_si256(opponent, horizontal_mask);
+			__m256i cross_cells = _mm256_and_si256(opponent, all_side_mask);
+
+			__m256i result = _mm256_or_si256(
+				_mm256_or_si256(
+					GetShiftedFlipsAvx2<Geometry::SHIFT_HORIZONTAL>(input, player, horizontal_cells),
+					GetShiftedFlipsAvx2<Geometry::SHIFT_VERTICAL>(input, player, vertical_cells)),
+				_mm256_or_si256(
+					GetShiftedFlipsAvx2<Geometry::SHIFT_VERTICAL - Geometry::SHIFT_HORIZONTAL>(input, player, cross_cells),
+					GetShiftedFlipsAvx2<Geometry::SHIFT_VERTICAL + Geometry::SHIFT_HORIZONTAL>(input, player, cross_cells)));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(flips + i), result);
+		}
+
+		return end;
+	}
+
+	REVERSI_TARGET_AVX2 size_t BoardBatch::PopCountAvx2(const u64* bits, int* counts, const size_t count)
+	{
+		constexpr size_t LANES = 4;
+		const size_t end = count - count % LANES;
+
+		//4ビットごとの個数を表引きし、バイトの合計をpsadbwで64ビットごとにまとめる
+		const __m256i table = _mm256_setr_epi8(
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m256i low_mask = _mm256_set1_epi8(0x0F);
+		const __m256i zero = _mm256_setzero_si256();
+
+		//64ビットの下位32ビットを先頭の128ビットに集める
+		const __m256i gather = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+
+		for (size_t i = 0; i < end; i += LANES)
+		{
+			__m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + i));
+			__m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(value, low_mask));
+			__m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(value, 4), low_mask));
+			__m256i sums = _mm256_sad_epu8(_mm256_add_epi8(low, high), zero);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(counts + i), _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(sums, gather)));
+		}
+
+		return end;
+	}
+
+	REVERSI_TARGET_AVX512 size_t BoardBatch::ComputeLegalMovesAvx512(const u64* mine, const u64* others, u64* moves, const size_t count)
+	{
+		constexpr size_t LANES = 8;
+		const size_t end = count - count % LANES;
+
+		const __m512i board_mask = _mm512_set1_epi64((long long)Geometry::BOARD_MASK);
+		const __m512i vertical_mask = _mm512_set1_epi64((long long)Geometry::VERTICAL_MASK);
+		const __m512i horizontal_mask = _mm512_set1_epi64((long long)Geometry::HORIZONTAL_MASK);
+		const __m512i all_side_mask = _mm512_set1_epi64((long long)Geometry::ALL_SIDE_MASK);
+
+		for (size_t i = 0; i < end; i += LANES)
+		{
+			__m512i player = _mm512_loadu_si512(mine + i);
+			__m512i opponent = _mm512_loadu_si512(others + i);
+
+			__m512i empties = _mm512_andnot_si512(_mm512_or_si512(player, opponent), board_mask);
+			__m512i vertical_cells = _mm512_and_si512(opponent, vertical_mask);
+			__m512i horizontal_cells = _mm512_and_si512(opponent, horizontal_mask);
+			__m512i cross_cells = _mm512_and_si512(opponent, all_side_mask);
+
+			__m512i result = _mm512_or_si512(
+				_mm512_or_si512(
+					GetShiftedMovesAvx512<Geometry::SHIFT_VERTICAL>(player, vertical_cells, empties),
+					GetShiftedMovesAvx512<Geometry::SHIFT_HORIZONTAL>(player, horizontal_cells, empties)),
+				_mm512_or_si512(
+					GetShiftedMovesAvx512<Geometry::SHIFT_VERTICAL + Geometry::SHIFT_HORIZONTAL>(player, cross_cells, empties),
+					GetShiftedMovesAvx512<Geometry::SHIFT_VERTICAL - Geometry::SHIFT_HORIZONTAL>(player, cross_cells, empties)));
+
+			_mm512_storeu_si512(moves + i, result);
+		}
+
+		return end;
+	}
+
+	REVERSI_TARGET_AVX512 size_t BoardBatch::ComputeFlipsAvx512(const u64* inputs, const u64* mine, const u64* others, u64* flips, const size_t count)
+	{
+		constexpr size_t LANES = 8;
+		const size_t end = count - count % LANES;
+
+		const __m512i vertical_mask = _mm512_set1_epi64((long long)Geometry::VERTICAL_MASK);
+		const __m512i horizontal_mask = _mm512_set1_epi64((long long)Geometry::HORIZONTAL_MASK);
+		const __m512i all_side_mask = _mm512_set1_epi64((long long)Geometry::ALL_SIDE_MASK);
+
+		for (size_t i = 0; i < end; i += LANES)
+		{
+			__m512i input = _mm512_loadu_si512(inputs + i);
+			__m512i player = _mm512_loadu_si512(mine + i);
+			__m512i opponent = _mm512_loadu_si512(others + i);
+
+			__m512i vertical_cells = _mm512_and_si512(opponent, vertical_mask);
+			__m512i horizontal_cells = _mm512_and_si512(opponent, horizontal_mask);
+			__m512i cross_cells = _mm512_and_si512(opponent, all_side_mask);
+
+			__m512i result = _mm512_or_si512(
+				_mm512_or_si512(
+					GetShiftedFlipsAvx512<Geometry::SHIFT_HORIZONTAL>(input, player, horizontal_cells),
+					GetShiftedFlipsAvx512<Geometry::SHIFT_VERTICAL>(input, player, vertical_cells)),
+				_mm512_or_si512(
+					GetShiftedFlipsAvx512<Geometry::SHIFT_VERTICAL - Geometry::SHIFT_HORIZONTAL>(input, player, cross_cells),
+					GetShiftedFlipsAvx512<Geometry::SHIFT_VERTICAL + Geometry::SHIFT_HORIZONTAL>(input, player, cross_cells)));
+
+			_mm512_storeu_si512(flips + i, result);
+		}
+
+		return end;
+	}
+
+	REVERSI_TARGET_AVX512 size_t BoardBatch::PopCountAvx512(const u64* bits, int* counts, const size_t count)
+	{
+		constexpr size_t LANES = 8;
+		const size_t end = count - count % LANES;
+
+		for (size_t i = 0; i < end; i += LANES)
+		{
+			__m512i sums = _mm512_popcnt_epi64(_mm512_loadu_si512(bits + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(counts + i), _mm512_cvtepi64_epi32(sums));
+		}
+
+		return end;
+	}
+#endif
+}
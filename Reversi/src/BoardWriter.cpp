@@ -1,9 +1,22 @@
 #include "../include/BoardWriter.h"
 
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <Windows.h>
+#else
+#include <clocale>
+#include <cstdlib>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+
 namespace Reversi
 {
-	BoardWriter::BoardWriter(int board_size) : board_size(board_size)
+	BoardWriter::BoardWriter(int board_size) : board_size(board_size), is_frame_drawn(false)
 	{
+#ifdef _WIN32
 		//MSゴシックに強制
 		CONSOLE_FONT_INFOEX font = { sizeof(font) };
 		HANDLE hcout = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -18,18 +31,43 @@ namespace Reversi
 		GetConsoleMode(stdHandle, &mode);
 		SetConsoleMode(stdHandle, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
 
+		//盤面はUTF-8のバイト列で直接書き込む
+		SetConsoleOutputCP(CP_UTF8);
+
 		//unicode対応
 		_setmode(_fileno(stdout), _O_U16TEXT);
+#else
+		//メッセージのワイド文字を端末の文字コードで出力できるようにする
+		std::setlocale(LC_ALL, "");
+		if (MB_CUR_MAX == 1)
+			std::setlocale(LC_ALL, "C.UTF-8");
+#endif
+
+		drawn_cells.fill(NOT_DRAWN);
+		BuildFrame();
+		BuildCellGlyphs();
+
+		//全マスを書き換えても再確保しない大きさを確保しておく
+		write_buffer.reserve(frame_bytes.size() + 64 * (cell_glyphs[0].size() + cell_positions[0].size() + 16));
 	}
 
 	BoardWriter::~BoardWriter()
 	{
+		//スクロール範囲を元に戻し、カーソルを画面の一番下に移す
+		if (is_frame_drawn)
+		{
+			write_buffer += "\033[r\033[999;1H\n";
+			Flush();
+		}
+
+#ifdef _WIN32
 		//元のフォントに戻す
 		CONSOLE_FONT_INFOEX font = { sizeof(font) };
 		HANDLE hcout = GetStdHandle(STD_OUTPUT_HANDLE);
 		GetCurrentConsoleFontEx(hcout, FALSE, &font);
 		wcscpy_s(font.FaceName, defaultFontName.c_str());
 		SetCurrentConsoleFontEx(hcout, FALSE, &font);
+#endif
 	}
 
 	void BoardWriter::Write(const std::pair<u64, u64> field_data, const u64 legal_moves, const u64 input)
@@ -37,138 +75,281 @@ namespace Reversi
 		u64 black = field_data.first;
 		u64 white = field_data.second;
 
-		write_buffer += L'\n';
-		write_buffer += GetBackColorCode(22);
-		write_buffer += L"                                       ";
-		write_buffer += GetBackColorCode(-1);
-		write_buffer += L'\n';
-		write_buffer += GetBackColorCode(22);
-		write_buffer += L"   ";
-		WriteAlphabets();
-		write_buffer += GetBackColorCode(22);
-		write_buffer += L"   ";
-		write_buffer += GetFrontColorCode(0);
-		WriteParts(L'┏', L'┳', L'┓');
-
-		for (int i = 0; i < board_size; i++)
+		if (!is_frame_drawn)
 		{
-			write_buffer += GetBackColorCode(22);
-			write_buffer += GetFrontColorCode(-1);
-			write_buffer += L' ';
-			write_buffer += (wchar_t)(L'1' + i);
+			//画面を消して枠を上部に描き、メッセージは枠の下の範囲だけでスクロールさせる
+			write_buffer += "\033[2J\033[H";
+			write_buffer += frame_bytes;
+			write_buffer += "\033[";
+			write_buffer += std::to_string(FRAME_HEIGHT + 1);
+			write_buffer += "r\033[";
+			write_buffer += std::to_string(FRAME_HEIGHT + 1);
+			write_buffer += ";1H";
+
+			drawn_cells.fill(NOT_DRAWN);
+			is_frame_drawn = true;
+		}
 
-			write_buffer += L' ';
-			write_buffer += GetFrontColorCode(0);
-			write_buffer += L'┃';
+		//メッセージ側のカーソル位置を保存してから、変わったマスだけを書き換える
+		size_t header_size = write_buffer.size();
+		write_buffer += "\0337";
 
-			for (int j = 0; j < board_size; j++)
+		for (int i = 0; i < board_size; ++i)
+		{
+			for (int j = 0; j < board_size; ++j)
 			{
-				write_buffer += L' ';
-				write_buffer += ToStone(black, white, legal_moves, i * 8 + j, input);
-				write_buffer += L'┃';
-			}
-
-			write_buffer += L"   ";
-			write_buffer += GetBackColorCode(-1);
-			write_buffer += L'\n';
+				int offset = i * 8 + j;
+				unsigned char kind = ToCellKind(black, white, legal_moves, offset, input);
 
-			if (i < board_size - 1)
-			{
-				write_buffer += GetBackColorCode(22);
-				write_buffer += GetFrontColorCode(-1);
-				write_buffer += L"   ";
+				if (drawn_cells[offset] == kind)
+					continue;
 
-				write_buffer += GetFrontColorCode(0);
-				WriteParts(L'┣', L'╋', L'┫');
+				write_buffer += cell_positions[offset];
+				write_buffer += cell_glyphs[kind];
+				drawn_cells[offset] = kind;
 			}
 		}
 
-		write_buffer += GetBackColorCode(22);
-		write_buffer += L"   ";
-		WriteParts(L'┗', L'┻', L'┛');
-		write_buffer += GetBackColorCode(22);
-		write_buffer += L"                                       ";
-		write_buffer += GetFrontColorCode(-1);
-		write_buffer += GetBackColorCode(-1);
-		write_buffer += L'\n';
-
-		//ボード表示だけ高速なprintfを使う
-		wprintf(write_buffer.c_str());
+		//何も変わっていなければ書き込まない
+		if (write_buffer.size() == header_size + 2)
+		{
+			write_buffer.resize(header_size);
+		}
+		else
+		{
+			write_buffer += "\033[39m\033[49m\0338";
+		}
 
-		write_buffer.clear();
+		Flush();
 	}
 
-	std::wstring BoardWriter::ToStone(const u64 black_data, const u64 white_data, const u64 legal_moves, const int offset, const u64 input) const
+	void BoardWriter::Invalidate()
 	{
-		std::wstring stone;
+		is_frame_drawn = false;
+	}
 
+	unsigned char BoardWriter::ToCellKind(const u64 black_data, const u64 white_data, const u64 legal_moves, const int offset, const u64 input)
+	{
 		bool is_input = input != 0xFFFFFFFFFFFFFFFF && ((1ull << offset) & input) == input;
-
-		if (is_input)
-		{
-			stone += GetBackColorCode(1);
-		}
+		unsigned char kind = Empty;
 
 		if (((legal_moves >> offset) & 1ull) == 1ull)
 		{
-			stone += L'＋';
+			kind = Legal;
 		}
 		else if (((black_data >> offset) & 1ull) == 1ull)
 		{
-			stone += L'●';
+			kind = Black;
 		}
 		else if (((white_data >> offset) & 1ull) == 1ull)
 		{
-			stone += GetFrontColorCode(231);
-			stone += L'●';
-			stone += GetFrontColorCode(0);
+			kind = White;
 		}
-		else
+
+		return is_input ? kind + HIGHLIGHT_OFFSET : kind;
+	}
+
+	void BoardWriter::BuildCellGlyphs()
+	{
+		for (int kind = 0; kind < CELL_GLYPH_COUNT; ++kind)
 		{
-			stone += L"  ";
+			bool is_highlight = kind >= HIGHLIGHT_OFFSET;
+			std::wstring glyph;
+
+			glyph += GetBackColorCode(is_highlight ? 1 : 22);
+			glyph += GetFrontColorCode(kind % CELL_KIND_COUNT == White ? 231 : 0);
+
+			//文字幅が端末で異なっても枠を崩さないよう、2マス分を空白で消してから戻って書く
+			glyph += L"  \033[2D";
+
+			switch (kind % CELL_KIND_COUNT)
+			{
+			case Legal:
+				glyph += L'＋';
+				break;
+			case Black:
+			case White:
+				glyph += L'●';
+				break;
+			default:
+				break;
+			}
+
+			cell_glyphs[kind].clear();
+			AppendUtf8(cell_glyphs[kind], glyph);
+		}
+
+		//各マスの石を書く位置(行は枠の上2行と罫線の分、列は行番号と罫線の分ずれる)
+		for (int i = 0; i < 8; ++i)
+		{
+			for (int j = 0; j < 8; ++j)
+			{
+				cell_positions[i * 8 + j] = "\033[" + std::to_string(4 + i * 2) + ";" + std::to_string(6 + j * 4) + "H";
+			}
 		}
+	}
+
+	void BoardWriter::BuildFrame()
+	{
+		std::wstring frame;
+
+		frame += GetBackColorCode(22);
+		frame += L"                                       ";
+		frame += GetBackColorCode(-1);
+		frame += L'\n';
+		frame += GetBackColorCode(22);
+		frame += L"   ";
+		WriteAlphabets(frame);
+		frame += GetBackColorCode(22);
+		frame += L"   ";
+		frame += GetFrontColorCode(0);
+		WriteParts(frame, L'┏', L'┳', L'┓');
 
-		if (is_input)
+		for (int i = 0; i < board_size; i++)
 		{
-			stone += GetBackColorCode(22);
+			frame += GetBackColorCode(22);
+			frame += GetFrontColorCode(-1);
+			frame += L' ';
+			frame += (wchar_t)(L'1' + i);
+
+			frame += L' ';
+			frame += GetFrontColorCode(0);
+			frame += L'┃';
+
+			//石はWriteで書き込むので空けておく
+			for (int j = 0; j < board_size; j++)
+			{
+				frame += L"   ┃";
+			}
+
+			frame += L"   ";
+			frame += GetBackColorCode(-1);
+			frame += L'\n';
+
+			if (i < board_size - 1)
+			{
+				frame += GetBackColorCode(22);
+				frame += GetFrontColorCode(-1);
+				frame += L"   ";
+
+				frame += GetFrontColorCode(0);
+				WriteParts(frame, L'┣', L'╋', L'┫');
+			}
 		}
 
-		return stone;
+		frame += GetBackColorCode(22);
+		frame += L"   ";
+		WriteParts(frame, L'┗', L'┻', L'┛');
+		frame += GetBackColorCode(22);
+		frame += L"                                       ";
+		frame += GetFrontColorCode(-1);
+		frame += GetBackColorCode(-1);
+		frame += L'\n';
+
+		frame_bytes.clear();
+		AppendUtf8(frame_bytes, frame);
 	}
 
-	void BoardWriter::WriteParts(const wchar_t& l_side, const wchar_t& m_side, const wchar_t& r_side)
+	void BoardWriter::WriteParts(std::wstring& frame, const wchar_t& l_side, const wchar_t& m_side, const wchar_t& r_side) const
 	{
-		write_buffer += l_side;
+		frame += l_side;
 
 		for (int j = 0; j < board_size - 1; j++)
 		{
-			write_buffer += L"━━━";
-			write_buffer += m_side;
+			frame += L"━━━";
+			frame += m_side;
 		}
 
-		write_buffer += L"━━━";
-		write_buffer += r_side;
-		write_buffer += L"   ";
-		write_buffer += GetBackColorCode(-1);
-		write_buffer += L'\n';
+		frame += L"━━━";
+		frame += r_side;
+		frame += L"   ";
+		frame += GetBackColorCode(-1);
+		frame += L'\n';
 	}
 
-	void BoardWriter::WriteAlphabets()
+	void BoardWriter::WriteAlphabets(std::wstring& frame) const
 	{
-		write_buffer += L"  ";
+		frame += L"  ";
 
 		for (int i = 0; i < board_size; ++i)
 		{
-			write_buffer += (wchar_t)(L'a' + i);
-			write_buffer += L"   ";
+			frame += (wchar_t)(L'a' + i);
+			frame += L"   ";
 		}
 
-		write_buffer += L"  ";
-		write_buffer += GetBackColorCode(-1);
-		write_buffer += L'\n';
+		frame += L"  ";
+		frame += GetBackColorCode(-1);
+		frame += L'\n';
+	}
+
+	void BoardWriter::Flush()
+	{
+		if (write_buffer.empty())
+			return;
+
+		//メッセージ側の出力と順番が入れ替わらないよう先に流しておく
+		std::wcout.flush();
+		std::fflush(stdout);
+
+#ifdef _WIN32
+		DWORD written = 0;
+		WriteFile(GetStdHandle(STD_OUTPUT_HANDLE), write_buffer.data(), (DWORD)write_buffer.size(), &written, nullptr);
+#else
+		const char* data = write_buffer.data();
+		size_t rest = write_buffer.size();
+
+		while (rest > 0)
+		{
+			ssize_t written = ::write(STDOUT_FILENO, data, rest);
+			if (written <= 0)
+				break;
+
+			data += written;
+			rest -= (size_t)written;
+		}
+#endif
+
+		write_buffer.clear();
+	}
+
+	void BoardWriter::AppendUtf8(std::string& buffer, const std::wstring_view text)
+	{
+		for (size_t i = 0; i < text.size(); ++i)
+		{
+			char32_t code = (char32_t)text[i];
+
+			//wchar_tが16bitの環境ではサロゲートペアを結合する
+			if (0xD800 <= code && code < 0xDC00 && i + 1 < text.size())
+			{
+				code = 0x10000 + ((code - 0xD800) << 10) + ((char32_t)text[++i] - 0xDC00);
+			}
+
+			if (code < 0x80)
+			{
+				buffer += (char)code;
+			}
+			else if (code < 0x800)
+			{
+				buffer += (char)(0xC0 | (code >> 6));
+				buffer += (char)(0x80 | (code & 0x3F));
+			}
+			else if (code < 0x10000)
+			{
+				buffer += (char)(0xE0 | (code >> 12));
+				buffer += (char)(0x80 | ((code >> 6) & 0x3F));
+				buffer += (char)(0x80 | (code & 0x3F));
+			}
+			else
+			{
+				buffer += (char)(0xF0 | (code >> 18));
+				buffer += (char)(0x80 | ((code >> 12) & 0x3F));
+				buffer += (char)(0x80 | ((code >> 6) & 0x3F));
+				buffer += (char)(0x80 | (code & 0x3F));
+			}
+		}
 	}
 
-	std::wstring BoardWriter::GetBackColorCode(const int id) const
+	std::wstring BoardWriter::GetBackColorCode(const int id)
 	{
 		if (id < 0)
 			return L"\033[49m";
@@ -180,7 +361,7 @@ namespace Reversi
 		return code;
 	}
 
-	std::wstring BoardWriter::GetFrontColorCode(const int id) const
+	std::wstring BoardWriter::GetFrontColorCode(const int id)
 	{
 		if (id < 0)
 			return L"\033[39m";
@@ -192,4 +373,4 @@ namespace Reversi
 		return code;
 	}
 
-}
\ No newline at end of file
+}
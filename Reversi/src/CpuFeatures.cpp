@@ -0,0 +1,81 @@
+#include "../include/CpuFeatures.h"
+
+#if defined(REVERSI_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Reversi
+{
+	namespace
+	{
+		bool DetectAvx2()
+		{
+#if defined(REVERSI_X86) && defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+
+			//OSがYMMレジスタを保存するか(OSXSAVE, AVX)
+			__cpuid(info, 1);
+			bool has_osxsave = (info[2] & (1 << 27)) != 0;
+			bool has_avx = (info[2] & (1 << 28)) != 0;
+			if (!has_osxsave || !has_avx || (_xgetbv(0) & 0x6) != 0x6)
+				return false;
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#elif defined(REVERSI_X86)
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#else
+			return false;
+#endif
+		}
+
+		bool DetectAvx512()
+		{
+#if defined(REVERSI_X86) && defined(_MSC_VER)
+			if (!DetectAvx2())
+				return false;
+
+			//OSがZMMレジスタとマスクレジスタを保存するか(opmask, ZMM_Hi256, Hi16_ZMM)
+			if ((_xgetbv(0) & 0xE6) != 0xE6)
+				return false;
+
+			int info[4];
+			__cpuidex(info, 7, 0);
+			bool has_avx512f = (info[1] & (1 << 16)) != 0;
+			bool has_vpopcntdq = (info[2] & (1 << 14)) != 0;
+			return has_avx512f && has_vpopcntdq;
+#elif defined(REVERSI_X86)
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq");
+#else
+			return false;
+#endif
+		}
+	}
+
+	bool IsAvx2Supported()
+	{
+		//起動後に変わることは無いので一度だけ調べる
+		static const bool is_supported = DetectAvx2();
+		return is_supported;
+	}
+
+	bool IsAvx512Supported()
+	{
+		static const bool is_supported = DetectAvx512();
+		return is_supported;
+	}
+
+	SimdLevel GetSupportedSimdLevel()
+	{
+		if (IsAvx512Supported())
+			return SimdLevel::Avx512;
+		if (IsAvx2Supported())
+			return SimdLevel::Avx2;
+		return SimdLevel::Scalar;
+	}
+}
@@ -0,0 +1,316 @@
+#include "../include/CpuTopology.h"
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Reversi
+{
+	CpuTopology::CpuTopology() : cpu_count(0)
+	{
+		Detect();
+	}
+
+	const CpuTopology& CpuTopology::Get()
+	{
+		static const CpuTopology topology;
+		return topology;
+	}
+
+	void CpuTopology::Detect()
+	{
+		//物理コアの2つ目以降の論理コア(SMTの兄弟)
+		std::vector<int> secondary_cpus;
+
+#ifdef _WIN32
+		DWORD length = 0;
+		GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+		std::vector<unsigned char> buffer(length);
+
+		if (length != 0 && GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &length))
+		{
+			for (DWORD offset = 0; offset < length;)
+			{
+				const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX* info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+
+				if (info->Relationship == RelationNumaNode)
+				{
+					const GROUP_AFFINITY& mask = info->NumaNode.GroupMask;
+					Node node = { (int)info->NumaNode.NodeNumber, {} };
+					for (int bit = 0; bit < 64; ++bit)
+					{
+						if ((mask.Mask >> bit) & 1)
+							node.cpus.push_back(mask.Group * 64 + bit);
+					}
+
+					memory_node_ids.push_back(node.id);
+					nodes.push_back(std::move(node));
+				}
+				else if (info->Relationship == RelationProcessorCore)
+				{
+					const GROUP_AFFINITY& mask = info->Processor.GroupMask[0];
+					bool is_first = true;
+					for (int bit = 0; bit < 64; ++bit)
+					{
+						if (((mask.Mask >> bit) & 1) == 0)
+							continue;
+
+						if (!is_first)
+							secondary_cpus.push_back(mask.Group * 64 + bit);
+						is_first = false;
+					}
+				}
+
+				offset += info->Size;
+			}
+		}
+
+		//プロセッサグループが1つなら、プロセスに許された論理コアだけを使う
+		DWORD_PTR process_mask = 0;
+		DWORD_PTR system_mask = 0;
+		if (GetActiveProcessorGroupCount() == 1 && GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+		{
+			for (Node& node : nodes)
+			{
+				std::erase_if(node.cpus, [process_mask](const int cpu) { return cpu >= 64 || ((process_mask >> cpu) & 1) == 0; });
+			}
+		}
+		std::erase_if(nodes, [](const Node& node) { return node.cpus.empty(); });
+
+		if (nodes.empty())
+		{
+			Node node = { 0, {} };
+			for (int cpu = 0; cpu < (int)std::max(1u, std::thread::hardware_concurrency()); ++cpu)
+			{
+				node.cpus.push_back(cpu);
+			}
+			nodes.push_back(std::move(node));
+		}
+#else
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		bool has_mask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+		//tasksetやcgroupで制限されていれば、許された論理コアだけを使う
+		auto is_allowed = [&allowed, has_mask](const int cpu)
+			{
+				return cpu >= 0 && cpu < CPU_SETSIZE && (!has_mask || CPU_ISSET(cpu, &allowed));
+			};
+
+		auto read_line = [](const std::string& path)
+			{
+				std::ifstream stream(path);
+				std::string line;
+				std::getline(stream, line);
+				return line;
+			};
+
+		const std::filesystem::path node_root = "/sys/devices/system/node";
+		std::error_code error;
+
+		for (std::filesystem::directory_iterator it(node_root, error); !error && it != std::filesystem::directory_iterator(); it.increment(error))
+		{
+			std::string name = it->path().filename().string();
+			if (name.size() <= 4 || !name.starts_with("node") || !std::all_of(name.begin() + 4, name.end(), [](const char c) { return std::isdigit((unsigned char)c) != 0; }))
+				continue;
+
+			Node node = { std::stoi(name.substr(4)), {} };
+			for (int cpu : ParseCpuList(read_line((it->path() / "cpulist").string())))
+			{
+				if (is_allowed(cpu))
+					node.cpus.push_back(cpu);
+			}
+
+			//メモリだけのノードや、許されていないノードは使わない
+			if (!node.cpus.empty())
+				nodes.push_back(std::move(node));
+		}
+
+		memory_node_ids = ParseCpuList(read_line((node_root / "has_memory").string()));
+
+		//NUMAの情報が無ければ、許されたすべての論理コアを1つのノードとする
+		if (nodes.empty())
+		{
+			Node node = { 0, {} };
+			int limit = has_mask ? CPU_SETSIZE : (int)std::max(1u, std::thread::hardware_concurrency());
+			for (int cpu = 0; cpu < limit; ++cpu)
+			{
+				if (is_allowed(cpu))
+					node.cpus.push_back(cpu);
+			}
+			nodes.push_back(std::move(node));
+		}
+
+		for (const Node& node : nodes)
+		{
+			for (int cpu : node.cpus)
+			{
+				//兄弟の中で最も番号の小さい許された論理コアを物理コアの代表にする
+				for (int sibling : ParseCpuList(read_line("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list")))
+				{
+					if (!is_allowed(sibling))
+						continue;
+
+					if (sibling != cpu)
+						secondary_cpus.push_back(cpu);
+					break;
+				}
+			}
+		}
+#endif
+
+		std::sort(nodes.begin(), nodes.end(), [](const Node& a, const Node& b) { return a.id < b.id; });
+		std::sort(secondary_cpus.begin(), secondary_cpus.end());
+
+		//物理コアを一通り埋めてからSMTの兄弟を使う
+		cpu_count = 0;
+		for (Node& node : nodes)
+		{
+			std::sort(node.cpus.begin(), node.cpus.end(), [&secondary_cpus](const int a, const int b)
+				{
+					bool is_a_secondary = std::binary_search(secondary_cpus.begin(), secondary_cpus.end(), a);
+					bool is_b_secondary = std::binary_search(secondary_cpus.begin(), secondary_cpus.end(), b);
+					return is_a_secondary != is_b_secondary ? is_b_secondary : a < b;
+				});
+			cpu_count += (int)node.cpus.size();
+		}
+
+		if (memory_node_ids.empty())
+		{
+			for (const Node& node : nodes)
+			{
+				memory_node_ids.push_back(node.id);
+			}
+		}
+	}
+
+	std::vector<int> CpuTopology::ParseCpuList(const std::string& text)
+	{
+		std::vector<int> cpus;
+		size_t position = 0;
+
+		while (position < text.size())
+		{
+			size_t end = text.find(',', position);
+			if (end == std::string::npos)
+				end = text.size();
+
+			std::string range = text.substr(position, end - position);
+			size_t dash = range.find('-');
+
+			try
+			{
+				int first = std::stoi(range.substr(0, dash));
+				int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+				for (int cpu = first; cpu <= last; ++cpu)
+				{
+					cpus.push_back(cpu);
+				}
+			}
+			catch (const std::exception&)
+			{
+				//改行や空の一覧は読み飛ばす
+			}
+
+			position = end + 1;
+		}
+
+		return cpus;
+	}
+
+	int CpuTopology::GetNodeCount() const
+	{
+		return (int)nodes.size();
+	}
+
+	int CpuTopology::GetCpuCount() const
+	{
+		return cpu_count;
+	}
+
+	const std::vector<int>& CpuTopology::GetNodeCpus(const int node) const
+	{
+		return nodes[node].cpus;
+	}
+
+	const std::vector<int>& CpuTopology::GetMemoryNodeIds() const
+	{
+		return memory_node_ids;
+	}
+
+	int CpuTopology::GetCpu(const int index, const ThreadPlacement placement) const
+	{
+		if (placement == ThreadPlacement::None || cpu_count == 0)
+			return -1;
+
+		//論理コアより多いスレッドは最初から繰り返す
+		if (placement == ThreadPlacement::Compact)
+		{
+			int rest = index % cpu_count;
+			for (const Node& node : nodes)
+			{
+				if (rest < (int)node.cpus.size())
+					return node.cpus[rest];
+				rest -= (int)node.cpus.size();
+			}
+		}
+
+		const Node& node = nodes[index % nodes.size()];
+		return node.cpus[(index / nodes.size()) % node.cpus.size()];
+	}
+
+	std::vector<int> CpuTopology::GetCpus(const int count, const ThreadPlacement placement) const
+	{
+		std::vector<int> cpus;
+		if (placement == ThreadPlacement::None)
+			return cpus;
+
+		for (int i = 0; i < count; ++i)
+		{
+			cpus.push_back(GetCpu(i, placement));
+		}
+
+		return cpus;
+	}
+
+	bool CpuTopology::PinCurrentThread(const int cpu)
+	{
+		if (cpu < 0)
+			return false;
+
+#ifdef _WIN32
+		GROUP_AFFINITY affinity = {};
+		affinity.Group = (WORD)(cpu / 64);
+		affinity.Mask = (KAFFINITY)1 << (cpu % 64);
+		return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+#else
+		if (cpu >= CPU_SETSIZE)
+			return false;
+
+		cpu_set_t set;
+		CPU_ZERO(&set);
+		CPU_SET(cpu, &set);
+		return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+	}
+
+	std::string CpuTopology::Describe() const
+	{
+		std::string text = std::to_string(nodes.size()) + " nodes (";
+
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			text += (i == 0 ? "node" : ", node") + std::to_string(nodes[i].id) + ": " + std::to_string(nodes[i].cpus.size()) + " cpus";
+		}
+
+		return text + ")";
+	}
+}
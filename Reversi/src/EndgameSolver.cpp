@@ -0,0 +1,53 @@
+#include "../include/EndgameSolver.h"
+#include "../include/Evaluator.h"
+
+namespace Reversi
+{
+	int EndgameSolver::Solve(const Position position, int alpha, const int beta, const bool passed)
+	{
+		u64 legal_moves = position.GetLegalMoves();
+
+		if (legal_moves == 0ull)
+		{
+			//両者とも置けなければ終局
+			if (passed)
+				return std::popcount(position.player) - std::popcount(position.opponent);
+
+			return -Solve(position.Pass(), -beta, -alpha, true);
+		}
+
+		int best = -64;
+
+		while (legal_moves != 0ull)
+		{
+			u64 input = legal_moves & (~legal_moves + 1);
+			legal_moves &= legal_moves - 1;
+
+			int score = -Solve(position.Play(input, position.GetFlips(input)), -beta, -alpha, false);
+
+			if (score > best)
+			{
+				best = score;
+
+				if (score > alpha)
+					alpha = score;
+
+				if (alpha >= beta)
+					break;
+			}
+		}
+
+		return best;
+	}
+
+	int EndgameSolver::ToEvaluatorScore(const int disc_difference)
+	{
+		if (disc_difference > 0)
+			return Evaluator::WIN_SCORE + disc_difference;
+
+		if (disc_difference < 0)
+			return -Evaluator::WIN_SCORE + disc_difference;
+
+		return 0;
+	}
+}
@@ -0,0 +1,505 @@
+#include "../include/EngineService.h"
+#include "../include/CpuTopology.h"
+#include "../include/ReversiEngine.h"
+#include "../include/SearchTrace.h"
+#include <charconv>
+#include <format>
+#include <limits>
+#include <sstream>
+#include <string_view>
+
+namespace Reversi
+{
+	namespace
+	{
+		long long ToNanoseconds(const std::chrono::steady_clock::time_point time)
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+		}
+
+		double ToMilliseconds(const std::chrono::steady_clock::duration duration)
+		{
+			return std::chrono::duration<double, std::milli>(duration).count();
+		}
+
+		//16進の盤面を読む(0xは付いていても良い。読めない文字が残れば失敗)
+		bool ParseBitboard(const std::string& text, u64& bitboard)
+		{
+			std::string_view digits = text;
+			if (digits.starts_with("0x") || digits.starts_with("0X"))
+				digits.remove_prefix(2);
+
+			auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), bitboard, 16);
+			return error == std::errc() && end == digits.data() + digits.size() && !digits.empty();
+		}
+	}
+
+	std::string EngineService::ToSquareName(const u64 input)
+	{
+		if (input == 0ull)
+			return "pass";
+
+		int index = CountTrailingZeros(input);
+		return { (char)('a' + index % 8), (char)('1' + index / 8) };
+	}
+
+	u64 EngineService::ParseSquareName(const std::string& name)
+	{
+		if (name.size() != 2 || name[0] < 'a' || 'h' < name[0] || name[1] < '1' || '8' < name[1])
+			return 0ull;
+
+		return 1ull << (8 * (name[1] - '1') + (name[0] - 'a'));
+	}
+
+	void EngineService::Connection::Send(const std::string& line)
+	{
+		std::lock_guard<std::mutex> lock(write_mutex);
+		socket.WriteLine(line);
+	}
+
+	EngineService::EngineService(const int worker_count, const size_t table_megabytes) :
+		worker_count(std::max(worker_count, 1)),
+		is_stopping(false),
+		is_listening(false),
+		next_session_id(1),
+		search_count(0)
+	{
+		transposition_table = std::make_shared<TranspositionTable>(table_megabytes);
+
+		//対局用のエンジンと同じパラメータを読み込む
+		probcut_table = std::make_shared<ProbCutTable>();
+		probcut_table->Load(ReversiEngine::PROBCUT_FILE);
+		reduction_table = std::make_shared<ReductionTable>();
+		reduction_table->Load(ReversiEngine::REDUCTION_FILE);
+		evaluation_weights = std::make_shared<EvaluationWeights>();
+		evaluation_weights->Load(ReversiEngine::EVALUATION_FILE);
+
+		for (int i = 0; i < this->worker_count; ++i)
+		{
+			std::unique_ptr<Worker> worker = std::make_unique<Worker>();
+			worker->stop_requested.store(false, std::memory_order_relaxed);
+			worker->deadline.store(0, std::memory_order_relaxed);
+			worker->cpu = -1;
+			worker->search_system.SetEvaluationWeights(evaluation_weights);
+			worker->search_system.SetProbCut(probcut_table, 2);
+			worker->search_system.SetReductions(reduction_table);
+			worker->search_system.SetTranspositionTable(transposition_table);
+			worker->search_system.SetStopFlag(&worker->stop_requested);
+			workers.push_back(std::move(worker));
+		}
+
+		metrics.AddHistogram("reversi_service_queue_seconds", "Time a go request waited before a worker picked it up.", queue_histogram, 1e-9, 1e-5, 10.0);
+		metrics.AddHistogram("reversi_service_first_move_seconds", "Time from receiving a go request until a move was available.", first_move_histogram, 1e-9, 1e-5, 10.0);
+		metrics.AddHistogram("reversi_service_search_seconds", "Time a worker spent searching one go request.", search_histogram, 1e-9, 1e-5, 10.0);
+		metrics.AddHistogram("reversi_service_search_nodes", "Nodes searched for one go request.", node_histogram, 1.0, 10.0, 1e9);
+	}
+
+	EngineService::~EngineService()
+	{
+		Stop();
+	}
+
+	bool EngineService::Run(const std::string& path)
+	{
+		if (!listener.Listen(path))
+			return false;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			is_listening = true;
+		}
+		condition.notify_all();
+
+		for (std::unique_ptr<Worker>& worker : workers)
+		{
+			worker->thread = std::thread(&EngineService::RunWorker, this, std::ref(*worker));
+		}
+		watchdog = std::thread(&EngineService::RunWatchdog, this);
+
+		if (!metrics_path.empty())
+			metrics.Start(metrics_path, MetricsExporter::EXPORT_INTERVAL);
+
+		while (!is_stopping.load())
+		{
+			LocalSocket client = listener.Accept();
+			if (!client.IsOpen())
+				continue;
+
+			std::shared_ptr<Connection> connection = std::make_shared<Connection>();
+			connection->socket = std::move(client);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (is_stopping.load())
+				break;
+
+			//切断した接続のスレッドを片付けて、接続が入れ替わっても溜まらないようにする
+			std::erase_if(connections, [](const std::shared_ptr<Connection>& finished)
+				{
+					if (!finished->is_finished.load())
+						return false;
+
+					finished->thread.join();
+					return true;
+				});
+
+			connections.push_back(connection);
+			connection->thread = std::thread(&EngineService::ServeConnection, this, connection);
+		}
+
+		//Stopで止めた接続と探索スレッドが終わるのを待つ
+		std::vector<std::shared_ptr<Connection>> remaining;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			remaining.swap(connections);
+		}
+		for (std::shared_ptr<Connection>& connection : remaining)
+		{
+			//Stopより先に取り出した接続もここで閉じる
+			connection->socket.Shutdown();
+			connection->thread.join();
+		}
+		for (std::unique_ptr<Worker>& worker : workers)
+		{
+			worker->thread.join();
+		}
+		watchdog.join();
+
+		//最後の値を書き出して止める
+		metrics.Stop();
+
+		listener.Close();
+		return true;
+	}
+
+	void EngineService::Stop()
+	{
+		if (is_stopping.exchange(true))
+			return;
+
+		listener.Shutdown();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		for (std::shared_ptr<Connection>& connection : connections)
+		{
+			connection->socket.Shutdown();
+		}
+
+		//探索中の依頼もすぐに打ち切る
+		for (std::unique_ptr<Worker>& worker : workers)
+		{
+			worker->stop_requested.store(true);
+		}
+		condition.notify_all();
+	}
+
+	void EngineService::SetMetricsFile(const std::string& path)
+	{
+		metrics_path = path;
+	}
+
+	void EngineService::SetHardwarePolicy(const HardwarePolicy& policy)
+	{
+		transposition_table->SetMemoryPolicy(policy, worker_count);
+
+		for (int i = 0; i < worker_count; ++i)
+		{
+			workers[i]->cpu = CpuTopology::Get().GetCpu(i, policy.thread_placement);
+		}
+	}
+
+	bool EngineService::WaitUntilListening(const std::chrono::milliseconds timeout)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		return condition.wait_for(lock, timeout, [this]() { return is_listening; });
+	}
+
+	void EngineService::ServeConnection(const std::shared_ptr<Connection> connection)
+	{
+		std::string line;
+		while (connection->socket.ReadLine(line))
+		{
+			std::string reply = HandleCommand(connection, line);
+			if (!reply.empty())
+				connection->Send(reply);
+		}
+
+		//切断したらこの接続のセッションを閉じる(探索中の依頼は応答先が無いので捨てられる)
+		std::lock_guard<std::mutex> lock(mutex);
+		for (u64 id : connection->session_ids)
+		{
+			auto found = sessions.find(id);
+			if (found != sessions.end())
+			{
+				found->second->is_closed = true;
+				sessions.erase(found);
+			}
+		}
+		connection->is_finished.store(true);
+	}
+
+	std::shared_ptr<EngineService::Session> EngineService::FindSession(const u64 id)
+	{
+		auto found = sessions.find(id);
+		return found != sessions.end() && !found->second->is_closed ? found->second : nullptr;
+	}
+
+	std::string EngineService::HandleCommand(const std::shared_ptr<Connection>& connection, const std::string& line)
+	{
+		std::istringstream stream(line);
+		std::string command;
+		u64 id = 0;
+		stream >> command;
+
+		if (command == "new")
+		{
+			std::shared_ptr<Session> session = std::make_shared<Session>();
+			session->side = Side::Black;
+			session->connection = connection;
+			session->is_running = false;
+			session->is_closed = false;
+
+			std::lock_guard<std::mutex> lock(mutex);
+			session->id = next_session_id++;
+			sessions[session->id] = session;
+			connection->session_ids.push_back(session->id);
+			return std::format("session {}", session->id);
+		}
+
+		if (command == "shutdown")
+		{
+			//Stopでこの接続も閉じるので先に応答する
+			connection->Send("ok 0");
+			Stop();
+			return "";
+		}
+
+		if (!(stream >> id))
+			return "error 0 syntax";
+
+		std::lock_guard<std::mutex> lock(mutex);
+		std::shared_ptr<Session> session = FindSession(id);
+		if (!session)
+			return std::format("error {} session", id);
+
+		if (command == "go")
+		{
+			int max_depth = 0;
+			int milliseconds = 0;
+			if (!(stream >> max_depth >> milliseconds) || max_depth <= 0)
+				return std::format("error {} syntax", id);
+
+			auto now = std::chrono::steady_clock::now();
+			session->pending.push_back({ max_depth, now, now + std::chrono::milliseconds(milliseconds) });
+
+			//待っている依頼が無く探索中でもなければ、順番待ちの最後に並ぶ
+			if (session->pending.size() == 1 && !session->is_running)
+			{
+				ready_sessions.push_back(session);
+				condition.notify_all();
+			}
+
+			return "";
+		}
+
+		if (command == "close")
+		{
+			session->is_closed = true;
+			sessions.erase(id);
+			return std::format("ok {}", id);
+		}
+
+		//盤面は探索の依頼が無い間だけ書き換えられる
+		if (session->is_running || !session->pending.empty())
+			return std::format("error {} busy", id);
+
+		if (command == "set")
+		{
+			std::string black, white, side;
+			u64 black_bitboard = 0ull;
+			u64 white_bitboard = 0ull;
+			if (!(stream >> black >> white >> side) || !ParseBitboard(black, black_bitboard) || !ParseBitboard(white, white_bitboard)
+				|| (side != "b" && side != "w"))
+				return std::format("error {} syntax", id);
+
+			//同じマスに両方の石は置けない
+			if ((black_bitboard & white_bitboard) != 0ull)
+				return std::format("error {} illegal", id);
+
+			session->board.SetFieldData({ black_bitboard, white_bitboard });
+			session->side = side == "w" ? Side::White : Side::Black;
+			return std::format("ok {}", id);
+		}
+
+		if (command == "play")
+		{
+			std::string name;
+			stream >> name;
+
+			u64 legal_moves = session->board.GetLegalMoves(session->side);
+			u64 input = ParseSquareName(name);
+
+			//パスは打てる手が無い時だけ受け付ける
+			if (name == "pass" ? legal_moves != 0ull : (input & legal_moves) == 0ull)
+				return std::format("error {} illegal", id);
+
+			if (input != 0ull)
+			{
+				session->board.Set(input, session->side);
+				session->board.Flip(input, session->side);
+			}
+			session->side = GetOpponentSide(session->side);
+			return std::format("ok {}", id);
+		}
+
+		return std::format("error {} command", id);
+	}
+
+	void EngineService::RunWorker(Worker& worker)
+	{
+		if (worker.cpu >= 0)
+			CpuTopology::PinCurrentThread(worker.cpu);
+
+		while (true)
+		{
+			std::shared_ptr<Session> session;
+			Request request;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [this]() { return is_stopping.load() || !ready_sessions.empty(); });
+				if (is_stopping.load())
+					return;
+
+				//先頭のセッションから1件だけ取り出し、残りは最後に並び直した時に処理する
+				session = ready_sessions.front();
+				ready_sessions.pop_front();
+
+				if (session->is_closed)
+				{
+					session->pending.clear();
+					continue;
+				}
+
+				request = session->pending.front();
+				session->pending.pop_front();
+				session->is_running = true;
+			}
+
+			std::string reply = Search(worker, *session, request);
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				session->is_running = false;
+
+				if (!session->pending.empty() && !session->is_closed)
+				{
+					ready_sessions.push_back(session);
+					condition.notify_one();
+				}
+			}
+
+			//応答を受け取ったクライアントがすぐ次の手を送れるよう、探索中を解除してから送る
+			if (std::shared_ptr<Connection> connection = session->connection.lock())
+				connection->Send(reply);
+		}
+	}
+
+	void EngineService::RunWatchdog()
+	{
+		while (!is_stopping.load())
+		{
+			long long now = ToNanoseconds(std::chrono::steady_clock::now());
+
+			for (std::unique_ptr<Worker>& worker : workers)
+			{
+				std::lock_guard<std::mutex> lock(worker->deadline_mutex);
+				long long deadline = worker->deadline.load(std::memory_order_relaxed);
+				if (deadline != 0 && now >= deadline)
+					worker->stop_requested.store(true, std::memory_order_relaxed);
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	std::string EngineService::Search(Worker& worker, Session& session, const Request& request)
+	{
+		constexpr int alpha = std::numeric_limits<int>::min();
+		constexpr int beta = std::numeric_limits<int>::max();
+		SearchTrace::Scope trace_scope("request", session.id);
+
+		auto start = std::chrono::steady_clock::now();
+		double wait = ToMilliseconds(start - request.received);
+		queue_histogram.Record(ToNanoseconds(start) - ToNanoseconds(request.received));
+		worker.search_system.ResetNodeCount();
+
+		//依頼は並行して探索するので、全員が1件ずつ探索するごとに世代を1つ進め、古い依頼の項目から置き換えさせる
+		if (search_count.fetch_add(1, std::memory_order_relaxed) % worker_count == 0)
+			transposition_table->AdvanceGeneration();
+
+		Position root = session.board.GetPosition(session.side);
+		u64 legal_moves = root.GetLegalMoves();
+
+		if (legal_moves == 0ull)
+		{
+			if (root.GetOpponentLegalMoves() == 0ull)
+				return std::format("error {} gameover", session.id);
+
+			session.side = GetOpponentSide(session.side);
+			return std::format("bestmove {} pass 0 0 {} 0", session.id, wait);
+		}
+
+		//期限を過ぎて取り出された依頼は探索せずに最初の手を返す
+		u64 best_move = LowestBit(legal_moves);
+		int best_score = 0;
+		int reached_depth = 0;
+
+		if (start < request.deadline)
+		{
+			{
+				std::lock_guard<std::mutex> lock(worker.deadline_mutex);
+				worker.stop_requested.store(false, std::memory_order_relaxed);
+				worker.deadline.store(ToNanoseconds(request.deadline), std::memory_order_relaxed);
+			}
+
+			//空きマスより深く読んでも結果は変わらない
+			int max_depth = std::min(request.max_depth, std::max(64 - root.CountStones(), 1));
+
+			for (int depth = 1; depth <= max_depth; ++depth)
+			{
+				SearchTrace::Scope iteration_scope("iteration", depth);
+				SearchResult result = worker.search_system.AlphaBetaSearch(root, 0, depth, alpha, beta, true);
+
+				//中断された深さの結果は使わない
+				if (worker.stop_requested.load(std::memory_order_relaxed))
+					break;
+
+				best_move = result.Point;
+				best_score = result.Score;
+				reached_depth = depth;
+
+				//最初の深さを読み終えた時点で打てる手がある
+				if (depth == 1)
+					first_move_histogram.Record(ToNanoseconds(std::chrono::steady_clock::now()) - ToNanoseconds(request.received));
+			}
+
+			std::lock_guard<std::mutex> lock(worker.deadline_mutex);
+			worker.deadline.store(0, std::memory_order_relaxed);
+		}
+
+		session.board.Set(best_move, session.side);
+		session.board.Flip(best_move, session.side);
+		session.side = GetOpponentSide(session.side);
+
+		auto end = std::chrono::steady_clock::now();
+		double elapsed = ToMilliseconds(end - start);
+		search_histogram.Record(ToNanoseconds(end) - ToNanoseconds(start));
+		node_histogram.Record(worker.search_system.GetNodeCount());
+
+		//探索せずに返した手は応答した時に打てるようになる
+		if (reached_depth == 0)
+			first_move_histogram.Record(ToNanoseconds(end) - ToNanoseconds(request.received));
+
+		return std::format("bestmove {} {} {} {} {:.3f} {:.3f}", session.id, ToSquareName(best_move), best_score, reached_depth, wait, elapsed);
+	}
+}
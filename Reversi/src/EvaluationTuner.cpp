@@ -0,0 +1,194 @@
+#include "../include/EvaluationTuner.h"
+#include <cmath>
+
+namespace Reversi
+{
+	EvaluationTuner::EvaluationTuner(const double score_scale, const double regularization) :
+		score_scale(score_scale),
+		regularization(regularization)
+	{
+
+	}
+
+	bool EvaluationTuner::Run(const std::string& dataset_path, const std::string& output_path) const
+	{
+		TrainingData dataset;
+		if (!dataset.Open(dataset_path))
+			return false;
+
+		//教師局面をスレッド数で分割して集計する
+		size_t count = dataset.GetCount();
+		unsigned int thread_count = std::max(1u, std::thread::hardware_concurrency());
+		size_t chunk = (count + thread_count - 1) / thread_count;
+		std::vector<std::future<NormalEquations>> futures;
+
+		for (size_t begin = 0; begin < count; begin += chunk)
+		{
+			size_t end = std::min(count, begin + chunk);
+			futures.emplace_back(std::async(std::launch::async, &EvaluationTuner::Accumulate, this, std::cref(dataset), begin, end));
+		}
+
+		NormalEquations equations;
+		for (std::future<NormalEquations>& future : futures)
+		{
+			NormalEquations result = future.get();
+			for (int stage = 0; stage < EvaluationWeights::STAGE_COUNT; ++stage)
+			{
+				equations[stage].Merge(result[stage]);
+			}
+		}
+
+		StageWeights stages[EvaluationWeights::STAGE_COUNT];
+		const std::shared_ptr<const EvaluationWeights>& defaults = EvaluationWeights::GetDefault();
+
+		for (int stage = 0; stage < EvaluationWeights::STAGE_COUNT; ++stage)
+		{
+			stages[stage] = defaults->Get(stage);
+
+			//教師局面が無い進行度は既定値のままにする
+			if (equations[stage].n < FEATURE_COUNT)
+				continue;
+
+			std::array<double, FEATURE_COUNT> solution = Solve(equations[stage]);
+
+			for (int i = 0; i < 64; ++i)
+			{
+				stages[stage].squares[i] = (int32_t)std::lround(solution[GetSquareClass(i)]);
+			}
+			stages[stage].confirm = (int32_t)std::lround(solution[SQUARE_CLASS_COUNT]);
+			stages[stage].mobility = (int32_t)std::lround(solution[SQUARE_CLASS_COUNT + 1]);
+
+			std::wcout << L"stage " << stage << L": " << equations[stage].n << L" positions, corner "
+				<< stages[stage].squares[0] << L" confirm " << stages[stage].confirm
+				<< L" mobility " << stages[stage].mobility << std::endl;
+		}
+
+		return EvaluationWeights::Save(output_path, stages);
+	}
+
+	EvaluationTuner::NormalEquations EvaluationTuner::Accumulate(const TrainingData& dataset, const size_t begin, const size_t end) const
+	{
+		NormalEquations equations;
+		Evaluator evaluator;
+		std::array<double, FEATURE_COUNT> x;
+
+		for (size_t i = begin; i < end; ++i)
+		{
+			TrainingRecord record = dataset.Get(i);
+			Position position = Position::FromFieldData(std::make_pair(record.black, record.white), record.side);
+
+			//Evaluateと同じ特徴量を手番側の視点で取り出す
+			EvaluationFeatures features = evaluator.GetFeatures(position, true);
+			u64 others = features.field.first;
+			u64 mine = features.field.second;
+
+			x.fill(0.0);
+			for (int square = 0; square < 64; ++square)
+			{
+				x[GetSquareClass(square)] += (double)((mine >> square) & 1ull) - (double)((others >> square) & 1ull);
+			}
+			x[SQUARE_CLASS_COUNT] = features.confirm;
+			x[SQUARE_CLASS_COUNT + 1] = features.mobility;
+
+			double y = record.score * score_scale;
+			NormalEquation& equation = equations[EvaluationWeights::GetStage(features.stone_count)];
+
+			for (int row = 0; row < FEATURE_COUNT; ++row)
+			{
+				for (int column = 0; column < FEATURE_COUNT; ++column)
+				{
+					equation.xx[row * FEATURE_COUNT + column] += x[row] * x[column];
+				}
+				equation.xy[row] += x[row] * y;
+			}
+			equation.n += 1.0;
+		}
+
+		return equations;
+	}
+
+	std::array<double, EvaluationTuner::FEATURE_COUNT> EvaluationTuner::Solve(const NormalEquation& equation) const
+	{
+		//(XtX + λI)w = Xty をガウスの消去法で解く
+		std::array<double, FEATURE_COUNT * FEATURE_COUNT> a = equation.xx;
+		std::array<double, FEATURE_COUNT> b = equation.xy;
+
+		for (int i = 0; i < FEATURE_COUNT; ++i)
+		{
+			a[i * FEATURE_COUNT + i] += regularization;
+		}
+
+		for (int column = 0; column < FEATURE_COUNT; ++column)
+		{
+			//部分ピボット選択
+			int pivot = column;
+			for (int row = column + 1; row < FEATURE_COUNT; ++row)
+			{
+				if (std::abs(a[row * FEATURE_COUNT + column]) > std::abs(a[pivot * FEATURE_COUNT + column]))
+					pivot = row;
+			}
+
+			for (int k = 0; k < FEATURE_COUNT; ++k)
+			{
+				std::swap(a[column * FEATURE_COUNT + k], a[pivot * FEATURE_COUNT + k]);
+			}
+			std::swap(b[column], b[pivot]);
+
+			for (int row = column + 1; row < FEATURE_COUNT; ++row)
+			{
+				double factor = a[row * FEATURE_COUNT + column] / a[column * FEATURE_COUNT + column];
+				for (int k = column; k < FEATURE_COUNT; ++k)
+				{
+					a[row * FEATURE_COUNT + k] -= factor * a[column * FEATURE_COUNT + k];
+				}
+				b[row] -= factor * b[column];
+			}
+		}
+
+		std::array<double, FEATURE_COUNT> solution = {};
+		for (int row = FEATURE_COUNT - 1; row >= 0; --row)
+		{
+			double sum = b[row];
+			for (int k = row + 1; k < FEATURE_COUNT; ++k)
+			{
+				sum -= a[row * FEATURE_COUNT + k] * solution[k];
+			}
+			solution[row] = sum / a[row * FEATURE_COUNT + row];
+		}
+
+		return solution;
+	}
+
+	int EvaluationTuner::GetSquareClass(const int index)
+	{
+		//A1, B1, C1, D1, B2, C2, D2, C3, D3, D4 の10種類に纏める
+		constexpr int classes[4][4] = {
+			{ 0, 1, 2, 3 },
+			{ 1, 4, 5, 6 },
+			{ 2, 5, 7, 8 },
+			{ 3, 6, 8, 9 },
+		};
+
+		int row = index / 8;
+		int column = index % 8;
+		row = std::min(row, 7 - row);
+		column = std::min(column, 7 - column);
+
+		return classes[row][column];
+	}
+
+	void EvaluationTuner::NormalEquation::Merge(const NormalEquation& other)
+	{
+		for (size_t i = 0; i < xx.size(); ++i)
+		{
+			xx[i] += other.xx[i];
+		}
+
+		for (size_t i = 0; i < xy.size(); ++i)
+		{
+			xy[i] += other.xy[i];
+		}
+
+		n += other.n;
+	}
+}
@@ -0,0 +1,101 @@
+#include "../include/EvaluationWeights.h"
+#include <fstream>
+#include <cstring>
+
+namespace Reversi
+{
+	namespace
+	{
+		//手調整された各マスのウェイト
+		constexpr int default_square_weights[64] = {
+				45, -11, 4, -1, -1, 4, -11, 45,
+				-11, -16, -1, -3, -3, 2, -16, -11,
+				4, -1, 2, -1, -1, 2, -1, 4,
+				-1, -3, -1, 0, 0, -1, -3, -1,
+				-1, -3, -1, 0, 0, -1, -3, -1,
+				4, -1, 2, -1, -1, 2, -1, 4,
+				-11, -16, -1, -3, -3, 2, -16, -11,
+				45, -11, 4, -1, -1, 4, -11, 45,
+		};
+
+		constexpr StageWeights MakeDefaultStage()
+		{
+			StageWeights stage = {};
+
+			//マスのウェイトは4倍してから全体を8倍していた
+			for (int i = 0; i < 64; ++i)
+			{
+				stage.squares[i] = default_square_weights[i] * 4 * 8;
+			}
+
+			stage.confirm = 165;
+			stage.mobility = 20;
+			return stage;
+		}
+
+		constexpr StageWeights default_stages[EvaluationWeights::STAGE_COUNT] = {
+			MakeDefaultStage(), MakeDefaultStage(), MakeDefaultStage(),
+			MakeDefaultStage(), MakeDefaultStage(), MakeDefaultStage(),
+		};
+	}
+
+	EvaluationWeights::EvaluationWeights() : stages(default_stages)
+	{
+
+	}
+
+	const std::shared_ptr<const EvaluationWeights>& EvaluationWeights::GetDefault()
+	{
+		static const std::shared_ptr<const EvaluationWeights> instance = std::make_shared<EvaluationWeights>();
+		return instance;
+	}
+
+	bool EvaluationWeights::Load(const std::string& path)
+	{
+		stages = default_stages;
+
+		if (!file.Open(path))
+			return false;
+
+		constexpr size_t payload_size = sizeof(StageWeights) * STAGE_COUNT;
+
+		//サイズ・識別子・バージョン・チェックサムが一致しないファイルは使わない
+		FileHeader header;
+		bool is_valid = file.GetSize() == sizeof(FileHeader) + payload_size;
+
+		if (is_valid)
+		{
+			std::memcpy(&header, file.GetData(), sizeof(FileHeader));
+			is_valid = header.magic == FILE_MAGIC && header.version == FILE_VERSION && header.stage_count == STAGE_COUNT &&
+				header.checksum == ComputeChecksum(file.GetData() + sizeof(FileHeader), payload_size);
+		}
+
+		if (!is_valid)
+		{
+			file.Close();
+			return false;
+		}
+
+		stages = reinterpret_cast<const StageWeights*>(file.GetData() + sizeof(FileHeader));
+		return true;
+	}
+
+	bool EvaluationWeights::Save(const std::string& path, const StageWeights (&stages)[STAGE_COUNT])
+	{
+		std::ofstream stream(path, std::ios::binary);
+		if (!stream)
+			return false;
+
+		FileHeader header = {
+			FILE_MAGIC,
+			FILE_VERSION,
+			STAGE_COUNT,
+			ComputeChecksum(stages, sizeof(stages))
+		};
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(reinterpret_cast<const char*>(stages), sizeof(stages));
+
+		return static_cast<bool>(stream);
+	}
+}
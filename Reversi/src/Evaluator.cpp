@@ -2,27 +2,27 @@
 
 namespace Reversi
 {
-	Evaluator::Evaluator(std::shared_ptr<Board>& board)
-		: board(board)
+	template <int size>
+	BasicEvaluator<size>::BasicEvaluator()
+		: weights(EvaluationWeights::GetDefault())
 	{
 
 	}
 
-	//評価関数
-	int Evaluator::Evaluate(Side side) const
+	template <int size>
+	void BasicEvaluator<size>::SetWeights(const std::shared_ptr<const EvaluationWeights>& weights)
 	{
-		//盤面情報の取得
-		std::pair<int, int> counts = board->CountStone();
-		std::pair<u64, u64> field_data = board->GetFieldData();
-		std::pair<int, int> legal_counts = board->CountLegalMoves();
+		this->weights = weights ? weights : EvaluationWeights::GetDefault();
+	}
 
-		//逆サイドの評価の場合は盤面情報をswap
-		if (side == Side::Black)
-		{
-			std::swap(std::get<0>(counts), std::get<1>(counts));
-			std::swap(std::get<0>(field_data), std::get<1>(field_data));
-			std::swap(std::get<0>(legal_counts), std::get<1>(legal_counts));
-		}
+	//評価関数
+	template <int size>
+	int BasicEvaluator<size>::EvaluateField(const std::pair<Bits, Bits> field_data) const
+	{
+		std::pair<int, int> counts = std::make_pair(PopCount(field_data.first), PopCount(field_data.second));
+		std::pair<int, int> legal_counts = std::make_pair(
+			PopCount(Position::ComputeLegalMoves(field_data.first, field_data.second)),
+			PopCount(Position::ComputeLegalMoves(field_data.second, field_data.first)));
 
 		//ゲーム終了時のスコアを取得
 		int ending_score = EvaluateGameEnd(counts, legal_counts.first, legal_counts.second);
@@ -30,77 +30,96 @@ namespace Reversi
 		if (ending_score != 0)
 			return ending_score;
 
+		//進行度は8x8の石数に換算して決める
+		int stone_count = (counts.first + counts.second) * 64 / Geometry::SQUARE_COUNT;
+		const StageWeights& stage_weights = weights->Get(EvaluationWeights::GetStage(stone_count));
 		int bestScore = 0;
 
 		//各座標のウェイトを評価
-		bestScore += EvaluateWeight(field_data) * 8;
+		bestScore += EvaluateWeight(field_data, stage_weights);
 
 		//確定石を評価
-		bestScore += EvaluateConfirm(field_data) * 165;
+		bestScore += EvaluateConfirm(field_data) * stage_weights.confirm;
 
 		//着手可能数を評価
-		bestScore += legal_counts.first * 20;
+		bestScore += legal_counts.first * stage_weights.mobility;
 
 		return bestScore;
 	}
 
-	int Evaluator::EvaluateGameEnd(std::pair<int, int> counts, int legal_count_mine, int legal_count_other) const
+	template <int size>
+	EvaluationFeatures BasicEvaluator<size>::GetFeatures(const Position& position, const bool is_max) const requires (size == DEFAULT_BOARD_SIZE)
+	{
+		//Evaluateと同じ向きに揃える
+		std::pair<u64, u64> field_data = is_max ? std::make_pair(position.opponent, position.player) : std::make_pair(position.player, position.opponent);
+		int mobility = PopCount(Position::ComputeLegalMoves(field_data.first, field_data.second));
+
+		return { field_data, EvaluateConfirm(field_data), mobility, position.CountStones() };
+	}
+
+	template <int size>
+	int BasicEvaluator<size>::EvaluateGameEnd(std::pair<int, int> counts, int legal_count_mine, int legal_count_other)
 	{
 		if (counts.first == 0)
 			return 20000000;
 		if (counts.second == 0)
 			return -20000000;
 
-		if (counts.first + counts.second == 64 || legal_count_mine + legal_count_other == 0)
+		if (counts.first + counts.second == Geometry::SQUARE_COUNT || legal_count_mine + legal_count_other == 0)
 		{
 			if (counts.first < counts.second)
-				return 15000;
+				return WIN_SCORE;
 
 			if (counts.first > counts.second)
-				return -15000;
+				return -WIN_SCORE;
 		}
 
 		return 0;
 	}
 
-	int Evaluator::EvaluateWeight(const std::pair<u64, u64> field) const
+	template <int size>
+	int BasicEvaluator<size>::EvaluateWeight(const std::pair<Bits, Bits> field, const StageWeights& stage_weights) const
 	{
 		int sum = 0;
 
-		for (int i = 0; i < 64; ++i)
+		for (int i = 0; i < Geometry::SQUARE_COUNT; ++i)
 		{
-			int sign = static_cast<int>(((field.second >> i) & 1ull) - ((field.first >> i) & 1ull));
-			sum += weights[i] * sign * 4;
+			int sign = static_cast<int>((bool)((field.second >> i) & Bits(1))) - static_cast<int>((bool)((field.first >> i) & Bits(1)));
+
+			//8x8ではウェイトの番号とマスの番号が一致する
+			if constexpr (size == DEFAULT_BOARD_SIZE)
+				sum += stage_weights.squares[i] * sign;
+			else
+				sum += stage_weights.squares[WEIGHT_SQUARES[i]] * sign;
 		}
 
 		return sum;
 	}
 
-	int Evaluator::EvaluateConfirm(const std::pair<u64, u64> field) const
+	template <int size>
+	int BasicEvaluator<size>::EvaluateConfirm(const std::pair<Bits, Bits> field) const
 	{
-		u64 mine = field.first;
-		u64 others = field.second;
-		u64 all = mine | others;
+		Bits mine = field.first;
+		Bits others = field.second;
+		Bits all = mine | others;
 		int count = 0;
 
-		for (const u64& corner : corners)
+		for (const Bits& corner : corners)
 		{
-			if ((all & corner) == 0ull)
+			if (!(all & corner))
 				continue;
 
-			u64 target = (mine & corner) == 0ull ? mine : others;
-			u64 obstacle = (mine & corner) == 0ull ? others : mine;
+			Bits target = !(mine & corner) ? mine : others;
+			Bits obstacle = !(mine & corner) ? others : mine;
 
 			//繋がってる石を取得する
-			u64 flips = board->GetCrossFloods(corner, obstacle);
-			count += (std::popcount(flips) + 1) * (-(int)(target == others));
+			Bits flips = Position::GetCrossFloods(corner, obstacle);
+			count += (PopCount(flips) + 1) * (-(int)(target == others));
 		}
 
 		return count;
 	}
-}
-
-
-
-
 
+	template class BasicEvaluator<8>;
+	template class BasicEvaluator<10>;
+}
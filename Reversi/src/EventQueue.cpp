@@ -0,0 +1,36 @@
+#include "../include/EventQueue.h"
+
+namespace Reversi
+{
+	void EventQueue::Push(GameEvent event)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			events.emplace_back(std::move(event));
+		}
+
+		condition.notify_one();
+	}
+
+	bool EventQueue::Pop(GameEvent& event, const std::chrono::milliseconds timeout)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		if (!condition.wait_for(lock, timeout, [this]() { return !events.empty(); }))
+			return false;
+
+		event = std::move(events.front());
+		events.pop_front();
+		return true;
+	}
+
+	GameEvent EventQueue::Pop()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [this]() { return !events.empty(); });
+
+		GameEvent event = std::move(events.front());
+		events.pop_front();
+		return event;
+	}
+}
@@ -0,0 +1,186 @@
+#include "../include/GameRecordReader.h"
+#include "../include/Checksum.h"
+#include <cstring>
+
+namespace Reversi
+{
+	namespace
+	{
+		//可変長整数(下位7ビットずつ、最上位ビットが続きの印)を読む
+		bool ReadVarint(const unsigned char*& cursor, const unsigned char* end, u64& value)
+		{
+			value = 0;
+
+			for (int shift = 0; shift < 64 && cursor < end; shift += 7)
+			{
+				unsigned char byte = *cursor++;
+				value |= (u64)(byte & 0x7F) << shift;
+
+				if ((byte & 0x80) == 0)
+					return true;
+			}
+
+			return false;
+		}
+
+		PlayerSetting ReadPlayerSetting(const unsigned char* data)
+		{
+			return { static_cast<PlayerType>(data[0]), data[1], static_cast<EvaluatorType>(data[2]) };
+		}
+	}
+
+	bool GameRecordReader::Open(const std::string& path)
+	{
+		offsets.clear();
+		valid_size = 0;
+
+		if (!file.Open(path) || file.GetSize() < HEADER_SIZE)
+			return false;
+
+		uint32_t header[2];
+		std::memcpy(header, file.GetData(), HEADER_SIZE);
+
+		if (header[0] != FILE_MAGIC || header[1] != FILE_VERSION)
+		{
+			file.Close();
+			return false;
+		}
+
+		const unsigned char* data = file.GetData();
+		size_t size = file.GetSize();
+		size_t offset = HEADER_SIZE;
+
+		while (size - offset >= RECORD_HEADER_SIZE)
+		{
+			uint16_t payload_size;
+			uint32_t checksum;
+			std::memcpy(&payload_size, data + offset, 2);
+			std::memcpy(&checksum, data + offset + 2, 4);
+
+			const unsigned char* payload = data + offset + RECORD_HEADER_SIZE;
+			size_t rest = size - offset - RECORD_HEADER_SIZE;
+
+			//途中で切れた局・壊れた局があればそこで打ち切る
+			if (payload_size < RECORD_FIXED_SIZE || payload_size > rest)
+				break;
+
+			if (payload_size < RECORD_FIXED_SIZE + payload[8] || ComputeChecksum(payload, payload_size) != checksum)
+				break;
+
+			offsets.emplace_back(offset + RECORD_HEADER_SIZE);
+			offset += RECORD_HEADER_SIZE + payload_size;
+		}
+
+		valid_size = offset;
+		return true;
+	}
+
+	size_t GameRecordReader::GetCount() const
+	{
+		return offsets.size();
+	}
+
+	size_t GameRecordReader::GetValidSize() const
+	{
+		return valid_size;
+	}
+
+	size_t GameRecordReader::GetPayloadSize(const size_t index) const
+	{
+		uint16_t payload_size;
+		std::memcpy(&payload_size, file.GetData() + offsets[index] - RECORD_HEADER_SIZE, 2);
+		return payload_size;
+	}
+
+	size_t GameRecordReader::GetOffset(const size_t index) const
+	{
+		return offsets[index] - RECORD_HEADER_SIZE;
+	}
+
+	std::span<const unsigned char> GameRecordReader::GetSquares(const size_t index) const
+	{
+		const unsigned char* data = file.GetData() + offsets[index];
+		return { data + RECORD_FIXED_SIZE, data[8] };
+	}
+
+	std::pair<int, int> GameRecordReader::GetResult(const size_t index) const
+	{
+		const unsigned char* data = file.GetData() + offsets[index];
+		return { data[6], data[7] };
+	}
+
+	GameRecord GameRecordReader::Get(const size_t index) const
+	{
+		const unsigned char* data = file.GetData() + offsets[index];
+		const unsigned char* end = data + GetPayloadSize(index);
+		GameRecord record;
+
+		record.black = ReadPlayerSetting(data);
+		record.white = ReadPlayerSetting(data + 3);
+		record.black_count = data[6];
+		record.white_count = data[7];
+
+		int move_count = data[8];
+		const unsigned char* squares = data + RECORD_FIXED_SIZE;
+		const unsigned char* cursor = squares + move_count;
+
+		record.moves.resize(move_count);
+		for (int i = 0; i < move_count; ++i)
+		{
+			MoveRecord& move = record.moves[i];
+			move.square = squares[i];
+
+			//チェックサムは合っているので、足りなければ0のままにする
+			u64 microseconds = 0;
+			u64 nodes = 0;
+			if (ReadVarint(cursor, end, microseconds) && ReadVarint(cursor, end, nodes))
+			{
+				move.microseconds = (uint32_t)microseconds;
+				move.nodes = nodes;
+			}
+			else
+			{
+				move.microseconds = 0;
+				move.nodes = 0;
+			}
+		}
+
+		return record;
+	}
+
+	bool GameRecordReader::Replay(const size_t index, Board& board) const
+	{
+		const unsigned char* data = file.GetData() + offsets[index];
+		const unsigned char* squares = data + RECORD_FIXED_SIZE;
+		int move_count = data[8];
+		Side side = Side::Black;
+
+		board.Reset();
+
+		for (int i = 0; i < move_count; ++i)
+		{
+			unsigned char square = squares[i];
+
+			if (square != GameRecord::PASS_SQUARE)
+			{
+				if (square > 63)
+					return false;
+
+				u64 input = 1ull << square;
+
+				//空いていないマスや1つも返せない手は不正な棋譜
+				if ((board.GetAllBoard() & input) != 0ull)
+					return false;
+
+				board.Set(input, side);
+				if (board.Flip(input, side) == 0ull)
+					return false;
+			}
+
+			side = GetOpponentSide(side);
+		}
+
+		std::pair<int, int> counts = board.CountStone();
+		return counts.first == data[6] && counts.second == data[7];
+	}
+}
@@ -0,0 +1,152 @@
+#include "../include/GameRecordWriter.h"
+#include "../include/GameRecordReader.h"
+#include "../include/Checksum.h"
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+
+namespace Reversi
+{
+	namespace
+	{
+		//可変長整数(下位7ビットずつ、最上位ビットが続きの印)を書く
+		void WriteVarint(std::vector<unsigned char>& buffer, u64 value)
+		{
+			while (value >= 0x80)
+			{
+				buffer.emplace_back((unsigned char)(value | 0x80));
+				value >>= 7;
+			}
+
+			buffer.emplace_back((unsigned char)value);
+		}
+
+		void WritePlayerSetting(std::vector<unsigned char>& buffer, const PlayerSetting& setting)
+		{
+			buffer.emplace_back(static_cast<unsigned char>(setting.type));
+			buffer.emplace_back(setting.depth);
+			buffer.emplace_back(static_cast<unsigned char>(setting.evaluator));
+		}
+	}
+
+	GameRecordWriter::~GameRecordWriter()
+	{
+		Close();
+	}
+
+	bool GameRecordWriter::Open(const std::string& path)
+	{
+		Close();
+
+		std::error_code error;
+		uintmax_t file_size = std::filesystem::file_size(path, error);
+		bool is_new = error || file_size < GameRecordReader::HEADER_SIZE;
+
+		if (!is_new)
+		{
+			//読める局の後ろに残った書きかけの局を切り捨てる(残すと以降の追記が読めなくなる)
+			size_t valid_size;
+			{
+				GameRecordReader reader;
+				if (!reader.Open(path))
+					return false;
+
+				valid_size = reader.GetValidSize();
+			}
+
+			if (valid_size != file_size)
+			{
+				std::filesystem::resize_file(path, valid_size, error);
+				if (error)
+					return false;
+			}
+		}
+
+		stream.open(path, std::ios::binary | (is_new ? std::ios::trunc : std::ios::app));
+		if (!stream)
+			return false;
+
+		if (is_new)
+		{
+			uint32_t header[2] = { GameRecordReader::FILE_MAGIC, GameRecordReader::FILE_VERSION };
+			stream.write(reinterpret_cast<const char*>(header), GameRecordReader::HEADER_SIZE);
+		}
+
+		buffer.reserve(FLUSH_SIZE + 4096);
+		return static_cast<bool>(stream);
+	}
+
+	void GameRecordWriter::Close()
+	{
+		if (!stream.is_open())
+			return;
+
+		Flush();
+		stream.close();
+	}
+
+	bool GameRecordWriter::IsOpen() const
+	{
+		return stream.is_open();
+	}
+
+	bool GameRecordWriter::Write(const GameRecord& record)
+	{
+		if (!stream.is_open())
+			return false;
+
+		//見出しは本体を書いてから埋める
+		size_t begin = buffer.size();
+		buffer.resize(begin + GameRecordReader::RECORD_HEADER_SIZE);
+		Encode(record, buffer);
+
+		uint16_t payload_size = (uint16_t)(buffer.size() - begin - GameRecordReader::RECORD_HEADER_SIZE);
+		uint32_t checksum = ComputeChecksum(buffer.data() + begin + GameRecordReader::RECORD_HEADER_SIZE, payload_size);
+		std::memcpy(buffer.data() + begin, &payload_size, 2);
+		std::memcpy(buffer.data() + begin + 2, &checksum, 4);
+
+		if (buffer.size() >= FLUSH_SIZE)
+			return Flush();
+
+		return static_cast<bool>(stream);
+	}
+
+	bool GameRecordWriter::Flush()
+	{
+		if (!stream.is_open())
+			return false;
+
+		if (!buffer.empty())
+		{
+			stream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+			buffer.clear();
+		}
+
+		stream.flush();
+		return static_cast<bool>(stream);
+	}
+
+	void GameRecordWriter::Encode(const GameRecord& record, std::vector<unsigned char>& buffer)
+	{
+		//手数は1バイトに収める(通常の対局はパスを含めても100手に満たない)
+		size_t move_count = std::min<size_t>(record.moves.size(), 255);
+
+		WritePlayerSetting(buffer, record.black);
+		WritePlayerSetting(buffer, record.white);
+		buffer.emplace_back(record.black_count);
+		buffer.emplace_back(record.white_count);
+		buffer.emplace_back((unsigned char)move_count);
+
+		//再生時に着手位置だけを連続して読めるよう、先にまとめて並べる
+		for (size_t i = 0; i < move_count; ++i)
+		{
+			buffer.emplace_back(record.moves[i].square);
+		}
+
+		for (size_t i = 0; i < move_count; ++i)
+		{
+			WriteVarint(buffer, record.moves[i].microseconds);
+			WriteVarint(buffer, record.moves[i].nodes);
+		}
+	}
+}
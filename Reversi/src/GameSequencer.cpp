@@ -1,4 +1,5 @@
 #include "../include/GameSequencer.h"
+#include "../include/SearchTrace.h"
 
 namespace Reversi
 {
@@ -6,6 +7,7 @@ namespace Reversi
 		std::shared_ptr<BoardWriter>& board_writer,
 		std::shared_ptr<MessageWriter>& message_writer) :
 		engine(board),
+		events(std::make_shared<EventQueue>()),
 		player_turn(Side::Black),
 		current_turn(Side::Black),
 		current_state(State::Invalid),
@@ -18,11 +20,61 @@ namespace Reversi
 		rand_module.seed(1234);
 	}
 
+	void GameSequencer::SetEvaluatorType(const EvaluatorType type)
+	{
+		engine.SetEvaluatorType(type);
+	}
+
+	void GameSequencer::SetEngineMode(const EngineMode mode)
+	{
+		engine.SetEngineMode(mode);
+	}
+
+	bool GameSequencer::SetTranspositionTable(const size_t megabytes, const std::string& shared_name)
+	{
+		engine.SetTranspositionTableSize(megabytes);
+		return shared_name.empty() || engine.ShareTranspositionTable(shared_name);
+	}
+
+	bool GameSequencer::SetSearchCache(const std::string& path)
+	{
+		return engine.AttachSearchCache(path);
+	}
+
+	void GameSequencer::SetThreadCount(const int count)
+	{
+		engine.SetThreadCount(count);
+	}
+
+	void GameSequencer::SetHardwarePolicy(const HardwarePolicy& policy)
+	{
+		engine.SetHardwarePolicy(policy);
+	}
+
+	void GameSequencer::SetMetricsFile(const std::string& path)
+	{
+		metrics.AddHistogram("reversi_engine_move_seconds", "Time the engine spent choosing one move.", move_histogram, 1e-9, 1e-4, 100.0);
+		metrics.AddHistogram("reversi_engine_move_nodes", "Nodes the engine searched for one move.", node_histogram, 1.0, 10.0, 1e10);
+		metrics.Start(path, MetricsExporter::EXPORT_INTERVAL);
+	}
+
+	void GameSequencer::SetTracePath(const std::string& path)
+	{
+		trace_path = path;
+		SearchTrace::Enable(!path.empty());
+	}
+
 	void GameSequencer::Start()
 	{
 		// 外部に公開するものをできる限り減らしましょう
 		// これら全てはこのクラス内限定使用で問題ありません。
 
+		//入力は別スレッドで読み、キューから受け取る(探索中もr/sを受け付けるため)
+		reader.StartAsync(events);
+
+		//棋譜ファイルが開けなくても対局はできるので記録しないだけにする
+		record_writer.Open(RECORD_FILE);
+
 		while (current_state != State::Stop)
 		{
 			//オセロボードの表示
@@ -43,6 +95,9 @@ namespace Reversi
 				AskRetry();
 			}
 		}
+
+		//次に起動した時のために探索結果を残す
+		engine.SaveSearchCache();
 	}
 
 	//インゲームのメインループ
@@ -50,6 +105,7 @@ namespace Reversi
 	{
 		message_writer->WriteGameStartMessage();
 		BoardInfo boardInfo = GetBoardInfo();
+		BeginRecord();
 
 		//局面が終了するまでループ
 		while (!boardInfo.is_end)
@@ -58,6 +114,11 @@ namespace Reversi
 			Refresh();
 			message_writer->WriteTurnMessage(player_turn, engine.GetSearchDepth());
 
+			//過去の対局で現れた局面なら勝敗を表示する
+			PositionStats stats;
+			if (engine.QueryPosition(current_turn, stats))
+				message_writer->WritePositionStats(stats);
+
 			//着手可能数を取得
 			std::pair<int, int> legal_counts = board->CountLegalMoves();
 			int mine_count = current_turn == Side::Black ? legal_counts.first : legal_counts.second;
@@ -67,20 +128,22 @@ namespace Reversi
 			{
 				message_writer->WritePassMessage(current_turn);
 				prev_input = 0xFFFFFFFFFFFFFFFF;
+				RecordMove(0ull);
 			}
 			else
 			{
 				if (current_turn == player_turn)
 				{
 					PlayerTurn();
-
-					if (current_state == State::Stop || current_state == State::Restart || current_state == State::End)
-						break;
 				}
 				else
 				{
 					EnemyTurn();
 				}
+
+				//探索中のr/sもここで抜ける
+				if (current_state == State::Stop || current_state == State::Restart || current_state == State::End)
+					break;
 			}
 
 			//ボード情報を更新
@@ -93,6 +156,10 @@ namespace Reversi
 		if (boardInfo.is_end)
 		{
 			current_state = State::End;
+			EndRecord(boardInfo);
+
+			//落ちても直前の対局までの探索結果は残るよう、終局ごとに保存する
+			engine.SaveSearchCache();
 
 			//リザルト表示
 			Refresh();
@@ -120,6 +187,33 @@ namespace Reversi
 		board_writer->Write(field_data, legal_moves, prev_input);
 	}
 
+	void GameSequencer::BeginRecord()
+	{
+		PlayerSetting human = { PlayerType::Human, 0, EvaluatorType::Handcrafted };
+		PlayerType enemy_type = engine.GetEngineMode() == EngineMode::MonteCarlo ? PlayerType::MonteCarloEngine : PlayerType::Engine;
+		PlayerSetting enemy = { enemy_type, (unsigned char)engine.GetSearchDepth(), engine.GetEvaluatorType() };
+
+		game_record.black = player_turn == Side::Black ? human : enemy;
+		game_record.white = player_turn == Side::White ? human : enemy;
+		game_record.moves.clear();
+	}
+
+	void GameSequencer::RecordMove(const u64 input, const uint32_t microseconds, const u64 nodes)
+	{
+		unsigned char square = input == 0ull ? GameRecord::PASS_SQUARE : (unsigned char)std::countr_zero(input);
+		game_record.moves.push_back({ square, microseconds, nodes });
+	}
+
+	void GameSequencer::EndRecord(const BoardInfo& board_info)
+	{
+		game_record.black_count = (unsigned char)board_info.black_count;
+		game_record.white_count = (unsigned char)board_info.white_count;
+
+		//対局の間隔は長いので一局ごとに書き出す
+		record_writer.Write(game_record);
+		record_writer.Flush();
+	}
+
 	void GameSequencer::ChangeTurn()
 	{
 		current_turn = current_turn == Side::Black ? Side::White : Side::Black;
@@ -132,7 +226,8 @@ namespace Reversi
 		do
 		{
 			//コマンド情報を取得
-			Command command = reader.ReadCommand();
+			reader.WriteInitialMessage();
+			Command command = reader.ParseCommand(WaitInput());
 			current_state = command.state;
 
 			// ネストを深くしないように早期コンティニューさせる
@@ -146,6 +241,7 @@ namespace Reversi
 				board->Set(command.set, current_turn);
 				board->Flip(command.set, current_turn);
 				prev_input = command.set;
+				RecordMove(command.set);
 			}
 			else
 			{
@@ -162,15 +258,64 @@ namespace Reversi
 		//ベンチマーク
 		reversiBenchmark.Start();
 
-		//最善手を計算
-		u64 best_move = engine.MakeBestMove();
+		//最善手の計算はバックグラウンドで行い、その間は入力と途中経過の表示を受け付ける
+		int search_id = engine.StartSearch(events);
+		u64 best_move = 0ull;
+		bool is_found = false;
+		current_state = State::Set;
+
+		while (!is_found)
+		{
+			GameEvent event;
+			if (events->Pop(event, PROGRESS_INTERVAL))
+			{
+				if (event.type == GameEventType::SearchFinished)
+				{
+					//中断した探索の結果は捨てる
+					if (event.search_id != search_id)
+						continue;
+
+					best_move = event.point;
+					is_found = true;
+				}
+				else
+				{
+					Command command = reader.ParseCommand(event.text);
+
+					//リスタート・終了はすぐに探索を打ち切る
+					if (command.state == State::Restart || command.state == State::Stop)
+					{
+						engine.CancelSearch();
+						current_state = command.state;
+						std::wcout << std::endl;
+						return;
+					}
+
+					if (command.state == State::Set)
+						message_writer->WriteSearchingCommandMessage();
+
+					continue;
+				}
+			}
+
+			message_writer->WriteSearchProgress(engine.GetProgress());
+		}
 
 		reversiBenchmark.End();
 
+		//探索スレッドはすべて終わっているので、ここまでの記録を書き出せる
+		if (!trace_path.empty() && !SearchTrace::Export(trace_path))
+			std::wcerr << L"cannot write trace" << std::endl;
+
 		board->Set(best_move, current_turn);
 		board->Flip(best_move, current_turn);
 
 		prev_input = best_move;
+
+		SearchProgress progress = engine.GetProgress();
+		RecordMove(best_move, (uint32_t)(progress.seconds * 1000000.0), progress.nodes);
+		move_histogram.Record((u64)(progress.seconds * 1e9));
+		node_histogram.Record(progress.nodes);
 	}
 
 	void GameSequencer::AskSelectStrength()
@@ -183,7 +328,7 @@ namespace Reversi
 			message_writer->WriteSelectStrengthMessage(invalid, MIN_STRENGTH, MAX_STRENGTH);
 			invalid = false;
 
-			std::wcin >> input_buffer;
+			input_buffer = WaitInput();
 
 			int strength = std::stoi(input_buffer);
 
@@ -208,7 +353,7 @@ namespace Reversi
 			message_writer->WriteSelectTurnMessage(invalid);
 			invalid = false;
 
-			std::wcin >> input_buffer;
+			input_buffer = WaitInput();
 
 			if (input_buffer == L"0")
 			{
@@ -227,6 +372,20 @@ namespace Reversi
 		} while (invalid);
 	}
 
+	std::wstring GameSequencer::WaitInput()
+	{
+		//入力は別スレッドで読むので、wcinのtieによるフラッシュに頼らずプロンプトを出しておく
+		std::wcout.flush();
+
+		//前の探索の結果など入力以外のイベントは読み飛ばす
+		while (true)
+		{
+			GameEvent event = events->Pop();
+			if (event.type == GameEventType::Input)
+				return event.text;
+		}
+	}
+
 	BoardInfo GameSequencer::GetBoardInfo() const
 	{
 		std::pair<int, int> stoneCounts = board->CountStone();
@@ -248,7 +407,7 @@ namespace Reversi
 			message_writer->WriteRetryMessage(invalid);
 			invalid = false;
 
-			std::wcin >> input_buffer;
+			input_buffer = WaitInput();
 
 			if (input_buffer == L"y")
 			{
@@ -19,16 +19,25 @@ namespace Reversi
 		return (set & legal_positions) == set;
 	}
 
-	Command InputReader::ReadCommand() const
+	void InputReader::StartAsync(const std::shared_ptr<EventQueue>& queue) const
 	{
-		std::wstring input;
-		State state;
-		u64 pos = 0ull;
+		//入力待ちで止まったままでも終了できるように切り離す(キューは共有して寿命を延ばす)
+		std::thread([queue]()
+			{
+				std::wstring input;
+				while (std::wcin >> input)
+				{
+					queue->Push({ GameEventType::Input, input, 0, 0ull });
+				}
 
-		WriteInitialMessage();
+				queue->Push({ GameEventType::Input, L"s", 0, 0ull });
+			}).detach();
+	}
 
-		//入力を取る
-		std::wcin >> input;
+	Command InputReader::ParseCommand(std::wstring input) const
+	{
+		State state;
+		u64 pos = 0ull;
 
 		size_t length = input.length();
 
@@ -0,0 +1,243 @@
+#include "../include/InterleavedSearch.h"
+#include <limits>
+
+namespace Reversi
+{
+	InterleavedSearch::InterleavedSearch(const std::shared_ptr<TranspositionTable>& table, const size_t slot_count) :
+		transposition_table(table),
+		slots(slot_count),
+		active_count(0),
+		cursor(0),
+		node_count(0)
+	{
+		for (Slot& slot : slots)
+		{
+			slot.tag = 0;
+			slot.is_active = false;
+		}
+	}
+
+	void InterleavedSearch::SetEvaluationWeights(const std::shared_ptr<const EvaluationWeights>& weights)
+	{
+		evaluator.SetWeights(weights);
+	}
+
+	bool InterleavedSearch::Add(const Position& position, const int depth, const u64 tag)
+	{
+		for (Slot& slot : slots)
+		{
+			if (slot.is_active)
+				continue;
+
+			//探索中にスタックを伸ばし直さないよう、深さ分を先に確保する
+			slot.frames.clear();
+			slot.frames.reserve(depth + 1);
+			slot.tag = tag;
+			slot.is_active = true;
+			++active_count;
+
+			PushFrame(slot, position, 0ull, depth, std::numeric_limits<int>::min(), std::numeric_limits<int>::max(), true);
+			return true;
+		}
+
+		return false;
+	}
+
+	bool InterleavedSearch::RunUntilComplete(u64& tag, SearchResult& result)
+	{
+		if (active_count == 0)
+			return false;
+
+		while (true)
+		{
+			Slot& slot = slots[cursor];
+			cursor = cursor + 1 == slots.size() ? 0 : cursor + 1;
+
+			if (!slot.is_active)
+				continue;
+
+			if (Step(slot, result))
+			{
+				slot.is_active = false;
+				--active_count;
+				tag = slot.tag;
+				return true;
+			}
+		}
+	}
+
+	size_t InterleavedSearch::GetActiveCount() const
+	{
+		return active_count;
+	}
+
+	u64 InterleavedSearch::GetNodeCount() const
+	{
+		return node_count;
+	}
+
+	void InterleavedSearch::ResetNodeCount()
+	{
+		node_count = 0;
+	}
+
+	void InterleavedSearch::PushFrame(Slot& slot, const Position& position, const u64 point, const int depth, const int alpha, const int beta, const bool is_max)
+	{
+		Frame& frame = slot.frames.emplace_back();
+		frame.position = position;
+		frame.point = point;
+		frame.depth = depth;
+		frame.alpha = alpha;
+		frame.beta = beta;
+		frame.is_max = is_max;
+		frame.state = FrameState::Enter;
+		frame.use_table = false;
+	}
+
+	bool InterleavedSearch::Step(Slot& slot, SearchResult& result)
+	{
+		//SearchSystem::Searchと同じ順に処理し、置換表を引く前にだけ他の探索へ切り替える
+		while (true)
+		{
+			Frame& frame = slot.frames.back();
+
+			switch (frame.state)
+			{
+			case FrameState::Enter:
+			{
+				++node_count;
+
+				u64 legal_moves = frame.depth != 0 ? frame.position.GetLegalMoves() : 0ull;
+
+				//一番深くまで到達したか、おけるマスが無くなったら評価する
+				if (legal_moves == 0ull)
+				{
+					int score = frame.is_max ? evaluator.Evaluate<true>(frame.position) : evaluator.Evaluate<false>(frame.position);
+					if (Return(slot, { score, frame.point }, result))
+						return true;
+
+					break;
+				}
+
+				frame.rest = legal_moves;
+				frame.first = 0ull;
+				frame.best = { frame.is_max ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max(), 0ull };
+				frame.original_alpha = frame.alpha;
+				frame.original_beta = frame.beta;
+				frame.use_table = transposition_table && frame.depth >= TranspositionTable::MIN_DEPTH;
+
+				if (frame.use_table)
+				{
+					frame.hash = TranspositionTable::ComputeHash(frame.position.player, frame.position.opponent, frame.is_max);
+					transposition_table->Prefetch(frame.hash);
+					frame.state = FrameState::Probe;
+					return false;
+				}
+
+				frame.state = FrameState::Next;
+				break;
+			}
+
+			case FrameState::Probe:
+			{
+				TranspositionEntry entry;
+				frame.state = FrameState::Next;
+
+				if (transposition_table->Probe(frame.hash, entry) && entry.move != TranspositionTable::NO_MOVE)
+				{
+					frame.first = SquareBit<u64>(entry.move) & frame.rest;
+
+					if (entry.depth == frame.depth && TranspositionTable::IsCutoff(entry, frame.alpha, frame.beta, false))
+					{
+						//この段では記録しない
+						frame.use_table = false;
+						if (Return(slot, { entry.score, frame.first }, result))
+							return true;
+					}
+				}
+
+				break;
+			}
+
+			case FrameState::Next:
+			{
+				if (frame.rest == 0ull)
+				{
+					if (Return(slot, frame.best, result))
+						return true;
+
+					break;
+				}
+
+				//記録した最善手の後は、着手可能位置を下位ビットから順に取り出す
+				u64 input = frame.first != 0ull ? frame.first : LowestBit(frame.rest);
+				frame.rest &= ~input;
+				frame.first = 0ull;
+				frame.input = input;
+
+				//積むとframeが指す先が変わることがあるので、先に値を取り出す
+				Position child = frame.position.Play(input, frame.position.GetFlips(input));
+				PushFrame(slot, child, input, frame.depth - 1, frame.alpha, frame.beta, !frame.is_max);
+				break;
+			}
+			}
+		}
+	}
+
+	bool InterleavedSearch::Return(Slot& slot, const SearchResult& result, SearchResult& root_result)
+	{
+		SearchResult value = result;
+
+		while (true)
+		{
+			//置換表を引いたノードは探索結果を記録する
+			const Frame& frame = slot.frames.back();
+			if (frame.use_table)
+				transposition_table->Store(frame.hash, value.Score, frame.depth, frame.original_alpha, frame.original_beta, value.Point != 0ull ? CountTrailingZeros(value.Point) : TranspositionTable::NO_MOVE, false);
+
+			slot.frames.pop_back();
+
+			if (slot.frames.empty())
+			{
+				root_result = value;
+				return true;
+			}
+
+			Frame& parent = slot.frames.back();
+			int score = value.Score;
+
+			if (parent.is_max)
+			{
+				//βカット
+				if (parent.beta <= score)
+				{
+					value = { score, parent.input };
+					continue;
+				}
+
+				if (score > parent.best.Score)
+				{
+					parent.best = { score, parent.input };
+					parent.alpha = score;
+				}
+			}
+			else
+			{
+				//αカット
+				if (parent.alpha >= score)
+				{
+					value = { score, parent.input };
+					continue;
+				}
+
+				if (score < parent.best.Score)
+				{
+					parent.best = { score, parent.input };
+					parent.beta = score;
+				}
+			}
+
+			return false;
+		}
+	}
+}
@@ -0,0 +1,343 @@
+#include "../include/KernelBenchmark.h"
+#include "../include/CpuFeatures.h"
+#include "../include/GameRecordReader.h"
+#include "../include/SearchSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+namespace Reversi
+{
+	namespace
+	{
+		//計測した処理の結果を捨てずに残し、最適化で処理が消えないようにする
+		volatile u64 sink;
+	}
+
+	KernelBenchmark::KernelBenchmark(const int position_count, const int repetition_count) :
+		position_count(std::max(position_count, 1)),
+		repetition_count(std::max(repetition_count, 3))
+	{
+
+	}
+
+	void KernelBenchmark::AddSample(const Board& board, const Side side)
+	{
+		Position position = board.GetPosition(side);
+		u64 legal_moves = position.GetLegalMoves();
+		if (legal_moves == 0ull)
+			return;
+
+		Sample sample = {};
+		sample.board = board;
+		sample.side = side;
+		sample.position = position;
+
+		//手は局面ごとに変えて分岐予測に偏りが出ないようにする
+		for (int skip = (int)(samples.size() % PopCount(legal_moves)); skip > 0; --skip)
+		{
+			legal_moves = ResetLowestBit(legal_moves);
+		}
+		sample.move = LowestBit(legal_moves);
+
+		//石のある角が無ければa1から数える(何も繋がらない)
+		u64 all = position.player | position.opponent;
+		u64 corners = all & 0x8100000000000081ull;
+		sample.corner = corners != 0ull ? LowestBit(corners) : 1ull;
+		sample.obstacle = (position.player & sample.corner) != 0ull ? position.opponent : position.player;
+
+		//評価側が手番の時と同じ向き
+		sample.field = { position.opponent, position.player };
+		sample.counts = { PopCount(sample.field.first), PopCount(sample.field.second) };
+		sample.legal_counts = {
+			PopCount(Position::ComputeLegalMoves(sample.field.first, sample.field.second)),
+			PopCount(Position::ComputeLegalMoves(sample.field.second, sample.field.first)) };
+		sample.stage_weights = &evaluator.weights->Get(EvaluationWeights::GetStage(sample.counts.first + sample.counts.second));
+
+		samples.push_back(sample);
+	}
+
+	void KernelBenchmark::LoadCorpus(const std::string& record_path)
+	{
+		samples.clear();
+
+		//実際の対局の局面を、序盤から終盤まで打った順に集める
+		GameRecordReader reader;
+		if (reader.Open(record_path))
+		{
+			for (size_t game = 0; game < reader.GetCount() && (int)samples.size() < position_count; ++game)
+			{
+				Board board;
+				Side side = Side::Black;
+
+				for (unsigned char square : reader.GetSquares(game))
+				{
+					if ((int)samples.size() >= position_count)
+						break;
+
+					AddSample(board, side);
+
+					if (square != GameRecord::PASS_SQUARE)
+					{
+						u64 input = 1ull << (square & 63);
+						board.Set(input, side);
+						board.Flip(input, side);
+					}
+					side = GetOpponentSide(side);
+				}
+			}
+		}
+
+		size_t recorded_count = samples.size();
+
+		//足りなければ浅い探索の自己対局で補う(序盤だけはランダムに打つ)
+		constexpr int alpha = std::numeric_limits<int>::min();
+		constexpr int beta = std::numeric_limits<int>::max();
+		std::mt19937 rand_module(42);
+		SearchSystem search_system;
+
+		while ((int)samples.size() < position_count)
+		{
+			Board board;
+			Side side = Side::Black;
+
+			for (int ply = 0; (int)samples.size() < position_count; ++ply)
+			{
+				u64 legal_moves = board.GetLegalMoves(side);
+				if (legal_moves == 0ull)
+				{
+					if (board.GetLegalMoves(GetOpponentSide(side)) == 0ull)
+						break;
+
+					side = GetOpponentSide(side);
+					continue;
+				}
+
+				AddSample(board, side);
+
+				u64 input;
+				if (ply < 8)
+				{
+					for (int skip = (int)(rand_module() % PopCount(legal_moves)); skip > 0; --skip)
+					{
+						legal_moves = ResetLowestBit(legal_moves);
+					}
+					input = LowestBit(legal_moves);
+				}
+				else
+				{
+					input = search_system.AlphaBetaSearch(board.GetPosition(side), 0, 2, alpha, beta, true).Point;
+				}
+
+				board.Set(input, side);
+				board.Flip(input, side);
+				side = GetOpponentSide(side);
+			}
+		}
+
+		corpus_source = recorded_count == samples.size() ? "records" : (recorded_count == 0 ? "self-play" : "records+self-play");
+	}
+
+	u64 KernelBenchmark::ReadTimestampCounter()
+	{
+#ifdef REVERSI_X86
+		return __rdtsc();
+#else
+		return 0;
+#endif
+	}
+
+	template <typename Kernel>
+	void KernelBenchmark::Measure(const std::string& name, Kernel kernel)
+	{
+		u64 checksum = 0;
+
+		//予熱でキャッシュと分岐予測を整える
+		for (int i = 0; i < WARMUP_COUNT; ++i)
+		{
+			for (const Sample& sample : samples)
+			{
+				checksum += kernel(sample);
+			}
+		}
+		sink = checksum;
+
+		std::vector<double> nanoseconds;
+		double total_nanoseconds = 0.0;
+		u64 total_cycles = 0;
+
+		for (int i = 0; i < repetition_count; ++i)
+		{
+			checksum = 0;
+			u64 cycles = ReadTimestampCounter();
+			auto start = std::chrono::steady_clock::now();
+
+			for (const Sample& sample : samples)
+			{
+				checksum += kernel(sample);
+			}
+
+			double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+			total_cycles += ReadTimestampCounter() - cycles;
+			total_nanoseconds += elapsed;
+			nanoseconds.push_back(elapsed / (double)samples.size());
+			sink = checksum;
+		}
+
+		results.push_back(Summarize(name, nanoseconds, (double)total_cycles / std::max(total_nanoseconds, 1.0), checksum));
+	}
+
+	KernelBenchmark::Result KernelBenchmark::Summarize(const std::string& name, std::vector<double> nanoseconds, const double cycles_per_nanosecond, const u64 checksum)
+	{
+		auto median_of = [](std::vector<double> values)
+			{
+				std::sort(values.begin(), values.end());
+				size_t half = values.size() / 2;
+				return values.size() % 2 == 1 ? values[half] : (values[half - 1] + values[half]) / 2.0;
+			};
+
+		//割り込みや周波数の変化で遅れた標本を除く(絶対偏差の中央値は正規分布の標準偏差に換算する)
+		double median = median_of(nanoseconds);
+		std::vector<double> deviations;
+		for (double value : nanoseconds)
+		{
+			deviations.push_back(std::abs(value - median));
+		}
+		double limit = OUTLIER_THRESHOLD * 1.4826 * median_of(deviations);
+
+		std::vector<double> kept;
+		for (double value : nanoseconds)
+		{
+			if (std::abs(value - median) <= limit)
+				kept.push_back(value);
+		}
+
+		double mean = 0.0;
+		for (double value : kept)
+		{
+			mean += value;
+		}
+		mean /= (double)kept.size();
+
+		double variance = 0.0;
+		for (double value : kept)
+		{
+			variance += (value - mean) * (value - mean);
+		}
+
+		double kept_median = median_of(kept);
+		return {
+			name, kept_median, mean, std::sqrt(variance / (double)kept.size()), *std::min_element(kept.begin(), kept.end()),
+			kept_median * cycles_per_nanosecond, (int)kept.size(), checksum };
+	}
+
+	void KernelBenchmark::Run()
+	{
+		results.clear();
+
+		Measure("board.get_legal_moves", [](const Sample& sample) { return sample.board.GetLegalMoves(sample.side); });
+		Measure("board.count_legal_moves", [](const Sample& sample)
+			{
+				std::pair<int, int> counts = sample.board.CountLegalMoves();
+				return (u64)(counts.first * 64 + counts.second);
+			});
+		Measure("board.flip", [](const Sample& sample)
+			{
+				Board board = sample.board;
+				board.Set(sample.move, sample.side);
+				return board.Flip(sample.move, sample.side);
+			});
+
+		//反転位置の計算方法ごと(同じ局面と手なのでチェックサムが一致する)
+		Measure("position.flip_shift", [](const Sample& sample)
+			{
+				return Position::ComputeFlipsWith<FlipKernel::Shift>(sample.move, sample.position.player, sample.position.opponent);
+			});
+		Measure("position.flip_lookup", [](const Sample& sample)
+			{
+				return Position::ComputeFlipsWith<FlipKernel::Lookup>(sample.move, sample.position.player, sample.position.opponent);
+			});
+		if (IsAvx2Supported())
+		{
+			Measure("position.flip_simd", [](const Sample& sample)
+				{
+					return Position::ComputeFlipsWith<FlipKernel::Simd>(sample.move, sample.position.player, sample.position.opponent);
+				});
+		}
+
+		Measure("board.get_cross_floods", [](const Sample& sample) { return sample.board.GetCrossFloods(sample.corner, sample.obstacle); });
+
+		Measure("evaluator.evaluate", [this](const Sample& sample) { return (u64)evaluator.Evaluate<true>(sample.position); });
+		Measure("evaluator.weight", [this](const Sample& sample) { return (u64)evaluator.EvaluateWeight(sample.field, *sample.stage_weights); });
+		Measure("evaluator.confirm", [this](const Sample& sample) { return (u64)evaluator.EvaluateConfirm(sample.field); });
+		Measure("evaluator.mobility", [](const Sample& sample)
+			{
+				return (u64)(PopCount(Position::ComputeLegalMoves(sample.field.first, sample.field.second)) * 64 +
+					PopCount(Position::ComputeLegalMoves(sample.field.second, sample.field.first)));
+			});
+		Measure("evaluator.game_end", [](const Sample& sample)
+			{
+				return (u64)Evaluator::EvaluateGameEnd(sample.counts, sample.legal_counts.first, sample.legal_counts.second);
+			});
+
+		std::wstring str = std::format(L"[Benchmark] Kernels {} positions ({}), {} samples\n", samples.size(), std::wstring(corpus_source.begin(), corpus_source.end()), repetition_count);
+		str += L"kernel: ns/op (median) mean +- stddev, min, cycles/op (TSC), kept\n";
+
+		for (const Result& result : results)
+		{
+			str += std::format(L"{}: {:.3f} {:.3f} +- {:.3f}, {:.3f}, {:.2f}, {}/{}\n", std::wstring(result.name.begin(), result.name.end()),
+				result.median, result.mean, result.deviation, result.minimum, result.cycles, result.kept_count, repetition_count);
+		}
+
+		//反転位置の計算方法はどれも同じ結果になる
+		bool is_flip_consistent = true;
+		const Result* shift_result = nullptr;
+		for (const Result& result : results)
+		{
+			if (!result.name.starts_with("position.flip_"))
+				continue;
+
+			if (shift_result == nullptr)
+				shift_result = &result;
+			else if (result.checksum != shift_result->checksum)
+				is_flip_consistent = false;
+		}
+		str += std::format(L"Flip kernels agree: {}\n", is_flip_consistent ? L"yes" : L"NO");
+
+		std::wcout << str << std::endl;
+	}
+
+	bool KernelBenchmark::WriteJson(const std::string& path) const
+	{
+		std::ofstream stream(path, std::ios::trunc);
+		if (!stream)
+			return false;
+
+		//キーの順は固定し、1つの処理を1行に書いて差分を見やすくする
+		stream << "{\n";
+		stream << std::format("  \"corpus\": {{\"source\": \"{}\", \"positions\": {}}},\n", corpus_source, samples.size());
+		stream << std::format("  \"samples\": {},\n  \"warmup\": {},\n  \"outlier_threshold\": {},\n", repetition_count, WARMUP_COUNT, OUTLIER_THRESHOLD);
+		SimdLevel level = GetSupportedSimdLevel();
+		const char* simd = level == SimdLevel::Avx512 ? "avx512" : (level == SimdLevel::Avx2 ? "avx2" : "scalar");
+		stream << std::format("  \"simd\": \"{}\",\n  \"tsc\": {},\n", simd, ReadTimestampCounter() != 0 ? "true" : "false");
+		stream << "  \"kernels\": [\n";
+
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const Result& result = results[i];
+			double ops_per_cycle = result.cycles > 0.0 ? 1.0 / result.cycles : 0.0;
+
+			stream << std::format("    {{\"name\": \"{}\", \"ns_per_op\": {:.4f}, \"mean\": {:.4f}, \"stddev\": {:.4f}, \"min\": {:.4f}, "
+				"\"cycles_per_op\": {:.3f}, \"ops_per_cycle\": {:.4f}, \"kept\": {}, \"checksum\": {}}}{}\n",
+				result.name, result.median, result.mean, result.deviation, result.minimum,
+				result.cycles, ops_per_cycle, result.kept_count, result.checksum, i + 1 < results.size() ? "," : "");
+		}
+
+		stream << "  ]\n}\n";
+		return static_cast<bool>(stream);
+	}
+}
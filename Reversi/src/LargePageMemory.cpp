@@ -0,0 +1,290 @@
+#include "../include/LargePageMemory.h"
+#include "../include/CpuTopology.h"
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Reversi
+{
+	namespace
+	{
+		//物理メモリを割り当てるために書き込む間隔(通常のページの大きさ)
+		constexpr size_t TOUCH_STRIDE = 4096;
+
+#ifdef _WIN32
+		//ラージページはロックされたメモリなので、プロセスのトークンで権限を有効にできた時だけ使える
+		bool EnableLockMemoryPrivilege()
+		{
+			HANDLE token = nullptr;
+			if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+				return false;
+
+			TOKEN_PRIVILEGES privileges = {};
+			privileges.PrivilegeCount = 1;
+			privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+			//権限を持っていなくてもAdjustTokenPrivilegesは成功するので、GetLastErrorで確かめる
+			bool is_enabled = LookupPrivilegeValueA(nullptr, "SeLockMemoryPrivilege", &privileges.Privileges[0].Luid) &&
+				AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+				GetLastError() == ERROR_SUCCESS;
+
+			CloseHandle(token);
+			return is_enabled;
+		}
+#else
+		//linux/mempolicy.hのMPOL_INTERLEAVE(libnumaを使わずにmbindを呼ぶ)
+		constexpr int MEMORY_POLICY_INTERLEAVE = 3;
+#endif
+	}
+
+	LargePageMemory::LargePageMemory() : data(nullptr), size(0), huge_page_mode(HugePageMode::Off), is_interleaved(false), mapped_size(0)
+	{
+
+	}
+
+	LargePageMemory::~LargePageMemory()
+	{
+		Free();
+	}
+
+	bool LargePageMemory::Allocate(const size_t new_size, const HugePageMode huge_pages, const NodeMemoryPolicy node_memory, const std::vector<int>& touch_cpus)
+	{
+		Free();
+		if (new_size == 0)
+			return false;
+
+		//ヒュージページの境界に揃える(区間ごとに書き込む時も1つのヒュージページを分けない)
+		size_t aligned_size = (new_size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+		const std::vector<int>& node_ids = CpuTopology::Get().GetMemoryNodeIds();
+		HugePageMode mode = huge_pages;
+		bool interleaved = false;
+
+#ifdef _WIN32
+		void* address = nullptr;
+
+		if (mode == HugePageMode::Explicit)
+		{
+			size_t large_page_size = GetLargePageMinimum();
+			if (large_page_size != 0 && EnableLockMemoryPrivilege())
+			{
+				aligned_size = (aligned_size + large_page_size - 1) / large_page_size * large_page_size;
+				address = VirtualAlloc(nullptr, aligned_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			}
+		}
+
+		//Windowsには透過的なヒュージページが無いので、ラージページでなければ通常のページになる
+		if (address == nullptr)
+		{
+			mode = HugePageMode::Off;
+
+			//予約した領域を区間ごとに別のノードを指定して確定する
+			if (node_memory == NodeMemoryPolicy::Interleave && node_ids.size() > 1)
+			{
+				address = VirtualAlloc(nullptr, aligned_size, MEM_RESERVE, PAGE_READWRITE);
+				interleaved = address != nullptr;
+
+				for (size_t offset = 0; interleaved && offset < aligned_size; offset += HUGE_PAGE_SIZE)
+				{
+					DWORD node = (DWORD)node_ids[(offset / HUGE_PAGE_SIZE) % node_ids.size()];
+					interleaved = VirtualAllocExNuma(GetCurrentProcess(), static_cast<unsigned char*>(address) + offset, HUGE_PAGE_SIZE, MEM_COMMIT, PAGE_READWRITE, node) != nullptr;
+				}
+
+				if (address != nullptr && !interleaved)
+				{
+					VirtualFree(address, 0, MEM_RELEASE);
+					address = nullptr;
+				}
+			}
+
+			if (address == nullptr)
+				address = VirtualAlloc(nullptr, aligned_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			if (address == nullptr)
+				return false;
+		}
+#else
+		void* address = MAP_FAILED;
+
+		//予約されたヒュージページが足りなければ透過的なヒュージページにする
+		if (mode == HugePageMode::Explicit)
+		{
+			address = mmap(nullptr, aligned_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if (address == MAP_FAILED)
+				mode = HugePageMode::Transparent;
+		}
+
+		if (address == MAP_FAILED)
+		{
+			//境界に揃えるため余分に取り、前後を返す
+			size_t reserved_size = aligned_size + HUGE_PAGE_SIZE;
+			void* reserved = mmap(nullptr, reserved_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (reserved == MAP_FAILED)
+				return false;
+
+			uintptr_t start = ((uintptr_t)reserved + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1);
+			size_t head = start - (uintptr_t)reserved;
+			size_t tail = reserved_size - head - aligned_size;
+			if (head != 0)
+				munmap(reserved, head);
+			if (tail != 0)
+				munmap(reinterpret_cast<void*>(start + aligned_size), tail);
+
+			address = reinterpret_cast<void*>(start);
+
+			//Offならシステムの設定に任せる(alwaysなら要求しなくても使われる)
+			if (mode == HugePageMode::Transparent)
+				madvise(address, aligned_size, MADV_HUGEPAGE);
+		}
+
+		//ページを割り当てる前に方針を決めておく
+		if (node_memory == NodeMemoryPolicy::Interleave && node_ids.size() > 1)
+		{
+			constexpr int bits = (int)sizeof(unsigned long) * 8;
+			int max_node = *std::max_element(node_ids.begin(), node_ids.end());
+			std::vector<unsigned long> mask(max_node / bits + 1, 0ul);
+			for (int id : node_ids)
+			{
+				mask[id / bits] |= 1ul << (id % bits);
+			}
+
+			//カーネルはmaxnode - 1ビットまで読む
+			interleaved = syscall(SYS_mbind, address, aligned_size, MEMORY_POLICY_INTERLEAVE, mask.data(), (unsigned long)max_node + 2, 0u) == 0;
+		}
+#endif
+
+		data = static_cast<unsigned char*>(address);
+		size = new_size;
+		mapped_size = aligned_size;
+		huge_page_mode = mode;
+		is_interleaved = interleaved;
+
+		Touch(node_memory == NodeMemoryPolicy::FirstTouch ? touch_cpus : std::vector<int>());
+		return true;
+	}
+
+	void LargePageMemory::Touch(const std::vector<int>& cpus)
+	{
+		//0を書くので内容は変わらない
+		auto touch = [this](const size_t first, const size_t last)
+			{
+				volatile unsigned char* bytes = data;
+				for (size_t offset = first; offset < last; offset += TOUCH_STRIDE)
+				{
+					bytes[offset] = 0;
+				}
+			};
+
+		if (cpus.empty())
+		{
+			touch(0, mapped_size);
+			return;
+		}
+
+		//ヒュージページ単位の区間に分け、探索スレッドと同じ論理コアで書き込む
+		size_t chunk_count = mapped_size / HUGE_PAGE_SIZE;
+		std::vector<std::thread> threads;
+
+		for (size_t i = 0; i < cpus.size(); ++i)
+		{
+			size_t first = chunk_count * i / cpus.size() * HUGE_PAGE_SIZE;
+			size_t last = chunk_count * (i + 1) / cpus.size() * HUGE_PAGE_SIZE;
+			threads.emplace_back([&touch, cpu = cpus[i], first, last]()
+				{
+					CpuTopology::PinCurrentThread(cpu);
+					touch(first, last);
+				});
+		}
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	void LargePageMemory::Free()
+	{
+		if (data == nullptr)
+			return;
+
+#ifdef _WIN32
+		VirtualFree(data, 0, MEM_RELEASE);
+#else
+		munmap(data, mapped_size);
+#endif
+
+		data = nullptr;
+		size = 0;
+		mapped_size = 0;
+		huge_page_mode = HugePageMode::Off;
+		is_interleaved = false;
+	}
+
+	unsigned char* LargePageMemory::GetData() const
+	{
+		return data;
+	}
+
+	size_t LargePageMemory::GetSize() const
+	{
+		return size;
+	}
+
+	HugePageMode LargePageMemory::GetHugePageMode() const
+	{
+		return huge_page_mode;
+	}
+
+	bool LargePageMemory::IsInterleaved() const
+	{
+		return is_interleaved;
+	}
+
+	size_t LargePageMemory::GetHugePageBytes() const
+	{
+		if (data == nullptr)
+			return 0;
+
+		if (huge_page_mode == HugePageMode::Explicit)
+			return mapped_size;
+
+#ifdef _WIN32
+		return 0;
+#else
+		//ノードの指定などで分かれた領域ごとに、透過的なヒュージページの大きさを合計する
+		uintptr_t begin = (uintptr_t)data;
+		uintptr_t end = begin + mapped_size;
+		std::ifstream stream("/proc/self/smaps");
+		std::string line;
+		bool is_inside = false;
+		size_t bytes = 0;
+
+		while (std::getline(stream, line))
+		{
+			//領域の行は"開始-終了 権限 ..."、項目の行は"名前: 値 kB"
+			size_t space = line.find(' ');
+			size_t dash = line.find('-');
+			if (space != std::string::npos && dash < space && line.find(':') > space)
+			{
+				uintptr_t start = (uintptr_t)std::stoull(line.substr(0, dash), nullptr, 16);
+				uintptr_t stop = (uintptr_t)std::stoull(line.substr(dash + 1, space - dash - 1), nullptr, 16);
+				is_inside = start < end && stop > begin;
+			}
+			else if (is_inside && line.starts_with("AnonHugePages:"))
+			{
+				bytes += (size_t)std::stoull(line.substr(14)) * 1024;
+			}
+		}
+
+		return bytes;
+#endif
+	}
+}
@@ -0,0 +1,123 @@
+#include "../include/LatencyHistogram.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace Reversi
+{
+	LatencyHistogram::LatencyHistogram()
+	{
+		Reset();
+	}
+
+	int LatencyHistogram::GetIndex(const u64 value)
+	{
+		//有効ビット数に収まる値はそのまま区間の番号にする
+		if (value < (1ull << PRECISION_BITS))
+			return (int)value;
+
+		//最上位ビットから有効ビット数だけ残し、落としたビット数で範囲を決める
+		int shift = std::bit_width(value) - PRECISION_BITS;
+		return shift * SUB_BUCKET_COUNT + (int)(value >> shift);
+	}
+
+	u64 LatencyHistogram::GetLowerBound(const int index)
+	{
+		if (index < (1 << PRECISION_BITS))
+			return (u64)index;
+
+		int shift = index / SUB_BUCKET_COUNT - 1;
+		return (u64)(index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT) << shift;
+	}
+
+	u64 LatencyHistogram::GetUpperBound(const int index)
+	{
+		if (index < (1 << PRECISION_BITS))
+			return (u64)index;
+
+		int shift = index / SUB_BUCKET_COUNT - 1;
+		return GetLowerBound(index) + ((1ull << shift) - 1);
+	}
+
+	void LatencyHistogram::Record(const u64 value)
+	{
+		counts[GetIndex(value)].fetch_add(1, std::memory_order_relaxed);
+		sum.fetch_add(value, std::memory_order_relaxed);
+
+		//最小値と最大値は更新する時だけ書き込む
+		u64 current = minimum.load(std::memory_order_relaxed);
+		while (value < current && !minimum.compare_exchange_weak(current, value, std::memory_order_relaxed))
+		{
+		}
+
+		current = maximum.load(std::memory_order_relaxed);
+		while (value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	void LatencyHistogram::Reset()
+	{
+		for (std::atomic<u64>& count : counts)
+		{
+			count.store(0, std::memory_order_relaxed);
+		}
+		sum.store(0, std::memory_order_relaxed);
+		minimum.store(std::numeric_limits<u64>::max(), std::memory_order_relaxed);
+		maximum.store(0, std::memory_order_relaxed);
+	}
+
+	LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const
+	{
+		Snapshot snapshot = { std::vector<u64>(BUCKET_COUNT), 0, 0, 0, 0 };
+
+		//総数は区間の数の合計にして、区間と食い違わないようにする
+		for (int i = 0; i < BUCKET_COUNT; ++i)
+		{
+			snapshot.counts[i] = counts[i].load(std::memory_order_relaxed);
+			snapshot.count += snapshot.counts[i];
+		}
+
+		snapshot.sum = sum.load(std::memory_order_relaxed);
+		snapshot.maximum = maximum.load(std::memory_order_relaxed);
+		snapshot.minimum = snapshot.count != 0 ? minimum.load(std::memory_order_relaxed) : 0;
+		return snapshot;
+	}
+
+	double LatencyHistogram::Snapshot::GetMean() const
+	{
+		return count != 0 ? (double)sum / (double)count : 0.0;
+	}
+
+	u64 LatencyHistogram::Snapshot::GetPercentile(const double ratio) const
+	{
+		if (count == 0)
+			return 0;
+
+		u64 rank = std::max((u64)std::ceil(ratio * (double)count), (u64)1);
+		u64 cumulative = 0;
+
+		for (int i = 0; i < BUCKET_COUNT; ++i)
+		{
+			cumulative += counts[i];
+			if (cumulative >= rank)
+				return std::min(GetUpperBound(i), maximum);
+		}
+
+		return maximum;
+	}
+
+	u64 LatencyHistogram::Snapshot::CountAtOrBelow(const u64 value) const
+	{
+		int last = GetIndex(value);
+		u64 cumulative = 0;
+
+		for (int i = 0; i <= last; ++i)
+		{
+			cumulative += counts[i];
+		}
+
+		return cumulative;
+	}
+}
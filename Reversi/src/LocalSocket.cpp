@@ -0,0 +1,253 @@
+#include "../include/LocalSocket.h"
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <afunix.h>
+#include <cstdio>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace Reversi
+{
+	namespace
+	{
+		//INVALID_SOCKETも-1と同じビット列になる
+		constexpr std::intptr_t INVALID_DESCRIPTOR = -1;
+
+#ifdef _WIN32
+		using NativeSocket = SOCKET;
+
+		//Winsockは使う前に一度だけ初期化する
+		bool InitializeSockets()
+		{
+			static const bool is_initialized = []()
+				{
+					WSADATA data;
+					return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+				}();
+			return is_initialized;
+		}
+
+		void CloseDescriptor(const std::intptr_t descriptor)
+		{
+			closesocket((NativeSocket)descriptor);
+		}
+
+		void RemoveFile(const std::string& path)
+		{
+			std::remove(path.c_str());
+		}
+#else
+		using NativeSocket = int;
+
+		bool InitializeSockets()
+		{
+			return true;
+		}
+
+		void CloseDescriptor(const std::intptr_t descriptor)
+		{
+			close((NativeSocket)descriptor);
+		}
+
+		void RemoveFile(const std::string& path)
+		{
+			unlink(path.c_str());
+		}
+#endif
+
+		//パスが長すぎればfalse
+		bool MakeAddress(const std::string& path, sockaddr_un& address)
+		{
+			std::memset(&address, 0, sizeof(address));
+			address.sun_family = AF_UNIX;
+
+			if (path.size() >= sizeof(address.sun_path))
+				return false;
+
+			std::memcpy(address.sun_path, path.c_str(), path.size());
+			return true;
+		}
+	}
+
+	LocalSocket::LocalSocket() : descriptor(INVALID_DESCRIPTOR)
+	{
+
+	}
+
+	LocalSocket::~LocalSocket()
+	{
+		Close();
+	}
+
+	LocalSocket::LocalSocket(LocalSocket&& other) noexcept :
+		descriptor(other.descriptor),
+		buffer(std::move(other.buffer)),
+		listen_path(std::move(other.listen_path))
+	{
+		other.descriptor = INVALID_DESCRIPTOR;
+		other.listen_path.clear();
+	}
+
+	LocalSocket& LocalSocket::operator=(LocalSocket&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+			descriptor = other.descriptor;
+			buffer = std::move(other.buffer);
+			listen_path = std::move(other.listen_path);
+			other.descriptor = INVALID_DESCRIPTOR;
+			other.listen_path.clear();
+		}
+
+		return *this;
+	}
+
+	bool LocalSocket::Listen(const std::string& path)
+	{
+		Close();
+
+		sockaddr_un address;
+		if (!InitializeSockets() || !MakeAddress(path, address))
+			return false;
+
+		descriptor = (std::intptr_t)socket(AF_UNIX, SOCK_STREAM, 0);
+		if (descriptor == INVALID_DESCRIPTOR)
+			return false;
+
+		//前回落ちた時のソケットファイルが残っているとbindできない
+		RemoveFile(path);
+
+		if (bind((NativeSocket)descriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+			listen((NativeSocket)descriptor, SOMAXCONN) != 0)
+		{
+			Close();
+			return false;
+		}
+
+		listen_path = path;
+		return true;
+	}
+
+	LocalSocket LocalSocket::Accept() const
+	{
+		LocalSocket client;
+		if (descriptor == INVALID_DESCRIPTOR)
+			return client;
+
+		client.descriptor = (std::intptr_t)accept((NativeSocket)descriptor, nullptr, nullptr);
+		return client;
+	}
+
+	bool LocalSocket::Connect(const std::string& path)
+	{
+		Close();
+
+		sockaddr_un address;
+		if (!InitializeSockets() || !MakeAddress(path, address))
+			return false;
+
+		descriptor = (std::intptr_t)socket(AF_UNIX, SOCK_STREAM, 0);
+		if (descriptor == INVALID_DESCRIPTOR)
+			return false;
+
+		if (connect((NativeSocket)descriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool LocalSocket::ReadLine(std::string& line)
+	{
+		while (true)
+		{
+			size_t end = buffer.find('\n');
+			if (end != std::string::npos)
+			{
+				line.assign(buffer, 0, end);
+				buffer.erase(0, end + 1);
+
+				//Windowsのクライアントが送る改行にも合わせる
+				if (!line.empty() && line.back() == '\r')
+					line.pop_back();
+
+				return true;
+			}
+
+			if (descriptor == INVALID_DESCRIPTOR)
+				return false;
+
+			char chunk[4096];
+			int count = (int)recv((NativeSocket)descriptor, chunk, (int)sizeof(chunk), 0);
+			if (count <= 0)
+				return false;
+
+			buffer.append(chunk, (size_t)count);
+		}
+	}
+
+	bool LocalSocket::WriteLine(const std::string& line)
+	{
+		if (descriptor == INVALID_DESCRIPTOR)
+			return false;
+
+		std::string data = line + "\n";
+		size_t sent = 0;
+
+		while (sent < data.size())
+		{
+#if defined(MSG_NOSIGNAL)
+			//相手が閉じていてもSIGPIPEで落ちないようにする
+			int count = (int)send((NativeSocket)descriptor, data.data() + sent, (int)(data.size() - sent), MSG_NOSIGNAL);
+#else
+			int count = (int)send((NativeSocket)descriptor, data.data() + sent, (int)(data.size() - sent), 0);
+#endif
+			if (count <= 0)
+				return false;
+
+			sent += (size_t)count;
+		}
+
+		return true;
+	}
+
+	void LocalSocket::Shutdown()
+	{
+		if (descriptor == INVALID_DESCRIPTOR)
+			return;
+
+#ifdef _WIN32
+		shutdown((NativeSocket)descriptor, SD_BOTH);
+#else
+		shutdown((NativeSocket)descriptor, SHUT_RDWR);
+#endif
+	}
+
+	void LocalSocket::Close()
+	{
+		if (descriptor != INVALID_DESCRIPTOR)
+			CloseDescriptor(descriptor);
+
+		if (!listen_path.empty())
+			RemoveFile(listen_path);
+
+		descriptor = INVALID_DESCRIPTOR;
+		buffer.clear();
+		listen_path.clear();
+	}
+
+	bool LocalSocket::IsOpen() const
+	{
+		return descriptor != INVALID_DESCRIPTOR;
+	}
+}
@@ -1,19 +1,440 @@
 #include <iostream>
 #include <thread>
+#include <string>
 #include "../include/Board.h"
 #include "../include/BoardWriter.h"
 #include "../include/InputReader.h"
 #include "../include/ReversiEngine.h"
 #include "../include/GameSequencer.h"
+#include "../include/ProbCutCalibrator.h"
+#include "../include/ReductionTuner.h"
+#include "../include/TrainingDataGenerator.h"
+#include "../include/EvaluationTuner.h"
+#include "../include/NeuralTrainer.h"
+#include "../include/ReversiBenchmark.h"
+#include "../include/PositionIndexBuilder.h"
+#include "../include/EngineService.h"
+#include "../include/ServiceLoadGenerator.h"
+#include "../include/KernelBenchmark.h"
 
 using namespace Reversi;
 
-int main()
+//コマンドライン引数で指定されたツールを実行する(argv[1]がツール名。スレッドとメモリの配置はサービスとベンチマークが使う)
+int RunTool(const int argc, char* argv[], const HardwarePolicy& policy)
 {
+	std::string tool = argv[1];
+
+	if (tool == "--calibrate-probcut")
+	{
+		//--calibrate-probcut [局面数] [最大深さ] [出力ファイル]
+		int position_count = argc > 2 ? std::stoi(argv[2]) : 600;
+		int max_depth = argc > 3 ? std::stoi(argv[3]) : 8;
+		std::string path = argc > 4 ? argv[4] : ReversiEngine::PROBCUT_FILE;
+
+		ProbCutTable table;
+		ProbCutCalibrator calibrator(position_count, max_depth);
+		calibrator.Run(table);
+
+		return table.Save(path) ? 0 : 1;
+	}
+
+	if (tool == "--tune-reductions")
+	{
+		//--tune-reductions [1候補あたりの対局数] [一手の思考時間(ミリ秒)] [出力ファイル]
+		int game_count = argc > 2 ? std::stoi(argv[2]) : 20;
+		int milliseconds = argc > 3 ? std::stoi(argv[3]) : 100;
+		std::string path = argc > 4 ? argv[4] : ReversiEngine::REDUCTION_FILE;
+
+		//今のファイルのパラメータから始める
+		ReductionTable table;
+		table.Load(path);
+		ReductionTuner tuner(game_count, milliseconds);
+		tuner.Run(table);
+
+		return table.Save(path) ? 0 : 1;
+	}
+
+	if (tool == "--collect-training")
+	{
+		//--collect-training [対局数] [探索深さ] [出力ファイル]
+		int game_count = argc > 2 ? std::stoi(argv[2]) : 1000;
+		int depth = argc > 3 ? std::stoi(argv[3]) : 4;
+		std::string path = argc > 4 ? argv[4] : "training.bin";
+
+		TrainingDataGenerator generator(game_count, depth);
+		return generator.Run(path) ? 0 : 1;
+	}
+
+	if (tool == "--tune-eval")
+	{
+		//--tune-eval [教師局面ファイル] [出力ファイル]
+		std::string dataset_path = argc > 2 ? argv[2] : "training.bin";
+		std::string output_path = argc > 3 ? argv[3] : ReversiEngine::EVALUATION_FILE;
+
+		EvaluationTuner tuner;
+		return tuner.Run(dataset_path, output_path) ? 0 : 1;
+	}
+
+	if (tool == "--train-nnue")
+	{
+		//--train-nnue [教師局面ファイル] [出力ファイル] [周回数]
+		std::string dataset_path = argc > 2 ? argv[2] : "training.bin";
+		std::string output_path = argc > 3 ? argv[3] : ReversiEngine::NEURAL_NETWORK_FILE;
+		int epochs = argc > 4 ? std::stoi(argv[4]) : 10;
+
+		NeuralTrainer trainer(epochs);
+		return trainer.Run(dataset_path, output_path) ? 0 : 1;
+	}
+
+	if (tool == "--bench-eval")
+	{
+		//--bench-eval [対局数] [探索深さ] [ネットワークファイル]
+		int game_count = argc > 2 ? std::stoi(argv[2]) : 20;
+		int depth = argc > 3 ? std::stoi(argv[3]) : 4;
+		std::string path = argc > 4 ? argv[4] : ReversiEngine::NEURAL_NETWORK_FILE;
+
+		std::shared_ptr<NeuralNetwork> network = std::make_shared<NeuralNetwork>();
+		network->Load(path);
+		ReversiBenchmark::CompareEvaluators(game_count, depth, network);
+		return 0;
+	}
+
+	if (tool == "--bench-mcts")
+	{
+		//--bench-mcts [対局数] [一手の思考時間(ミリ秒)] [最大スレッド数]
+		int game_count = argc > 2 ? std::stoi(argv[2]) : 20;
+		int milliseconds = argc > 3 ? std::stoi(argv[3]) : 100;
+		int thread_count = argc > 4 ? std::stoi(argv[4]) : (int)std::max(1u, std::thread::hardware_concurrency());
+
+		ReversiBenchmark::CompareMonteCarlo(game_count, milliseconds, thread_count);
+		return 0;
+	}
+
+	if (tool == "--bench-lmr")
+	{
+		//--bench-lmr [対局数] [一手の思考時間(ミリ秒)]
+		int game_count = argc > 2 ? std::stoi(argv[2]) : 20;
+		int milliseconds = argc > 3 ? std::stoi(argv[3]) : 100;
+
+		ReversiBenchmark::CompareReductions(game_count, milliseconds);
+		return 0;
+	}
+
+	if (tool == "--bench-probcut")
+	{
+		//--bench-probcut [局面数] [一局面の思考時間(ミリ秒)]
+		int position_count = argc > 2 ? std::stoi(argv[2]) : 100;
+		int milliseconds = argc > 3 ? std::stoi(argv[3]) : 1000;
+
+		ReversiBenchmark::CompareProbCut(position_count, milliseconds);
+		return 0;
+	}
+
+	if (tool == "--bench-interleave")
+	{
+		//--bench-interleave [対局数] [探索深さ] [同時に進める探索の数] [置換表の大きさ(MB)]
+		int game_count = argc > 2 ? std::stoi(argv[2]) : 64;
+		int depth = argc > 3 ? std::stoi(argv[3]) : 6;
+		int slot_count = argc > 4 ? std::stoi(argv[4]) : 16;
+		int megabytes = argc > 5 ? std::stoi(argv[5]) : 1024;
+
+		return ReversiBenchmark::CompareInterleavedSearch(game_count, depth, slot_count, megabytes) ? 0 : 1;
+	}
+
+	if (tool == "--bench-cache")
+	{
+		//--bench-cache [局面数] [最大深さ] [保存するファイル] [置換表の大きさ(MB)]
+		int position_count = argc > 2 ? std::stoi(argv[2]) : 50;
+		int depth = argc > 3 ? std::stoi(argv[3]) : 8;
+		std::string path = argc > 4 ? argv[4] : "bench.rvsc";
+		int megabytes = argc > 5 ? std::stoi(argv[5]) : 64;
+
+		return ReversiBenchmark::CompareSearchCache(position_count, depth, path, megabytes) ? 0 : 1;
+	}
+
+	if (tool == "--bench-search")
+	{
+		//--bench-search [探索深さ] [局面数] [盤面の大きさ]
+		int depth = argc > 2 ? std::stoi(argv[2]) : 7;
+		int position_count = argc > 3 ? std::stoi(argv[3]) : 20;
+		int size = argc > 4 ? std::stoi(argv[4]) : DEFAULT_BOARD_SIZE;
+
+		ReversiBenchmark::RunSearchBenchmark(depth, position_count, size);
+		return 0;
+	}
+
+	if (tool == "--bench-kernels")
+	{
+		//--bench-kernels [棋譜ファイル] [局面数] [標本数] [出力するJSONファイル]
+		std::string record_path = argc > 2 ? argv[2] : GameSequencer::RECORD_FILE;
+		int position_count = argc > 3 ? std::stoi(argv[3]) : 10000;
+		int repetition_count = argc > 4 ? std::stoi(argv[4]) : 30;
+		std::string output_path = argc > 5 ? argv[5] : "kernels.json";
+
+		KernelBenchmark benchmark(position_count, repetition_count);
+		benchmark.LoadCorpus(record_path);
+		benchmark.Run();
+		return benchmark.WriteJson(output_path) ? 0 : 1;
+	}
+
+	if (tool == "--bench-perft")
+	{
+		//--bench-perft [深さ] [盤面の大きさ]
+		int depth = argc > 2 ? std::stoi(argv[2]) : 9;
+		int size = argc > 3 ? std::stoi(argv[3]) : DEFAULT_BOARD_SIZE;
+
+		ReversiBenchmark::RunPerft(depth, size);
+		return 0;
+	}
+
+	if (tool == "--bench-batch")
+	{
+		//--bench-batch [同時に打つ盤面の数] [繰り返す回数]
+		int board_count = argc > 2 ? std::stoi(argv[2]) : 4096;
+		int round_count = argc > 3 ? std::stoi(argv[3]) : 20;
+
+		return ReversiBenchmark::RunBatchBenchmark(board_count, round_count) ? 0 : 1;
+	}
+
+	if (tool == "--bench-records")
+	{
+		//--bench-records [対局数] [出力ファイル]
+		int game_count = argc > 2 ? std::stoi(argv[2]) : 100000;
+		std::string path = argc > 3 ? argv[3] : "bench.rvgr";
+
+		ReversiBenchmark::RunRecordBenchmark(game_count, path);
+		return 0;
+	}
+
+	if (tool == "--replay-records")
+	{
+		//--replay-records [棋譜ファイル]
+		std::string path = argc > 2 ? argv[2] : GameSequencer::RECORD_FILE;
+
+		return ReversiBenchmark::ReplayRecords(path) ? 0 : 1;
+	}
+
+	if (tool == "--build-index")
+	{
+		//--build-index [棋譜ファイル] [出力ファイル] [手数]
+		std::string archive_path = argc > 2 ? argv[2] : GameSequencer::RECORD_FILE;
+		std::string output_path = argc > 3 ? argv[3] : ReversiEngine::POSITION_INDEX_FILE;
+		int max_plies = argc > 4 ? std::stoi(argv[4]) : 20;
+
+		PositionIndexBuilder builder(max_plies);
+		return builder.Run(archive_path, output_path) ? 0 : 1;
+	}
+
+	if (tool == "--bench-index")
+	{
+		//--bench-index [索引ファイル] [棋譜ファイル] [引く回数]
+		std::string index_path = argc > 2 ? argv[2] : ReversiEngine::POSITION_INDEX_FILE;
+		std::string archive_path = argc > 3 ? argv[3] : GameSequencer::RECORD_FILE;
+		int query_count = argc > 4 ? std::stoi(argv[4]) : 100000;
+
+		ReversiBenchmark::RunIndexBenchmark(index_path, archive_path, query_count);
+		return 0;
+	}
+
+	if (tool == "--remove-shared-table")
+	{
+		//--remove-shared-table [共有メモリの名前]
+		TranspositionTable::RemoveShared(argc > 2 ? argv[2] : "reversi-tt");
+		return 0;
+	}
+
+	if (tool == "--serve")
+	{
+		//--serve [ソケットファイル] [探索スレッド数] [置換表の大きさ(MB)] [メトリクスファイル]
+		std::string path = argc > 2 ? argv[2] : EngineService::SOCKET_PATH;
+		int worker_count = argc > 3 ? std::stoi(argv[3]) : (int)std::max(1u, std::thread::hardware_concurrency());
+		int megabytes = argc > 4 ? std::stoi(argv[4]) : ReversiEngine::TRANSPOSITION_TABLE_MEGABYTES;
+		std::string metrics_path = argc > 5 ? argv[5] : "";
+
+		EngineService service(worker_count, megabytes);
+		service.SetMetricsFile(metrics_path);
+		service.SetHardwarePolicy(policy);
+		if (service.Run(path))
+			return 0;
+
+		std::wcerr << L"cannot listen on socket" << std::endl;
+		return 1;
+	}
+
+	if (tool == "--load-test")
+	{
+		//--load-test [ソケットファイル] [セッション数] [秒数] [最大深さ] [期限(ミリ秒)] [探索スレッド数] [メトリクスファイル]
+		//探索スレッド数を指定すると、同じプロセスでサービスを起動してから負荷をかける
+		std::string path = argc > 2 ? argv[2] : EngineService::SOCKET_PATH;
+		int session_count = argc > 3 ? std::stoi(argv[3]) : 32;
+		int seconds = argc > 4 ? std::stoi(argv[4]) : 10;
+		int max_depth = argc > 5 ? std::stoi(argv[5]) : 8;
+		int deadline = argc > 6 ? std::stoi(argv[6]) : 50;
+		int worker_count = argc > 7 ? std::stoi(argv[7]) : 0;
+		std::string metrics_path = argc > 8 ? argv[8] : "";
+
+		std::unique_ptr<EngineService> service;
+		std::thread service_thread;
+		if (worker_count > 0)
+		{
+			service = std::make_unique<EngineService>(worker_count, ReversiEngine::TRANSPOSITION_TABLE_MEGABYTES);
+			service->SetMetricsFile(metrics_path);
+			service->SetHardwarePolicy(policy);
+			service_thread = std::thread([&service, &path]() { service->Run(path); });
+
+			if (!service->WaitUntilListening(std::chrono::seconds(5)))
+			{
+				service->Stop();
+				service_thread.join();
+				std::wcerr << L"cannot listen on socket" << std::endl;
+				return 1;
+			}
+		}
+
+		ServiceLoadGenerator generator(path, session_count, seconds, max_depth, deadline);
+		bool is_succeeded = generator.Run();
+
+		if (service)
+		{
+			service->Stop();
+			service_thread.join();
+		}
+		return is_succeeded ? 0 : 1;
+	}
+
+	if (tool == "--bench-parallel")
+	{
+		//--bench-parallel [局面数] [探索深さ] [最大スレッド数]
+		int position_count = argc > 2 ? std::stoi(argv[2]) : 20;
+		int depth = argc > 3 ? std::stoi(argv[3]) : 8;
+		int max_threads = argc > 4 ? std::stoi(argv[4]) : (int)std::max(1u, std::thread::hardware_concurrency());
+
+		ReversiBenchmark::RunParallelScaling(position_count, depth, max_threads);
+		return 0;
+	}
+
+	if (tool == "--bench-trace")
+	{
+		//--bench-trace [局面数] [探索深さ] [出力するトレースファイル]
+		int position_count = argc > 2 ? std::stoi(argv[2]) : 20;
+		int depth = argc > 3 ? std::stoi(argv[3]) : 7;
+		std::string path = argc > 4 ? argv[4] : "trace.json";
+
+		return ReversiBenchmark::CompareSearchTrace(position_count, depth, path) ? 0 : 1;
+	}
+
+	if (tool == "--bench-numa")
+	{
+		//--bench-numa [局面数] [探索深さ] [スレッド数] [置換表の大きさ(MB)]
+		//配置を指定しなければ、ノードに振り分けて固定し、透過的なヒュージページを交互に置いたものと比べる
+		int position_count = argc > 2 ? std::stoi(argv[2]) : 20;
+		int depth = argc > 3 ? std::stoi(argv[3]) : 8;
+		int thread_count = argc > 4 ? std::stoi(argv[4]) : (int)std::max(1u, std::thread::hardware_concurrency());
+		int megabytes = argc > 5 ? std::stoi(argv[5]) : 1024;
+
+		HardwarePolicy compared = policy;
+		if (policy == HardwarePolicy())
+			compared = { ThreadPlacement::Spread, HugePageMode::Transparent, NodeMemoryPolicy::Interleave };
+
+		ReversiBenchmark::CompareHardwarePolicy(position_count, depth, thread_count, megabytes, compared);
+		return 0;
+	}
+
+	if (tool == "--bench-pns")
+	{
+		//--bench-pns [空きマス数] [局面数] [スレッド数] [表の大きさ(MB)] [1局面の上限秒数]
+		int empties = argc > 2 ? std::stoi(argv[2]) : 26;
+		int position_count = argc > 3 ? std::stoi(argv[3]) : 4;
+		int thread_count = argc > 4 ? std::stoi(argv[4]) : (int)std::max(1u, std::thread::hardware_concurrency());
+		int megabytes = argc > 5 ? std::stoi(argv[5]) : 1024;
+		int seconds = argc > 6 ? std::stoi(argv[6]) : 600;
+
+		return ReversiBenchmark::CompareProofSearch(position_count, empties, thread_count, megabytes, seconds) ? 0 : 1;
+	}
+
+	std::wcerr << L"unknown option" << std::endl;
+	return 1;
+}
+
+int main(int argc, char* argv[])
+{
+	//対局時の評価関数と探索方式、置換表の指定(--evaluator neural, --engine mcts, --table-size 256, --shared-table reversi-tt, --search-cache search.rvsc, --trace trace.json, --threads 8, --metrics metrics.prom)
+	//探索スレッドとメモリの配置の指定(--placement none|compact|spread, --huge-pages off|transparent|explicit, --node-memory local|interleave|first-touch)はツールの前にも書ける
+	EvaluatorType evaluator_type = EvaluatorType::Handcrafted;
+	EngineMode engine_mode = EngineMode::AlphaBeta;
+	size_t table_megabytes = ReversiEngine::TRANSPOSITION_TABLE_MEGABYTES;
+	std::string shared_table_name;
+	std::string search_cache_path;
+	std::string trace_path;
+	int thread_count = 0;
+	std::string metrics_path;
+	HardwarePolicy hardware_policy;
+	int index = 1;
+
+	for (; index + 1 < argc; index += 2)
+	{
+		std::string option = argv[index];
+		std::string value = argv[index + 1];
+
+		if (option == "--evaluator")
+			evaluator_type = value == "neural" ? EvaluatorType::Neural : EvaluatorType::Handcrafted;
+		else if (option == "--engine")
+			engine_mode = value == "mcts" ? EngineMode::MonteCarlo : EngineMode::AlphaBeta;
+		else if (option == "--table-size")
+			table_megabytes = (size_t)std::stoull(value);
+		else if (option == "--shared-table")
+			shared_table_name = value;
+		else if (option == "--search-cache")
+			search_cache_path = value;
+		else if (option == "--trace")
+			trace_path = value;
+		else if (option == "--threads")
+			thread_count = std::stoi(value);
+		else if (option == "--metrics")
+			metrics_path = value;
+		else if (option == "--placement")
+			hardware_policy.thread_placement = value == "compact" ? ThreadPlacement::Compact : (value == "spread" ? ThreadPlacement::Spread : ThreadPlacement::None);
+		else if (option == "--huge-pages")
+			hardware_policy.huge_pages = value == "explicit" ? HugePageMode::Explicit : (value == "transparent" ? HugePageMode::Transparent : HugePageMode::Off);
+		else if (option == "--node-memory")
+			hardware_policy.node_memory = value == "first-touch" ? NodeMemoryPolicy::FirstTouch : (value == "interleave" ? NodeMemoryPolicy::Interleave : NodeMemoryPolicy::Local);
+		else
+			break;
+	}
+
+	if (index < argc)
+	{
+		//ツール名がargv[1]に来るようにずらす
+		return RunTool(argc - (index - 1), argv + (index - 1), hardware_policy);
+	}
+
 	std::shared_ptr<Board> board = std::make_shared<Board>();
 	std::shared_ptr<BoardWriter> board_writer = std::make_shared<BoardWriter>(8);
 	std::shared_ptr<MessageWriter> message_writer = std::make_shared<MessageWriter>();
 	GameSequencer sequencer(board, board_writer, message_writer);
+	sequencer.SetEvaluatorType(evaluator_type);
+	sequencer.SetEngineMode(engine_mode);
+
+	//共有できなくても自分だけの置換表で対局できる
+	if (!sequencer.SetTranspositionTable(table_megabytes, shared_table_name))
+		std::wcerr << L"cannot attach shared transposition table" << std::endl;
+
+	//指定が無ければ論理コア数で探索する
+	if (thread_count > 0)
+		sequencer.SetThreadCount(thread_count);
+
+	//スレッドの数が決まってから置換表を配置し直す(確保し直すので探索結果を読み込む前に行う)
+	if (hardware_policy != HardwarePolicy())
+		sequencer.SetHardwarePolicy(hardware_policy);
+
+	//前回の探索結果が無いか使えなくても、終了時に作り直す
+	if (!search_cache_path.empty() && !sequencer.SetSearchCache(search_cache_path))
+		std::wcerr << L"search cache is missing or stale, starting cold" << std::endl;
+
+	sequencer.SetTracePath(trace_path);
+
+	if (!metrics_path.empty())
+		sequencer.SetMetricsFile(metrics_path);
 
 	//起動メッセージの表示
 	message_writer->WriteWelcomeMessage();
@@ -0,0 +1,121 @@
+#include "../include/MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace Reversi
+{
+#ifdef _WIN32
+	MappedFile::MappedFile() : data(nullptr), size(0), file_handle(INVALID_HANDLE_VALUE), mapping_handle(nullptr)
+	{
+
+	}
+#else
+	MappedFile::MappedFile() : data(nullptr), size(0), descriptor(-1)
+	{
+
+	}
+#endif
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+#ifdef _WIN32
+		file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file_handle == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0)
+		{
+			Close();
+			return false;
+		}
+
+		mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping_handle == nullptr)
+		{
+			Close();
+			return false;
+		}
+
+		data = static_cast<const unsigned char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+		size = static_cast<size_t>(file_size.QuadPart);
+#else
+		descriptor = open(path.c_str(), O_RDONLY);
+		if (descriptor < 0)
+			return false;
+
+		struct stat status;
+		if (fstat(descriptor, &status) != 0 || status.st_size == 0)
+		{
+			Close();
+			return false;
+		}
+
+		void* address = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+		data = address == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(address);
+		size = static_cast<size_t>(status.st_size);
+#endif
+
+		if (data == nullptr)
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+#ifdef _WIN32
+		if (data != nullptr)
+			UnmapViewOfFile(data);
+		if (mapping_handle != nullptr)
+			CloseHandle(mapping_handle);
+		if (file_handle != INVALID_HANDLE_VALUE)
+			CloseHandle(file_handle);
+
+		mapping_handle = nullptr;
+		file_handle = INVALID_HANDLE_VALUE;
+#else
+		if (data != nullptr)
+			munmap(const_cast<unsigned char*>(data), size);
+		if (descriptor >= 0)
+			close(descriptor);
+
+		descriptor = -1;
+#endif
+
+		data = nullptr;
+		size = 0;
+	}
+
+	bool MappedFile::IsOpen() const
+	{
+		return data != nullptr;
+	}
+
+	const unsigned char* MappedFile::GetData() const
+	{
+		return data;
+	}
+
+	size_t MappedFile::GetSize() const
+	{
+		return size;
+	}
+}
@@ -12,7 +12,9 @@ namespace Reversi
 		write_buffer += L"ゲームを開始するにはEnterキーを押してください...\n";
 
 		WriteMessage();
-		getchar();
+
+		//以降の入力はwcinで読むので、標準入力をバイト単位の関数で読まない(Linuxでは向きが固定される)
+		std::wcin.ignore(std::numeric_limits<std::streamsize>::max(), L'\n');
 	}
 
 	void MessageWriter::WritePassMessage(const Side side)
@@ -22,9 +24,6 @@ namespace Reversi
 		write_buffer += L"パスします。\n";
 
 		WriteMessage();
-
-		constexpr double wait_time = 1.0;
-		std::this_thread::sleep_for(std::chrono::milliseconds((int)(wait_time * 1000)));
 	}
 
 	void MessageWriter::WriteTurnMessage(const Side player_turn, const int max_depth)
@@ -119,4 +118,49 @@ namespace Reversi
 
 		WriteMessage();
 	}
-}
\ No newline at end of file
+
+	void MessageWriter::WriteSearchProgress(const SearchProgress& progress)
+	{
+		//行頭に戻って行を消してから書く
+		write_buffer += L"\r\033[2K";
+		write_buffer += L"深さ" + std::to_wstring(progress.depth);
+		write_buffer += L" " + std::to_wstring(progress.completed_moves) + L"/" + std::to_wstring(progress.total_moves) + L"手";
+
+		if (progress.completed_moves > 0)
+		{
+			int index = std::countr_zero(progress.best.Point);
+			write_buffer += L" 最善手: ";
+			write_buffer += (wchar_t)(L'a' + index % 8);
+			write_buffer += (wchar_t)(L'1' + index / 8);
+			write_buffer += L"(" + std::to_wstring(progress.best.Score) + L")";
+		}
+
+		u64 nps = progress.seconds > 0.0 ? (u64)(progress.nodes / progress.seconds) : 0;
+		write_buffer += L" " + std::to_wstring(progress.nodes) + L"ノード " + std::to_wstring(nps / 1000) + L"kN/s";
+
+		if (progress.is_finished)
+		{
+			write_buffer += L'\n';
+		}
+
+		WriteMessage();
+		std::wcout.flush();
+	}
+
+	void MessageWriter::WriteSearchingCommandMessage()
+	{
+		write_buffer += L"\n敵AIの考え中はリスタート(r)と終了(s)のみ受け付けます。\n";
+
+		WriteMessage();
+	}
+
+	void MessageWriter::WritePositionStats(const PositionStats& stats)
+	{
+		uint32_t total = stats.wins + stats.draws + stats.losses;
+
+		write_buffer += L"この局面の過去の対局: " + std::to_wstring(total) + L"局";
+		write_buffer += L" (手番側の勝ち" + std::to_wstring(stats.wins) + L" 引き分け" + std::to_wstring(stats.draws) + L" 負け" + std::to_wstring(stats.losses) + L")\n";
+
+		WriteMessage();
+	}
+}
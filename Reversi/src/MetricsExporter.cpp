@@ -0,0 +1,118 @@
+#include "../include/MetricsExporter.h"
+#include <cmath>
+#include <filesystem>
+#include <format>
+#include <fstream>
+
+namespace Reversi
+{
+	MetricsExporter::MetricsExporter() : is_stopping(false)
+	{
+
+	}
+
+	MetricsExporter::~MetricsExporter()
+	{
+		Stop();
+	}
+
+	void MetricsExporter::AddHistogram(const std::string& name, const std::string& help, const LatencyHistogram& histogram,
+		const double scale, const double min_bound, const double max_bound)
+	{
+		Metric metric = { name, help, &histogram, scale, {} };
+
+		//1, 2, 5, 10, 20, 50, ...と境界を並べる(10進の表記から読み、書き出した境界に誤差が出ないようにする)
+		for (int exponent = (int)std::floor(std::log10(min_bound)); std::pow(10.0, exponent) <= max_bound * 1.0001; ++exponent)
+		{
+			for (int step : { 1, 2, 5 })
+			{
+				double bound = std::stod(std::format("{}e{}", step, exponent));
+				if (bound >= min_bound * 0.9999 && bound <= max_bound * 1.0001)
+					metric.bounds.push_back(bound);
+			}
+		}
+
+		metrics.push_back(std::move(metric));
+	}
+
+	std::string MetricsExporter::Format() const
+	{
+		std::string text;
+
+		for (const Metric& metric : metrics)
+		{
+			LatencyHistogram::Snapshot snapshot = metric.histogram->GetSnapshot();
+
+			text += std::format("# HELP {} {}\n# TYPE {} histogram\n", metric.name, metric.help, metric.name);
+			for (double bound : metric.bounds)
+			{
+				//境界と同じ区間に入る値はその境界以下として数える(誤差は区間の幅まで)
+				u64 value = (u64)std::floor(bound / metric.scale + 0.5);
+				text += std::format("{}_bucket{{le=\"{}\"}} {}\n", metric.name, bound, snapshot.CountAtOrBelow(value));
+			}
+			text += std::format("{}_bucket{{le=\"+Inf\"}} {}\n", metric.name, snapshot.count);
+			text += std::format("{}_sum {}\n{}_count {}\n", metric.name, (double)snapshot.sum * metric.scale, metric.name, snapshot.count);
+		}
+
+		return text;
+	}
+
+	bool MetricsExporter::WriteFile(const std::string& path) const
+	{
+		std::string temporary_path = path + ".tmp";
+		{
+			std::ofstream stream(temporary_path, std::ios::trunc);
+			if (!stream)
+				return false;
+
+			stream << Format();
+			if (!stream)
+				return false;
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temporary_path, path, error);
+		if (error)
+		{
+			std::filesystem::remove(temporary_path, error);
+			return false;
+		}
+
+		return true;
+	}
+
+	void MetricsExporter::Start(const std::string& path, const std::chrono::milliseconds interval)
+	{
+		Stop();
+
+		this->path = path;
+		is_stopping = false;
+		thread = std::thread(&MetricsExporter::Run, this, interval);
+	}
+
+	void MetricsExporter::Stop()
+	{
+		if (!thread.joinable())
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			is_stopping = true;
+		}
+		condition.notify_all();
+		thread.join();
+
+		WriteFile(path);
+	}
+
+	void MetricsExporter::Run(const std::chrono::milliseconds interval)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (!is_stopping)
+		{
+			WriteFile(path);
+			condition.wait_for(lock, interval, [this]() { return is_stopping; });
+		}
+	}
+}
@@ -0,0 +1,278 @@
+#include "../include/MonteCarloTreeSearch.h"
+#include <algorithm>
+#include <cmath>
+#include <future>
+
+namespace Reversi
+{
+	MonteCarloTreeSearch::MonteCarloTreeSearch(const size_t node_capacity) :
+		nodes(std::min<size_t>(node_capacity, INVALID_NODE)),
+		node_count(0),
+		playout_count(0),
+		stop_flag(nullptr),
+		root_side(Side::Black)
+	{
+
+	}
+
+	u64 MonteCarloTreeSearch::GetPlayoutCount() const
+	{
+		return playout_count.load(std::memory_order_relaxed);
+	}
+
+	size_t MonteCarloTreeSearch::GetNodeCount() const
+	{
+		return std::min(node_count.load(std::memory_order_relaxed), nodes.size());
+	}
+
+	void MonteCarloTreeSearch::SetStopFlag(const std::atomic<bool>* flag)
+	{
+		stop_flag = flag;
+	}
+
+	SearchResult MonteCarloTreeSearch::Search(const Board& board, const Side side, const std::chrono::milliseconds time_limit, const int thread_count, const u64 max_playouts)
+	{
+		//木は探索ごとに作り直す
+		node_count.store(0, std::memory_order_relaxed);
+		playout_count.store(0, std::memory_order_relaxed);
+		root_board = board;
+		root_side = side;
+
+		Node& root = nodes[Allocate(1)];
+		root.move = 0;
+		Expand(root, root_board, root_side);
+
+		auto deadline = std::chrono::steady_clock::now() + time_limit;
+
+		//このスレッドも探索に加わる
+		std::vector<std::future<void>> futures;
+		for (int i = 1; i < thread_count; ++i)
+		{
+			futures.emplace_back(std::async(std::launch::async, &MonteCarloTreeSearch::Run, this, deadline, max_playouts, (u64)i));
+		}
+
+		Run(deadline, max_playouts, 0);
+
+		for (std::future<void>& future : futures)
+		{
+			future.get();
+		}
+
+		//最も多く訪れた手を選ぶ(勝率は訪問数が少ないとぶれるため使わない)
+		SearchResult best = { 0, 0 };
+		uint32_t best_visits = 0;
+
+		for (uint32_t i = 0; i < root.child_count; ++i)
+		{
+			const Node& child = nodes[root.first_child + i];
+			uint32_t visits = child.visits.load(std::memory_order_relaxed);
+
+			if (visits > best_visits)
+			{
+				best_visits = visits;
+				best = { (int)((u64)child.rewards.load(std::memory_order_relaxed) * 500 / visits), child.move };
+			}
+		}
+
+		return best;
+	}
+
+	void MonteCarloTreeSearch::Run(const std::chrono::steady_clock::time_point deadline, const u64 max_playouts, const u64 seed)
+	{
+		//スレッドごとに別の系列になるよう種を混ぜる(0は使えない)
+		Random random = { (seed + 1) * 0x9E3779B97F4A7C15ull };
+
+		while (true)
+		{
+			for (int i = 0; i < CHECK_INTERVAL; ++i)
+			{
+				RunOnce(random);
+			}
+
+			//プレイアウト数はまとめて足し、スレッド間で同じ変数を書き合う回数を減らす
+			u64 playouts = playout_count.fetch_add(CHECK_INTERVAL, std::memory_order_relaxed) + CHECK_INTERVAL;
+
+			if (stop_flag != nullptr && stop_flag->load(std::memory_order_relaxed))
+				break;
+			if (max_playouts != 0 && playouts >= max_playouts)
+				break;
+			if (std::chrono::steady_clock::now() >= deadline)
+				break;
+		}
+	}
+
+	void MonteCarloTreeSearch::RunOnce(Random& random)
+	{
+		//手を打つたびに手番が変わるので、経路の深さから手を打った側が分かる(パスも1手)
+		constexpr int MAX_PATH_LENGTH = 128;
+		Node* path[MAX_PATH_LENGTH];
+		int length = 0;
+
+		Board board = root_board;
+		Side side = root_side;
+		Node* node = &nodes[0];
+		path[length++] = node;
+
+		auto descend = [&]()
+			{
+				Node& child = SelectChild(*node);
+				child.virtual_losses.fetch_add(1, std::memory_order_relaxed);
+
+				if (child.move != 0ull)
+				{
+					board.Set(child.move, side);
+					board.Flip(child.move, side);
+				}
+
+				side = GetOpponentSide(side);
+				node = &child;
+				path[length++] = node;
+			};
+
+		//選択: 展開済みのノードをUCBで辿る
+		while (node->state.load(std::memory_order_acquire) == NodeState::Expanded && node->child_count != 0)
+		{
+			descend();
+		}
+
+		//展開: 十分に訪れた葉は子を作り、1段だけ進める
+		if (node->state.load(std::memory_order_relaxed) == NodeState::Leaf && node->visits.load(std::memory_order_relaxed) + 1 >= EXPAND_VISITS)
+		{
+			Expand(*node, board, side);
+
+			if (node->state.load(std::memory_order_acquire) == NodeState::Expanded && node->child_count != 0)
+				descend();
+		}
+
+		//プレイアウト
+		int difference = Playout(board, side, random);
+
+		//逆伝播: 各ノードに、そこへ至る手を打った側から見た結果を足す
+		for (int i = 0; i < length; ++i)
+		{
+			Side mover = i % 2 == 1 ? root_side : GetOpponentSide(root_side);
+			int sign = mover == Side::Black ? difference : -difference;
+			uint32_t reward = sign > 0 ? 2 : (sign == 0 ? 1 : 0);
+
+			path[i]->visits.fetch_add(1, std::memory_order_relaxed);
+			path[i]->rewards.fetch_add(reward, std::memory_order_relaxed);
+
+			if (i > 0)
+				path[i]->virtual_losses.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	uint32_t MonteCarloTreeSearch::Allocate(const uint32_t count)
+	{
+		size_t first = node_count.fetch_add(count, std::memory_order_relaxed);
+		if (first + count > nodes.size())
+			return INVALID_NODE;
+
+		for (size_t i = first; i < first + count; ++i)
+		{
+			Node& node = nodes[i];
+			node.move = 0;
+			node.first_child = 0;
+			node.child_count = 0;
+			node.visits.store(0, std::memory_order_relaxed);
+			node.rewards.store(0, std::memory_order_relaxed);
+			node.virtual_losses.store(0, std::memory_order_relaxed);
+			node.state.store(NodeState::Leaf, std::memory_order_relaxed);
+		}
+
+		return (uint32_t)first;
+	}
+
+	void MonteCarloTreeSearch::Expand(Node& node, const Board& board, const Side side)
+	{
+		//子を作るのは状態を書き換えられた1スレッドだけ
+		NodeState expected = NodeState::Leaf;
+		if (!node.state.compare_exchange_strong(expected, NodeState::Expanding, std::memory_order_acquire))
+			return;
+
+		u64 legal_moves = board.GetLegalMoves(side);
+
+		//打てなければ、相手が打てる時だけパスの子を作る(どちらも打てなければ終局)
+		uint32_t count = legal_moves != 0ull ? (uint32_t)PopCount(legal_moves) : (board.GetLegalMoves(GetOpponentSide(side)) != 0ull ? 1 : 0);
+		uint32_t first = count != 0 ? Allocate(count) : 0;
+
+		//ノードを使い切ったら葉のまま残す
+		if (first == INVALID_NODE)
+		{
+			node.state.store(NodeState::Leaf, std::memory_order_release);
+			return;
+		}
+
+		uint32_t index = first;
+		for (u64 rest = legal_moves; rest != 0ull; rest = ResetLowestBit(rest))
+		{
+			nodes[index++].move = LowestBit(rest);
+		}
+
+		node.first_child = first;
+		node.child_count = count;
+
+		//子を書き終えてから公開する
+		node.state.store(NodeState::Expanded, std::memory_order_release);
+	}
+
+	MonteCarloTreeSearch::Node& MonteCarloTreeSearch::SelectChild(const Node& node)
+	{
+		uint32_t parent_visits = node.visits.load(std::memory_order_relaxed) + node.virtual_losses.load(std::memory_order_relaxed);
+		double log_visits = std::log((double)std::max(parent_visits, 1u));
+
+		Node* best = nullptr;
+		double best_score = -1.0;
+
+		for (uint32_t i = 0; i < node.child_count; ++i)
+		{
+			Node& child = nodes[node.first_child + i];
+
+			//探索中のスレッドは報酬0の訪問として数える
+			uint32_t visits = child.visits.load(std::memory_order_relaxed) + child.virtual_losses.load(std::memory_order_relaxed);
+
+			//まだ誰も訪れていない手を先に試す
+			if (visits == 0)
+				return child;
+
+			double score = child.rewards.load(std::memory_order_relaxed) / (2.0 * visits) + EXPLORATION * std::sqrt(log_visits / visits);
+			if (score > best_score)
+			{
+				best_score = score;
+				best = &child;
+			}
+		}
+
+		return *best;
+	}
+
+	int MonteCarloTreeSearch::Playout(Board board, Side side, Random& random)
+	{
+		bool passed = false;
+
+		while (true)
+		{
+			u64 legal_moves = board.GetLegalMoves(side);
+
+			//両者とも打てなければ終局
+			if (legal_moves == 0ull)
+			{
+				if (passed)
+					break;
+
+				passed = true;
+				side = GetOpponentSide(side);
+				continue;
+			}
+
+			passed = false;
+			u64 input = SelectRandomBit(legal_moves, random.Next());
+			board.Set(input, side);
+			board.Flip(input, side);
+			side = GetOpponentSide(side);
+		}
+
+		std::pair<int, int> counts = board.CountStone();
+		return counts.first - counts.second;
+	}
+}
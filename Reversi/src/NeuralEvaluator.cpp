@@ -0,0 +1,147 @@
+#include "../include/NeuralEvaluator.h"
+#include "../include/Evaluator.h"
+
+namespace Reversi
+{
+	NeuralEvaluator::NeuralEvaluator() :
+		stack(std::make_unique<Accumulator[]>(MAX_PLY)),
+		ply(0),
+		overflow_count(0)
+	{
+		//どの局面とも一致しない値にして初回の評価で計算させる
+		stack[0].position = { 0xFFFFFFFFFFFFFFFF, 0xFFFFFFFFFFFFFFFF };
+	}
+
+	void NeuralEvaluator::SetNetwork(const std::shared_ptr<const NeuralNetwork>& network)
+	{
+		this->network = network;
+		ply = 0;
+		overflow_count = 0;
+		stack[0].position = { 0xFFFFFFFFFFFFFFFF, 0xFFFFFFFFFFFFFFFF };
+	}
+
+	bool NeuralEvaluator::IsAvailable() const
+	{
+		return network && network->IsLoaded();
+	}
+
+	void NeuralEvaluator::Push(const Position& position, const u64 input, const u64 flips)
+	{
+		//上限を超えた分は差分更新せず、評価時に計算し直す
+		if (ply + 1 >= MAX_PLY)
+		{
+			++overflow_count;
+			return;
+		}
+
+		//着手前の局面と一致していなければ計算し直してから更新する
+		Accumulator& current = stack[ply];
+		if (current.position != position)
+			Refresh(current, position);
+
+		//着手後は手番が入れ替わるので、視点も入れ替えて写す
+		Accumulator& next = stack[++ply];
+		std::copy(std::begin(current.values[0]), std::end(current.values[0]), next.values[1]);
+		std::copy(std::begin(current.values[1]), std::end(current.values[1]), next.values[0]);
+		next.position = position.Play(input, flips);
+
+		//着手側の視点では自分の石が増え、相手の石が減る
+		int16_t* mine_view = next.values[1];
+		int16_t* others_view = next.values[0];
+		int square = std::countr_zero(input);
+
+		AddFeature(mine_view, square);
+		AddFeature(others_view, 64 + square);
+
+		for (u64 rest = flips; rest != 0ull; rest &= rest - 1)
+		{
+			square = std::countr_zero(rest);
+
+			AddFeature(mine_view, square);
+			SubtractFeature(mine_view, 64 + square);
+			AddFeature(others_view, 64 + square);
+			SubtractFeature(others_view, square);
+		}
+	}
+
+	void NeuralEvaluator::Pop()
+	{
+		if (overflow_count > 0)
+		{
+			--overflow_count;
+			return;
+		}
+
+		if (ply > 0)
+			--ply;
+	}
+
+	template <bool is_max>
+	int NeuralEvaluator::Evaluate(const Position& position)
+	{
+		//ゲーム終了時のスコアは手書きの評価関数と揃える(相手側・評価側の順)
+		u64 evaluate_stones = is_max ? position.player : position.opponent;
+		u64 other_stones = is_max ? position.opponent : position.player;
+		std::pair<int, int> counts = std::make_pair(std::popcount(other_stones), std::popcount(evaluate_stones));
+
+		int ending_score = Evaluator::EvaluateGameEnd(counts, std::popcount(position.GetLegalMoves()), std::popcount(position.GetOpponentLegalMoves()));
+		if (ending_score != 0)
+			return ending_score;
+
+		Accumulator& current = stack[ply];
+		if (current.position != position)
+			Refresh(current, position);
+
+		int score = network->Propagate(current.values[0]);
+		return is_max ? score : -score;
+	}
+
+	template int NeuralEvaluator::Evaluate<true>(const Position& position);
+	template int NeuralEvaluator::Evaluate<false>(const Position& position);
+
+	void NeuralEvaluator::Refresh(Accumulator& accumulator, const Position& position) const
+	{
+		const NeuralNetwork::Parameters& parameters = network->GetParameters();
+
+		for (int view = 0; view < 2; ++view)
+		{
+			std::copy(std::begin(parameters.feature_biases), std::end(parameters.feature_biases), accumulator.values[view]);
+		}
+
+		for (u64 rest = position.player; rest != 0ull; rest &= rest - 1)
+		{
+			int square = std::countr_zero(rest);
+			AddFeature(accumulator.values[0], square);
+			AddFeature(accumulator.values[1], 64 + square);
+		}
+
+		for (u64 rest = position.opponent; rest != 0ull; rest &= rest - 1)
+		{
+			int square = std::countr_zero(rest);
+			AddFeature(accumulator.values[0], 64 + square);
+			AddFeature(accumulator.values[1], square);
+		}
+
+		accumulator.position = position;
+	}
+
+	void NeuralEvaluator::AddFeature(int16_t* values, const int feature) const
+	{
+		const int16_t* weights = network->GetParameters().feature_weights[feature];
+
+		for (int i = 0; i < NeuralNetwork::HIDDEN1_SIZE; ++i)
+		{
+			values[i] += weights[i];
+		}
+	}
+
+	void NeuralEvaluator::SubtractFeature(int16_t* values, const int feature) const
+	{
+		const int16_t* weights = network->GetParameters().feature_weights[feature];
+
+		for (int i = 0; i < NeuralNetwork::HIDDEN1_SIZE; ++i)
+		{
+			values[i] -= weights[i];
+		}
+	}
+}
@@ -0,0 +1,177 @@
+#include "../include/NeuralNetwork.h"
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+namespace Reversi
+{
+	NeuralNetwork::NeuralNetwork() : parameters(nullptr), use_avx2(IsAvx2Supported())
+	{
+
+	}
+
+	bool NeuralNetwork::Load(const std::string& path)
+	{
+		parameters = nullptr;
+
+		if (!file.Open(path))
+			return false;
+
+		//サイズ・識別子・バージョン・チェックサムが一致しないファイルは使わない
+		FileHeader header;
+		bool is_valid = file.GetSize() == sizeof(FileHeader) + sizeof(Parameters);
+
+		if (is_valid)
+		{
+			std::memcpy(&header, file.GetData(), sizeof(FileHeader));
+			is_valid = header.magic == FILE_MAGIC && header.version == FILE_VERSION && header.parameter_size == sizeof(Parameters) &&
+				header.checksum == ComputeChecksum(file.GetData() + sizeof(FileHeader), sizeof(Parameters));
+		}
+
+		if (!is_valid)
+		{
+			file.Close();
+			return false;
+		}
+
+		parameters = reinterpret_cast<const Parameters*>(file.GetData() + sizeof(FileHeader));
+		return true;
+	}
+
+	bool NeuralNetwork::Save(const std::string& path, const Parameters& parameters)
+	{
+		std::ofstream stream(path, std::ios::binary);
+		if (!stream)
+			return false;
+
+		FileHeader header = {
+			FILE_MAGIC,
+			FILE_VERSION,
+			sizeof(Parameters),
+			ComputeChecksum(&parameters, sizeof(Parameters)),
+			{}
+		};
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(reinterpret_cast<const char*>(&parameters), sizeof(Parameters));
+
+		return static_cast<bool>(stream);
+	}
+
+	bool NeuralNetwork::IsLoaded() const
+	{
+		return parameters != nullptr;
+	}
+
+	const NeuralNetwork::Parameters& NeuralNetwork::GetParameters() const
+	{
+		return *parameters;
+	}
+
+	int NeuralNetwork::Propagate(const int16_t* accumulator) const
+	{
+#ifdef REVERSI_X86
+		if (use_avx2)
+			return PropagateAvx2(accumulator);
+#endif
+
+		return PropagateScalar(accumulator);
+	}
+
+	int NeuralNetwork::PropagateScalar(const int16_t* accumulator) const
+	{
+		//隠れ層1: clipped ReLUでuint8に落とす
+		uint8_t hidden1[HIDDEN1_SIZE];
+		for (int i = 0; i < HIDDEN1_SIZE; ++i)
+		{
+			hidden1[i] = static_cast<uint8_t>(std::clamp<int>(accumulator[i], 0, ACTIVATION_MAX));
+		}
+
+		//隠れ層2
+		uint8_t hidden2[HIDDEN2_SIZE];
+		for (int j = 0; j < HIDDEN2_SIZE; ++j)
+		{
+			int sum = parameters->hidden_biases[j];
+			for (int i = 0; i < HIDDEN1_SIZE; ++i)
+			{
+				sum += hidden1[i] * parameters->hidden_weights[j][i];
+			}
+
+			hidden2[j] = static_cast<uint8_t>(std::clamp(sum >> WEIGHT_SHIFT, 0, ACTIVATION_MAX));
+		}
+
+		//出力層
+		int output = parameters->output_bias;
+		for (int j = 0; j < HIDDEN2_SIZE; ++j)
+		{
+			output += hidden2[j] * parameters->output_weights[j];
+		}
+
+		return static_cast<int>((long long)output * parameters->score_scale / (ACTIVATION_MAX << WEIGHT_SHIFT));
+	}
+
+#ifdef REVERSI_X86
+	namespace
+	{
+		REVERSI_TARGET_AVX2 inline int HorizontalSum(const __m256i value)
+		{
+			__m128i sum = _mm_add_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+			sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+			sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_cvtsi128_si32(sum);
+		}
+
+		//uint8 × int8 の積和をint32で求める
+		REVERSI_TARGET_AVX2 inline __m256i MultiplyAdd(const __m256i input, const __m256i weight)
+		{
+			return _mm256_madd_epi16(_mm256_maddubs_epi16(input, weight), _mm256_set1_epi16(1));
+		}
+	}
+
+	REVERSI_TARGET_AVX2 int NeuralNetwork::PropagateAvx2(const int16_t* accumulator) const
+	{
+		static_assert(HIDDEN1_SIZE == 64 && HIDDEN2_SIZE == 32, "AVX2 path assumes 64-32 hidden layers");
+
+		//隠れ層1: [0, 127]に丸めてuint8に詰める(packusはレーン単位で交互に並ぶので並べ直す)
+		const __m256i max = _mm256_set1_epi16(ACTIVATION_MAX);
+		__m256i a0 = _mm256_min_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulator)), max);
+		__m256i a1 = _mm256_min_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulator + 16)), max);
+		__m256i a2 = _mm256_min_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulator + 32)), max);
+		__m256i a3 = _mm256_min_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(accumulator + 48)), max);
+		__m256i hidden1_low = _mm256_permute4x64_epi64(_mm256_packus_epi16(a0, a1), _MM_SHUFFLE(3, 1, 2, 0));
+		__m256i hidden1_high = _mm256_permute4x64_epi64(_mm256_packus_epi16(a2, a3), _MM_SHUFFLE(3, 1, 2, 0));
+
+		//隠れ層2
+		alignas(32) int32_t sums[HIDDEN2_SIZE];
+		for (int j = 0; j < HIDDEN2_SIZE; ++j)
+		{
+			const __m256i* weights = reinterpret_cast<const __m256i*>(parameters->hidden_weights[j]);
+			__m256i sum = _mm256_add_epi32(MultiplyAdd(hidden1_low, _mm256_load_si256(weights)),
+				MultiplyAdd(hidden1_high, _mm256_load_si256(weights + 1)));
+			sums[j] = HorizontalSum(sum);
+		}
+
+		__m256i zero = _mm256_setzero_si256();
+		__m256i max32 = _mm256_set1_epi32(ACTIVATION_MAX);
+		__m256i hidden2[4];
+		for (int k = 0; k < 4; ++k)
+		{
+			__m256i sum = _mm256_add_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(sums + k * 8)),
+				_mm256_load_si256(reinterpret_cast<const __m256i*>(parameters->hidden_biases + k * 8)));
+			hidden2[k] = _mm256_min_epi32(_mm256_max_epi32(_mm256_srai_epi32(sum, WEIGHT_SHIFT), zero), max32);
+		}
+
+		//int32 → uint8に詰めて並びを戻す
+		__m256i packed16_low = _mm256_packs_epi32(hidden2[0], hidden2[1]);
+		__m256i packed16_high = _mm256_packs_epi32(hidden2[2], hidden2[3]);
+		__m256i packed8 = _mm256_packus_epi16(packed16_low, packed16_high);
+		__m256i hidden2_bytes = _mm256_permutevar8x32_epi32(packed8, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+
+		//出力層
+		__m256i output_weights = _mm256_load_si256(reinterpret_cast<const __m256i*>(parameters->output_weights));
+		int output = parameters->output_bias + HorizontalSum(MultiplyAdd(hidden2_bytes, output_weights));
+
+		return static_cast<int>((long long)output * parameters->score_scale / (ACTIVATION_MAX << WEIGHT_SHIFT));
+	}
+#endif
+}
@@ -0,0 +1,225 @@
+#include "../include/NeuralTrainer.h"
+#include <cmath>
+#include <numeric>
+#include <iostream>
+#include <algorithm>
+
+namespace Reversi
+{
+	namespace
+	{
+		//量子化後に溢れない範囲
+		constexpr float FEATURE_WEIGHT_LIMIT = 3.0f;
+		constexpr float DENSE_WEIGHT_LIMIT = 127.0f / (1 << NeuralNetwork::WEIGHT_SHIFT);
+
+		inline float ClippedRelu(const float value)
+		{
+			return std::clamp(value, 0.0f, 1.0f);
+		}
+
+		inline float ClippedReluGradient(const float value)
+		{
+			return value > 0.0f && value < 1.0f ? 1.0f : 0.0f;
+		}
+	}
+
+	NeuralTrainer::NeuralTrainer(const int epochs, const float learning_rate, const unsigned int seed) :
+		epochs(epochs),
+		learning_rate(learning_rate),
+		model(std::make_unique<FloatParameters>())
+	{
+		rand_module.seed(seed);
+	}
+
+	bool NeuralTrainer::Run(const std::string& dataset_path, const std::string& output_path)
+	{
+		TrainingData dataset;
+		if (!dataset.Open(dataset_path) || dataset.GetCount() == 0)
+			return false;
+
+		Initialize();
+
+		std::vector<size_t> order(dataset.GetCount());
+		std::iota(order.begin(), order.end(), 0);
+
+		float rate = learning_rate;
+		for (int epoch = 0; epoch < epochs; ++epoch)
+		{
+			std::shuffle(order.begin(), order.end(), rand_module);
+
+			double loss = 0.0;
+			for (size_t index : order)
+			{
+				loss += Train(dataset.Get(index), rate);
+			}
+
+			//出力単位の二乗誤差を石差の平均誤差に直して表示する
+			std::wcout << L"epoch " << epoch << L": rmse " << std::sqrt(loss / order.size()) * DISCS_PER_OUTPUT << L" discs" << std::endl;
+			rate *= 0.8f;
+		}
+
+		std::unique_ptr<NeuralNetwork::Parameters> parameters = Quantize();
+		return NeuralNetwork::Save(output_path, *parameters);
+	}
+
+	void NeuralTrainer::Initialize()
+	{
+		std::uniform_real_distribution<float> feature_distribution(-0.1f, 0.1f);
+		std::uniform_real_distribution<float> hidden_distribution(-0.125f, 0.125f);
+		std::uniform_real_distribution<float> output_distribution(-0.18f, 0.18f);
+
+		for (auto& row : model->feature_weights)
+		{
+			for (float& weight : row)
+			{
+				weight = feature_distribution(rand_module);
+			}
+		}
+
+		for (auto& row : model->hidden_weights)
+		{
+			for (float& weight : row)
+			{
+				weight = hidden_distribution(rand_module);
+			}
+		}
+
+		for (float& weight : model->output_weights)
+		{
+			weight = output_distribution(rand_module);
+		}
+
+		//初期状態で活性化関数の線形な範囲に入るようにする
+		std::fill(std::begin(model->feature_biases), std::end(model->feature_biases), 0.5f);
+		std::fill(std::begin(model->hidden_biases), std::end(model->hidden_biases), 0.5f);
+		model->output_bias = 0.0f;
+	}
+
+	float NeuralTrainer::Train(const TrainingRecord& record, const float rate)
+	{
+		u64 mine = record.side == Side::Black ? record.black : record.white;
+		u64 others = record.side == Side::Black ? record.white : record.black;
+
+		//有効な特徴量(自分の石: 0~63, 相手の石: 64~127)
+		int features[64];
+		int feature_count = 0;
+		for (u64 rest = mine; rest != 0ull; rest &= rest - 1)
+		{
+			features[feature_count++] = std::countr_zero(rest);
+		}
+		for (u64 rest = others; rest != 0ull; rest &= rest - 1)
+		{
+			features[feature_count++] = 64 + std::countr_zero(rest);
+		}
+
+		//順伝播
+		float hidden1_sum[HIDDEN1_SIZE];
+		float hidden1[HIDDEN1_SIZE];
+		std::copy(std::begin(model->feature_biases), std::end(model->feature_biases), hidden1_sum);
+
+		for (int i = 0; i < feature_count; ++i)
+		{
+			const float* weights = model->feature_weights[features[i]];
+			for (int k = 0; k < HIDDEN1_SIZE; ++k)
+			{
+				hidden1_sum[k] += weights[k];
+			}
+		}
+
+		for (int k = 0; k < HIDDEN1_SIZE; ++k)
+		{
+			hidden1[k] = ClippedRelu(hidden1_sum[k]);
+		}
+
+		float hidden2_sum[HIDDEN2_SIZE];
+		float hidden2[HIDDEN2_SIZE];
+		float output = model->output_bias;
+
+		for (int j = 0; j < HIDDEN2_SIZE; ++j)
+		{
+			float sum = model->hidden_biases[j];
+			for (int k = 0; k < HIDDEN1_SIZE; ++k)
+			{
+				sum += model->hidden_weights[j][k] * hidden1[k];
+			}
+
+			hidden2_sum[j] = sum;
+			hidden2[j] = ClippedRelu(sum);
+			output += model->output_weights[j] * hidden2[j];
+		}
+
+		//逆伝播
+		float error = output - record.score / DISCS_PER_OUTPUT;
+		float hidden1_gradient[HIDDEN1_SIZE] = {};
+
+		for (int j = 0; j < HIDDEN2_SIZE; ++j)
+		{
+			float gradient = error * model->output_weights[j] * ClippedReluGradient(hidden2_sum[j]);
+			model->output_weights[j] = std::clamp(model->output_weights[j] - rate * error * hidden2[j], -DENSE_WEIGHT_LIMIT, DENSE_WEIGHT_LIMIT);
+
+			if (gradient == 0.0f)
+				continue;
+
+			for (int k = 0; k < HIDDEN1_SIZE; ++k)
+			{
+				hidden1_gradient[k] += gradient * model->hidden_weights[j][k];
+				model->hidden_weights[j][k] = std::clamp(model->hidden_weights[j][k] - rate * gradient * hidden1[k], -DENSE_WEIGHT_LIMIT, DENSE_WEIGHT_LIMIT);
+			}
+			model->hidden_biases[j] -= rate * gradient;
+		}
+		model->output_bias -= rate * error;
+
+		for (int k = 0; k < HIDDEN1_SIZE; ++k)
+		{
+			float gradient = hidden1_gradient[k] * ClippedReluGradient(hidden1_sum[k]);
+			if (gradient == 0.0f)
+				continue;
+
+			for (int i = 0; i < feature_count; ++i)
+			{
+				float& weight = model->feature_weights[features[i]][k];
+				weight = std::clamp(weight - rate * gradient, -FEATURE_WEIGHT_LIMIT, FEATURE_WEIGHT_LIMIT);
+			}
+			model->feature_biases[k] = std::clamp(model->feature_biases[k] - rate * gradient, -FEATURE_WEIGHT_LIMIT, FEATURE_WEIGHT_LIMIT);
+		}
+
+		return error * error;
+	}
+
+	std::unique_ptr<NeuralNetwork::Parameters> NeuralTrainer::Quantize() const
+	{
+		constexpr float activation_scale = NeuralNetwork::ACTIVATION_MAX;
+		constexpr float weight_scale = 1 << NeuralNetwork::WEIGHT_SHIFT;
+
+		std::unique_ptr<NeuralNetwork::Parameters> parameters = std::make_unique<NeuralNetwork::Parameters>();
+
+		for (int f = 0; f < INPUT_SIZE; ++f)
+		{
+			for (int k = 0; k < HIDDEN1_SIZE; ++k)
+			{
+				parameters->feature_weights[f][k] = (int16_t)std::lround(model->feature_weights[f][k] * activation_scale);
+			}
+		}
+
+		for (int k = 0; k < HIDDEN1_SIZE; ++k)
+		{
+			parameters->feature_biases[k] = (int16_t)std::lround(model->feature_biases[k] * activation_scale);
+		}
+
+		for (int j = 0; j < HIDDEN2_SIZE; ++j)
+		{
+			for (int k = 0; k < HIDDEN1_SIZE; ++k)
+			{
+				parameters->hidden_weights[j][k] = (int8_t)std::lround(model->hidden_weights[j][k] * weight_scale);
+			}
+
+			parameters->hidden_biases[j] = (int32_t)std::lround(model->hidden_biases[j] * activation_scale * weight_scale);
+			parameters->output_weights[j] = (int8_t)std::lround(model->output_weights[j] * weight_scale);
+		}
+
+		parameters->output_bias = (int32_t)std::lround(model->output_bias * activation_scale * weight_scale);
+		parameters->score_scale = (int32_t)(DISCS_PER_OUTPUT * SCORE_PER_DISC);
+
+		return parameters;
+	}
+}
@@ -0,0 +1,33 @@
+#include "../include/Position.h"
+
+namespace Reversi
+{
+	template <int size>
+	typename BasicPosition<size>::Bits BasicPosition<size>::GetCrossFloods(const Bits input, const Bits others)
+	{
+		Bits vertical_cells = others & Geometry::VERTICAL_MASK;
+		Bits horizontal_cells = others & Geometry::HORIZONTAL_MASK;
+		Bits floods;
+
+		//上
+		Bits flood = Spread<size - 2, true>(vertical_cells & (input << SHIFT_VERTICAL), vertical_cells, SHIFT_VERTICAL);
+		floods = flood;
+
+		//下
+		flood = Spread<size - 2, false>(vertical_cells & (input >> SHIFT_VERTICAL), vertical_cells, SHIFT_VERTICAL);
+		floods |= flood;
+
+		//右
+		flood = Spread<size - 2, false>(horizontal_cells & (input >> SHIFT_HORIZONTAL), horizontal_cells, SHIFT_HORIZONTAL);
+		floods = flood;
+
+		//左
+		flood = Spread<size - 2, true>(horizontal_cells & (input << SHIFT_HORIZONTAL), horizontal_cells, SHIFT_HORIZONTAL);
+		floods |= flood;
+
+		return floods;
+	}
+
+	template struct BasicPosition<8>;
+	template struct BasicPosition<10>;
+}
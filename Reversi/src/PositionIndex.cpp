@@ -0,0 +1,98 @@
+#include "../include/PositionIndex.h"
+#include <cstring>
+
+namespace Reversi
+{
+	bool PositionIndex::Open(const std::string& path)
+	{
+		header = {};
+
+		if (!file.Open(path) || file.GetSize() < sizeof(Header))
+			return false;
+
+		std::memcpy(&header, file.GetData(), sizeof(Header));
+
+		//大きさが見出しと合わないファイルは書き込み途中なので使わない
+		bool is_valid = header.magic == FILE_MAGIC && header.version == FILE_VERSION &&
+			header.bucket_bits >= 1 && header.bucket_bits <= 32 &&
+			file.GetSize() == GetEntryOffset(header.bucket_bits) + header.entry_count * sizeof(Entry) + header.posting_count * sizeof(u64);
+
+		if (!is_valid)
+		{
+			file.Close();
+			header = {};
+			return false;
+		}
+
+		return true;
+	}
+
+	bool PositionIndex::IsOpen() const
+	{
+		return file.IsOpen();
+	}
+
+	bool PositionIndex::Find(const Position& position, PositionStats& stats) const
+	{
+		if (!file.IsOpen())
+			return false;
+
+		Position canonical = position.GetCanonical();
+		u64 bucket = Hash(canonical) >> (64 - header.bucket_bits);
+
+		const unsigned char* data = file.GetData();
+		u64 range[2];
+		std::memcpy(range, data + GetBucketOffset() + bucket * sizeof(u64), sizeof(range));
+
+		//大きさが合っていても中身が壊れたファイルでは、範囲の外を読まずに見つからなかったことにする
+		if (range[0] > range[1] || range[1] > header.entry_count)
+			return false;
+
+		const unsigned char* entries = data + GetEntryOffset(header.bucket_bits);
+
+		for (u64 i = range[0]; i < range[1]; ++i)
+		{
+			Entry entry;
+			std::memcpy(&entry, entries + i * sizeof(Entry), sizeof(Entry));
+
+			if (entry.player != canonical.player || entry.opponent != canonical.opponent)
+				continue;
+
+			if (entry.posting_index > header.posting_count || entry.posting_count > header.posting_count - entry.posting_index)
+				return false;
+
+			stats.wins = entry.wins;
+			stats.draws = entry.draws;
+			stats.losses = entry.losses;
+			stats.game_offsets.resize(entry.posting_count);
+
+			const unsigned char* postings = entries + header.entry_count * sizeof(Entry);
+			std::memcpy(stats.game_offsets.data(), postings + entry.posting_index * sizeof(u64), entry.posting_count * sizeof(u64));
+			return true;
+		}
+
+		return false;
+	}
+
+	const PositionIndex::Header& PositionIndex::GetHeader() const
+	{
+		return header;
+	}
+
+	size_t PositionIndex::GetFileSize() const
+	{
+		return file.GetSize();
+	}
+
+	u64 PositionIndex::Hash(const Position& canonical)
+	{
+		//上位ビットでバケットを決めるので、よく混ぜておく
+		u64 hash = canonical.player * 0x9E3779B97F4A7C15ull ^ canonical.opponent;
+		hash ^= hash >> 32;
+		hash *= 0xD6E8FEB86659FD93ull;
+		hash ^= hash >> 32;
+		hash *= 0xD6E8FEB86659FD93ull;
+		hash ^= hash >> 32;
+		return hash;
+	}
+}
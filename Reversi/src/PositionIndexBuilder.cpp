@@ -0,0 +1,232 @@
+#include "../include/PositionIndexBuilder.h"
+#include "../include/Board.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+namespace Reversi
+{
+	PositionIndexBuilder::PositionIndexBuilder(const int max_plies, const int max_postings, const size_t memory_limit) :
+		max_plies(max_plies),
+		max_postings(max_postings),
+		memory_limit(memory_limit)
+	{
+
+	}
+
+	bool PositionIndexBuilder::Run(const std::string& archive_path, const std::string& output_path) const
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		GameRecordReader reader;
+		if (!reader.Open(archive_path))
+			return false;
+
+		size_t game_count = reader.GetCount();
+
+		//現れる局面数の上限を見積もり、分割数とバケット数を決める
+		u64 estimate = 0;
+		for (size_t i = 0; i < game_count; ++i)
+		{
+			estimate += std::min<size_t>(reader.GetSquares(i).size(), max_plies + 1);
+		}
+
+		//分割はハッシュの範囲で区切るので、分割を順に書けばハッシュ順に並ぶ
+		u64 partition_count = std::max<u64>(1, (estimate * sizeof(Occurrence) + memory_limit - 1) / memory_limit);
+		u64 partition_width = partition_count == 1 ? 0 : ~0ull / partition_count + 1;
+		int bucket_bits = std::clamp((int)std::bit_width(estimate / 8), 1, 32);
+
+		//項目は索引ファイルに、局の位置の一覧は一時ファイルに書いて最後に連結する
+		std::string postings_path = output_path + ".postings";
+		std::ofstream output(output_path, std::ios::binary | std::ios::trunc);
+		std::ofstream postings(postings_path, std::ios::binary | std::ios::trunc);
+		if (!output || !postings)
+			return false;
+
+		std::vector<u64> bucket_starts(((size_t)1 << bucket_bits) + 1, 0);
+		output.seekp(PositionIndex::GetEntryOffset(bucket_bits));
+
+		int thread_count = (int)std::max(1u, std::thread::hardware_concurrency());
+		u64 entry_count = 0;
+		u64 posting_count = 0;
+		u64 occurrence_count = 0;
+		std::vector<PositionIndex::Entry> entry_buffer;
+		std::vector<u64> posting_buffer;
+
+		auto write_buffers = [&]()
+			{
+				output.write(reinterpret_cast<const char*>(entry_buffer.data()), entry_buffer.size() * sizeof(PositionIndex::Entry));
+				postings.write(reinterpret_cast<const char*>(posting_buffer.data()), posting_buffer.size() * sizeof(u64));
+				entry_count += entry_buffer.size();
+				posting_count += posting_buffer.size();
+				entry_buffer.clear();
+				posting_buffer.clear();
+			};
+
+		for (u64 partition = 0; partition < partition_count; ++partition)
+		{
+			//局の範囲をスレッドに分けて集める
+			std::vector<std::future<std::vector<Occurrence>>> futures;
+			for (int i = 0; i < thread_count; ++i)
+			{
+				size_t begin = game_count * i / thread_count;
+				size_t end = game_count * (i + 1) / thread_count;
+				size_t reserve = (size_t)(estimate / partition_count / thread_count * 11 / 10);
+				futures.emplace_back(std::async(std::launch::async, &PositionIndexBuilder::Collect, this, std::cref(reader), begin, end,
+					partition_width, partition, reserve));
+			}
+
+			std::vector<std::vector<Occurrence>> chunks;
+			for (std::future<std::vector<Occurrence>>& future : futures)
+			{
+				chunks.emplace_back(future.get());
+				occurrence_count += chunks.back().size();
+			}
+
+			//並べ替え済みの各スレッドの結果を合流させながら、同じ局面をまとめる
+			std::vector<size_t> cursors(chunks.size(), 0);
+
+			while (true)
+			{
+				//先頭が最小のスレッドを選ぶ(スレッド数は少ないので線形に探す)
+				size_t chosen = chunks.size();
+				for (size_t i = 0; i < chunks.size(); ++i)
+				{
+					if (cursors[i] < chunks[i].size() && (chosen == chunks.size() || chunks[i][cursors[i]] < chunks[chosen][cursors[chosen]]))
+						chosen = i;
+				}
+
+				if (chosen == chunks.size())
+					break;
+
+				const Occurrence* next = &chunks[chosen][cursors[chosen]++];
+
+				PositionIndex::Entry* entry = entry_buffer.empty() ? nullptr : &entry_buffer.back();
+				if (entry == nullptr || entry->player != next->position.player || entry->opponent != next->position.opponent)
+				{
+					//まとめ終わった項目はある程度溜まったら書き出す
+					if (entry_buffer.size() >= WRITE_CHUNK_SIZE)
+						write_buffers();
+
+					entry_buffer.push_back({ next->position.player, next->position.opponent, 0, 0, 0, 0, posting_count + posting_buffer.size() });
+					entry = &entry_buffer.back();
+					++bucket_starts[(next->hash >> (64 - bucket_bits)) + 1];
+				}
+
+				if (next->result > 0)
+					++entry->wins;
+				else if (next->result < 0)
+					++entry->losses;
+				else
+					++entry->draws;
+
+				if ((int)entry->posting_count < max_postings)
+				{
+					posting_buffer.emplace_back(next->game_offset);
+					++entry->posting_count;
+				}
+			}
+
+			write_buffers();
+		}
+
+		postings.close();
+
+		//局の位置の一覧を項目の後ろに連結する
+		{
+			std::ifstream input(postings_path, std::ios::binary);
+			std::vector<char> buffer((size_t)1 << 20);
+
+			while (input)
+			{
+				input.read(buffer.data(), buffer.size());
+				output.write(buffer.data(), input.gcount());
+			}
+		}
+		std::remove(postings_path.c_str());
+
+		//バケットごとの数を開始番号に直す
+		for (size_t i = 1; i < bucket_starts.size(); ++i)
+		{
+			bucket_starts[i] += bucket_starts[i - 1];
+		}
+
+		PositionIndex::Header header = { PositionIndex::FILE_MAGIC, PositionIndex::FILE_VERSION, (uint32_t)bucket_bits,
+			(uint32_t)max_plies, (uint32_t)max_postings, 0, entry_count, posting_count, game_count };
+
+		output.seekp(0);
+		output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		output.write(reinterpret_cast<const char*>(bucket_starts.data()), bucket_starts.size() * sizeof(u64));
+		output.close();
+
+		if (!output)
+			return false;
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::wcout << L"indexed " << game_count << L" games, " << occurrence_count << L" positions, "
+			<< entry_count << L" unique (" << partition_count << L" partitions, " << thread_count << L" threads, "
+			<< seconds << L"s)" << std::endl;
+
+		return true;
+	}
+
+	std::vector<PositionIndexBuilder::Occurrence> PositionIndexBuilder::Collect(const GameRecordReader& reader, const size_t begin, const size_t end,
+		const u64 partition_width, const u64 partition, const size_t reserve) const
+	{
+		std::vector<Occurrence> occurrences;
+		occurrences.reserve(reserve);
+		Position initial = Board().GetPosition(Side::Black);
+
+		for (size_t game = begin; game < end; ++game)
+		{
+			std::span<const unsigned char> squares = reader.GetSquares(game);
+			std::pair<int, int> counts = reader.GetResult(game);
+			u64 game_offset = reader.GetOffset(game);
+
+			//黒番から見た勝敗
+			signed char black_result = (signed char)((counts.first > counts.second) - (counts.first < counts.second));
+			Position position = initial;
+			bool is_black = true;
+			int ply = 0;
+
+			for (unsigned char square : squares)
+			{
+				if (square == GameRecord::PASS_SQUARE)
+				{
+					position = position.Pass();
+					is_black = !is_black;
+					continue;
+				}
+
+				if (ply > max_plies || square > 63)
+					break;
+
+				Position canonical = position.GetCanonical();
+				u64 hash = PositionIndex::Hash(canonical);
+
+				if (partition_width == 0 || hash / partition_width == partition)
+				{
+					occurrences.push_back({ hash, canonical, game_offset, is_black ? black_result : (signed char)-black_result });
+				}
+
+				//不正な手があればその局の残りは使わない
+				u64 input = 1ull << square;
+				u64 flips = position.GetFlips(input);
+				if ((position.GetAllBoard() & input) != 0ull || flips == 0ull)
+					break;
+
+				position = position.Play(input, flips);
+				is_black = !is_black;
+				++ply;
+			}
+		}
+
+		std::sort(occurrences.begin(), occurrences.end());
+		return occurrences;
+	}
+}
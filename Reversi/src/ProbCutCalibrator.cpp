@@ -0,0 +1,191 @@
+#include "../include/ProbCutCalibrator.h"
+#include <cmath>
+
+namespace Reversi
+{
+	ProbCutCalibrator::ProbCutCalibrator(const int position_count, const int max_depth, const unsigned int seed) :
+		position_count(position_count),
+		max_depth(std::clamp(max_depth, ProbCutTable::MIN_DEPTH, ProbCutTable::MAX_DEPTH))
+	{
+		rand_module.seed(seed);
+	}
+
+	void ProbCutCalibrator::Run(ProbCutTable& table)
+	{
+		std::vector<Sample> samples = CollectSamples();
+
+		//サンプルをスレッド数で分割して計測する
+		unsigned int thread_count = std::max(1u, std::thread::hardware_concurrency());
+		size_t chunk = (samples.size() + thread_count - 1) / thread_count;
+		std::vector<std::future<RegressionTable>> futures;
+
+		for (size_t begin = 0; begin < samples.size(); begin += chunk)
+		{
+			size_t end = std::min(samples.size(), begin + chunk);
+			futures.emplace_back(std::async(std::launch::async, &ProbCutCalibrator::Measure, this, std::cref(samples), begin, end));
+		}
+
+		RegressionTable regressions(ProbCutTable::STAGE_COUNT * (ProbCutTable::MAX_DEPTH + 1));
+		for (std::future<RegressionTable>& future : futures)
+		{
+			RegressionTable result = future.get();
+			for (size_t i = 0; i < regressions.size(); ++i)
+			{
+				regressions[i].Merge(result[i]);
+			}
+		}
+
+		for (int stage = 0; stage < ProbCutTable::STAGE_COUNT; ++stage)
+		{
+			//計測していない深さは表のまま(既定値も無ければProbCutを行わない)にする
+			for (int depth = ProbCutTable::MIN_DEPTH; depth <= max_depth; ++depth)
+			{
+				const Regression& regression = regressions[GetIndex(stage, depth)];
+
+				//サンプルが少ない場合は既定値のままにする
+				if (regression.n < MIN_SAMPLE_COUNT)
+					continue;
+
+				ProbCutParameter parameter = regression.Fit();
+				table.Set(stage, depth, parameter);
+
+				std::wcout << L"stage " << stage << L" depth " << depth
+					<< L" (shallow " << ProbCutTable::GetShallowDepth(depth) << L"): slope " << parameter.slope
+					<< L" offset " << parameter.offset << L" sigma " << parameter.sigma
+					<< L" n " << regression.n << std::endl;
+			}
+		}
+	}
+
+	std::vector<ProbCutCalibrator::Sample> ProbCutCalibrator::CollectSamples()
+	{
+		std::vector<Sample> samples;
+
+		for (int i = 0; i < position_count; ++i)
+		{
+			//進行度が偏らないように打ち進める手数を均等に割り振る
+			int plies = i % 60;
+			Sample sample = { Board(), Side::Black };
+			bool is_end = false;
+
+			for (int ply = 0; ply < plies && !is_end; ++ply)
+			{
+				u64 legal_moves = sample.board.GetLegalMoves(sample.side);
+
+				//パス
+				if (legal_moves == 0ull)
+				{
+					sample.side = sample.side == Side::Black ? Side::White : Side::Black;
+					legal_moves = sample.board.GetLegalMoves(sample.side);
+					is_end = legal_moves == 0ull;
+					if (is_end)
+						break;
+				}
+
+				//着手可能位置からランダムに一つ選ぶ
+				std::uniform_int_distribution<int> distribution(0, std::popcount(legal_moves) - 1);
+				for (int skip = distribution(rand_module); skip > 0; --skip)
+				{
+					legal_moves &= legal_moves - 1;
+				}
+				u64 input = legal_moves & (~legal_moves + 1);
+
+				sample.board.Set(input, sample.side);
+				sample.board.Flip(input, sample.side);
+				sample.side = sample.side == Side::Black ? Side::White : Side::Black;
+			}
+
+			if (is_end || sample.board.GetLegalMoves(sample.side) == 0ull)
+				continue;
+
+			samples.emplace_back(sample);
+		}
+
+		return samples;
+	}
+
+	ProbCutCalibrator::RegressionTable ProbCutCalibrator::Measure(const std::vector<Sample>& samples, const size_t begin, const size_t end) const
+	{
+		constexpr int alpha = std::numeric_limits<int>::min();
+		constexpr int beta = std::numeric_limits<int>::max();
+
+		//終局のスコアは回帰を歪めるので除外する
+		constexpr int score_limit = 15000;
+
+		RegressionTable regressions(ProbCutTable::STAGE_COUNT * (ProbCutTable::MAX_DEPTH + 1));
+		SearchSystem search_system;
+		std::vector<int> scores(max_depth + 1);
+
+		for (size_t i = begin; i < end; ++i)
+		{
+			const Sample& sample = samples[i];
+			Position position = sample.board.GetPosition(sample.side);
+			int stage = ProbCutTable::GetStage(position.CountStones());
+
+			//探索中は手番側(max)と相手側(min)の両方の視点でProbCutを行うので、両方で計測する
+			for (bool is_max : { true, false })
+			{
+				for (int depth = 1; depth <= max_depth; ++depth)
+				{
+					scores[depth] = search_system.AlphaBetaSearch(position, 0, depth, alpha, beta, is_max).Score;
+				}
+
+				for (int depth = ProbCutTable::MIN_DEPTH; depth <= max_depth; ++depth)
+				{
+					int shallow = scores[ProbCutTable::GetShallowDepth(depth)];
+					int deep = scores[depth];
+
+					if (std::abs(shallow) >= score_limit || std::abs(deep) >= score_limit)
+						continue;
+
+					regressions[GetIndex(stage, depth)].Add(shallow, deep);
+				}
+			}
+		}
+
+		return regressions;
+	}
+
+	int ProbCutCalibrator::GetIndex(const int stage, const int depth) const
+	{
+		return stage * (ProbCutTable::MAX_DEPTH + 1) + depth;
+	}
+
+	void ProbCutCalibrator::Regression::Add(const double x, const double y)
+	{
+		n += 1.0;
+		sum_x += x;
+		sum_y += y;
+		sum_xx += x * x;
+		sum_xy += x * y;
+		sum_yy += y * y;
+	}
+
+	void ProbCutCalibrator::Regression::Merge(const Regression& other)
+	{
+		n += other.n;
+		sum_x += other.sum_x;
+		sum_y += other.sum_y;
+		sum_xx += other.sum_xx;
+		sum_xy += other.sum_xy;
+		sum_yy += other.sum_yy;
+	}
+
+	ProbCutParameter ProbCutCalibrator::Regression::Fit() const
+	{
+		//最小二乗法で deep = slope * shallow + offset を求める
+		double denominator = n * sum_xx - sum_x * sum_x;
+		double slope = denominator != 0.0 ? (n * sum_xy - sum_x * sum_y) / denominator : 1.0;
+
+		//傾きが負になるような相関の無いデータでは予測しない
+		slope = std::max(slope, 0.01);
+		double offset = (sum_y - slope * sum_x) / n;
+
+		//残差の二乗和から標準偏差を求める
+		double error = sum_yy - 2.0 * slope * sum_xy - 2.0 * offset * sum_y
+			+ slope * slope * sum_xx + 2.0 * slope * offset * sum_x + n * offset * offset;
+		double sigma = std::sqrt(std::max(error, 0.0) / n);
+
+		return { slope, offset, sigma };
+	}
+}
@@ -0,0 +1,136 @@
+#include "../include/ProbCutTable.h"
+
+namespace Reversi
+{
+	namespace
+	{
+		//ProbCutCalibratorで求めた既定のパラメータ(進行度ごとに深さMIN_DEPTH~DEFAULT_MAX_DEPTH)
+		constexpr ProbCutParameter default_parameters[ProbCutTable::STAGE_COUNT][ProbCutTable::DEFAULT_MAX_DEPTH - ProbCutTable::MIN_DEPTH + 1] = {
+			//石数4~13
+			{
+				{ 1.011, 16.1, 112.6 }, { 1.094, 9.6, 112.8 }, { 1.073, 3.9, 84.9 }, { 1.146, 11.5, 137.4 }, { 1.122, 10.4, 113.4 }
+			},
+			//石数14~23
+			{
+				{ 1.046, -12.0, 188.2 }, { 1.083, -20.1, 190.5 }, { 1.074, -14.0, 188.0 }, { 1.142, -29.2, 241.5 }, { 1.114, -22.2, 243.2 }
+			},
+			//石数24~33
+			{
+				{ 1.010, -40.5, 317.1 }, { 1.037, -51.4, 250.9 }, { 1.038, -42.9, 236.0 }, { 1.111, -101.3, 425.0 }, { 1.090, -97.7, 389.1 }
+			},
+			//石数34~43
+			{
+				{ 1.049, -93.3, 405.0 }, { 1.062, -82.9, 360.4 }, { 1.032, -86.7, 300.9 }, { 1.111, -162.1, 484.0 }, { 1.065, -171.6, 438.4 }
+			},
+			//石数44~53
+			{
+				{ 1.000, -158.3, 438.7 }, { 1.033, -134.1, 479.8 }, { 1.044, -136.5, 443.4 }, { 1.071, -267.1, 773.2 }, { 1.067, -242.2, 741.7 }
+			},
+			//石数54~64
+			{
+				{ 1.085, -180.4, 784.9 }, { 1.058, -141.1, 710.4 }, { 1.054, -134.9, 707.8 }, { 1.107, -257.8, 1130.2 }, { 1.096, -241.6, 948.8 }
+			}
+		};
+	}
+
+	ProbCutTable::ProbCutTable() : parameters(), calibrated()
+	{
+		for (int stage = 0; stage < STAGE_COUNT; ++stage)
+		{
+			for (int depth = MIN_DEPTH; depth <= DEFAULT_MAX_DEPTH; ++depth)
+			{
+				Set(stage, depth, default_parameters[stage][depth - MIN_DEPTH]);
+			}
+		}
+	}
+
+	const ProbCutParameter& ProbCutTable::Get(const int stage, const int depth) const
+	{
+		return parameters[stage][depth];
+	}
+
+	bool ProbCutTable::IsCalibrated(const int stage, const int depth) const
+	{
+		return calibrated[stage][depth];
+	}
+
+	void ProbCutTable::Set(const int stage, const int depth, const ProbCutParameter& parameter)
+	{
+		parameters[stage][depth] = parameter;
+		calibrated[stage][depth] = true;
+	}
+
+	bool ProbCutTable::Load(const std::string& path)
+	{
+		std::ifstream stream(path);
+		if (!stream)
+			return false;
+
+		//1行に "進行度 深さ slope offset sigma" を記述する
+		ProbCutParameter loaded[STAGE_COUNT][MAX_DEPTH + 1] = {};
+		bool loaded_calibrated[STAGE_COUNT][MAX_DEPTH + 1] = {};
+		std::copy(&parameters[0][0], &parameters[0][0] + STAGE_COUNT * (MAX_DEPTH + 1), &loaded[0][0]);
+		std::copy(&calibrated[0][0], &calibrated[0][0] + STAGE_COUNT * (MAX_DEPTH + 1), &loaded_calibrated[0][0]);
+
+		int stage, depth;
+		ProbCutParameter parameter;
+		while (stream >> stage >> depth >> parameter.slope >> parameter.offset >> parameter.sigma)
+		{
+			if (stage < 0 || stage >= STAGE_COUNT || depth < MIN_DEPTH || depth > MAX_DEPTH)
+				return false;
+
+			//傾きが正でない、もしくは誤差が負のパラメータは信用しない
+			if (parameter.slope <= 0.0 || parameter.sigma < 0.0)
+				return false;
+
+			loaded[stage][depth] = parameter;
+			loaded_calibrated[stage][depth] = true;
+		}
+
+		if (!stream.eof())
+			return false;
+
+		std::copy(&loaded[0][0], &loaded[0][0] + STAGE_COUNT * (MAX_DEPTH + 1), &parameters[0][0]);
+		std::copy(&loaded_calibrated[0][0], &loaded_calibrated[0][0] + STAGE_COUNT * (MAX_DEPTH + 1), &calibrated[0][0]);
+		return true;
+	}
+
+	bool ProbCutTable::Save(const std::string& path) const
+	{
+		std::ofstream stream(path);
+		if (!stream)
+			return false;
+
+		for (int stage = 0; stage < STAGE_COUNT; ++stage)
+		{
+			for (int depth = MIN_DEPTH; depth <= MAX_DEPTH; ++depth)
+			{
+				if (!calibrated[stage][depth])
+					continue;
+
+				const ProbCutParameter& parameter = parameters[stage][depth];
+				stream << stage << ' ' << depth << ' '
+					<< parameter.slope << ' ' << parameter.offset << ' ' << parameter.sigma << '\n';
+			}
+		}
+
+		return static_cast<bool>(stream);
+	}
+
+	int ProbCutTable::GetStage(const int stone_count)
+	{
+		//4~64個の石を10個ずつ区切る
+		return std::clamp((stone_count - 4) / 10, 0, STAGE_COUNT - 1);
+	}
+
+	int ProbCutTable::GetShallowDepth(const int depth)
+	{
+		//偶奇を揃えた上で深さの半分程度を浅い探索に使う
+		return std::max(1, depth / 4 * 2 + (depth & 1));
+	}
+
+	double ProbCutTable::GetThreshold(const int selectivity)
+	{
+		return thresholds[std::clamp(selectivity, 0, SELECTIVITY_COUNT - 1)];
+	}
+}
@@ -0,0 +1,546 @@
+#include "../include/ProofNumberSearch.h"
+#include "../include/TranspositionTable.h"
+#include <algorithm>
+#include <bit>
+#include <future>
+
+namespace Reversi
+{
+	ProofNumberSearch::ProofNumberSearch(const size_t megabytes) :
+		locks(std::make_unique<std::mutex[]>(LOCK_COUNT)),
+		entry_count(0),
+		is_collecting(false),
+		collection_count(0),
+		node_count(0),
+		is_stopped(false),
+		is_finished(false),
+		stop_flag(nullptr),
+		alpha_beta_empties(12)
+	{
+		size_t bucket_count = std::bit_floor(std::max<size_t>(megabytes * 1024 * 1024 / sizeof(Bucket), 1));
+		buckets.resize(bucket_count);
+		bucket_mask = bucket_count - 1;
+	}
+
+	int ProofNumberSearch::GetAlphaBetaEmpties() const
+	{
+		return alpha_beta_empties;
+	}
+
+	void ProofNumberSearch::SetAlphaBetaEmpties(const int empties)
+	{
+		alpha_beta_empties = std::max(empties, 0);
+	}
+
+	u64 ProofNumberSearch::GetNodeCount() const
+	{
+		return node_count.load(std::memory_order_relaxed);
+	}
+
+	int ProofNumberSearch::GetCollectionCount() const
+	{
+		return collection_count.load(std::memory_order_relaxed);
+	}
+
+	size_t ProofNumberSearch::GetEntryCount() const
+	{
+		return entry_count.load(std::memory_order_relaxed);
+	}
+
+	size_t ProofNumberSearch::GetCapacity() const
+	{
+		return buckets.size() * BUCKET_SIZE;
+	}
+
+	void ProofNumberSearch::SetStopFlag(const std::atomic<bool>* flag)
+	{
+		stop_flag = flag;
+	}
+
+	void ProofNumberSearch::Clear()
+	{
+		std::fill(buckets.begin(), buckets.end(), Bucket{});
+		entry_count.store(0, std::memory_order_relaxed);
+	}
+
+	ProofResult ProofNumberSearch::Solve(const Position& position, const std::chrono::milliseconds time_limit, const int thread_count)
+	{
+		//表は探索ごとに作り直す
+		Clear();
+		node_count.store(0, std::memory_order_relaxed);
+		collection_count.store(0, std::memory_order_relaxed);
+		is_stopped.store(false, std::memory_order_relaxed);
+
+		auto deadline = std::chrono::steady_clock::now() + time_limit;
+		ProofResult result = { GameOutcome::Unknown, 0 };
+
+		//石差1以上(勝ち)を証明し、反証されたら石差0以上(引き分け)を証明する
+		//2回目も1回目の表を使う(子の目標は1 - thresholdなので、1回目の子孫の多くがそのまま使える)
+		for (int threshold = 1; threshold >= 0; --threshold)
+		{
+			is_finished.store(false, std::memory_order_relaxed);
+
+			//このスレッドも探索に加わる
+			std::vector<std::future<void>> futures;
+			for (int i = 1; i < thread_count; ++i)
+			{
+				futures.emplace_back(std::async(std::launch::async, &ProofNumberSearch::Run, this, position, threshold, deadline));
+			}
+
+			Run(position, threshold, deadline);
+
+			for (std::future<void>& future : futures)
+			{
+				future.get();
+			}
+
+			uint32_t proof = 1;
+			uint32_t disproof = 1;
+			if (!Lookup(position, threshold, proof, disproof) || (proof != 0 && disproof != 0))
+				return result;
+
+			if (proof == 0)
+			{
+				result.outcome = threshold == 1 ? GameOutcome::Win : GameOutcome::Draw;
+
+				//子の目標が反証された手が証明した手
+				for (u64 rest = position.GetLegalMoves(); rest != 0ull; rest = ResetLowestBit(rest))
+				{
+					u64 input = LowestBit(rest);
+					uint32_t child_proof = 1;
+					uint32_t child_disproof = 1;
+
+					if (Lookup(position.Play(input, position.GetFlips(input)), 1 - threshold, child_proof, child_disproof) && child_disproof == 0)
+					{
+						result.move = input;
+						break;
+					}
+				}
+
+				return result;
+			}
+		}
+
+		result.outcome = GameOutcome::Loss;
+		return result;
+	}
+
+	ProofResult ProofNumberSearch::SolveByAlphaBeta(const Position& position, const std::chrono::milliseconds time_limit)
+	{
+		node_count.store(0, std::memory_order_relaxed);
+		is_stopped.store(false, std::memory_order_relaxed);
+		is_finished.store(false, std::memory_order_relaxed);
+
+		SearchContext context = { 0, 0, std::chrono::steady_clock::now() + time_limit, 0 };
+		u64 legal_moves = position.GetLegalMoves();
+		int best = -64;
+		u64 best_move = 0;
+
+		//勝敗だけを知るので(-1, 1)の窓で読む
+		if (legal_moves == 0ull)
+		{
+			best = -AlphaBeta(context, position.Pass(), -1, 1, true);
+		}
+		else
+		{
+			int alpha = -1;
+
+			for (u64 rest = legal_moves; rest != 0ull && alpha < 1; rest = ResetLowestBit(rest))
+			{
+				u64 input = LowestBit(rest);
+				int score = -AlphaBeta(context, position.Play(input, position.GetFlips(input)), -1, -alpha, false);
+
+				if (score > best)
+				{
+					best = score;
+					best_move = input;
+					alpha = std::max(alpha, score);
+				}
+			}
+		}
+
+		node_count.fetch_add(context.nodes - context.reported_nodes, std::memory_order_relaxed);
+
+		if (is_stopped.load(std::memory_order_relaxed))
+			return { GameOutcome::Unknown, 0 };
+
+		if (best > 0)
+			return { GameOutcome::Win, best_move };
+		if (best == 0)
+			return { GameOutcome::Draw, best_move };
+		return { GameOutcome::Loss, 0 };
+	}
+
+	void ProofNumberSearch::Run(const Position root, const int threshold, const std::chrono::steady_clock::time_point deadline)
+	{
+		SearchContext context = { 0, 0, deadline, 0 };
+
+		while (!IsStopped(context))
+		{
+			MultipleIterativeDeepening(context, root, threshold, INFINITE_NUMBER, INFINITE_NUMBER);
+
+			uint32_t proof = 1;
+			uint32_t disproof = 1;
+			if (Lookup(root, threshold, proof, disproof) && (proof == 0 || disproof == 0))
+				is_finished.store(true, std::memory_order_relaxed);
+		}
+
+		node_count.fetch_add(context.nodes - context.reported_nodes, std::memory_order_relaxed);
+	}
+
+	u64 ProofNumberSearch::MultipleIterativeDeepening(SearchContext& context, const Position& position, const int threshold, const uint32_t proof_limit, const uint32_t disproof_limit)
+	{
+		u64 start_nodes = context.nodes++;
+		u64 legal_moves = position.GetLegalMoves();
+
+		if (legal_moves == 0ull && position.GetOpponentLegalMoves() == 0ull)
+		{
+			//終局(空きマスは勝った側のものになるので、勝敗は石数だけで決まる)
+			bool is_proven = PopCount(position.player) - PopCount(position.opponent) >= threshold;
+			Store(position, threshold, is_proven ? 0 : INFINITE_NUMBER, is_proven ? INFINITE_NUMBER : 0, 1, 0);
+			return 1;
+		}
+
+		if (64 - position.CountStones() <= alpha_beta_empties)
+		{
+			//表に載せるより読み切った方が速い
+			bool is_proven = AlphaBeta(context, position, threshold - 1, threshold, false) >= threshold;
+
+			//中断された探索の値は使えない
+			if (!IsStopped(context))
+				Store(position, threshold, is_proven ? 0 : INFINITE_NUMBER, is_proven ? INFINITE_NUMBER : 0, context.nodes - start_nodes, 0);
+
+			return context.nodes - start_nodes;
+		}
+
+		//子は相手番の局面で、目標は「相手の石差が1 - threshold以上」(自分の目標の否定)
+		Position children[64];
+		uint32_t initial_disproofs[64];
+		int child_count = 0;
+
+		if (legal_moves == 0ull)
+		{
+			children[child_count++] = position.Pass();
+		}
+		else
+		{
+			for (u64 rest = legal_moves; rest != 0ull; rest = ResetLowestBit(rest))
+			{
+				u64 input = LowestBit(rest);
+				children[child_count++] = position.Play(input, position.GetFlips(input));
+			}
+		}
+
+		//相手の着手可能数が少ない子ほど反証(自分の証明)しやすいものとして始める(df-pn+)
+		for (int i = 0; i < child_count; ++i)
+		{
+			initial_disproofs[i] = std::max(PopCount(children[i].GetLegalMoves()), 1);
+		}
+
+		int child_threshold = 1 - threshold;
+		uint32_t proof;
+		uint32_t disproof;
+		bool is_marked = false;
+
+		for (;;)
+		{
+			//自分の証明数は子の反証数の最小値、反証数は子の証明数の和
+			proof = INFINITE_NUMBER;
+			u64 disproof_sum = 0;
+			int best = 0;
+			uint32_t best_proof = 0;
+			uint32_t second_disproof = INFINITE_NUMBER;
+
+			for (int i = 0; i < child_count; ++i)
+			{
+				uint32_t child_proof = 1;
+				uint32_t child_disproof = initial_disproofs[i];
+				Lookup(children[i], child_threshold, child_proof, child_disproof);
+
+				disproof_sum += child_proof;
+
+				if (child_disproof < proof)
+				{
+					second_disproof = proof;
+					proof = child_disproof;
+					best = i;
+					best_proof = child_proof;
+				}
+				else if (child_disproof < second_disproof)
+				{
+					second_disproof = child_disproof;
+				}
+			}
+
+			//証明済みでなければ無限大にしない
+			disproof = proof == 0 ? INFINITE_NUMBER : (uint32_t)std::min<u64>(disproof_sum, INFINITE_NUMBER - 1);
+			if (disproof_sum == 0)
+				disproof = 0;
+
+			if (proof >= proof_limit || disproof >= disproof_limit || IsStopped(context))
+				break;
+
+			//他のスレッドが避けられるよう、探索中の印を付ける
+			if (!is_marked)
+			{
+				Store(position, threshold, proof, disproof, 0, 1);
+				is_marked = true;
+			}
+
+			//子の証明数のしきい値は自分の反証数のしきい値から、反証数のしきい値は2番目に小さい子の反証数から決める
+			//反証数のしきい値は2番目の子の1.25倍まで広げ、兄弟の間を行き来する回数を減らす(1+εの工夫)
+			uint32_t child_proof_limit = disproof_limit >= INFINITE_NUMBER ? INFINITE_NUMBER : disproof_limit - (disproof - best_proof);
+			uint32_t child_disproof_limit = (uint32_t)std::min<u64>(proof_limit, (u64)second_disproof + second_disproof / 4 + 1);
+
+			MultipleIterativeDeepening(context, children[best], child_threshold, child_proof_limit, child_disproof_limit);
+		}
+
+		Store(position, threshold, proof, disproof, context.nodes - start_nodes, is_marked ? -1 : 0);
+		return context.nodes - start_nodes;
+	}
+
+	int ProofNumberSearch::AlphaBeta(SearchContext& context, const Position& position, int alpha, const int beta, const bool passed)
+	{
+		++context.nodes;
+		if (IsStopped(context))
+			return alpha;
+
+		u64 legal_moves = position.GetLegalMoves();
+
+		if (legal_moves == 0ull)
+		{
+			//両者とも置けなければ終局
+			if (passed)
+				return PopCount(position.player) - PopCount(position.opponent);
+
+			return -AlphaBeta(context, position.Pass(), -beta, -alpha, true);
+		}
+
+		int best = -64;
+
+		if (64 - position.CountStones() > ORDERING_EMPTIES)
+		{
+			//相手の着手可能数が少ない手から調べる(早くカットできる)
+			Position children[64];
+			int mobilities[64];
+			int child_count = 0;
+
+			for (u64 rest = legal_moves; rest != 0ull; rest = ResetLowestBit(rest))
+			{
+				u64 input = LowestBit(rest);
+				Position child = position.Play(input, position.GetFlips(input));
+				int mobility = PopCount(child.GetLegalMoves());
+
+				int i = child_count++;
+				for (; i > 0 && mobilities[i - 1] > mobility; --i)
+				{
+					children[i] = children[i - 1];
+					mobilities[i] = mobilities[i - 1];
+				}
+				children[i] = child;
+				mobilities[i] = mobility;
+			}
+
+			for (int i = 0; i < child_count; ++i)
+			{
+				int score = -AlphaBeta(context, children[i], -beta, -alpha, false);
+
+				if (score > best)
+				{
+					best = score;
+					alpha = std::max(alpha, score);
+
+					if (alpha >= beta)
+						break;
+				}
+			}
+		}
+		else
+		{
+			for (u64 rest = legal_moves; rest != 0ull; rest = ResetLowestBit(rest))
+			{
+				u64 input = LowestBit(rest);
+				int score = -AlphaBeta(context, position.Play(input, position.GetFlips(input)), -beta, -alpha, false);
+
+				if (score > best)
+				{
+					best = score;
+					alpha = std::max(alpha, score);
+
+					if (alpha >= beta)
+						break;
+				}
+			}
+		}
+
+		return best;
+	}
+
+	bool ProofNumberSearch::IsStopped(SearchContext& context)
+	{
+		if (++context.check_count >= CHECK_INTERVAL)
+		{
+			context.check_count = 0;
+			node_count.fetch_add(context.nodes - context.reported_nodes, std::memory_order_relaxed);
+			context.reported_nodes = context.nodes;
+
+			if (std::chrono::steady_clock::now() >= context.deadline || (stop_flag && stop_flag->load(std::memory_order_relaxed)))
+				is_stopped.store(true, std::memory_order_relaxed);
+		}
+
+		return is_stopped.load(std::memory_order_relaxed) || is_finished.load(std::memory_order_relaxed);
+	}
+
+	size_t ProofNumberSearch::GetBucketIndex(const Position& position, const int threshold) const
+	{
+		return TranspositionTable::ComputeHash(position.player, position.opponent, threshold != 0) & bucket_mask;
+	}
+
+	bool ProofNumberSearch::Lookup(const Position& position, const int threshold, uint32_t& proof, uint32_t& disproof)
+	{
+		size_t index = GetBucketIndex(position, threshold);
+		std::lock_guard<std::mutex> lock(locks[index & (LOCK_COUNT - 1)]);
+
+		for (const Entry& entry : buckets[index].entries)
+		{
+			if (entry.is_used && entry.player == position.player && entry.opponent == position.opponent && entry.threshold == threshold)
+			{
+				proof = entry.proof;
+				disproof = entry.disproof;
+
+				//証明・反証済みの値はそのまま使う
+				if (entry.busy != 0 && proof != 0 && disproof != 0)
+				{
+					proof = std::min(proof + entry.busy * VIRTUAL_NUMBER, INFINITE_NUMBER - 1);
+					disproof = std::min(disproof + entry.busy * VIRTUAL_NUMBER, INFINITE_NUMBER - 1);
+				}
+
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void ProofNumberSearch::Store(const Position& position, const int threshold, const uint32_t proof, const uint32_t disproof, const u64 work, const int busy_delta)
+	{
+		size_t index = GetBucketIndex(position, threshold);
+		bool is_added = false;
+
+		{
+			std::lock_guard<std::mutex> lock(locks[index & (LOCK_COUNT - 1)]);
+			Entry* target = nullptr;
+
+			for (Entry& entry : buckets[index].entries)
+			{
+				if (entry.is_used && entry.player == position.player && entry.opponent == position.opponent && entry.threshold == threshold)
+				{
+					target = &entry;
+					break;
+				}
+			}
+
+			if (target == nullptr)
+			{
+				//空きか、探索中でない最も探索量の少ない項目を置き換える
+				for (Entry& entry : buckets[index].entries)
+				{
+					if (!entry.is_used)
+					{
+						target = &entry;
+						break;
+					}
+
+					if (entry.busy == 0 && (target == nullptr || entry.work < target->work))
+						target = &entry;
+				}
+
+				//すべて探索中なら記録しない
+				if (target == nullptr)
+					return;
+
+				is_added = !target->is_used;
+				*target = { position.player, position.opponent, 0, 0, 0, 0, (uint8_t)threshold, true };
+			}
+
+			target->proof = proof;
+			target->disproof = disproof;
+			target->work = (uint32_t)std::min<u64>(target->work + work, UINT32_MAX);
+			target->busy = (uint16_t)std::max(target->busy + busy_delta, 0);
+		}
+
+		if (is_added && entry_count.fetch_add(1, std::memory_order_relaxed) + 1 > GetCapacity() * COLLECT_RATIO)
+			Collect();
+	}
+
+	void ProofNumberSearch::Collect()
+	{
+		//他のスレッドが消している間は探索を続ける
+		bool expected = false;
+		if (!is_collecting.compare_exchange_strong(expected, true))
+			return;
+
+		//ロックごとに、そのロックが守るバケットを順に処理する
+		auto for_each_bucket = [this](auto&& function)
+			{
+				for (size_t lock_index = 0; lock_index < LOCK_COUNT; ++lock_index)
+				{
+					std::lock_guard<std::mutex> lock(locks[lock_index]);
+
+					for (size_t index = lock_index; index < buckets.size(); index += LOCK_COUNT)
+					{
+						function(buckets[index]);
+					}
+				}
+			};
+
+		//探索量の桁数ごとに項目を数え、RETAIN_RATIOまで減らせる最小の桁数を決める
+		size_t counts[33] = {};
+		size_t total = 0;
+		for_each_bucket([&](const Bucket& bucket)
+			{
+				for (const Entry& entry : bucket.entries)
+				{
+					if (entry.is_used && entry.busy == 0)
+					{
+						++counts[std::bit_width(entry.work)];
+						++total;
+					}
+				}
+			});
+
+		size_t retained = (size_t)(GetCapacity() * RETAIN_RATIO);
+		size_t target = total > retained ? total - retained : 0;
+
+		//探索中の項目が多くて減らせる分が無ければ何も消さない
+		if (target == 0)
+		{
+			is_collecting.store(false, std::memory_order_release);
+			return;
+		}
+
+		int max_level = -1;
+
+		for (size_t removed = 0; removed < target && max_level < 32;)
+		{
+			removed += counts[++max_level];
+		}
+
+		size_t removed = 0;
+		for_each_bucket([&](Bucket& bucket)
+			{
+				for (Entry& entry : bucket.entries)
+				{
+					if (entry.is_used && entry.busy == 0 && (int)std::bit_width(entry.work) <= max_level)
+					{
+						entry.is_used = false;
+						++removed;
+					}
+				}
+			});
+
+		entry_count.fetch_sub(removed, std::memory_order_relaxed);
+		collection_count.fetch_add(1, std::memory_order_relaxed);
+		is_collecting.store(false, std::memory_order_release);
+	}
+}
@@ -0,0 +1,101 @@
+#include "../include/ReductionTable.h"
+#include <cmath>
+#include <fstream>
+
+namespace Reversi
+{
+	ReductionTable::ReductionTable() : reductions()
+	{
+		Build();
+	}
+
+	const ReductionParameters& ReductionTable::GetParameters() const
+	{
+		return parameters;
+	}
+
+	void ReductionTable::SetParameters(const ReductionParameters& new_parameters)
+	{
+		parameters = new_parameters;
+		Build();
+	}
+
+	void ReductionTable::Build()
+	{
+		for (int depth = 0; depth <= MAX_DEPTH; ++depth)
+		{
+			for (int move_index = 0; move_index <= MAX_MOVE_INDEX; ++move_index)
+			{
+				int reduction = 0;
+
+				if (depth >= parameters.min_depth && move_index >= parameters.min_move_index && move_index > 0)
+				{
+					double value = parameters.base + std::log((double)depth) * std::log((double)move_index + 1.0) / parameters.divisor;
+
+					//子(深さdepth - 1)を少なくとも深さ1で探索し、偶奇を揃える
+					int limit = std::max(depth - 2, 0) / 2 * 2;
+					reduction = std::clamp((int)value / 2 * 2, 0, limit);
+				}
+
+				reductions[depth][move_index] = (unsigned char)reduction;
+			}
+		}
+	}
+
+	bool ReductionTable::Load(const std::string& path)
+	{
+		std::ifstream stream(path);
+		if (!stream)
+			return false;
+
+		//1行に "名前 値" を記述する(書かなかったものは今の値のまま)
+		ReductionParameters loaded = parameters;
+		std::string name;
+		double value;
+
+		while (stream >> name >> value)
+		{
+			if (name == "min_depth")
+				loaded.min_depth = (int)value;
+			else if (name == "min_move_index")
+				loaded.min_move_index = (int)value;
+			else if (name == "base")
+				loaded.base = value;
+			else if (name == "divisor")
+				loaded.divisor = value;
+			else if (name == "single_move_extension")
+				loaded.single_move_extension = (int)value;
+			else if (name == "pass_extension")
+				loaded.is_pass_extended = value != 0.0;
+			else
+				return false;
+		}
+
+		if (!stream.eof())
+			return false;
+
+		//延長量が奇数だと偶奇がずれ、負の割り算は削減量を決められないので信用しない
+		if (loaded.divisor <= 0.0 || loaded.min_depth < 0 || loaded.min_move_index < 0 ||
+			loaded.single_move_extension < 0 || loaded.single_move_extension % 2 != 0)
+			return false;
+
+		SetParameters(loaded);
+		return true;
+	}
+
+	bool ReductionTable::Save(const std::string& path) const
+	{
+		std::ofstream stream(path);
+		if (!stream)
+			return false;
+
+		stream << "min_depth " << parameters.min_depth << '\n'
+			<< "min_move_index " << parameters.min_move_index << '\n'
+			<< "base " << parameters.base << '\n'
+			<< "divisor " << parameters.divisor << '\n'
+			<< "single_move_extension " << parameters.single_move_extension << '\n'
+			<< "pass_extension " << (parameters.is_pass_extended ? 1 : 0) << '\n';
+
+		return static_cast<bool>(stream);
+	}
+}
@@ -0,0 +1,150 @@
+#include "../include/ReductionTuner.h"
+#include "../include/ReversiBenchmark.h"
+#include "../include/ReversiEngine.h"
+#include <format>
+#include <iostream>
+#include <random>
+
+namespace Reversi
+{
+	ReductionTuner::ReductionTuner(const int game_count, const int milliseconds) :
+		game_count(std::max(game_count, 2)),
+		time_limit(std::max(milliseconds, 1))
+	{
+
+	}
+
+	double ReductionTuner::MatchResult::GetScore() const
+	{
+		int game_count = wins + draws + losses;
+		return game_count != 0 ? (wins + draws * 0.5) / game_count : 0.0;
+	}
+
+	double ReductionTuner::MatchResult::GetAverageDepth(const int index) const
+	{
+		return depth_sum[index] / (double)std::max(move_counts[index], 1);
+	}
+
+	ReductionTuner::MatchResult ReductionTuner::PlayMatch(const std::shared_ptr<const ReductionTable>& candidate, const std::shared_ptr<const ReductionTable>& opponent) const
+	{
+		//対局用のエンジンと同じパラメータで探索する
+		std::shared_ptr<ProbCutTable> probcut_table = std::make_shared<ProbCutTable>();
+		probcut_table->Load(ReversiEngine::PROBCUT_FILE);
+		std::shared_ptr<EvaluationWeights> weights = std::make_shared<EvaluationWeights>();
+		weights->Load(ReversiEngine::EVALUATION_FILE);
+
+		SearchSystem search_systems[2];
+		for (int i = 0; i < 2; ++i)
+		{
+			search_systems[i].SetProbCut(probcut_table, 2);
+			search_systems[i].SetEvaluationWeights(weights);
+			search_systems[i].SetReductions(i == 0 ? candidate : opponent);
+		}
+
+		MatchResult result;
+		Board board;
+
+		for (int game = 0; game < game_count; ++game)
+		{
+			//2局ごとに同じ序盤を使い、先後を入れ替える
+			std::mt19937 rand_module(game / 2);
+			Side candidate_side = game % 2 == 0 ? Side::Black : Side::White;
+			Side side = Side::Black;
+			board.Reset();
+
+			for (int ply = 0;; ++ply)
+			{
+				Side other = GetOpponentSide(side);
+				u64 legal_moves = board.GetLegalMoves(side);
+
+				if (legal_moves == 0ull)
+				{
+					if (board.GetLegalMoves(other) == 0ull)
+						break;
+
+					side = other;
+					continue;
+				}
+
+				u64 input;
+				if (ply < RANDOM_PLIES)
+				{
+					for (int skip = (int)(rand_module() % PopCount(legal_moves)); skip > 0; --skip)
+					{
+						legal_moves = ResetLowestBit(legal_moves);
+					}
+					input = LowestBit(legal_moves);
+				}
+				else
+				{
+					int index = side == candidate_side ? 0 : 1;
+					int reached_depth = 0;
+					search_systems[index].ResetNodeCount();
+
+					auto start = std::chrono::steady_clock::now();
+					input = ReversiBenchmark::SearchWithTimeLimit(search_systems[index], board.GetPosition(side), time_limit, reached_depth);
+					result.seconds[index] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+					result.nodes[index] += search_systems[index].GetNodeCount();
+					result.depth_sum[index] += reached_depth;
+					++result.move_counts[index];
+				}
+
+				board.Set(input, side);
+				board.Flip(input, side);
+				side = other;
+			}
+
+			std::pair<int, int> counts = board.CountStone();
+			int difference = candidate_side == Side::Black ? counts.first - counts.second : counts.second - counts.first;
+			result.wins += difference > 0;
+			result.draws += difference == 0;
+			result.losses += difference < 0;
+		}
+
+		return result;
+	}
+
+	void ReductionTuner::Run(ReductionTable& table) const
+	{
+		ReductionParameters best_parameters = table.GetParameters();
+		double best_score = -1.0;
+		double best_gain = 0.0;
+
+		std::wcout << std::format(L"[Tuning] Reductions vs no reductions, {} games per candidate, {}ms per move", game_count, time_limit.count()) << std::endl;
+
+		for (double divisor : DIVISORS)
+		{
+			for (int min_move_index : MIN_MOVE_INDICES)
+			{
+				ReductionParameters parameters = table.GetParameters();
+				parameters.divisor = divisor;
+				parameters.min_move_index = min_move_index;
+
+				std::shared_ptr<ReductionTable> candidate = std::make_shared<ReductionTable>();
+				candidate->SetParameters(parameters);
+				MatchResult result = PlayMatch(candidate, nullptr);
+
+				double score = result.GetScore();
+				double gain = result.GetAverageDepth(0) - result.GetAverageDepth(1);
+				std::wcout << std::format(L"divisor {:.2f}, min_move_index {}: W/D/L {}/{}/{} ({:.1f}%), depth {:.2f} vs {:.2f} ({:+.2f})",
+					divisor, min_move_index, result.wins, result.draws, result.losses, score * 100.0,
+					result.GetAverageDepth(0), result.GetAverageDepth(1), gain) << std::endl;
+
+				if (score > best_score || (score == best_score && gain > best_gain))
+				{
+					best_parameters = parameters;
+					best_score = score;
+					best_gain = gain;
+				}
+			}
+		}
+
+		//削減しても勝てなければ、削減しない深さから始めて延長だけを残す
+		if (best_score < 0.5)
+			best_parameters.min_depth = ReductionTable::MAX_DEPTH + 1;
+
+		table.SetParameters(best_parameters);
+		std::wcout << std::format(L"Selected: divisor {:.2f}, min_move_index {}, min_depth {} ({:.1f}%)",
+			best_parameters.divisor, best_parameters.min_move_index, best_parameters.min_depth, best_score * 100.0) << std::endl;
+	}
+}
@@ -0,0 +1,223 @@
+#include "../include/ReversiApi.h"
+#include "../include/ReversiEngine.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+using namespace Reversi;
+
+/// <summary>
+/// C APIのエンジン1つ分。探索は呼び出したスレッドで行い、時間の上限は見張りのスレッドが中断させる
+/// </summary>
+struct reversi_engine
+{
+	std::shared_ptr<Board> board;
+	std::unique_ptr<ReversiEngine> engine;
+	Side side = Side::Black;
+	int default_selectivity = 0;
+
+	//探索と盤面の設定を順に処理する
+	std::mutex search_mutex;
+
+	//呼ばれた探索の数と、中断させた時点でのその数(番号がこれより小さい探索は始まる前でも中断する)
+	std::atomic<u64> search_calls{ 0 };
+	std::atomic<u64> cancelled_calls{ 0 };
+
+	//時間の上限の見張り
+	std::mutex timer_mutex;
+	std::condition_variable timer_condition;
+	std::chrono::steady_clock::time_point deadline;
+	bool has_deadline = false;
+	bool is_destroying = false;
+	std::thread timer;
+
+	void RunTimer()
+	{
+		std::unique_lock<std::mutex> lock(timer_mutex);
+
+		while (!is_destroying)
+		{
+			if (!has_deadline)
+			{
+				timer_condition.wait(lock);
+				continue;
+			}
+
+			//期限が変わったか消されたら待ち直す
+			std::chrono::steady_clock::time_point current = deadline;
+			if (timer_condition.wait_until(lock, current) == std::cv_status::timeout && has_deadline && deadline == current)
+			{
+				engine->RequestStop();
+				has_deadline = false;
+			}
+		}
+	}
+
+	//今までに呼ばれた探索をすべて中断させる
+	void Cancel()
+	{
+		u64 calls = search_calls.load();
+		u64 cancelled = cancelled_calls.load();
+
+		//同時に中断させても、大きい方の数を残す
+		while (cancelled < calls && !cancelled_calls.compare_exchange_weak(cancelled, calls))
+		{
+		}
+
+		engine->RequestStop();
+	}
+
+	void SetDeadline(const bool is_enabled, const std::chrono::steady_clock::time_point time)
+	{
+		{
+			std::lock_guard<std::mutex> lock(timer_mutex);
+			has_deadline = is_enabled;
+			deadline = time;
+		}
+		timer_condition.notify_all();
+	}
+};
+
+extern "C"
+{
+	uint32_t reversi_api_version(void)
+	{
+		return REVERSI_API_VERSION;
+	}
+
+	reversi_engine* reversi_engine_create(int32_t thread_count, int32_t table_megabytes)
+	{
+		try
+		{
+			std::unique_ptr<reversi_engine> handle = std::make_unique<reversi_engine>();
+			handle->board = std::make_shared<Board>();
+			handle->engine = std::make_unique<ReversiEngine>(handle->board);
+			handle->default_selectivity = handle->engine->GetSelectivity();
+
+			if (thread_count > 0)
+				handle->engine->SetThreadCount(thread_count);
+			if (table_megabytes > 0)
+				handle->engine->SetTranspositionTableSize((size_t)table_megabytes);
+
+			handle->timer = std::thread(&reversi_engine::RunTimer, handle.get());
+			return handle.release();
+		}
+		catch (...)
+		{
+			return nullptr;
+		}
+	}
+
+	void reversi_engine_destroy(reversi_engine* engine)
+	{
+		if (engine == nullptr)
+			return;
+
+		//探索を止めてから見張りを終わらせる
+		engine->Cancel();
+		{
+			std::lock_guard<std::mutex> lock(engine->search_mutex);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(engine->timer_mutex);
+			engine->is_destroying = true;
+		}
+		engine->timer_condition.notify_all();
+		engine->timer.join();
+
+		delete engine;
+	}
+
+	reversi_status reversi_engine_set_position(reversi_engine* engine, uint64_t black, uint64_t white, reversi_side side_to_move)
+	{
+		if (engine == nullptr || (black & white) != 0ull || (side_to_move != REVERSI_BLACK && side_to_move != REVERSI_WHITE))
+			return REVERSI_INVALID_ARGUMENT;
+
+		std::lock_guard<std::mutex> lock(engine->search_mutex);
+		engine->board->SetFieldData({ black, white });
+		engine->side = side_to_move == REVERSI_WHITE ? Side::White : Side::Black;
+		return REVERSI_OK;
+	}
+
+	reversi_status reversi_engine_search(reversi_engine* engine, const reversi_limits* limits, reversi_result* result)
+	{
+		if (engine == nullptr || limits == nullptr || result == nullptr)
+			return REVERSI_INVALID_ARGUMENT;
+
+		//待っている間に中断されたかを知るため、ロックを取る前に番号を取る
+		u64 call = engine->search_calls.fetch_add(1);
+
+		try
+		{
+			std::lock_guard<std::mutex> lock(engine->search_mutex);
+			ReversiEngine& search_engine = *engine->engine;
+			auto start = std::chrono::steady_clock::now();
+			*result = { -1, 0, 0, 1, 0, 0.0 };
+
+			//前の探索の中断フラグを消してから確かめるので、この後に届いた中断は探索を止める
+			search_engine.ClearStopRequest();
+			if (call < engine->cancelled_calls.load())
+				return REVERSI_CANCELLED;
+
+			u64 legal_moves = engine->board->GetLegalMoves(engine->side);
+			if (legal_moves == 0ull)
+				return engine->board->GetLegalMoves(GetOpponentSide(engine->side)) == 0ull ? REVERSI_GAME_OVER : REVERSI_OK;
+
+			//時間切れの時に返せるよう、最初の合法手を入れておく
+			result->move = std::countr_zero(legal_moves);
+			result->is_complete = 0;
+
+			search_engine.SetEvaluateSide(engine->side);
+			search_engine.SetSelectivity(limits->selectivity >= 0 ? limits->selectivity : engine->default_selectivity);
+
+			if (limits->time_limit_ms > 0)
+				engine->SetDeadline(true, start + std::chrono::milliseconds(limits->time_limit_ms));
+
+			//空きマスより深く読んでも結果は変わらない(終盤は空きマスの深さで完全読みになる)
+			int empties = 64 - std::popcount(engine->board->GetAllBoard());
+			int max_depth = std::min(std::max(limits->max_depth, 1), empties);
+
+			for (int depth = 1; depth <= max_depth; ++depth)
+			{
+				search_engine.SetSearchDepth(depth);
+				u64 best_move = search_engine.MakeBestMove();
+				SearchProgress progress = search_engine.GetProgress();
+				result->nodes += progress.nodes;
+
+				//中断された深さの結果は使わない
+				if (search_engine.IsStopRequested() || best_move == 0ull)
+					break;
+
+				result->move = std::countr_zero(best_move);
+				result->score = progress.best.Score;
+				result->depth = depth;
+				result->is_complete = depth == max_depth ? 1 : 0;
+			}
+
+			engine->SetDeadline(false, start);
+			search_engine.ClearStopRequest();
+			result->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			return result->depth == 0 ? REVERSI_CANCELLED : REVERSI_OK;
+		}
+		catch (...)
+		{
+			engine->SetDeadline(false, std::chrono::steady_clock::now());
+			return REVERSI_INTERNAL_ERROR;
+		}
+	}
+
+	void reversi_engine_cancel(reversi_engine* engine)
+	{
+		if (engine != nullptr)
+			engine->Cancel();
+	}
+
+	uint64_t reversi_legal_moves(uint64_t player, uint64_t opponent)
+	{
+		return Position::ComputeLegalMoves(player, opponent);
+	}
+}
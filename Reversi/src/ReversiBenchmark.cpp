@@ -1,45 +1,1711 @@
 #include "../include/ReversiBenchmark.h"
+#include "../include/CpuTopology.h"
+#include "../include/ProofNumberSearch.h"
+#include "../include/ReductionTuner.h"
+#include "../include/ReversiEngine.h"
+#include "../include/SearchTrace.h"
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <future>
 
 namespace Reversi
 {
 	void ReversiBenchmark::Start()
 	{
-		start = std::chrono::system_clock::now();
+		start = std::chrono::steady_clock::now();
 	}
 
 	void ReversiBenchmark::End()
 	{
-		end = std::chrono::system_clock::now();
-
-		double elapsed = static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() / 1000.0);
-		milliseconds.emplace_back(elapsed);
-		move_count++;
+		end = std::chrono::steady_clock::now();
+		move_histogram.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
 	}
 
 	void ReversiBenchmark::Clear()
 	{
-		milliseconds.clear();
-		move_count = 0;
+		move_histogram.Reset();
 	}
 
 	void ReversiBenchmark::WriteResult()
 	{
-		double sum = 0.0;
+		LatencyHistogram::Snapshot snapshot = move_histogram.GetSnapshot();
+		auto seconds = [](const u64 nanoseconds) { return (double)nanoseconds / 1e9; };
+		std::wstring str;
+
+		str += std::format(L"[Benchmark] {} moves\n", snapshot.count);
+		str += std::format(L"Ave: {:.6f}s\n", snapshot.GetMean() / 1e9);
+		str += std::format(L"Min: {:.6f}s\n", seconds(snapshot.minimum));
+		str += std::format(L"P50: {:.6f}s\n", seconds(snapshot.GetPercentile(0.5)));
+		str += std::format(L"P90: {:.6f}s\n", seconds(snapshot.GetPercentile(0.9)));
+		str += std::format(L"P99: {:.6f}s\n", seconds(snapshot.GetPercentile(0.99)));
+		str += std::format(L"Max: {:.6f}s\n", seconds(snapshot.maximum));
+
+		std::wcout << str << std::endl;
+	}
+
+	void ReversiBenchmark::CompareEvaluators(const int game_count, const int depth, const std::shared_ptr<const NeuralNetwork>& network)
+	{
+		constexpr int alpha = std::numeric_limits<int>::min();
+		constexpr int beta = std::numeric_limits<int>::max();
+		constexpr int random_plies = 8;
+
+		std::shared_ptr<Board> board = std::make_shared<Board>();
+		SearchSystem handcrafted;
+		SearchSystem neural;
+		neural.SetEvaluator(EvaluatorType::Neural, network);
+
+		if (neural.GetEvaluatorType() != EvaluatorType::Neural)
+		{
+			std::wcout << L"[Benchmark] neural network is not loaded" << std::endl;
+			return;
+		}
+
+		//評価関数ごとの探索ノード数と時間
+		u64 nodes[2] = {};
+		double seconds[2] = {};
+		int wins = 0, draws = 0, losses = 0;
+
+		for (int game = 0; game < game_count; ++game)
+		{
+			//2局ごとに同じ序盤を使い、先後を入れ替える
+			std::mt19937 rand_module(game / 2);
+			Side neural_side = game % 2 == 0 ? Side::Black : Side::White;
+			Side side = Side::Black;
+			board->Reset();
+
+			for (int ply = 0;; ++ply)
+			{
+				Side other = side == Side::Black ? Side::White : Side::Black;
+				u64 legal_moves = board->GetLegalMoves(side);
+
+				if (legal_moves == 0ull)
+				{
+					if (board->GetLegalMoves(other) == 0ull)
+						break;
+
+					side = other;
+					continue;
+				}
+
+				u64 input;
+				if (ply < random_plies)
+				{
+					std::uniform_int_distribution<int> distribution(0, std::popcount(legal_moves) - 1);
+					for (int skip = distribution(rand_module); skip > 0; --skip)
+					{
+						legal_moves &= legal_moves - 1;
+					}
+					input = legal_moves & (~legal_moves + 1);
+				}
+				else
+				{
+					int index = side == neural_side ? 1 : 0;
+					SearchSystem& search_system = side == neural_side ? neural : handcrafted;
+					search_system.ResetNodeCount();
+
+					auto start = std::chrono::steady_clock::now();
+					input = search_system.AlphaBetaSearch(board->GetPosition(side), 0, depth, alpha, beta, true).Point;
+					seconds[index] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+					nodes[index] += search_system.GetNodeCount();
+				}
+
+				board->Set(input, side);
+				board->Flip(input, side);
+				side = other;
+			}
+
+			std::pair<int, int> counts = board->CountStone();
+			int difference = neural_side == Side::Black ? counts.first - counts.second : counts.second - counts.first;
+			wins += difference > 0;
+			draws += difference == 0;
+			losses += difference < 0;
+		}
+
+		std::wstring str;
+		str += L"[Benchmark] Handcrafted vs Neural\n";
+		str += std::format(L"Handcrafted: {} nodes, {}s, {} nps\n", nodes[0], seconds[0], nodes[0] / std::max(seconds[0], 1e-9));
+		str += std::format(L"Neural: {} nodes, {}s, {} nps\n", nodes[1], seconds[1], nodes[1] / std::max(seconds[1], 1e-9));
+		str += std::format(L"Neural W/D/L: {}/{}/{} ({}%)\n", wins, draws, losses, (wins + draws * 0.5) * 100.0 / std::max(game_count, 1));
+
+		std::wcout << str << std::endl;
+	}
+
+	void ReversiBenchmark::CompareMonteCarlo(const int game_count, const int milliseconds, const int thread_count)
+	{
+		constexpr int random_plies = 8;
+		std::chrono::milliseconds time_limit(milliseconds);
+
+		MonteCarloTreeSearch monte_carlo;
+		std::shared_ptr<Board> board = std::make_shared<Board>();
+		std::wstring str = std::format(L"[Benchmark] Monte Carlo vs AlphaBeta ({}ms per move)\n", milliseconds);
+
+		//初期局面でスレッド数ごとのプレイアウト速度を計測する
+		double single_rate = 0.0;
+		for (int threads = 1;; threads = std::min(threads * 2, thread_count))
+		{
+			auto start = std::chrono::steady_clock::now();
+			monte_carlo.Search(*board, Side::Black, time_limit, threads);
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			double rate = monte_carlo.GetPlayoutCount() / std::max(seconds, 1e-9);
+			single_rate = threads == 1 ? rate : single_rate;
+			str += std::format(L"{} threads: {} playouts/s (x{}), {} nodes\n", threads, rate, rate / std::max(single_rate, 1e-9), monte_carlo.GetNodeCount());
+
+			if (threads >= thread_count)
+				break;
+		}
+
+		SearchSystem alpha_beta;
+		alpha_beta.SetProbCut(std::make_shared<ProbCutTable>(), 2);
+
+		u64 playouts = 0;
+		u64 nodes = 0;
+		int depth_sum = 0;
+		int move_counts[2] = {};
+		int wins = 0, draws = 0, losses = 0;
+
+		for (int game = 0; game < game_count; ++game)
+		{
+			//2局ごとに同じ序盤を使い、先後を入れ替える
+			std::mt19937 rand_module(game / 2);
+			Side monte_carlo_side = game % 2 == 0 ? Side::Black : Side::White;
+			Side side = Side::Black;
+			board->Reset();
+
+			for (int ply = 0;; ++ply)
+			{
+				Side other = side == Side::Black ? Side::White : Side::Black;
+				u64 legal_moves = board->GetLegalMoves(side);
+
+				if (legal_moves == 0ull)
+				{
+					if (board->GetLegalMoves(other) == 0ull)
+						break;
+
+					side = other;
+					continue;
+				}
+
+				u64 input;
+				if (ply < random_plies)
+				{
+					std::uniform_int_distribution<int> distribution(0, std::popcount(legal_moves) - 1);
+					for (int skip = distribution(rand_module); skip > 0; --skip)
+					{
+						legal_moves &= legal_moves - 1;
+					}
+					input = legal_moves & (~legal_moves + 1);
+				}
+				else if (side == monte_carlo_side)
+				{
+					input = monte_carlo.Search(*board, side, time_limit, 1).Point;
+					playouts += monte_carlo.GetPlayoutCount();
+					++move_counts[0];
+				}
+				else
+				{
+					int reached_depth = 0;
+					alpha_beta.ResetNodeCount();
+					input = SearchWithTimeLimit(alpha_beta, board->GetPosition(side), time_limit, reached_depth);
+					nodes += alpha_beta.GetNodeCount();
+					depth_sum += reached_depth;
+					++move_counts[1];
+				}
+
+				board->Set(input, side);
+				board->Flip(input, side);
+				side = other;
+			}
+
+			std::pair<int, int> counts = board->CountStone();
+			int difference = monte_carlo_side == Side::Black ? counts.first - counts.second : counts.second - counts.first;
+			wins += difference > 0;
+			draws += difference == 0;
+			losses += difference < 0;
+		}
+
+		str += std::format(L"Monte Carlo: {} playouts/move\n", playouts / std::max(move_counts[0], 1));
+		str += std::format(L"AlphaBeta: {} nodes/move, depth {}\n", nodes / std::max(move_counts[1], 1), depth_sum / (double)std::max(move_counts[1], 1));
+		str += std::format(L"Monte Carlo W/D/L: {}/{}/{} ({}%)\n", wins, draws, losses, (wins + draws * 0.5) * 100.0 / std::max(game_count, 1));
+
+		std::wcout << str << std::endl;
+	}
+
+	void ReversiBenchmark::CompareReductions(const int game_count, const int milliseconds)
+	{
+		std::shared_ptr<ReductionTable> table = std::make_shared<ReductionTable>();
+		table->Load(ReversiEngine::REDUCTION_FILE);
+
+		ReductionTuner tuner(game_count, milliseconds);
+		ReductionTuner::MatchResult result = tuner.PlayMatch(table, nullptr);
+
+		std::wstring str = std::format(L"[Benchmark] Reductions vs no reductions ({}ms per move)\n", milliseconds);
+		const wchar_t* names[] = { L"Reductions", L"No reductions" };
+
+		for (int i = 0; i < 2; ++i)
+		{
+			str += std::format(L"{}: depth {:.2f}, {} nodes/move, {:.0f} nodes/s\n", names[i], result.GetAverageDepth(i),
+				result.nodes[i] / (u64)std::max(result.move_counts[i], 1), result.nodes[i] / std::max(result.seconds[i], 1e-9));
+		}
+
+		str += std::format(L"Depth gain: {:+.2f}\n", result.GetAverageDepth(0) - result.GetAverageDepth(1));
+		str += std::format(L"Reductions W/D/L: {}/{}/{} ({:.1f}%)\n", result.wins, result.draws, result.losses, result.GetScore() * 100.0);
+
+		std::wcout << str << std::endl;
+	}
+
+	void ReversiBenchmark::CompareProbCut(const int position_count, const int milliseconds)
+	{
+		constexpr int selectivities[] = { 2, 0 };
+
+		std::shared_ptr<ProbCutTable> probcut_table = std::make_shared<ProbCutTable>();
+		probcut_table->Load(ReversiEngine::PROBCUT_FILE);
+
+		//局面ごとに固定の乱数で12~41手打ち、中盤の局面を作る
+		std::vector<Position> positions;
+		for (int game = 0; (int)positions.size() < position_count; ++game)
+		{
+			std::mt19937 rand_module(game);
+			int random_plies = 12 + (int)(rand_module() % 30);
+			Board board;
+			Side side = Side::Black;
+
+			for (int ply = 0; ply < random_plies; ++ply)
+			{
+				u64 legal_moves = board.GetLegalMoves(side);
+				if (legal_moves == 0ull)
+				{
+					side = GetOpponentSide(side);
+					legal_moves = board.GetLegalMoves(side);
+					if (legal_moves == 0ull)
+						break;
+				}
+
+				for (int skip = (int)(rand_module() % PopCount(legal_moves)); skip > 0; --skip)
+				{
+					legal_moves = ResetLowestBit(legal_moves);
+				}
+
+				u64 input = LowestBit(legal_moves);
+				board.Set(input, side);
+				board.Flip(input, side);
+				side = GetOpponentSide(side);
+			}
+
+			if (board.GetLegalMoves(side) != 0ull)
+				positions.push_back(board.GetPosition(side));
+		}
+
+		std::wstring str = std::format(L"[Benchmark] ProbCut vs full width ({} positions, {}ms per position)\n", positions.size(), milliseconds);
+		std::shared_ptr<TranspositionTable> table = std::make_shared<TranspositionTable>();
+		SearchSystem search_system;
+		search_system.SetTranspositionTable(table);
+		double average_depths[2] = {};
+
+		for (int i = 0; i < 2; ++i)
+		{
+			search_system.SetProbCut(probcut_table, selectivities[i]);
+			u64 nodes = 0;
+			int depth_sum = 0;
+
+			//前の局面や選択度の結果を使わないよう、局面ごとに置換表を消す
+			for (const Position& position : positions)
+			{
+				table->Clear();
+				search_system.ResetNodeCount();
+
+				int reached_depth = 0;
+				SearchWithTimeLimit(search_system, position, std::chrono::milliseconds(milliseconds), reached_depth);
+				nodes += search_system.GetNodeCount();
+				depth_sum += reached_depth;
+			}
+
+			average_depths[i] = depth_sum / (double)std::max((int)positions.size(), 1);
+			str += std::format(L"Selectivity {}: depth {:.2f}, {} nodes/position\n", selectivities[i], average_depths[i], nodes / (u64)std::max((int)positions.size(), 1));
+		}
+
+		str += std::format(L"Depth gain: {:+.2f}\n", average_depths[0] - average_depths[1]);
+
+		std::wcout << str << std::endl;
+	}
+
+	u64 ReversiBenchmark::SearchWithTimeLimit(SearchSystem& search_system, const Position& position, const std::chrono::milliseconds time_limit, int& reached_depth)
+	{
+		constexpr int alpha = std::numeric_limits<int>::min();
+		constexpr int beta = std::numeric_limits<int>::max();
+
+		std::atomic<bool> stop_requested(false);
+		std::mutex mutex;
+		std::condition_variable condition;
+		bool is_finished = false;
+		search_system.SetStopFlag(&stop_requested);
+
+		//時間になったら中断フラグを立てる(先に探索が終われば何もしない)
+		auto deadline = std::chrono::steady_clock::now() + time_limit;
+		std::future<void> timer = std::async(std::launch::async, [&]()
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				if (!condition.wait_until(lock, deadline, [&]() { return is_finished; }))
+					stop_requested.store(true, std::memory_order_relaxed);
+			});
+
+		//空きマスより深く読んでも結果は変わらない
+		int empty_count = 64 - position.CountStones();
+		u64 best_move = position.GetLegalMoves() & (~position.GetLegalMoves() + 1);
+		reached_depth = 0;
+
+		for (int depth = 1; depth <= std::max(empty_count, 1); ++depth)
+		{
+			SearchResult result = search_system.AlphaBetaSearch(position, 0, depth, alpha, beta, true);
+
+			//中断された深さの結果は使わない
+			if (stop_requested.load(std::memory_order_relaxed))
+				break;
+
+			best_move = result.Point;
+			reached_depth = depth;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			is_finished = true;
+		}
+		condition.notify_one();
+		timer.get();
+
+		search_system.SetStopFlag(nullptr);
+		return best_move;
+	}
+
+	bool ReversiBenchmark::CompareInterleavedSearch(const int game_count, const int depth, const int slot_count, const int megabytes)
+	{
+		constexpr int alpha = std::numeric_limits<int>::min();
+		constexpr int beta = std::numeric_limits<int>::max();
+		constexpr int random_plies = 8;
+
+		std::shared_ptr<TranspositionTable> table = std::make_shared<TranspositionTable>(megabytes);
+		SearchSystem search_system;
+		search_system.SetTranspositionTable(table);
+		InterleavedSearch interleaved(table, (size_t)std::max(slot_count, 1));
+
+		std::wstring str = std::format(L"[Benchmark] Interleaved search depth {}, {} slots, {}MB table\n", depth, slot_count, megabytes);
+
+		//局ごとに固定の乱数で序盤を打つ(終局したらtrue)
+		auto play_random = [](Board& board, Side& side, const int game)
+			{
+				std::mt19937 rand_module(game);
+				board.Reset();
+				side = Side::Black;
+
+				for (int ply = 0; ply < random_plies; ++ply)
+				{
+					u64 legal_moves = board.GetLegalMoves(side);
+					if (legal_moves == 0ull)
+						return true;
+
+					for (int skip = (int)(rand_module() % PopCount(legal_moves)); skip > 0; --skip)
+					{
+						legal_moves = ResetLowestBit(legal_moves);
+					}
+
+					u64 input = LowestBit(legal_moves);
+					board.Set(input, side);
+					board.Flip(input, side);
+					side = GetOpponentSide(side);
+				}
+
+				return false;
+			};
+
+		//打てなければパスし、両者とも打てなければ終局(trueを返す)
+		auto skip_pass = [](const Board& board, Side& side)
+			{
+				if (board.GetLegalMoves(side) != 0ull)
+					return false;
+
+				side = GetOpponentSide(side);
+				return board.GetLegalMoves(side) == 0ull;
+			};
+
+		//同じ局面を両方で探索し、評価値が一致することを確かめる(最善手は置換表の内容で同点の手が入れ替わり得る)
+		std::vector<Position> positions;
+		for (int game = 0; (int)positions.size() < std::max(slot_count, 1) * 4; ++game)
+		{
+			Board board;
+			Side side;
+			if (!play_random(board, side, game) && !skip_pass(board, side))
+				positions.push_back(board.GetPosition(side));
+		}
+
+		std::vector<int> expected(positions.size());
+		for (size_t i = 0; i < positions.size(); ++i)
+		{
+			expected[i] = search_system.AlphaBetaSearch(positions[i], 0, depth, alpha, beta, true).Score;
+		}
+
+		table->Clear();
+		bool is_matched = true;
+		size_t next = 0;
+		u64 tag;
+		SearchResult result;
+
+		while (next < positions.size() && interleaved.Add(positions[next], depth, next))
+		{
+			++next;
+		}
+		while (interleaved.RunUntilComplete(tag, result))
+		{
+			is_matched = is_matched && result.Score == expected[tag];
+			if (next < positions.size() && interleaved.Add(positions[next], depth, next))
+				++next;
+		}
+		str += std::format(L"{} positions: {}\n", positions.size(), is_matched ? L"scores match" : L"MISMATCH");
+
+		//1局ずつ再帰で探索する
+		table->Clear();
+		search_system.ResetNodeCount();
+		u64 recursive_moves = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for (int game = 0; game < game_count; ++game)
+		{
+			Board board;
+			Side side;
+			if (play_random(board, side, game))
+				continue;
+
+			while (!skip_pass(board, side))
+			{
+				u64 input = search_system.AlphaBetaSearch(board.GetPosition(side), 0, depth, alpha, beta, true).Point;
+				board.Set(input, side);
+				board.Flip(input, side);
+				side = GetOpponentSide(side);
+				++recursive_moves;
+			}
+		}
+		double recursive_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		//すべての局を同時に進め、探索が終わった局から次の手を入れる
+		table->Clear();
+		interleaved.ResetNodeCount();
+		u64 interleaved_moves = 0;
+		std::vector<Board> boards(game_count);
+		std::vector<Side> sides(game_count);
+		int started = 0;
+
+		start = std::chrono::steady_clock::now();
+		auto start_game = [&]()
+			{
+				while (started < game_count)
+				{
+					int game = started++;
+					if (!play_random(boards[game], sides[game], game) && !skip_pass(boards[game], sides[game]))
+					{
+						interleaved.Add(boards[game].GetPosition(sides[game]), depth, game);
+						return;
+					}
+				}
+			};
+
+		for (int i = 0; i < slot_count; ++i)
+		{
+			start_game();
+		}
+
+		while (interleaved.RunUntilComplete(tag, result))
+		{
+			Board& board = boards[tag];
+			Side& side = sides[tag];
+			board.Set(result.Point, side);
+			board.Flip(result.Point, side);
+			side = GetOpponentSide(side);
+			++interleaved_moves;
+
+			if (skip_pass(board, side))
+				start_game();
+			else
+				interleaved.Add(board.GetPosition(side), depth, tag);
+		}
+		double interleaved_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		auto games_per_hour = [game_count](const double seconds) { return game_count * 3600.0 / std::max(seconds, 1e-9); };
+		str += std::format(L"Recursive: {:.1f} games/hour, {} moves, {:.1f} nodes/s\n", games_per_hour(recursive_seconds), recursive_moves,
+			search_system.GetNodeCount() / std::max(recursive_seconds, 1e-9));
+		str += std::format(L"Interleaved: {:.1f} games/hour, {} moves, {:.1f} nodes/s\n", games_per_hour(interleaved_seconds), interleaved_moves,
+			interleaved.GetNodeCount() / std::max(interleaved_seconds, 1e-9));
+		str += std::format(L"Speedup: x{:.3f}\n", recursive_seconds / std::max(interleaved_seconds, 1e-9));
+
+		std::wcout << str << std::endl;
+		return is_matched;
+	}
+
+	bool ReversiBenchmark::CompareSearchCache(const int position_count, const int depth, const std::string& path, const int megabytes)
+	{
+		constexpr int alpha = std::numeric_limits<int>::min();
+		constexpr int beta = std::numeric_limits<int>::max();
+		const u64 fingerprint = SearchCache::ComputeFingerprint({});
+
+		//序盤をランダムに打って局面を作る
+		auto make_positions = [position_count](const unsigned int seed)
+			{
+				std::mt19937 rand_module(seed);
+				std::vector<Position> positions;
+				Board board;
+
+				while ((int)positions.size() < position_count)
+				{
+					board.Reset();
+					Side side = Side::Black;
+					int plies = 8 + (int)(rand_module() % 20);
+
+					for (int ply = 0; ply < plies; ++ply)
+					{
+						u64 legal_moves = board.GetLegalMoves(side);
+						if (legal_moves == 0ull)
+							break;
+
+						for (int skip = (int)(rand_module() % PopCount(legal_moves)); skip > 0; --skip)
+						{
+							legal_moves = ResetLowestBit(legal_moves);
+						}
+
+						u64 input = LowestBit(legal_moves);
+						board.Set(input, side);
+						board.Flip(input, side);
+						side = GetOpponentSide(side);
+					}
+
+					if (board.GetLegalMoves(side) != 0ull)
+						positions.emplace_back(board.GetPosition(side));
+				}
+
+				return positions;
+			};
+
+		//局面ごとに1から反復深化し、すべての局面で各深さを探索し終えるまでの時間を足し合わせる
+		auto measure = [depth](const std::vector<Position>& positions, const std::shared_ptr<TranspositionTable>& table)
+			{
+				SearchSystem search_system;
+				search_system.SetTranspositionTable(table);
+				std::vector<double> milliseconds(depth + 1, 0.0);
+
+				for (const Position& position : positions)
+				{
+					table->NewSearch();
+					auto start = std::chrono::steady_clock::now();
+
+					for (int d = 1; d <= depth; ++d)
+					{
+						search_system.AlphaBetaSearch(position, 0, d, alpha, beta, true);
+						milliseconds[d] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+					}
+				}
+
+				return milliseconds;
+			};
+
+		std::vector<Position> repeated = make_positions(42);
+		std::vector<Position> fresh = make_positions(4242);
+		std::wstring str = std::format(L"[Benchmark] Search cache depth {}, {} positions, {}MB table\n", depth, position_count, megabytes);
+
+		//起動直後: 空の表で探索してから保存する
+		std::shared_ptr<TranspositionTable> cold_table = std::make_shared<TranspositionTable>(megabytes);
+		std::vector<double> cold_repeated = measure(repeated, cold_table);
+
+		SearchCache writer;
+		auto start = std::chrono::steady_clock::now();
+		bool is_saved = writer.Save(path, *cold_table, fingerprint);
+		double save_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		writer.Close();
+		cold_table.reset();
+
+		if (!is_saved)
+		{
+			std::wcout << L"cannot write search cache" << std::endl;
+			return false;
+		}
+
+		std::vector<double> cold_fresh = measure(fresh, std::make_shared<TranspositionTable>(megabytes));
+
+		//再起動後: 開くのは見出しを確かめるだけで、読み込みは別に計る
+		auto restart = [&](std::vector<double>& result, const std::vector<Position>& positions, double& open_time, double& load_time, size_t& imported)
+			{
+				std::shared_ptr<TranspositionTable> table = std::make_shared<TranspositionTable>(megabytes);
+				SearchCache cache;
+				u64 corrupted_chunks = 0;
+
+				auto begin = std::chrono::steady_clock::now();
+				bool is_opened = cache.Open(path, fingerprint);
+				auto opened = std::chrono::steady_clock::now();
+				imported = cache.LoadTranspositionTable(*table, corrupted_chunks);
+				auto loaded = std::chrono::steady_clock::now();
+
+				open_time = std::chrono::duration<double, std::milli>(opened - begin).count();
+				load_time = std::chrono::duration<double, std::milli>(loaded - opened).count();
+				result = measure(positions, table);
+				return is_opened && corrupted_chunks == 0;
+			};
+
+		std::vector<double> warm_repeated, warm_fresh;
+		double open_time, load_time;
+		size_t imported;
+		bool is_valid = restart(warm_repeated, repeated, open_time, load_time, imported);
+		is_valid &= restart(warm_fresh, fresh, open_time, load_time, imported);
+
+		str += std::format(L"Save: {:.1f}ms ({} bytes)\n", save_time, std::filesystem::file_size(path));
+		str += std::format(L"Attach: {:.3f}ms, load: {:.1f}ms ({} entries)\n", open_time, load_time, imported);
+		str += L"depth: same positions cold/warm (ms) | new positions cold/warm (ms)\n";
+
+		for (int d = 1; d <= depth; ++d)
+		{
+			str += std::format(L"{}: {:.1f} / {:.1f} (x{:.2f}) | {:.1f} / {:.1f} (x{:.2f})\n", d,
+				cold_repeated[d], warm_repeated[d], cold_repeated[d] / std::max(warm_repeated[d], 1e-9),
+				cold_fresh[d], warm_fresh[d], cold_fresh[d] / std::max(warm_fresh[d], 1e-9));
+		}
+
+		//壊れた塊は読み込まず、パラメータが変わったファイルや切り詰められたファイルは開かない
+		{
+			std::fstream stream(path, std::ios::binary | std::ios::in | std::ios::out);
+			stream.seekp((std::streamoff)(std::filesystem::file_size(path) / 2));
+			stream.put('\x5A');
+		}
+
+		SearchCache cache;
+		TranspositionTable table(megabytes);
+		u64 corrupted_chunks = 0;
+		bool is_corruption_detected = cache.Open(path, fingerprint) && (cache.LoadTranspositionTable(table, corrupted_chunks), corrupted_chunks == 1);
+		bool is_stale_rejected = !cache.Open(path, fingerprint + 1);
+		cache.Close();
+
+		std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+		bool is_truncation_rejected = !cache.Open(path, fingerprint);
+		cache.Close();
+		std::filesystem::remove(path);
+
+		str += std::format(L"Integrity: corrupted chunk {}, stale parameters {}, truncated file {}",
+			is_corruption_detected ? L"skipped" : L"NOT DETECTED", is_stale_rejected ? L"rejected" : L"ACCEPTED", is_truncation_rejected ? L"rejected" : L"ACCEPTED");
+
+		std::wcout << str << std::endl;
+		return is_valid && is_corruption_detected && is_stale_rejected && is_truncation_rejected;
+	}
+
+	bool ReversiBenchmark::CompareSearchTrace(const int position_count, const int depth, const std::string& path)
+	{
+		std::shared_ptr<Board> plain_board = std::make_shared<Board>();
+		std::shared_ptr<Board> traced_board = std::make_shared<Board>();
+		ReversiEngine plain(plain_board);
+		ReversiEngine traced(traced_board);
+		plain.SetSearchDepth(depth);
+		traced.SetSearchDepth(depth);
+
+		//両方のエンジンが同じ局面を探索し、同じ手を返すことを確かめる
+		auto search = [](ReversiEngine& engine, std::shared_ptr<Board>& target, const Board& board, const Side side, const bool is_traced, double& seconds)
+			{
+				*target = board;
+				engine.SetEvaluateSide(side);
+				SearchTrace::Enable(is_traced);
+
+				auto start = std::chrono::steady_clock::now();
+				u64 best_move = engine.MakeBestMove();
+				seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+				SearchTrace::Enable(false);
+				return best_move;
+			};
+
+		SearchTrace::Clear();
+		std::mt19937 rand_module(42);
+		double plain_seconds = 0.0;
+		double traced_seconds = 0.0;
+		int mismatch_count = 0;
+
+		for (int i = 0; i < position_count; ++i)
+		{
+			//序盤をランダムに打って局面を作る
+			Board board;
+			Side side = Side::Black;
+			int plies = 8 + (int)(rand_module() % 20);
+
+			for (int ply = 0; ply < plies; ++ply)
+			{
+				u64 legal_moves = board.GetLegalMoves(side);
+				if (legal_moves == 0ull)
+					break;
+
+				for (int skip = (int)(rand_module() % PopCount(legal_moves)); skip > 0; --skip)
+				{
+					legal_moves = ResetLowestBit(legal_moves);
+				}
+
+				u64 input = LowestBit(legal_moves);
+				board.Set(input, side);
+				board.Flip(input, side);
+				side = GetOpponentSide(side);
+			}
+
+			if (board.GetLegalMoves(side) == 0ull)
+				continue;
+
+			//先に探索する方が有利にならないよう、局面ごとに順を入れ替える
+			u64 plain_move, traced_move;
+			if (i % 2 == 0)
+			{
+				plain_move = search(plain, plain_board, board, side, false, plain_seconds);
+				traced_move = search(traced, traced_board, board, side, true, traced_seconds);
+			}
+			else
+			{
+				traced_move = search(traced, traced_board, board, side, true, traced_seconds);
+				plain_move = search(plain, plain_board, board, side, false, plain_seconds);
+			}
+
+			if (plain_move != traced_move)
+				++mismatch_count;
+		}
+
+		bool is_exported = SearchTrace::Export(path);
+
+		std::wstring str = std::format(L"[Benchmark] Search trace depth {}, {} positions\n", depth, position_count);
+		str += std::format(L"Disabled: {:.3f} s\n", plain_seconds);
+		str += std::format(L"Enabled: {:.3f} s\n", traced_seconds);
+		str += std::format(L"Overhead: {:.2f} %\n", (traced_seconds / std::max(plain_seconds, 1e-9) - 1.0) * 100.0);
+		str += std::format(L"Best move mismatches: {}\n", mismatch_count);
+		str += is_exported ? std::format(L"Trace: {}\n", std::wstring(path.begin(), path.end())) : std::wstring(L"cannot write trace\n");
+
+		std::wcout << str << std::endl;
+		return is_exported;
+	}
+
+	void ReversiBenchmark::RunParallelScaling(const int position_count, const int depth, const int max_threads)
+	{
+		//序盤をランダムに打って局面を作る
+		std::mt19937 rand_module(42);
+		std::vector<std::pair<Board, Side>> positions;
+
+		while ((int)positions.size() < position_count)
+		{
+			Board board;
+			Side side = Side::Black;
+			int plies = 8 + (int)(rand_module() % 20);
+
+			for (int ply = 0; ply < plies; ++ply)
+			{
+				u64 legal_moves = board.GetLegalMoves(side);
+				if (legal_moves == 0ull)
+					break;
+
+				for (int skip = (int)(rand_module() % PopCount(legal_moves)); skip > 0; --skip)
+				{
+					legal_moves = ResetLowestBit(legal_moves);
+				}
+
+				u64 input = LowestBit(legal_moves);
+				board.Set(input, side);
+				board.Flip(input, side);
+				side = GetOpponentSide(side);
+			}
+
+			if (board.GetLegalMoves(side) != 0ull)
+				positions.emplace_back(board, side);
+		}
+
+		std::vector<int> thread_counts;
+		for (int count = 1; count < max_threads; count *= 2)
+		{
+			thread_counts.push_back(count);
+		}
+		thread_counts.push_back(std::clamp(max_threads, 1, 64));
+
+		std::wstring str = std::format(L"[Benchmark] Parallel scaling depth {}, {} positions\n", depth, position_count);
+		str += L"threads: seconds, speedup, efficiency, nodes, overhead, nodes/s, busy, idle, dispatch wait, result wait, best move changes\n";
+		std::wstring thread_str;
+		double serial_seconds = 0.0;
+		u64 serial_nodes = 0;
+		std::vector<u64> serial_moves;
+
+		for (int thread_count : thread_counts)
+		{
+			//スレッド数ごとに空の置換表から始める
+			std::shared_ptr<Board> board = std::make_shared<Board>();
+			ReversiEngine engine(board);
+			engine.SetThreadCount(thread_count);
+			engine.SetSearchDepth(depth);
+
+			double seconds = 0.0;
+			double wait_seconds = 0.0;
+			u64 nodes = 0;
+			int changed_count = 0;
+			std::vector<ThreadStatistics> threads(thread_count > 1 ? thread_count : 0, ThreadStatistics{});
+
+			for (size_t i = 0; i < positions.size(); ++i)
+			{
+				*board = positions[i].first;
+				engine.SetEvaluateSide(positions[i].second);
+				u64 best_move = engine.MakeBestMove();
+
+				SearchProgress progress = engine.GetProgress();
+				ParallelStatistics statistics = engine.GetParallelStatistics();
+				seconds += progress.seconds;
+				nodes += progress.nodes;
+				wait_seconds += statistics.wait_seconds;
+
+				for (size_t t = 0; t < statistics.threads.size(); ++t)
+				{
+					threads[t].root_moves += statistics.threads[t].root_moves;
+					threads[t].nodes += statistics.threads[t].nodes;
+					threads[t].busy_seconds += statistics.threads[t].busy_seconds;
+					threads[t].dispatch_seconds += statistics.threads[t].dispatch_seconds;
+				}
+
+				//1スレッドの結果を基準にする(評価値が同じ手の選び方で変わることがある)
+				if (thread_count == 1)
+					serial_moves.push_back(best_move);
+				else if (best_move != serial_moves[i])
+					++changed_count;
+			}
+
+			if (thread_count == 1)
+			{
+				serial_seconds = seconds;
+				serial_nodes = nodes;
+			}
+
+			//1スレッドは呼び出したスレッドがすべての時間を探索に使う
+			double busy_seconds = seconds;
+			double dispatch_seconds = 0.0;
+			if (!threads.empty())
+			{
+				busy_seconds = 0.0;
+				for (const ThreadStatistics& thread : threads)
+				{
+					busy_seconds += thread.busy_seconds;
+					dispatch_seconds += thread.dispatch_seconds;
+				}
+			}
+
+			double capacity = std::max(seconds * thread_count, 1e-9);
+			double speedup = serial_seconds / std::max(seconds, 1e-9);
+
+			str += std::format(L"{}: {:.3f} s, x{:.2f}, {:.1f} %, {}, {:+.1f} %, {:.0f}, {:.1f} %, {:.1f} %, {:.1f} ms, {:.1f} %, {}\n",
+				thread_count, seconds, speedup, speedup / thread_count * 100.0, nodes,
+				((double)nodes / std::max((double)serial_nodes, 1.0) - 1.0) * 100.0, nodes / std::max(seconds, 1e-9),
+				busy_seconds / capacity * 100.0, (1.0 - busy_seconds / capacity) * 100.0, dispatch_seconds * 1000.0,
+				wait_seconds / std::max(seconds, 1e-9) * 100.0, changed_count);
+
+			//スレッドごとの偏りを見る
+			for (size_t t = 0; t < threads.size(); ++t)
+			{
+				const ThreadStatistics& thread = threads[t];
+				thread_str += std::format(L"{} threads #{}: {} moves, {} nodes, busy {:.1f} %, dispatch wait {:.2f} ms\n",
+					thread_count, t, thread.root_moves, thread.nodes, thread.busy_seconds / std::max(seconds, 1e-9) * 100.0, thread.dispatch_seconds * 1000.0);
+			}
+		}
+
+		std::wcout << str << thread_str << std::endl;
+	}
+
+	void ReversiBenchmark::CompareHardwarePolicy(const int position_count, const int depth, const int thread_count, const int megabytes, const HardwarePolicy& policy)
+	{
+		//序盤をランダムに打って局面を作る
+		std::mt19937 rand_module(42);
+		std::vector<std::pair<Board, Side>> positions;
+
+		while ((int)positions.size() < position_count)
+		{
+			Board board;
+			Side side = Side::Black;
+			int plies = 8 + (int)(rand_module() % 20);
+
+			for (int ply = 0; ply < plies; ++ply)
+			{
+				u64 legal_moves = board.GetLegalMoves(side);
+				if (legal_moves == 0ull)
+					break;
+
+				for (int skip = (int)(rand_module() % PopCount(legal_moves)); skip > 0; --skip)
+				{
+					legal_moves = ResetLowestBit(legal_moves);
+				}
+
+				u64 input = LowestBit(legal_moves);
+				board.Set(input, side);
+				board.Flip(input, side);
+				side = GetOpponentSide(side);
+			}
+
+			if (board.GetLegalMoves(side) != 0ull)
+				positions.emplace_back(board, side);
+		}
+
+		/// <summary>
+		/// 1つの配置で計測した合計
+		/// </summary>
+		struct Measurement
+		{
+			double seconds = 0.0;
+			u64 nodes = 0;
+			size_t huge_page_bytes = 0;
+		};
+
+		//配置ごとに空の置換表から始める
+		auto measure = [&positions, depth, thread_count, megabytes](const HardwarePolicy& target, Measurement& measurement)
+			{
+				std::shared_ptr<Board> board = std::make_shared<Board>();
+				ReversiEngine engine(board);
+				engine.SetTranspositionTableSize((size_t)megabytes);
+				engine.SetThreadCount(thread_count);
+				engine.SetSearchDepth(depth);
+				if (target != HardwarePolicy())
+					engine.SetHardwarePolicy(target);
+
+				for (const std::pair<Board, Side>& position : positions)
+				{
+					*board = position.first;
+					engine.SetEvaluateSide(position.second);
+					engine.MakeBestMove();
+
+					SearchProgress progress = engine.GetProgress();
+					measurement.seconds += progress.seconds;
+					measurement.nodes += progress.nodes;
+				}
+
+				measurement.huge_page_bytes = std::max(measurement.huge_page_bytes, engine.GetTranspositionTableHugePageBytes());
+			};
+
+		//先に計測する方が有利にならないよう、指定なし・指定あり・指定あり・指定なしの順に計測する
+		Measurement plain, placed;
+		measure(HardwarePolicy(), plain);
+		measure(policy, placed);
+		measure(policy, placed);
+		measure(HardwarePolicy(), plain);
+
+		const wchar_t* placement_names[] = { L"none", L"compact", L"spread" };
+		const wchar_t* huge_page_names[] = { L"off", L"transparent", L"explicit" };
+		const wchar_t* node_memory_names[] = { L"local", L"interleave", L"first-touch" };
+		std::string topology = CpuTopology::Get().Describe();
+
+		std::wstring str = std::format(L"[Benchmark] Hardware policy depth {}, {} positions, {} threads, {} MB table\n", depth, position_count, thread_count, megabytes);
+		str += std::format(L"Topology: {}\n", std::wstring(topology.begin(), topology.end()));
+		str += std::format(L"Policy: placement {}, huge pages {}, node memory {}\n",
+			placement_names[(int)policy.thread_placement], huge_page_names[(int)policy.huge_pages], node_memory_names[(int)policy.node_memory]);
+
+		for (const auto& [name, measurement] : { std::pair<const wchar_t*, const Measurement&>(L"Without policy", plain), std::pair<const wchar_t*, const Measurement&>(L"With policy", placed) })
+		{
+			str += std::format(L"{}: {:.3f} s, {} nodes, {:.0f} nodes/s, huge pages {} MB\n",
+				name, measurement.seconds, measurement.nodes, measurement.nodes / std::max(measurement.seconds, 1e-9), measurement.huge_page_bytes / (1024 * 1024));
+		}
+
+		double plain_speed = plain.nodes / std::max(plain.seconds, 1e-9);
+		double placed_speed = placed.nodes / std::max(placed.seconds, 1e-9);
+		str += std::format(L"Speedup: x{:.3f}\n", placed_speed / std::max(plain_speed, 1e-9));
+
+		std::wcout << str << std::endl;
+	}
+
+	bool ReversiBenchmark::CompareProofSearch(const int position_count, const int empties, const int thread_count, const int megabytes, const int seconds)
+	{
+		constexpr int alpha = std::numeric_limits<int>::min();
+		constexpr int beta = std::numeric_limits<int>::max();
+		constexpr int random_plies = 8;
+		constexpr int search_depth = 4;
+
+		//序盤をランダムに打ち、あとは浅い探索で打って指定した空きマス数の局面を作る
+		std::mt19937 rand_module(42);
+		SearchSystem search_system;
+		std::vector<Position> positions;
+
+		while ((int)positions.size() < position_count)
+		{
+			Board board;
+			Side side = Side::Black;
+
+			for (int ply = 0; 64 - PopCount(board.GetAllBoard()) > empties; ++ply)
+			{
+				u64 legal_moves = board.GetLegalMoves(side);
+				if (legal_moves == 0ull)
+				{
+					if (board.GetLegalMoves(GetOpponentSide(side)) == 0ull)
+						break;
+
+					side = GetOpponentSide(side);
+					continue;
+				}
+
+				u64 input;
+				if (ply < random_plies)
+				{
+					for (int skip = (int)(rand_module() % PopCount(legal_moves)); skip > 0; --skip)
+					{
+						legal_moves = ResetLowestBit(legal_moves);
+					}
+					input = LowestBit(legal_moves);
+				}
+				else
+				{
+					input = search_system.AlphaBetaSearch(board.GetPosition(side), 0, search_depth, alpha, beta, true).Point;
+				}
+
+				board.Set(input, side);
+				board.Flip(input, side);
+				side = GetOpponentSide(side);
+			}
+
+			if (64 - PopCount(board.GetAllBoard()) == empties && board.GetLegalMoves(side) != 0ull)
+				positions.push_back(board.GetPosition(side));
+		}
+
+		const wchar_t* outcome_names[] = { L"unknown", L"loss", L"draw", L"win" };
+		auto time_limit = std::chrono::milliseconds((long long)seconds * 1000);
+		ProofNumberSearch solver((size_t)megabytes);
+
+		std::wstring str = std::format(L"[Benchmark] Proof-number search {} empties, {} positions, {} threads, {} MB table, {} s limit\n",
+			empties, position_count, thread_count, megabytes, seconds);
+		str += std::format(L"Table: {} entries, alpha-beta below {} empties\n", solver.GetCapacity(), solver.GetAlphaBetaEmpties() + 1);
+		str += L"position: df-pn result, seconds, nodes, collections | alpha-beta result, seconds, nodes\n";
+
+		int proven_counts[2] = {};
+		double total_seconds[2] = {};
+		bool is_consistent = true;
+
+		for (size_t i = 0; i < positions.size(); ++i)
+		{
+			auto start = std::chrono::steady_clock::now();
+			ProofResult proof = solver.Solve(positions[i], time_limit, thread_count);
+			double proof_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			u64 proof_nodes = solver.GetNodeCount();
+			int collections = solver.GetCollectionCount();
+
+			start = std::chrono::steady_clock::now();
+			ProofResult reference = solver.SolveByAlphaBeta(positions[i], time_limit);
+			double reference_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			proven_counts[0] += proof.outcome != GameOutcome::Unknown;
+			proven_counts[1] += reference.outcome != GameOutcome::Unknown;
+			total_seconds[0] += proof_seconds;
+			total_seconds[1] += reference_seconds;
+
+			//両方とも読み切れば勝敗は一致しなければならない
+			if (proof.outcome != GameOutcome::Unknown && reference.outcome != GameOutcome::Unknown && proof.outcome != reference.outcome)
+				is_consistent = false;
+
+			str += std::format(L"{}: {}, {:.3f}, {}, {} | {}, {:.3f}, {}\n", i,
+				outcome_names[(int)proof.outcome], proof_seconds, proof_nodes, collections,
+				outcome_names[(int)reference.outcome], reference_seconds, solver.GetNodeCount());
+		}
+
+		str += std::format(L"Proven: df-pn {}/{} in {:.3f} s, alpha-beta {}/{} in {:.3f} s\n",
+			proven_counts[0], position_count, total_seconds[0], proven_counts[1], position_count, total_seconds[1]);
+		str += std::format(L"Consistent: {}\n", is_consistent ? L"yes" : L"NO");
+
+		std::wcout << str << std::endl;
+		return is_consistent;
+	}
+
+	void ReversiBenchmark::RunSearchBenchmark(const int depth, const int position_count, const int size)
+	{
+		switch (size)
+		{
+		case 8:
+			RunSearchBenchmarkBySize<8>(depth, position_count);
+			break;
+		case 10:
+			RunSearchBenchmarkBySize<10>(depth, position_count);
+			break;
+		default:
+			std::wcout << L"unsupported board size: " << size << std::endl;
+			break;
+		}
+	}
+
+	template <int size>
+	void ReversiBenchmark::RunSearchBenchmarkBySize(const int depth, const int position_count)
+	{
+		using Bits = typename BasicBoard<size>::Bits;
+		constexpr int alpha = std::numeric_limits<int>::min();
+		constexpr int beta = std::numeric_limits<int>::max();
+
+		//序盤をランダムに打って局面を作る(毎回同じ局面になるよう乱数は固定)
+		std::mt19937 rand_module(42);
+		std::vector<BasicPosition<size>> positions;
+		BasicBoard<size> board;
+
+		while ((int)positions.size() < position_count)
+		{
+			board.Reset();
+			Side side = Side::Black;
+			int plies = 8 + (int)(rand_module() % 20);
+			bool is_end = false;
+
+			for (int ply = 0; ply < plies && !is_end; ++ply)
+			{
+				Bits legal_moves = board.GetLegalMoves(side);
+				if (!legal_moves)
+				{
+					side = side == Side::Black ? Side::White : Side::Black;
+					legal_moves = board.GetLegalMoves(side);
+					is_end = !legal_moves;
+					if (is_end)
+						continue;
+				}
+
+				for (int skip = (int)(rand_module() % PopCount(legal_moves)); skip > 0; --skip)
+				{
+					legal_moves = ResetLowestBit(legal_moves);
+				}
+				Bits input = LowestBit(legal_moves);
+
+				board.Set(input, side);
+				board.Flip(input, side);
+				side = side == Side::Black ? Side::White : Side::Black;
+			}
+
+			if (!is_end && board.GetLegalMoves(side))
+				positions.emplace_back(board.GetPosition(side));
+		}
+
+		//ProbCutを使わない全幅探索で計測する
+		BasicSearchSystem<size> search_system;
+		long long checksum = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for (const BasicPosition<size>& position : positions)
+		{
+			BasicSearchResult<Bits> info = search_system.AlphaBetaSearch(position, Bits(0), depth, alpha, beta, true);
+			checksum += (long long)info.Score * 31 + CountTrailingZeros(info.Point);
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		u64 nodes = search_system.GetNodeCount();
+		std::wstring str;
+		str += std::format(L"[Benchmark] Search {}x{} depth {} x {} positions\n", size, size, depth, position_count);
+		str += std::format(L"Nodes: {}\n", nodes);
+		str += std::format(L"Time: {}s\n", seconds);
+		str += std::format(L"NPS: {}\n", nodes / std::max(seconds, 1e-9));
+		str += std::format(L"Checksum: {}\n", checksum);
+
+		std::wcout << str << std::endl;
+	}
+
+	void ReversiBenchmark::RunPerft(const int depth, const int size)
+	{
+		switch (size)
+		{
+		case 8:
+			RunPerftBySize<8>(depth);
+			break;
+		case 10:
+			RunPerftBySize<10>(depth);
+			break;
+		default:
+			std::wcout << L"unsupported board size: " << size << std::endl;
+			break;
+		}
+	}
+
+	template <int size>
+	void ReversiBenchmark::RunPerftBySize(const int depth)
+	{
+		BasicBoard<size> board;
+		std::wstring str = std::format(L"[Benchmark] Perft {}x{} depth {}\n", size, size, depth);
+
+		auto measure = [&str](const wchar_t* name, auto&& perft)
+			{
+				auto start = std::chrono::steady_clock::now();
+				u64 count = perft();
+				double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+				str += std::format(L"{}: {} leaves, {}s, {} leaves/s\n", name, count, seconds, count / std::max(seconds, 1e-9));
+			};
+
+		measure(L"Board (runtime side)", [&]() { return PerftDynamic(board, Side::Black, depth, false); });
+		measure(L"Board (template side)", [&]() { return PerftStatic<size, Side::Black>(board, depth, false); });
+		measure(L"Position (copy-make)", [&]() { return PerftPosition<size, FlipKernel::Shift>(board.GetPosition(Side::Black), depth, false); });
+
+		//8x8では反転位置の計算方法ごとにも数える(葉の数が一致しなければ実装が違う)
+		if constexpr (size == 8)
+		{
+			measure(L"Position (lookup flips)", [&]() { return PerftPosition<size, FlipKernel::Lookup>(board.GetPosition(Side::Black), depth, false); });
+			if (IsAvx2Supported())
+				measure(L"Position (SIMD flips)", [&]() { return PerftPosition<size, FlipKernel::Simd>(board.GetPosition(Side::Black), depth, false); });
+		}
+
+		std::wcout << str << std::endl;
+	}
+
+	namespace
+	{
+		//盤面ごとに独立した乱数(xorshift64*)
+		u64 NextRandom(u64& state)
+		{
+			state ^= state >> 12;
+			state ^= state << 25;
+			state ^= state >> 27;
+			return state * 0x2545F4914F6CDD1Dull;
+		}
+
+		//局と回ごとに異なる種(0は使えない)
+		u64 MakeSeed(const int round, const int index)
+		{
+			return ((u64)round << 32 | (u64)index) * 0x9E3779B97F4A7C15ull + 1;
+		}
+	}
+
+	bool ReversiBenchmark::RunBatchBenchmark(const int board_count, const int round_count)
+	{
+		const size_t count = (size_t)std::max(board_count, 1);
+		std::wstring str = std::format(L"[Benchmark] BoardBatch {} boards x {} rounds\n", count, round_count);
+
+		//Boardで1局ずつ打った終局面と石数
+		std::vector<Position> expected_positions(count * round_count);
+		std::vector<std::pair<int, int>> expected_counts(count * round_count);
+		u64 expected_moves = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for (int round = 0; round < round_count; ++round)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				Board board;
+				Side side = Side::Black;
+				u64 random = MakeSeed(round, (int)i);
+				bool passed = false;
+
+				while (true)
+				{
+					u64 legal_moves = board.GetLegalMoves(side);
+
+					if (legal_moves == 0ull)
+					{
+						if (passed)
+							break;
+
+						passed = true;
+						side = GetOpponentSide(side);
+						continue;
+					}
+
+					passed = false;
+					u64 input = MonteCarloTreeSearch::SelectRandomBit(legal_moves, NextRandom(random));
+					board.Set(input, side);
+					board.Flip(input, side);
+					side = GetOpponentSide(side);
+					++expected_moves;
+				}
+
+				//石数は黒番・白番ではなく終局時の手番側・相手側で比べる
+				std::pair<int, int> stones = board.CountStone();
+				expected_positions[round * count + i] = board.GetPosition(side);
+				expected_counts[round * count + i] = side == Side::Black ? stones : std::make_pair(stones.second, stones.first);
+			}
+		}
+		double board_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		str += std::format(L"Board (one by one): {} moves/s\n", expected_moves / std::max(board_seconds, 1e-9));
+
+		bool is_valid = true;
+		const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512 };
+		const wchar_t* names[] = { L"Scalar", L"AVX2", L"AVX-512" };
+
+		for (int level = 0; level < 3; ++level)
+		{
+			if (levels[level] > GetSupportedSimdLevel())
+			{
+				str += std::format(L"{}: not supported\n", names[level]);
+				continue;
+			}
+
+			BoardBatch batch(count);
+			batch.SetSimdLevel(levels[level]);
+
+			std::vector<u64> moves, inputs(count), flips, randoms(count);
+			std::vector<unsigned char> passed(count), finished(count), is_terminal;
+			std::vector<int> player_counts, opponent_counts;
+			std::vector<Position> positions(count);
+			u64 move_count = 0;
+			double kernel_seconds = 0.0;
+			bool is_matched = true;
+
+			start = std::chrono::steady_clock::now();
+			for (int round = 0; round < round_count; ++round)
+			{
+				Board initial;
+				for (size_t i = 0; i < count; ++i)
+				{
+					batch.Set(i, initial, Side::Black);
+					randoms[i] = MakeSeed(round, (int)i);
+					passed[i] = finished[i] = 0;
+				}
+
+				//すべての局が終わるまで同時に1手ずつ進める(終わった局はパスし続ける)
+				for (size_t active = count; active > 0;)
+				{
+					auto kernel_start = std::chrono::steady_clock::now();
+					batch.ComputeLegalMoves(moves);
+					kernel_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - kernel_start).count();
+
+					for (size_t i = 0; i < count; ++i)
+					{
+						inputs[i] = 0ull;
+						if (finished[i])
+							continue;
+
+						if (moves[i] == 0ull)
+						{
+							if (passed[i])
+							{
+								finished[i] = 1;
+								positions[i] = batch.GetPosition(i);
+								--active;
+							}
+
+							passed[i] = 1;
+							continue;
+						}
+
+						passed[i] = 0;
+						inputs[i] = MonteCarloTreeSearch::SelectRandomBit(moves[i], NextRandom(randoms[i]));
+						++move_count;
+					}
+
+					kernel_start = std::chrono::steady_clock::now();
+					batch.Play(inputs, flips);
+					kernel_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - kernel_start).count();
+				}
+
+				//パスし続けた局は手番が入れ替わっているので、終局時の局面に戻して数える
+				for (size_t i = 0; i < count; ++i)
+				{
+					batch.Set(i, positions[i]);
+				}
+				batch.ComputeTerminals(is_terminal);
+				batch.CountStones(player_counts, opponent_counts);
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					is_matched = is_matched && is_terminal[i] &&
+						positions[i] == expected_positions[round * count + i] &&
+						std::make_pair(player_counts[i], opponent_counts[i]) == expected_counts[round * count + i];
+				}
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			is_matched = is_matched && move_count == expected_moves;
+			is_valid = is_valid && is_matched;
+			str += std::format(L"{}: {} moves/s, kernels {} moves/s, {}\n", names[level], move_count / std::max(seconds, 1e-9),
+				move_count / std::max(kernel_seconds, 1e-9), is_matched ? L"matches Board" : L"MISMATCH");
+		}
+
+		std::wcout << str << std::endl;
+		return is_valid;
+	}
+
+	void ReversiBenchmark::RunRecordBenchmark(const int game_count, const std::string& path)
+	{
+		std::filesystem::remove(path);
+
+		GameRecordWriter writer;
+		if (!writer.Open(path))
+		{
+			std::wcout << L"cannot open record file" << std::endl;
+			return;
+		}
+
+		//ランダムに打った対局を書き出す(探索時間とノード数は大きさが実際に近くなるよう乱数で埋める)
+		std::mt19937 rand_module(42);
+		GameRecord record{};
+		record.black = { PlayerType::Engine, 6, EvaluatorType::Handcrafted };
+		record.white = { PlayerType::Engine, 6, EvaluatorType::Neural };
+		Board board;
+		u64 move_count = 0;
+		double write_seconds = 0.0;
+
+		for (int game = 0; game < game_count; ++game)
+		{
+			board.Reset();
+			record.moves.clear();
+			Side side = Side::Black;
+			bool passed = false;
+
+			while (true)
+			{
+				u64 legal_moves = board.GetLegalMoves(side);
+
+				if (legal_moves == 0ull)
+				{
+					if (passed)
+					{
+						//両者とも打てないので、直前のパスは記録しない
+						record.moves.pop_back();
+						break;
+					}
+
+					passed = true;
+					record.moves.push_back({ GameRecord::PASS_SQUARE, 0, 0 });
+					side = GetOpponentSide(side);
+					continue;
+				}
+
+				for (int skip = (int)(rand_module() % std::popcount(legal_moves)); skip > 0; --skip)
+				{
+					legal_moves &= legal_moves - 1;
+				}
+				u64 input = legal_moves & (~legal_moves + 1);
+
+				board.Set(input, side);
+				board.Flip(input, side);
+				record.moves.push_back({ (unsigned char)std::countr_zero(input), (uint32_t)(rand_module() % 200000), rand_module() % 2000000 });
+				passed = false;
+				side = GetOpponentSide(side);
+			}
+
+			std::pair<int, int> counts = board.CountStone();
+			record.black_count = (unsigned char)counts.first;
+			record.white_count = (unsigned char)counts.second;
+			move_count += record.moves.size();
+
+			auto start = std::chrono::steady_clock::now();
+			writer.Write(record);
+			write_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		writer.Close();
+		write_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		//読み直して全局を再生する
+		start = std::chrono::steady_clock::now();
+		GameRecordReader reader;
+		bool is_opened = reader.Open(path);
+		double open_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		size_t replayed = 0;
+		start = std::chrono::steady_clock::now();
+		for (size_t i = 0; is_opened && i < reader.GetCount(); ++i)
+		{
+			replayed += reader.Replay(i, board) ? 1 : 0;
+		}
+		double replay_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		double megabytes = reader.GetValidSize() / 1048576.0;
 		std::wstring str;
+		str += std::format(L"[Benchmark] Game records x {} games\n", game_count);
+		str += std::format(L"Size: {} bytes ({} bytes/game, {} moves)\n", reader.GetValidSize(), reader.GetValidSize() / (double)std::max(game_count, 1), move_count);
+		str += std::format(L"Write: {}s, {} games/s, {} MB/s\n", write_seconds, game_count / std::max(write_seconds, 1e-9), megabytes / std::max(write_seconds, 1e-9));
+		str += std::format(L"Open (checksum): {}s, {} MB/s\n", open_seconds, megabytes / std::max(open_seconds, 1e-9));
+		str += std::format(L"Replay: {} / {} games, {}s, {} moves/s\n", replayed, reader.GetCount(), replay_seconds, move_count / std::max(replay_seconds, 1e-9));
+
+		std::wcout << str << std::endl;
+	}
+
+	bool ReversiBenchmark::ReplayRecords(const std::string& path)
+	{
+		GameRecordReader reader;
+		if (!reader.Open(path))
+		{
+			std::wcout << L"cannot open record file" << std::endl;
+			return false;
+		}
+
+		Board board;
+		size_t invalid_count = 0;
+		u64 move_count = 0;
+		u64 nodes = 0;
+		double seconds = 0.0;
 
-		str += L"[Benchmark]\n";
-		for (int i = 0; i < milliseconds.size(); ++i)
+		for (size_t i = 0; i < reader.GetCount(); ++i)
 		{
-			str += std::format(L"{}: {}s\n", std::to_wstring(i), std::to_wstring(milliseconds[i]));
-			sum += milliseconds[i];
+			if (!reader.Replay(i, board))
+			{
+				++invalid_count;
+				continue;
+			}
+
+			GameRecord record = reader.Get(i);
+			move_count += record.moves.size();
+
+			for (const MoveRecord& move : record.moves)
+			{
+				nodes += move.nodes;
+				seconds += move.microseconds / 1000000.0;
+			}
 		}
 
-		str += std::format(L"Ave: {}s\n", sum / static_cast<double>(milliseconds.size()));
+		std::error_code error;
+		uintmax_t file_size = std::filesystem::file_size(path, error);
+
+		std::wstring str;
+		str += std::format(L"Games: {} ({} invalid)\n", reader.GetCount(), invalid_count);
+		str += std::format(L"Moves: {}\n", move_count);
+		str += std::format(L"Search: {} nodes, {}s\n", nodes, seconds);
 
-		auto minmax = std::minmax_element(milliseconds.begin(), milliseconds.end());
-		str += std::format(L"Min: {}s\n", *minmax.first);
-		str += std::format(L"Max: {}s\n", *minmax.second);
+		//書き込み途中で切れた末尾は読み飛ばしている
+		if (!error && file_size > reader.GetValidSize())
+			str += std::format(L"Ignored tail: {} bytes\n", file_size - reader.GetValidSize());
 
 		std::wcout << str << std::endl;
+		return invalid_count == 0;
+	}
+
+	void ReversiBenchmark::RunIndexBenchmark(const std::string& index_path, const std::string& archive_path, const int query_count)
+	{
+		PositionIndex index;
+		GameRecordReader reader;
+		if (!index.Open(index_path) || !reader.Open(archive_path) || reader.GetCount() == 0)
+		{
+			std::wcout << L"cannot open index or record file" << std::endl;
+			return;
+		}
+
+		const PositionIndex::Header& header = index.GetHeader();
+		std::mt19937 rand_module(42);
+		std::vector<double> nanoseconds;
+		nanoseconds.reserve(query_count);
+		int found_count = 0;
+		int listed_count = 0;
+		PositionStats stats;
+
+		for (int query = 0; query < query_count; ++query)
+		{
+			//局と手数を選び、その局面まで打つ(パスの直後は手番が入れ替わる)
+			size_t game = rand_module() % reader.GetCount();
+			std::span<const unsigned char> squares = reader.GetSquares(game);
+			//索引には着手する前の局面が入っているので、終局後の局面は選ばない
+			int placements = (int)std::count_if(squares.begin(), squares.end(), [](const unsigned char square) { return square != GameRecord::PASS_SQUARE; });
+			int target = (int)(rand_module() % std::max(std::min<int>(header.max_plies + 1, placements), 1));
+			Position position = Board().GetPosition(Side::Black);
+			int ply = 0;
+
+			for (unsigned char square : squares)
+			{
+				if (square == GameRecord::PASS_SQUARE)
+				{
+					position = position.Pass();
+					continue;
+				}
+
+				if (ply == target)
+					break;
+
+				u64 input = 1ull << square;
+				position = position.Play(input, position.GetFlips(input));
+				++ply;
+			}
+
+			//同じ局面として引けることを確かめるため、ランダムに回転・反転しておく
+			position = position.GetSymmetry((int)(rand_module() % Position::SYMMETRY_COUNT));
+
+			auto start = std::chrono::steady_clock::now();
+			bool is_found = index.Find(position, stats);
+			nanoseconds.emplace_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+
+			if (!is_found)
+				continue;
+
+			++found_count;
+
+			//局の位置が上限まで記録されていなければ、選んだ局が含まれているはず
+			uint32_t total = stats.wins + stats.draws + stats.losses;
+			if (total > header.max_postings || std::find(stats.game_offsets.begin(), stats.game_offsets.end(), reader.GetOffset(game)) != stats.game_offsets.end())
+				++listed_count;
+		}
+
+		std::sort(nanoseconds.begin(), nanoseconds.end());
+		auto percentile = [&nanoseconds](const double rate) { return nanoseconds.empty() ? 0.0 : nanoseconds[(size_t)((nanoseconds.size() - 1) * rate)]; };
+
+		std::wstring str;
+		str += std::format(L"[Benchmark] Position index x {} queries\n", query_count);
+		str += std::format(L"Index: {} games, {} positions, {} bytes ({} bytes/position)\n", header.game_count, header.entry_count, index.GetFileSize(), index.GetFileSize() / (double)std::max<u64>(header.entry_count, 1));
+		str += std::format(L"Found: {} / {} (game listed: {})\n", found_count, query_count, listed_count);
+		str += std::format(L"Latency: p50 {}ns, p99 {}ns, max {}ns\n", percentile(0.5), percentile(0.99), percentile(1.0));
+
+		std::wcout << str << std::endl;
+	}
+
+	template <int size>
+	u64 ReversiBenchmark::PerftDynamic(BasicBoard<size>& board, const Side side, const int depth, const bool passed)
+	{
+		using Bits = typename BasicBoard<size>::Bits;
+
+		if (depth == 0)
+			return 1;
+
+		Bits legal_moves = board.GetLegalMoves(side);
+		Side other = side == Side::Black ? Side::White : Side::Black;
+
+		//パス・終局
+		if (!legal_moves)
+			return passed ? 1 : PerftDynamic(board, other, depth - 1, true);
+
+		u64 count = 0;
+		for (Bits rest = legal_moves; rest; rest = ResetLowestBit(rest))
+		{
+			Bits input = LowestBit(rest);
+
+			board.Set(input, side);
+			Bits flips = board.Flip(input, side);
+
+			count += PerftDynamic(board, other, depth - 1, false);
+
+			board.SetEmpty(input);
+			board.Undo(flips, side);
+		}
+
+		return count;
+	}
+
+	template <int size, Side side>
+	u64 ReversiBenchmark::PerftStatic(BasicBoard<size>& board, const int depth, const bool passed)
+	{
+		using Bits = typename BasicBoard<size>::Bits;
+
+		if (depth == 0)
+			return 1;
+
+		Bits legal_moves = board.template GetLegalMoves<side>();
+
+		//パス・終局
+		if (!legal_moves)
+			return passed ? 1 : PerftStatic<size, GetOpponentSide(side)>(board, depth - 1, true);
+
+		u64 count = 0;
+		for (Bits rest = legal_moves; rest; rest = ResetLowestBit(rest))
+		{
+			Bits input = LowestBit(rest);
+
+			board.template Set<side>(input);
+			Bits flips = board.template Flip<side>(input);
+
+			count += PerftStatic<size, GetOpponentSide(side)>(board, depth - 1, false);
+
+			board.SetEmpty(input);
+			board.template Undo<side>(flips);
+		}
+
+		return count;
+	}
+
+	template <int size, FlipKernel kernel>
+	u64 ReversiBenchmark::PerftPosition(const BasicPosition<size>& position, const int depth, const bool passed)
+	{
+		using Bits = typename BasicPosition<size>::Bits;
+
+		if (depth == 0)
+			return 1;
+
+		Bits legal_moves = position.GetLegalMoves();
+
+		//パス・終局
+		if (!legal_moves)
+			return passed ? 1 : PerftPosition<size, kernel>(position.Pass(), depth - 1, true);
+
+		u64 count = 0;
+		for (Bits rest = legal_moves; rest; rest = ResetLowestBit(rest))
+		{
+			Bits input = LowestBit(rest);
+			Bits flips = BasicPosition<size>::template ComputeFlipsWith<kernel>(input, position.player, position.opponent);
+			count += PerftPosition<size, kernel>(position.Play(input, flips), depth - 1, false);
+		}
+
+		return count;
 	}
 }
@@ -1,21 +1,55 @@
 #include "../include/ReversiEngine.h"
+#include "../include/CpuTopology.h"
+#include "../include/SearchTrace.h"
+#include "../include/EndgameSolver.h"
+#include <bit>
 
 namespace Reversi
 {
-	ReversiEngine::ReversiEngine(std::shared_ptr<Board>& board) : board(board), search_system(board), max_depth(7), evaluateSide(Side::Black), future_count(0)
+	ReversiEngine::ReversiEngine(std::shared_ptr<Board>& board) : board(board), transposition_table_megabytes(TRANSPOSITION_TABLE_MEGABYTES), search_cache_fingerprint(0),
+		engine_mode(EngineMode::AlphaBeta), thread_count(1), evaluateSide(Side::Black), future_count(0),
+		stop_requested(false), search_id(0), progress(), parallel_wait_seconds(0.0), max_depth(7), selectivity(2)
 	{
+		//キャリブレーション結果があれば読み込み、無ければ組み込みの既定値を使う
+		probcut_table = std::make_shared<ProbCutTable>();
+		probcut_table->Load(PROBCUT_FILE);
+
+		//削減量のパラメータも無ければ組み込みの既定値を使う
+		reduction_table = std::make_shared<ReductionTable>();
+		reduction_table->Load(REDUCTION_FILE);
+		search_system.SetReductions(reduction_table);
+
+		//調整済みの評価パラメータがあればメモリマップする
+		evaluation_weights = std::make_shared<EvaluationWeights>();
+		evaluation_weights->Load(EVALUATION_FILE);
+		search_system.SetEvaluationWeights(evaluation_weights);
+		search_system.SetStopFlag(&stop_requested);
+
+		//置換表はすべての探索スレッドで共有する
+		transposition_table = std::make_shared<TranspositionTable>(transposition_table_megabytes);
+		search_system.SetTranspositionTable(transposition_table);
+
+		//学習済みのネットワークがあればメモリマップする
+		neural_network = std::make_shared<NeuralNetwork>();
+		neural_network->Load(NEURAL_NETWORK_FILE);
+
+		//完全読みの結果はファイルを開かなくても覚えておく
+		search_cache = std::make_shared<SearchCache>();
+
+		//過去の対局から作った局面の索引があればメモリマップする
+		position_index = std::make_shared<PositionIndex>();
+		position_index->Open(POSITION_INDEX_FILE);
+
 		//サポートされるスレッド数の取得
-		unsigned int support_threads_count = std::thread::hardware_concurrency();
-		support_threads_count = std::min((int)support_threads_count, 64);
-		is_support_multi_thread = support_threads_count > 1;
+		SetThreadCount((int)std::thread::hardware_concurrency());
+		SetSelectivity(selectivity);
+	}
 
-		if (is_support_multi_thread)
-		{
-			for (int i = 0; i < (int)support_threads_count; ++i)
-			{
-				tasks.emplace_back(SearchFuture());
-			}
-		}
+	ReversiEngine::~ReversiEngine()
+	{
+		//探索スレッドと読み込みがメンバを使い終わるまで待つ
+		CancelSearch();
+		WaitSearchCache();
 	}
 
 	void ReversiEngine::SetEvaluateSide(const Side side)
@@ -27,9 +61,9 @@ namespace Reversi
 	{
 		//探索深度の登録
 		max_depth = depth;
-		for (SearchFuture& task : tasks)
+		for (std::unique_ptr<SearchFuture>& task : tasks)
 		{
-			task.SetSearchDepth(depth);
+			task->SetSearchDepth(depth);
 		}
 	}
 
@@ -38,21 +72,287 @@ namespace Reversi
 		return max_depth;
 	}
 
+	void ReversiEngine::SetSelectivity(const int level)
+	{
+		//選択度の登録(0で全幅探索)
+		selectivity = std::clamp(level, 0, ProbCutTable::SELECTIVITY_COUNT - 1);
+		search_system.SetProbCut(probcut_table, selectivity);
+		for (std::unique_ptr<SearchFuture>& task : tasks)
+		{
+			task->SetProbCut(probcut_table, selectivity);
+		}
+	}
+
+	int ReversiEngine::GetSelectivity() const
+	{
+		return selectivity;
+	}
+
+	bool ReversiEngine::QueryPosition(const Side side, PositionStats& stats) const
+	{
+		return position_index->Find(board->GetPosition(side), stats);
+	}
+
+	bool ReversiEngine::ShareTranspositionTable(const std::string& name)
+	{
+		WaitSearchCache();
+		bool is_attached = transposition_table->AttachShared(name, transposition_table_megabytes, ComputeSearchCacheFingerprint());
+		LoadSearchCache();
+		return is_attached;
+	}
+
+	void ReversiEngine::SetTranspositionTableSize(const size_t megabytes)
+	{
+		if (megabytes == transposition_table_megabytes)
+			return;
+
+		transposition_table_megabytes = megabytes;
+
+		//確保し直すと読み込み中の置換表が消えるので、読み終わるのを待ってから読み直す
+		WaitSearchCache();
+		transposition_table->Resize(megabytes);
+		LoadSearchCache();
+	}
+
+	void ReversiEngine::SetThreadCount(const int count)
+	{
+		//futuresの数より多くは割り当てられない
+		thread_count = std::clamp(count, 1, 64);
+		is_support_multi_thread = thread_count > 1;
+
+		tasks.clear();
+		if (!is_support_multi_thread)
+			return;
+
+		//スレッドの数が変われば、最初に書き込むスレッドの配置も変わる
+		if (hardware_policy.node_memory == NodeMemoryPolicy::FirstTouch)
+		{
+			WaitSearchCache();
+			transposition_table->SetMemoryPolicy(hardware_policy, thread_count);
+			LoadSearchCache();
+		}
+
+		for (int i = 0; i < thread_count; ++i)
+		{
+			//探索スレッドはここで作り、次にスレッドの数か配置を変えるまで使い続ける
+			tasks.push_back(std::make_unique<SearchFuture>());
+			tasks.back()->SetEvaluationWeights(evaluation_weights);
+			tasks.back()->SetEvaluator(search_system.GetEvaluatorType(), neural_network);
+			tasks.back()->SetStopFlag(&stop_requested);
+			tasks.back()->SetTranspositionTable(transposition_table);
+			tasks.back()->SetProbCut(probcut_table, selectivity);
+			tasks.back()->SetReductions(reduction_table);
+			tasks.back()->SetSearchDepth(max_depth);
+			tasks.back()->SetCpu(CpuTopology::Get().GetCpu(i, hardware_policy.thread_placement));
+		}
+	}
+
+	void ReversiEngine::SetHardwarePolicy(const HardwarePolicy& policy)
+	{
+		hardware_policy = policy;
+
+		WaitSearchCache();
+		transposition_table->SetMemoryPolicy(policy, thread_count);
+		LoadSearchCache();
+
+		for (int i = 0; i < (int)tasks.size(); ++i)
+		{
+			tasks[i]->SetCpu(CpuTopology::Get().GetCpu(i, policy.thread_placement));
+		}
+	}
+
+	const HardwarePolicy& ReversiEngine::GetHardwarePolicy() const
+	{
+		return hardware_policy;
+	}
+
+	size_t ReversiEngine::GetTranspositionTableHugePageBytes() const
+	{
+		return transposition_table->GetHugePageBytes();
+	}
+
+	int ReversiEngine::GetThreadCount() const
+	{
+		return thread_count;
+	}
+
+	ParallelStatistics ReversiEngine::GetParallelStatistics() const
+	{
+		ParallelStatistics statistics = { GetProgress().seconds, parallel_wait_seconds, {} };
+		for (const std::unique_ptr<SearchFuture>& task : tasks)
+		{
+			statistics.threads.push_back(task->GetStatistics());
+		}
+
+		return statistics;
+	}
+
+	bool ReversiEngine::AttachSearchCache(const std::string& path)
+	{
+		WaitSearchCache();
+
+		//評価やProbCutのパラメータ、探索の設定が変わったら、保存した探索結果は使わない
+		search_cache_path = path;
+		search_cache_fingerprint = ComputeSearchCacheFingerprint();
+
+		if (!search_cache->Open(path, search_cache_fingerprint))
+			return false;
+
+		LoadSearchCache();
+		return true;
+	}
+
+	void ReversiEngine::WaitSearchCache()
+	{
+		if (search_cache_task.valid())
+			search_cache_task.wait();
+	}
+
+	void ReversiEngine::LoadSearchCache()
+	{
+		if (!search_cache->IsOpen())
+			return;
+
+		//チェックサムを確かめながら読むので時間がかかる。読み終わるまでの探索は読み込んだ分だけ使う
+		search_cache_task = std::async(std::launch::async, [this]()
+			{
+				u64 corrupted_chunks;
+				search_cache->LoadTranspositionTable(*transposition_table, corrupted_chunks);
+			});
+	}
+
+	bool ReversiEngine::SaveSearchCache()
+	{
+		if (search_cache_path.empty())
+			return false;
+
+		WaitSearchCache();
+
+		//開いた後に設定が変わっていれば、最後に探索した設定の結果として保存する
+		search_cache_fingerprint = ComputeSearchCacheFingerprint();
+		return search_cache->Save(search_cache_path, *transposition_table, search_cache_fingerprint);
+	}
+
+	u64 ReversiEngine::ComputeSearchCacheFingerprint() const
+	{
+		const ReductionParameters& reductions = reduction_table->GetParameters();
+
+		return SearchCache::ComputeFingerprint({ EVALUATION_FILE, PROBCUT_FILE, REDUCTION_FILE, NEURAL_NETWORK_FILE },
+			{
+				(u64)search_system.GetEvaluatorType(),
+				(u64)selectivity,
+				(u64)reductions.min_depth,
+				(u64)reductions.min_move_index,
+				std::bit_cast<u64>(reductions.base),
+				std::bit_cast<u64>(reductions.divisor),
+				(u64)reductions.single_move_extension,
+				(u64)reductions.is_pass_extended,
+			});
+	}
+
+	void ReversiEngine::SetEvaluatorType(const EvaluatorType type)
+	{
+		search_system.SetEvaluator(type, neural_network);
+		for (std::unique_ptr<SearchFuture>& task : tasks)
+		{
+			task->SetEvaluator(type, neural_network);
+		}
+	}
+
+	EvaluatorType ReversiEngine::GetEvaluatorType() const
+	{
+		return search_system.GetEvaluatorType();
+	}
+
+	void ReversiEngine::SetEngineMode(const EngineMode mode)
+	{
+		engine_mode = mode;
+
+		//ノードの領域は大きいので、使う時に初めて確保する
+		if (engine_mode == EngineMode::MonteCarlo && !monte_carlo)
+		{
+			monte_carlo = std::make_unique<MonteCarloTreeSearch>();
+			monte_carlo->SetStopFlag(&stop_requested);
+		}
+	}
+
+	EngineMode ReversiEngine::GetEngineMode() const
+	{
+		return engine_mode;
+	}
+
 	u64 ReversiEngine::MakeBestMove()
 	{
-		return is_support_multi_thread ? MakeBestMove_Parallel() : MakeBestMove_Single();
+		SearchTrace::Scope trace_scope("search", max_depth);
+
+		//途中経過を初期化する
+		search_system.ResetNodeCount();
+		for (std::unique_ptr<SearchFuture>& task : tasks)
+		{
+			task->ResetNodeCount();
+			task->ResetStatistics();
+		}
+		parallel_wait_seconds = 0.0;
+
+		{
+			std::lock_guard<std::mutex> lock(progress_mutex);
+			int total_moves = std::popcount(board->GetLegalMoves(evaluateSide));
+			progress = { max_depth, 0, total_moves, { std::numeric_limits<int>::min(), 0 }, 0, 0.0, false };
+			search_start = std::chrono::steady_clock::now();
+		}
+
+		transposition_table->NewSearch();
+
+		u64 best_move;
+		int empties = 64 - std::popcount(board->GetAllBoard());
+
+		if (engine_mode == EngineMode::MonteCarlo)
+			best_move = MakeBestMove_MonteCarlo();
+		else if (empties <= ENDGAME_SOLVE_EMPTIES && empties <= max_depth)
+			best_move = MakeBestMove_Endgame();
+		else
+			best_move = is_support_multi_thread ? MakeBestMove_Parallel() : MakeBestMove_Single();
+
+		{
+			std::lock_guard<std::mutex> lock(progress_mutex);
+			progress.is_finished = true;
+			search_end = std::chrono::steady_clock::now();
+		}
+
+		return best_move;
 	}
 
 	//最善手探索のシングルスレッド版
 	u64 ReversiEngine::MakeBestMove_Single()
 	{
-		constexpr int alpha = std::numeric_limits<int>::min();
 		constexpr int beta = std::numeric_limits<int>::max();
 
-		search_system.evaluateSide = evaluateSide;
-		SearchResult info = search_system.AlphaBetaSearch(0, max_depth, alpha, beta, evaluateSide);
+		Position root = board->GetPosition(evaluateSide);
+		u64 legal_moves = root.GetLegalMoves();
+		SearchResult best = { std::numeric_limits<int>::min(), 0 };
+		int alpha = std::numeric_limits<int>::min();
 
-		return info.Point;
+		//途中経過を出せるようにルートの手はここで回す(αの更新はAlphaBetaSearchのルートと同じ)
+		for (u64 rest = legal_moves; rest != 0ull; rest &= rest - 1)
+		{
+			if (stop_requested.load(std::memory_order_relaxed))
+				break;
+
+			u64 input = rest & (~rest + 1);
+			SearchTrace::Scope trace_scope("root move", std::countr_zero(input));
+			u64 flips = root.GetFlips(input);
+			SearchResult info = search_system.AlphaBetaSearch(root.Play(input, flips), input, max_depth - 1, alpha, beta, false);
+
+			if (info.Score > best.Score)
+			{
+				best = { info.Score, input };
+				alpha = info.Score;
+			}
+
+			UpdateProgress({ info.Score, input });
+		}
+
+		return best.Point;
 	}
 
 	//最善手探索のマルチスレッド版
@@ -61,9 +361,9 @@ namespace Reversi
 		u64 legal_moves = board->GetLegalMoves(evaluateSide);
 		SearchResult best_move = { std::numeric_limits<int>::min(), 0 };
 
-		for (SearchFuture& task : tasks)
+		for (std::unique_ptr<SearchFuture>& task : tasks)
 		{
-			task.Initialize(*board, evaluateSide);
+			task->Initialize(*board, evaluateSide);
 		}
 
 		//着手可能場所をキューに格納
@@ -80,20 +380,27 @@ namespace Reversi
 		future_count = input_queue.size();
 
 		//スレッド数分はとりあえず割り当てちゃう
-		for (int i = 0; i < tasks.size(); ++i)
+		for (int i = 0; i < (int)tasks.size(); ++i)
 		{
 			if (input_queue.empty())
 				break;
 
-			futures[i] = tasks[i].Schedule(input_queue.front());
+			SearchTrace::Instant("dispatch", std::countr_zero(input_queue.front()));
+			futures[i] = tasks[i]->Schedule(input_queue.front());
 			input_queue.pop();
 		}
 
 		auto min = std::chrono::system_clock::time_point::min();
 
+		//どのスレッドも終わっていない間を待ち時間として記録する
+		bool is_waiting = false;
+		std::chrono::steady_clock::time_point wait_start;
+
 		while (true)
 		{
-			for (int i = 0; i < tasks.size(); ++i)
+			bool is_any_done = false;
+
+			for (int i = 0; i < (int)tasks.size(); ++i)
 			{
 				std::future<SearchResult>& future = futures[i];
 				if (!future.valid())
@@ -105,11 +412,28 @@ namespace Reversi
 				if (is_done)
 				{
 					SearchResult result = future.get();
+					is_any_done = true;
+
+					if (is_waiting)
+					{
+						SearchTrace::End("wait");
+						is_waiting = false;
+						parallel_wait_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - wait_start).count();
+					}
+					SearchTrace::Instant("collect", std::countr_zero(result.Point));
+
+					//中断されたら残りの手はスケジュールしない
+					if (stop_requested.load(std::memory_order_relaxed))
+					{
+						future_count -= input_queue.size();
+						std::queue<u64>().swap(input_queue);
+					}
 
 					//終わったらすぐに次のスケジュールを行う
 					if (!input_queue.empty())
 					{
-						futures[i] = tasks[i].Schedule(input_queue.front());
+						SearchTrace::Instant("dispatch", std::countr_zero(input_queue.front()));
+						futures[i] = tasks[i]->Schedule(input_queue.front());
 
 						// popしわすれ？
 						input_queue.pop();
@@ -120,6 +444,8 @@ namespace Reversi
 						best_move = result;
 					}
 
+					UpdateProgress(result);
+
 					//全ての処理が終わったら結果を返す
 					future_count--;
 					if (future_count == 0)
@@ -128,10 +454,150 @@ namespace Reversi
 					}
 				}
 			}
+
+			if (!is_any_done && !is_waiting)
+			{
+				SearchTrace::Begin("wait");
+				is_waiting = true;
+				wait_start = std::chrono::steady_clock::now();
+			}
+		}
+	}
+
+	//最善手探索の完全読み版
+	u64 ReversiEngine::MakeBestMove_Endgame()
+	{
+		Position root = board->GetPosition(evaluateSide);
+		int score;
+		int move;
+
+		//前に読み切った局面ならすぐに返す
+		if (search_cache->FindSolved(root, score, move))
+		{
+			std::lock_guard<std::mutex> lock(progress_mutex);
+			progress.completed_moves = progress.total_moves;
+			progress.best = { EndgameSolver::ToEvaluatorScore(score), 1ull << move };
+			return 1ull << move;
+		}
+
+		SearchResult best = { std::numeric_limits<int>::min(), 0 };
+		int alpha = -65;
+
+		for (u64 rest = root.GetLegalMoves(); rest != 0ull; rest &= rest - 1)
+		{
+			if (stop_requested.load(std::memory_order_relaxed))
+				break;
+
+			u64 input = rest & (~rest + 1);
+			int value = -EndgameSolver::Solve(root.Play(input, root.GetFlips(input)), -64, -alpha, false);
+
+			if (value > best.Score)
+			{
+				best = { value, input };
+				alpha = value;
+			}
+
+			//途中経過は読み切れない深さの探索と同じ尺度で出す
+			UpdateProgress({ EndgameSolver::ToEvaluatorScore(value), input });
 		}
+
+		//中断されずにすべての手を読み切った時だけ覚える
+		if (best.Point != 0ull && !stop_requested.load(std::memory_order_relaxed))
+			search_cache->AddSolved(root, best.Score, CountTrailingZeros(best.Point));
+
+		return best.Point;
 	}
-}
 
+	//最善手探索のモンテカルロ木探索版
+	u64 ReversiEngine::MakeBestMove_MonteCarlo()
+	{
+		//すべてのスレッドで1つの木を共有して探索する
+		SearchResult result = monte_carlo->Search(*board, evaluateSide, MONTE_CARLO_TIME_PER_STRENGTH * max_depth, thread_count);
 
+		{
+			std::lock_guard<std::mutex> lock(progress_mutex);
+			progress.completed_moves = progress.total_moves;
+			progress.best = result;
+		}
 
+		return result.Point;
+	}
 
+	int ReversiEngine::StartSearch(const std::shared_ptr<EventQueue>& queue)
+	{
+		CancelSearch();
+
+		int id = ++search_id;
+		search_task = std::async(std::launch::async, [this, queue, id]()
+			{
+				u64 best_move = MakeBestMove();
+
+				//中断された探索の結果は送らない
+				if (!stop_requested.load(std::memory_order_relaxed))
+					queue->Push({ GameEventType::SearchFinished, L"", id, best_move });
+			});
+
+		return id;
+	}
+
+	void ReversiEngine::CancelSearch()
+	{
+		if (!search_task.valid())
+			return;
+
+		stop_requested.store(true, std::memory_order_relaxed);
+		search_task.get();
+		stop_requested.store(false, std::memory_order_relaxed);
+	}
+
+	void ReversiEngine::RequestStop()
+	{
+		stop_requested.store(true, std::memory_order_relaxed);
+	}
+
+	void ReversiEngine::ClearStopRequest()
+	{
+		stop_requested.store(false, std::memory_order_relaxed);
+	}
+
+	bool ReversiEngine::IsStopRequested() const
+	{
+		return stop_requested.load(std::memory_order_relaxed);
+	}
+
+	SearchProgress ReversiEngine::GetProgress() const
+	{
+		SearchProgress current;
+		std::chrono::steady_clock::time_point end;
+
+		{
+			std::lock_guard<std::mutex> lock(progress_mutex);
+			current = progress;
+			end = progress.is_finished ? search_end : std::chrono::steady_clock::now();
+			current.seconds = std::chrono::duration<double>(end - search_start).count();
+		}
+
+		current.nodes = search_system.GetNodeCount();
+		for (const std::unique_ptr<SearchFuture>& task : tasks)
+		{
+			current.nodes += task->GetNodeCount();
+		}
+
+		//モンテカルロ木探索ではプレイアウト数をノード数とする
+		if (engine_mode == EngineMode::MonteCarlo)
+			current.nodes = monte_carlo->GetPlayoutCount();
+
+		return current;
+	}
+
+	void ReversiEngine::UpdateProgress(const SearchResult& result)
+	{
+		std::lock_guard<std::mutex> lock(progress_mutex);
+
+		++progress.completed_moves;
+		if (result.Score > progress.best.Score)
+		{
+			progress.best = result;
+		}
+	}
+}
\ No newline at end of file
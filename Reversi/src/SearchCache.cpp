@@ -0,0 +1,303 @@
+#include "../include/SearchCache.h"
+#include "../include/Checksum.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace Reversi
+{
+	SearchCache::SearchCache() :
+		header(),
+		is_solved_checked(false),
+		is_solved_valid(false)
+	{
+
+	}
+
+	u64 SearchCache::GetChunkCount(const u64 bucket_count)
+	{
+		return (bucket_count + CHUNK_BUCKETS - 1) / CHUNK_BUCKETS;
+	}
+
+	u64 SearchCache::GetBucketOffset(const u64 bucket_count)
+	{
+		//バケットはキャッシュラインの境界から始める
+		u64 offset = sizeof(Header) + GetChunkCount(bucket_count) * sizeof(uint32_t);
+		return (offset + 63) & ~63ull;
+	}
+
+	u64 SearchCache::GetSolvedOffset(const u64 bucket_count)
+	{
+		return GetBucketOffset(bucket_count) + bucket_count * TranspositionTable::BUCKET_WORDS * sizeof(u64);
+	}
+
+	uint32_t SearchCache::ComputeHeaderChecksum(const Header& header)
+	{
+		Header copy = header;
+		copy.header_checksum = 0;
+		return ComputeChecksum(&copy, sizeof(copy));
+	}
+
+	bool SearchCache::Open(const std::string& path, const u64 fingerprint)
+	{
+		Close();
+
+		if (!file.Open(path) || file.GetSize() < sizeof(Header))
+		{
+			file.Close();
+			return false;
+		}
+
+		std::memcpy(&header, file.GetData(), sizeof(Header));
+
+		//大きさが見出しと合わないファイルは書き込み途中か壊れている
+		bool is_valid = header.magic == FILE_MAGIC && header.version == FILE_VERSION &&
+			header.header_checksum == ComputeHeaderChecksum(header) &&
+			header.fingerprint == fingerprint &&
+			header.bucket_count != 0 && std::has_single_bit(header.bucket_count) &&
+			header.bucket_count <= file.GetSize() / (TranspositionTable::BUCKET_WORDS * sizeof(u64)) &&
+			header.solved_count <= file.GetSize() / sizeof(SolvedEntry) &&
+			file.GetSize() == GetSolvedOffset(header.bucket_count) + header.solved_count * sizeof(SolvedEntry);
+
+		if (!is_valid)
+		{
+			file.Close();
+			header = {};
+			return false;
+		}
+
+		opened_path = path;
+		return true;
+	}
+
+	void SearchCache::Close()
+	{
+		file.Close();
+		header = {};
+		opened_path.clear();
+
+		std::lock_guard<std::mutex> lock(solved_mutex);
+		is_solved_checked = false;
+		is_solved_valid = false;
+	}
+
+	bool SearchCache::IsOpen() const
+	{
+		return file.IsOpen();
+	}
+
+	const SearchCache::Header& SearchCache::GetHeader() const
+	{
+		return header;
+	}
+
+	size_t SearchCache::LoadTranspositionTable(TranspositionTable& table, u64& corrupted_chunks) const
+	{
+		corrupted_chunks = 0;
+		if (!file.IsOpen())
+			return 0;
+
+		const unsigned char* data = file.GetData();
+		const u64* buckets = reinterpret_cast<const u64*>(data + GetBucketOffset(header.bucket_count));
+		u64 chunk_count = GetChunkCount(header.bucket_count);
+		size_t imported = 0;
+
+		for (u64 chunk = 0; chunk < chunk_count; ++chunk)
+		{
+			u64 first = chunk * CHUNK_BUCKETS;
+			u64 count = std::min(CHUNK_BUCKETS, header.bucket_count - first);
+			const u64* input = buckets + first * TranspositionTable::BUCKET_WORDS;
+
+			uint32_t checksum;
+			std::memcpy(&checksum, data + sizeof(Header) + chunk * sizeof(uint32_t), sizeof(checksum));
+
+			//壊れた塊の項目は信用しない
+			if (checksum != ComputeChecksum(input, count * TranspositionTable::BUCKET_WORDS * sizeof(u64)))
+			{
+				++corrupted_chunks;
+				continue;
+			}
+
+			imported += table.Import(input, count);
+		}
+
+		return imported;
+	}
+
+	bool SearchCache::IsLess(const SolvedEntry& entry, const u64 player, const u64 opponent)
+	{
+		return entry.player != player ? entry.player < player : entry.opponent < opponent;
+	}
+
+	u64 SearchCache::HashSolved(const u64 player, const u64 opponent)
+	{
+		return TranspositionTable::ComputeHash(player, opponent, true);
+	}
+
+	const SearchCache::SolvedEntry* SearchCache::GetFileSolved()
+	{
+		if (!file.IsOpen() || header.solved_count == 0)
+			return nullptr;
+
+		const SolvedEntry* entries = reinterpret_cast<const SolvedEntry*>(file.GetData() + GetSolvedOffset(header.bucket_count));
+
+		//最初に使う時に一度だけ確かめる
+		if (!is_solved_checked)
+		{
+			is_solved_checked = true;
+			is_solved_valid = header.solved_checksum == ComputeChecksum(entries, header.solved_count * sizeof(SolvedEntry));
+		}
+
+		return is_solved_valid ? entries : nullptr;
+	}
+
+	const SearchCache::SolvedEntry* SearchCache::FindFileSolved(const u64 player, const u64 opponent)
+	{
+		const SolvedEntry* entries = GetFileSolved();
+		if (entries == nullptr)
+			return nullptr;
+
+		const SolvedEntry* end = entries + header.solved_count;
+		const SolvedEntry* found = std::lower_bound(entries, end, std::make_pair(player, opponent),
+			[](const SolvedEntry& entry, const std::pair<u64, u64>& key) { return IsLess(entry, key.first, key.second); });
+
+		return found != end && found->player == player && found->opponent == opponent ? found : nullptr;
+	}
+
+	bool SearchCache::FindSolved(const Position& position, int& score, int& move)
+	{
+		std::lock_guard<std::mutex> lock(solved_mutex);
+
+		auto added = added_solved.find(HashSolved(position.player, position.opponent));
+		const SolvedEntry* entry = added != added_solved.end() && added->second.player == position.player && added->second.opponent == position.opponent ?
+			&added->second : FindFileSolved(position.player, position.opponent);
+
+		if (entry == nullptr)
+			return false;
+
+		score = entry->score;
+		move = entry->move;
+		return true;
+	}
+
+	void SearchCache::AddSolved(const Position& position, const int score, const int move)
+	{
+		std::lock_guard<std::mutex> lock(solved_mutex);
+		added_solved[HashSolved(position.player, position.opponent)] = { position.player, position.opponent, score, move };
+	}
+
+	bool SearchCache::Save(const std::string& path, const TranspositionTable& table, const u64 fingerprint)
+	{
+		//ファイルの結果と追加した結果を合わせて局面順に並べる(同じ局面は追加した方を残す)
+		std::vector<SolvedEntry> solved;
+		{
+			std::lock_guard<std::mutex> lock(solved_mutex);
+
+			if (const SolvedEntry* entries = GetFileSolved())
+				solved.assign(entries, entries + header.solved_count);
+
+			for (const auto& [hash, entry] : added_solved)
+			{
+				solved.push_back(entry);
+			}
+		}
+
+		std::stable_sort(solved.begin(), solved.end(), [](const SolvedEntry& a, const SolvedEntry& b) { return IsLess(a, b.player, b.opponent); });
+		std::reverse(solved.begin(), solved.end());
+		solved.erase(std::unique(solved.begin(), solved.end(), [](const SolvedEntry& a, const SolvedEntry& b) { return a.player == b.player && a.opponent == b.opponent; }), solved.end());
+		std::reverse(solved.begin(), solved.end());
+
+		u64 bucket_count = table.GetBucketCount();
+		u64 chunk_count = GetChunkCount(bucket_count);
+		std::vector<uint32_t> checksums(chunk_count);
+
+		Header new_header = {};
+		new_header.magic = FILE_MAGIC;
+		new_header.version = FILE_VERSION;
+		new_header.bucket_count = bucket_count;
+		new_header.solved_count = solved.size();
+		new_header.fingerprint = fingerprint;
+		new_header.solved_checksum = ComputeChecksum(solved.data(), solved.size() * sizeof(SolvedEntry));
+
+		std::string temporary_path = path + ".tmp";
+		{
+			std::ofstream stream(temporary_path, std::ios::binary | std::ios::trunc);
+			if (!stream)
+				return false;
+
+			//見出しとチェックサムは最後に書き直す
+			std::vector<char> padding(GetBucketOffset(bucket_count), 0);
+			stream.write(padding.data(), padding.size());
+
+			std::vector<u64> buffer(CHUNK_BUCKETS * TranspositionTable::BUCKET_WORDS);
+			for (u64 chunk = 0; chunk < chunk_count; ++chunk)
+			{
+				u64 first = chunk * CHUNK_BUCKETS;
+				u64 count = std::min(CHUNK_BUCKETS, bucket_count - first);
+				size_t bytes = count * TranspositionTable::BUCKET_WORDS * sizeof(u64);
+
+				table.Export(first, count, buffer.data());
+				checksums[chunk] = ComputeChecksum(buffer.data(), bytes);
+				stream.write(reinterpret_cast<const char*>(buffer.data()), bytes);
+			}
+
+			stream.write(reinterpret_cast<const char*>(solved.data()), solved.size() * sizeof(SolvedEntry));
+
+			new_header.header_checksum = ComputeHeaderChecksum(new_header);
+			stream.seekp(0);
+			stream.write(reinterpret_cast<const char*>(&new_header), sizeof(new_header));
+			stream.write(reinterpret_cast<const char*>(checksums.data()), checksums.size() * sizeof(uint32_t));
+
+			if (!stream)
+				return false;
+		}
+
+		//マップしたままではWindowsで置き換えられない
+		bool is_reopen = file.IsOpen() && opened_path == path;
+		if (is_reopen)
+			file.Close();
+
+		std::error_code error;
+		std::filesystem::rename(temporary_path, path, error);
+		if (error)
+		{
+			std::filesystem::remove(temporary_path, error);
+			if (is_reopen)
+				Open(path, header.fingerprint);
+
+			return false;
+		}
+
+		//書き出した結果はファイルから引けるようになる
+		if (is_reopen || !file.IsOpen())
+		{
+			if (Open(path, fingerprint))
+			{
+				std::lock_guard<std::mutex> lock(solved_mutex);
+				added_solved.clear();
+			}
+		}
+
+		return true;
+	}
+
+	u64 SearchCache::ComputeFingerprint(const std::vector<std::string>& paths, const std::vector<u64>& settings)
+	{
+		u64 fingerprint = FILE_VERSION;
+
+		for (const std::string& path : paths)
+		{
+			MappedFile parameter;
+			u64 checksum = parameter.Open(path) ? ComputeChecksum(parameter.GetData(), parameter.GetSize()) : 0xFFFFFFFFull << 32;
+			fingerprint = (fingerprint ^ checksum) * 0x100000001B3ull;
+		}
+
+		for (u64 setting : settings)
+		{
+			fingerprint = (fingerprint ^ setting) * 0x100000001B3ull;
+		}
+
+		return fingerprint;
+	}
+}
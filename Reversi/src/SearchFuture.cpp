@@ -1,46 +1,98 @@
 #include "../include/SearchFuture.h"
+#include "../include/CpuTopology.h"
+#include "../include/SearchTrace.h"
 
 namespace Reversi
 {
-	SearchFuture::SearchFuture() : depth(7), assigned_input(0)
+	SearchFuture::SearchFuture() : depth(7), cpu(-1), assigned_input(0), is_stopping(false), root_move_count(0), busy_seconds(0.0), dispatch_seconds(0.0), root_position{ 0ull, 0ull }
 	{
-		board_buffer = std::make_shared<Board>();
-		search_system = std::make_unique<SearchSystem>(board_buffer);
+		search_system = std::make_unique<SearchSystem>();
+		StartThread();
 	}
 
-	void SearchFuture::Initialize(const Board& origin, const Side side)
+	SearchFuture::~SearchFuture()
 	{
-		search_system->evaluateSide = side;
+		StopThread();
+	}
 
-		//現在のボード情報を更新する
-		board_buffer->Overwrite(origin);
+	void SearchFuture::Initialize(const Board& origin, const Side side)
+	{
+		//現在のボード情報を評価側から見た局面として保持する
+		root_position = origin.GetPosition(side);
 	}
 
 	std::future<SearchResult> SearchFuture::Schedule(const u64 input)
 	{
-		assigned_input = input;
+		Job job = { input, std::chrono::steady_clock::now(), {} };
+		std::future<SearchResult> future = job.result.get_future();
 
-		//SearchBestMoveを非同期実行する
-		return std::async(std::launch::async, &SearchFuture::SearchBestMove, this);
+		{
+			std::lock_guard<std::mutex> lock(job_mutex);
+			jobs.push(std::move(job));
+		}
+		job_condition.notify_one();
+
+		return future;
 	}
 
-	SearchResult SearchFuture::SearchBestMove()
+	void SearchFuture::StartThread()
+	{
+		is_stopping = false;
+		thread = std::thread(&SearchFuture::Run, this);
+	}
+
+	void SearchFuture::StopThread()
 	{
-		Side evaluateSide = search_system->evaluateSide;
-		Side nextSide = evaluateSide == Side::Black ? Side::White : Side::Black;
+		{
+			std::lock_guard<std::mutex> lock(job_mutex);
+			is_stopping = true;
+		}
+		job_condition.notify_one();
+		thread.join();
+	}
+
+	void SearchFuture::Run()
+	{
+		//同じスレッドで探索し続けるので、固定するのは起動した時の1回だけで良い
+		if (cpu >= 0)
+			CpuTopology::PinCurrentThread(cpu);
+
+		while (true)
+		{
+			Job job;
+
+			{
+				std::unique_lock<std::mutex> lock(job_mutex);
+				job_condition.wait(lock, [this]() { return is_stopping || !jobs.empty(); });
+				if (is_stopping)
+					return;
 
+				job = std::move(jobs.front());
+				jobs.pop();
+			}
+
+			//手を受け取った後に読むので、割り当てる前に設定した深さや局面が見える
+			assigned_input = job.input;
+			scheduled_time = job.scheduled_time;
+			job.result.set_value(SearchBestMove());
+		}
+	}
+
+	SearchResult SearchFuture::SearchBestMove()
+	{
 		constexpr int alpha = std::numeric_limits<int>::min();
 		constexpr int beta = std::numeric_limits<int>::max();
+		SearchTrace::Scope trace_scope("root move", std::countr_zero(assigned_input));
+		auto start = std::chrono::steady_clock::now();
 
-		//石を配置
-		board_buffer->Set(assigned_input, evaluateSide);
-		u64 flips = board_buffer->Flip(assigned_input, evaluateSide);
-
-		SearchResult info = search_system->AlphaBetaSearch(assigned_input, depth - 1, alpha, beta, nextSide);
+		//割り当てられた手を打った局面から相手番として探索する
+		u64 flips = root_position.GetFlips(assigned_input);
+		SearchResult info = search_system->AlphaBetaSearch(root_position.Play(assigned_input, flips), assigned_input, depth - 1, alpha, beta, false);
 
-		//手を巻き戻す
-		board_buffer->SetEmpty(assigned_input);
-		board_buffer->Undo(flips, evaluateSide);
+		//結果はfutureを通して受け取るので、読む側とは同期している
+		++root_move_count;
+		busy_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		dispatch_seconds += std::chrono::duration<double>(start - scheduled_time).count();
 
 		return { info.Score, assigned_input };
 	}
@@ -49,4 +101,67 @@ namespace Reversi
 	{
 		this->depth = max_depth;
 	}
+
+	void SearchFuture::SetProbCut(const std::shared_ptr<const ProbCutTable>& table, const int selectivity)
+	{
+		search_system->SetProbCut(table, selectivity);
+	}
+
+	void SearchFuture::SetReductions(const std::shared_ptr<const ReductionTable>& table)
+	{
+		search_system->SetReductions(table);
+	}
+
+	void SearchFuture::SetEvaluationWeights(const std::shared_ptr<const EvaluationWeights>& weights)
+	{
+		search_system->SetEvaluationWeights(weights);
+	}
+
+	void SearchFuture::SetEvaluator(const EvaluatorType type, const std::shared_ptr<const NeuralNetwork>& network)
+	{
+		search_system->SetEvaluator(type, network);
+	}
+
+	void SearchFuture::SetStopFlag(const std::atomic<bool>* flag)
+	{
+		search_system->SetStopFlag(flag);
+	}
+
+	void SearchFuture::SetTranspositionTable(const std::shared_ptr<TranspositionTable>& table)
+	{
+		search_system->SetTranspositionTable(table);
+	}
+
+	void SearchFuture::SetCpu(const int cpu)
+	{
+		if (cpu == this->cpu)
+			return;
+
+		//起動したスレッドは動かさず、新しいコアで起動し直す
+		StopThread();
+		this->cpu = cpu;
+		StartThread();
+	}
+
+	u64 SearchFuture::GetNodeCount() const
+	{
+		return search_system->GetNodeCount();
+	}
+
+	void SearchFuture::ResetNodeCount()
+	{
+		search_system->ResetNodeCount();
+	}
+
+	ThreadStatistics SearchFuture::GetStatistics() const
+	{
+		return { root_move_count, search_system->GetNodeCount(), busy_seconds, dispatch_seconds };
+	}
+
+	void SearchFuture::ResetStatistics()
+	{
+		root_move_count = 0;
+		busy_seconds = 0.0;
+		dispatch_seconds = 0.0;
+	}
 }
\ No newline at end of file
@@ -1,59 +1,248 @@
 #include "../include/SearchSystem.h"
+#include <cmath>
 
 namespace Reversi
 {
-	SearchSystem::SearchSystem(std::shared_ptr<Board>& board) :
-		board(board),
-		evaluator(board),
-		evaluateSide(Side::Black)
+	template <int size>
+	BasicSearchSystem<size>::BasicSearchSystem() :
+		evaluator_type(EvaluatorType::Handcrafted),
+		node_count(0),
+		stop_flag(nullptr),
+		probcut_threshold(0.0)
 	{
 
 	}
 
-	SearchResult SearchSystem::AlphaBetaSearch(const u64 point, int depth, int alpha, int beta, Side side)
+	template <int size>
+	void BasicSearchSystem<size>::SetProbCut(const std::shared_ptr<const ProbCutTable>& table, const int selectivity)
 	{
+		probcut_table = table;
+		probcut_threshold = table ? ProbCutTable::GetThreshold(selectivity) : 0.0;
+	}
+
+	template <int size>
+	void BasicSearchSystem<size>::SetReductions(const std::shared_ptr<const ReductionTable>& table)
+	{
+		reduction_table = table;
+	}
+
+	template <int size>
+	void BasicSearchSystem<size>::SetEvaluationWeights(const std::shared_ptr<const EvaluationWeights>& weights)
+	{
+		evaluator.SetWeights(weights);
+	}
+
+	template <int size>
+	void BasicSearchSystem<size>::SetEvaluator(const EvaluatorType type, const std::shared_ptr<const NeuralNetwork>& network)
+	{
+		neural_evaluator.SetNetwork(network);
+		evaluator_type = size == DEFAULT_BOARD_SIZE && type == EvaluatorType::Neural && neural_evaluator.IsAvailable() ? EvaluatorType::Neural : EvaluatorType::Handcrafted;
+	}
+
+	template <int size>
+	EvaluatorType BasicSearchSystem<size>::GetEvaluatorType() const
+	{
+		return evaluator_type;
+	}
+
+	template <int size>
+	u64 BasicSearchSystem<size>::GetNodeCount() const
+	{
+		return node_count.load(std::memory_order_relaxed);
+	}
+
+	template <int size>
+	void BasicSearchSystem<size>::ResetNodeCount()
+	{
+		node_count.store(0, std::memory_order_relaxed);
+	}
+
+	template <int size>
+	void BasicSearchSystem<size>::SetStopFlag(const std::atomic<bool>* flag)
+	{
+		stop_flag = flag;
+	}
+
+	template <int size>
+	void BasicSearchSystem<size>::SetTranspositionTable(const std::shared_ptr<TranspositionTable>& table)
+	{
+		transposition_table = table;
+	}
+
+	template <int size>
+	typename BasicSearchSystem<size>::SearchResult BasicSearchSystem<size>::AlphaBetaSearch(const Position position, const Bits point, const int depth, const int alpha, const int beta, const bool is_max)
+	{
+		//8x8以外の盤面は手書きの評価関数で全幅探索する
+		if constexpr (size != DEFAULT_BOARD_SIZE)
+		{
+			return Search<EvaluatorType::Handcrafted, NodeType::FullWidth>(position, point, depth, alpha, beta, is_max);
+		}
+		else
+		{
+			bool is_selective = probcut_threshold > 0.0;
+
+			if (evaluator_type == EvaluatorType::Neural)
+			{
+				return is_selective ?
+					Search<EvaluatorType::Neural, NodeType::Selective>(position, point, depth, alpha, beta, is_max) :
+					Search<EvaluatorType::Neural, NodeType::FullWidth>(position, point, depth, alpha, beta, is_max);
+			}
+
+			return is_selective ?
+				Search<EvaluatorType::Handcrafted, NodeType::Selective>(position, point, depth, alpha, beta, is_max) :
+				Search<EvaluatorType::Handcrafted, NodeType::FullWidth>(position, point, depth, alpha, beta, is_max);
+		}
+	}
+
+	template <int size>
+	template <EvaluatorType evaluation, typename BasicSearchSystem<size>::NodeType node_type>
+	typename BasicSearchSystem<size>::SearchResult BasicSearchSystem<size>::Search(const Position& position, const Bits point, const int depth, const int alpha, const int beta, const bool is_max)
+	{
+		return is_max ?
+			Search<evaluation, true, node_type>(position, point, depth, alpha, beta) :
+			Search<evaluation, false, node_type>(position, point, depth, alpha, beta);
+	}
+
+	template <int size>
+	template <EvaluatorType evaluation, bool is_max>
+	int BasicSearchSystem<size>::Evaluate(const Position& position)
+	{
+		if constexpr (evaluation == EvaluatorType::Neural)
+			return neural_evaluator.Evaluate<is_max>(position);
+		else
+			return evaluator.template Evaluate<is_max>(position);
+	}
+
+	template <int size>
+	template <EvaluatorType evaluation, bool is_max, typename BasicSearchSystem<size>::NodeType node_type>
+	typename BasicSearchSystem<size>::SearchResult BasicSearchSystem<size>::Search(const Position position, const Bits point, const int depth, int alpha, int beta)
+	{
+		//書き込むのはこのスレッドだけなので、ロック命令を使わずに加算する
+		node_count.store(node_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
 		// 実行速度を求めるならば、余計な処理を挟む前に評価しましょう。
 		//一番深くまで到達したら評価する
 		if (depth == 0)
 		{
-			int score = evaluator.Evaluate(evaluateSide);
+			int score = Evaluate<evaluation, is_max>(position);
 			return { score, point };
 		}
 
-		u64 legal_moves = board->GetLegalMoves(side);
-		bool is_max = evaluateSide == side;
-		SearchResult best = { is_max ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max(), 0 };
+		//中断されたらすぐに戻る
+		if (stop_flag != nullptr && stop_flag->load(std::memory_order_relaxed))
+			return { 0, point };
+
+		Bits legal_moves = position.GetLegalMoves();
+		SearchResult best = { is_max ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max(), Bits(0) };
 
-		//おけるマスが無くなったら評価する
-		if (legal_moves == 0)
+		//おけるマスが無くなったら評価する(相手が打てれば、パスは石を置かないので深さを減らさずに相手番を探索できる)
+		if (!legal_moves)
 		{
-			int score = evaluator.Evaluate(evaluateSide);
+			if (reduction_table != nullptr && reduction_table->GetParameters().is_pass_extended && position.GetOpponentLegalMoves())
+				return { Search<evaluation, !is_max, node_type>(position.Pass(), Bits(0), depth, alpha, beta).Score, point };
+
+			int score = Evaluate<evaluation, is_max>(position);
 			return { score, point };
 		}
 
-		for (int i = 0; i < 64; ++i)
+		//置換表に同じ深さの結果があれば使い、無くても記録した最善手を先に探索する
+		TranspositionTable* table = depth >= TranspositionTable::MIN_DEPTH ? transposition_table.get() : nullptr;
+		u64 hash = 0;
+		Bits first = Bits(0);
+		const int original_alpha = alpha;
+		const int original_beta = beta;
+
+		if (table != nullptr)
 		{
-			u64 input = 1ull << i;
+			hash = TranspositionTable::ComputeHash(position.player, position.opponent, is_max);
 
-			//着手可能位置ではなかったらスキップ
-			if ((legal_moves & input) == 0)
-				continue;
+			TranspositionEntry entry;
+			if (table->Probe(hash, entry) && entry.move != TranspositionTable::NO_MOVE)
+			{
+				first = SquareBit<Bits>(entry.move) & legal_moves;
 
-			//探索用に設置する
-			board->Set(input, side);
-			u64 flips = board->Flip(input, side);
+				if (entry.depth == depth && TranspositionTable::IsCutoff(entry, alpha, beta, node_type == NodeType::Selective))
+					return { entry.score, first };
+			}
+		}
+
+		//探索結果を記録して返す(中断された探索の値は記録しない。前向き枝刈りをしたノードの値は印を付ける)
+		auto store = [&](const SearchResult& result)
+			{
+				if (table != nullptr && !(stop_flag != nullptr && stop_flag->load(std::memory_order_relaxed)))
+					table->Store(hash, result.Score, depth, original_alpha, original_beta, result.Point ? CountTrailingZeros(result.Point) : TranspositionTable::NO_MOVE,
+						node_type == NodeType::Selective);
+
+				return result;
+			};
+
+		//Multi-ProbCutによる前向き枝刈り
+		if constexpr (node_type == NodeType::Selective)
+		{
+			if (ProbCutTable::MIN_DEPTH <= depth && depth <= ProbCutTable::MAX_DEPTH)
+			{
+				int score;
+				if (TryProbCut<evaluation, is_max>(position, depth, alpha, beta, score))
+					return { score, point };
+			}
+		}
+
+		//打てる手が1つしか無ければ、その手の先を延長する
+		int child_depth = depth - 1;
+		if (reduction_table != nullptr && !ResetLowestBit(legal_moves))
+			child_depth += reduction_table->GetParameters().single_move_extension;
+
+		//記録した最善手の後は、着手可能位置を下位ビットから順に取り出す
+		int move_index = 0;
+		for (Bits rest = legal_moves; rest; first = Bits(0), ++move_index)
+		{
+			Bits input = first ? first : LowestBit(rest);
+			rest = rest & ~input;
+			Bits flips = position.GetFlips(input);
+			Position next = position.Play(input, flips);
+
+			if constexpr (evaluation == EvaluatorType::Neural)
+				neural_evaluator.Push(position, input, flips);
+
+			//後から探索する手は浅いnull windowで探索し、窓を超えそうな時だけ元の深さで探索し直す
+			//(手を探索し終えていれば窓の端は有限)
+			int reduction = 0;
+			if constexpr (node_type == NodeType::Selective)
+			{
+				if (reduction_table != nullptr && (is_max ? alpha != std::numeric_limits<int>::min() : beta != std::numeric_limits<int>::max()))
+					reduction = reduction_table->GetReduction(depth, move_index);
+			}
 
-			SearchResult info = AlphaBetaSearch(input, depth - 1, alpha, beta, side == Side::Black ? Side::White : Side::Black);
+			SearchResult info;
+			if (reduction > 0)
+			{
+				if constexpr (is_max)
+				{
+					info = Search<evaluation, !is_max, node_type>(next, input, child_depth - reduction, alpha, alpha + 1);
+					if (info.Score > alpha)
+						info = Search<evaluation, !is_max, node_type>(next, input, child_depth, alpha, beta);
+				}
+				else
+				{
+					info = Search<evaluation, !is_max, node_type>(next, input, child_depth - reduction, beta - 1, beta);
+					if (info.Score < beta)
+						info = Search<evaluation, !is_max, node_type>(next, input, child_depth, alpha, beta);
+				}
+			}
+			else
+			{
+				//着手後の局面を作って渡すので、探索後の巻き戻しは不要
+				info = Search<evaluation, !is_max, node_type>(next, input, child_depth, alpha, beta);
+			}
 
-			//探索が終わったら巻き戻す
-			board->SetEmpty(input);
-			board->Undo(flips, side);
+			if constexpr (evaluation == EvaluatorType::Neural)
+				neural_evaluator.Pop();
 
-			if (is_max)
+			if constexpr (is_max)
 			{
 				//βカット
 				if (beta <= info.Score)
-					return { info.Score, input };
+					return store({ info.Score, input });
 
 				if (info.Score > best.Score)
 				{
@@ -65,7 +254,7 @@ namespace Reversi
 			{
 				//αカット
 				if (alpha >= info.Score)
-					return { info.Score, input };
+					return store({ info.Score, input });
 
 				if (info.Score < best.Score)
 				{
@@ -75,8 +264,62 @@ namespace Reversi
 			}
 		}
 
-		return best;
+		return store(best);
 	}
-}
 
+	template <int size>
+	template <EvaluatorType evaluation, bool is_max>
+	bool BasicSearchSystem<size>::TryProbCut(const Position& position, const int depth, const int alpha, const int beta, int& score)
+	{
+		constexpr int min = std::numeric_limits<int>::min();
+		constexpr int max = std::numeric_limits<int>::max();
+
+		int stage = ProbCutTable::GetStage(position.CountStones());
+
+		//計測していない深さの予測は当てにならないので刈らない
+		if (!probcut_table->IsCalibrated(stage, depth))
+			return false;
+
+		int shallow_depth = ProbCutTable::GetShallowDepth(depth);
+		const ProbCutParameter& parameter = probcut_table->Get(stage, depth);
+		double margin = probcut_threshold * parameter.sigma;
+
+		//予測値を浅い探索の窓に変換する(窓の端が溢れないように丸める)
+		auto to_bound = [](const double value)
+			{
+				return static_cast<int>(std::clamp(value, (double)min + 2.0, (double)max - 2.0));
+			};
+
+		//浅い探索中にProbCutを重ねると誤差が積み重なるため、全幅探索のノードで行う
+		//深い探索がβ以上になると予測できるか
+		if (beta != max)
+		{
+			int bound = to_bound(std::ceil((beta + margin - parameter.offset) / parameter.slope));
+			SearchResult info = Search<evaluation, is_max, NodeType::FullWidth>(position, Bits(0), shallow_depth, bound - 1, bound);
+
+			if (info.Score >= bound)
+			{
+				score = beta;
+				return true;
+			}
+		}
+
+		//深い探索がα以下になると予測できるか
+		if (alpha != min)
+		{
+			int bound = to_bound(std::floor((alpha - margin - parameter.offset) / parameter.slope));
+			SearchResult info = Search<evaluation, is_max, NodeType::FullWidth>(position, Bits(0), shallow_depth, bound, bound + 1);
+
+			if (info.Score <= bound)
+			{
+				score = alpha;
+				return true;
+			}
+		}
 
+		return false;
+	}
+
+	template class BasicSearchSystem<8>;
+	template class BasicSearchSystem<10>;
+}
@@ -0,0 +1,178 @@
+#include "../include/SearchTrace.h"
+#include "../include/Basic.h"
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Reversi
+{
+	namespace
+	{
+		/// <summary>
+		/// 記録1つ分
+		/// </summary>
+		struct TraceEvent
+		{
+			long long nanoseconds;
+			const char* name;
+			long long value;
+			char phase;
+		};
+
+		/// <summary>
+		/// 1つのスレッドが書き込むリングバッファ
+		/// 書き込むのは持ち主のスレッドだけなので、記録する時にロックを取らない
+		/// </summary>
+		struct TraceBuffer
+		{
+			std::unique_ptr<TraceEvent[]> events;
+
+			//これまでに書き込んだ数(書き出す側はこれより前の記録を読む)
+			std::atomic<u64> count;
+
+			//トレースの上での行の番号
+			int lane;
+		};
+
+		std::mutex registry_mutex;
+		std::vector<std::unique_ptr<TraceBuffer>> buffers;
+
+		//終了したスレッドのバッファ(探索スレッドはSetCpuやSetThreadCountで作り直され、EngineServiceは接続ごと、バックグラウンドの探索は1回ごとにスレッドを作るので、使い回して行の数を抑える)
+		std::vector<TraceBuffer*> free_buffers;
+
+		const std::chrono::steady_clock::time_point trace_epoch = std::chrono::steady_clock::now();
+
+		/// <summary>
+		/// スレッドが持つバッファ。スレッドが終了すると空きに戻す
+		/// </summary>
+		struct TraceBufferHolder
+		{
+			TraceBuffer* buffer = nullptr;
+
+			~TraceBufferHolder()
+			{
+				if (buffer == nullptr)
+					return;
+
+				std::lock_guard<std::mutex> lock(registry_mutex);
+				free_buffers.push_back(buffer);
+			}
+		};
+
+		thread_local TraceBufferHolder holder;
+
+		TraceBuffer* AcquireBuffer()
+		{
+			std::lock_guard<std::mutex> lock(registry_mutex);
+
+			if (!free_buffers.empty())
+			{
+				TraceBuffer* buffer = free_buffers.back();
+				free_buffers.pop_back();
+				return buffer;
+			}
+
+			auto buffer = std::make_unique<TraceBuffer>();
+			buffer->events = std::make_unique<TraceEvent[]>(SearchTrace::BUFFER_EVENTS);
+			buffer->count.store(0, std::memory_order_relaxed);
+			buffer->lane = (int)buffers.size();
+			buffers.push_back(std::move(buffer));
+			return buffers.back().get();
+		}
+	}
+
+	void SearchTrace::Enable(const bool is_enabled)
+	{
+#ifndef REVERSI_NO_TRACE
+		enabled.store(is_enabled, std::memory_order_relaxed);
+#endif
+	}
+
+	void SearchTrace::Record(const char* name, const char phase, const long long value)
+	{
+		TraceBuffer* buffer = holder.buffer;
+		if (buffer == nullptr)
+		{
+			buffer = AcquireBuffer();
+			holder.buffer = buffer;
+		}
+
+		u64 count = buffer->count.load(std::memory_order_relaxed);
+		TraceEvent& event = buffer->events[count & (BUFFER_EVENTS - 1)];
+		event.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - trace_epoch).count();
+		event.name = name;
+		event.value = value;
+		event.phase = phase;
+
+		buffer->count.store(count + 1, std::memory_order_release);
+	}
+
+	bool SearchTrace::Export(const std::string& path)
+	{
+		std::ofstream stream(path, std::ios::trunc);
+		if (!stream)
+			return false;
+
+		std::lock_guard<std::mutex> lock(registry_mutex);
+
+		stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		bool is_first = true;
+		auto separator = [&is_first]()
+			{
+				const char* result = is_first ? "" : ",\n";
+				is_first = false;
+				return result;
+			};
+
+		for (const auto& buffer : buffers)
+		{
+			u64 count = buffer->count.load(std::memory_order_acquire);
+			if (count == 0)
+				continue;
+
+			stream << std::format("{}{{\"ph\":\"M\",\"pid\":1,\"tid\":{},\"name\":\"thread_name\",\"args\":{{\"name\":\"search {}\"}}}}",
+				separator(), buffer->lane, buffer->lane);
+
+			//上書きで始まりが消えた区間の終わりは書かない
+			u64 first = count > BUFFER_EVENTS ? count - BUFFER_EVENTS : 0;
+			int depth = 0;
+
+			for (u64 i = first; i < count; ++i)
+			{
+				const TraceEvent& event = buffer->events[i & (BUFFER_EVENTS - 1)];
+
+				if (event.phase == 'B')
+				{
+					++depth;
+				}
+				else if (event.phase == 'E')
+				{
+					if (depth == 0)
+						continue;
+
+					--depth;
+				}
+
+				stream << std::format("{}{{\"ph\":\"{}\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"name\":\"{}\"{},\"args\":{{\"value\":{}}}}}",
+					separator(), event.phase, buffer->lane, (double)event.nanoseconds / 1000.0, event.name,
+					event.phase == 'i' ? ",\"s\":\"t\"" : "", event.value);
+			}
+		}
+
+		stream << "\n]}\n";
+		return static_cast<bool>(stream);
+	}
+
+	void SearchTrace::Clear()
+	{
+		std::lock_guard<std::mutex> lock(registry_mutex);
+
+		for (const auto& buffer : buffers)
+		{
+			buffer->count.store(0, std::memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,197 @@
+#include "../include/ServiceLoadGenerator.h"
+#include "../include/Board.h"
+#include "../include/EngineService.h"
+#include "../include/LocalSocket.h"
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace Reversi
+{
+	namespace
+	{
+		//1行送って1行の応答を読む(1つの接続に1つのセッションなので応答は順に届く)
+		bool Exchange(LocalSocket& socket, const std::string& command, std::string& reply)
+		{
+			return socket.WriteLine(command) && socket.ReadLine(reply);
+		}
+	}
+
+	ServiceLoadGenerator::ServiceLoadGenerator(const std::string& path, const int session_count, const int seconds, const int max_depth, const int deadline_milliseconds) :
+		path(path),
+		session_count(std::max(session_count, 1)),
+		seconds(std::max(seconds, 1)),
+		max_depth(std::max(max_depth, 1)),
+		deadline_milliseconds(std::max(deadline_milliseconds, 1))
+	{
+
+	}
+
+	bool ServiceLoadGenerator::Run()
+	{
+		std::vector<SessionResult> results(session_count);
+		std::vector<std::thread> threads;
+
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < session_count; ++i)
+		{
+			threads.emplace_back(&ServiceLoadGenerator::RunSession, this, i, std::ref(results[i]));
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::wstring str;
+		std::vector<double> all_latencies;
+		int timeout_count = 0;
+		int game_count = 0;
+		bool is_succeeded = true;
+
+		str += std::format(L"[ServiceLoad] {} sessions, {}s, depth {}, deadline {}ms\n", session_count, seconds, max_depth, deadline_milliseconds);
+		str += L"session: requests p50 p90 p99 max (ms) / timeouts / games\n";
+
+		for (int i = 0; i < session_count; ++i)
+		{
+			const SessionResult& result = results[i];
+			str += std::format(L"{:>3}: {} / {} / {}{}\n", i, FormatLatencies(result.latencies), result.timeout_count, result.game_count, result.is_failed ? L" FAILED" : L"");
+
+			all_latencies.insert(all_latencies.end(), result.latencies.begin(), result.latencies.end());
+			timeout_count += result.timeout_count;
+			game_count += result.game_count;
+			is_succeeded &= !result.is_failed;
+		}
+
+		str += std::format(L"all: {} / {} / {}\n", FormatLatencies(all_latencies), timeout_count, game_count);
+		str += std::format(L"throughput: {:.1f} requests/s", all_latencies.size() / elapsed);
+
+		std::wcout << str << std::endl;
+		return is_succeeded;
+	}
+
+	void ServiceLoadGenerator::RunSession(const int index, SessionResult& result) const
+	{
+		LocalSocket socket;
+		std::string reply;
+		u64 id = 0;
+
+		std::string type;
+		if (!socket.Connect(path) || !Exchange(socket, "new", reply) || !(std::istringstream(reply) >> type >> id) || type != "session")
+		{
+			result.is_failed = true;
+			return;
+		}
+
+		//偶数番目のセッションは先手、奇数番目は後手を打つ
+		std::mt19937 rand_module(index);
+		Side client_side = index % 2 == 0 ? Side::Black : Side::White;
+		Board board;
+		Side side = Side::Black;
+
+		auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+		while (std::chrono::steady_clock::now() < end)
+		{
+			u64 legal_moves = board.GetLegalMoves(side);
+
+			//終局したら初期局面に戻す
+			if (legal_moves == 0ull && board.GetLegalMoves(GetOpponentSide(side)) == 0ull)
+			{
+				board.Reset();
+				side = Side::Black;
+				++result.game_count;
+
+				auto field = board.GetFieldData();
+				if (!Exchange(socket, std::format("set {} {:x} {:x} b", id, field.first, field.second), reply) || reply.rfind("ok", 0) != 0)
+				{
+					result.is_failed = true;
+					break;
+				}
+				continue;
+			}
+
+			if (side == client_side)
+			{
+				u64 input = 0ull;
+				if (legal_moves != 0ull)
+				{
+					std::uniform_int_distribution<int> distribution(0, PopCount(legal_moves) - 1);
+					for (int skip = distribution(rand_module); skip > 0; --skip)
+					{
+						legal_moves = ResetLowestBit(legal_moves);
+					}
+					input = LowestBit(legal_moves);
+				}
+
+				if (!Exchange(socket, std::format("play {} {}", id, EngineService::ToSquareName(input)), reply) || reply.rfind("ok", 0) != 0)
+				{
+					result.is_failed = true;
+					break;
+				}
+
+				if (input != 0ull)
+				{
+					board.Set(input, side);
+					board.Flip(input, side);
+				}
+				side = GetOpponentSide(side);
+				continue;
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			if (!Exchange(socket, std::format("go {} {} {}", id, max_depth, deadline_milliseconds), reply))
+			{
+				result.is_failed = true;
+				break;
+			}
+			result.latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+			//bestmove <id> <手> <評価値> <深さ> ...
+			std::istringstream stream(reply);
+			std::string name;
+			u64 reply_id = 0;
+			int score = 0, depth = 0;
+			stream >> type >> reply_id >> name >> score >> depth;
+
+			u64 input = EngineService::ParseSquareName(name);
+			if (type != "bestmove" || reply_id != id || (input & legal_moves) != input || (input == 0ull) != (legal_moves == 0ull))
+			{
+				result.is_failed = true;
+				break;
+			}
+
+			//手があるのに1手も読めなかったら期限切れ
+			if (input != 0ull && depth == 0)
+				++result.timeout_count;
+
+			if (input != 0ull)
+			{
+				board.Set(input, side);
+				board.Flip(input, side);
+			}
+			side = GetOpponentSide(side);
+		}
+
+		Exchange(socket, std::format("close {}", id), reply);
+	}
+
+	double ServiceLoadGenerator::GetPercentile(const std::vector<double>& sorted, const double percent)
+	{
+		if (sorted.empty())
+			return 0.0;
+
+		size_t index = (size_t)(percent / 100.0 * (double)(sorted.size() - 1) + 0.5);
+		return sorted[std::min(index, sorted.size() - 1)];
+	}
+
+	std::wstring ServiceLoadGenerator::FormatLatencies(std::vector<double> latencies)
+	{
+		std::sort(latencies.begin(), latencies.end());
+		return std::format(L"{} {:.2f} {:.2f} {:.2f} {:.2f}", latencies.size(),
+			GetPercentile(latencies, 50.0), GetPercentile(latencies, 90.0), GetPercentile(latencies, 99.0), GetPercentile(latencies, 100.0));
+	}
+}
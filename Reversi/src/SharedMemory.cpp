@@ -0,0 +1,176 @@
+#include "../include/SharedMemory.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace Reversi
+{
+#ifdef _WIN32
+	SharedMemory::SharedMemory() : data(nullptr), size(0), mapping_handle(nullptr)
+	{
+
+	}
+#else
+	SharedMemory::SharedMemory() : data(nullptr), size(0)
+	{
+
+	}
+#endif
+
+	SharedMemory::~SharedMemory()
+	{
+		Close();
+	}
+
+	std::string SharedMemory::GetSystemName(const std::string& name)
+	{
+#ifdef _WIN32
+		return "Local\\" + name;
+#else
+		return name.starts_with('/') ? name : "/" + name;
+#endif
+	}
+
+	bool SharedMemory::Create(const std::string& name, const size_t new_size)
+	{
+		Close();
+
+#ifdef _WIN32
+		mapping_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD)((unsigned long long)new_size >> 32), (DWORD)new_size, GetSystemName(name).c_str());
+
+		//既にあれば既存のものが返るので、作れなかったものとして扱う
+		if (mapping_handle != nullptr && GetLastError() == ERROR_ALREADY_EXISTS)
+		{
+			Close();
+			return false;
+		}
+		if (mapping_handle == nullptr)
+			return false;
+
+		data = static_cast<unsigned char*>(MapViewOfFile(mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, new_size));
+#else
+		std::string system_name = GetSystemName(name);
+		int descriptor = shm_open(system_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		if (descriptor < 0)
+			return false;
+
+		if (ftruncate(descriptor, static_cast<off_t>(new_size)) != 0)
+		{
+			close(descriptor);
+			shm_unlink(system_name.c_str());
+			return false;
+		}
+
+		//マップした後は記述子が無くても使える
+		void* address = mmap(nullptr, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+		close(descriptor);
+
+		if (address == MAP_FAILED)
+		{
+			shm_unlink(system_name.c_str());
+			return false;
+		}
+
+		data = static_cast<unsigned char*>(address);
+#endif
+
+		size = new_size;
+		if (data == nullptr)
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool SharedMemory::Open(const std::string& name)
+	{
+		Close();
+
+#ifdef _WIN32
+		mapping_handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, GetSystemName(name).c_str());
+		if (mapping_handle == nullptr)
+			return false;
+
+		data = static_cast<unsigned char*>(MapViewOfFile(mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+
+		MEMORY_BASIC_INFORMATION information;
+		size = data != nullptr && VirtualQuery(data, &information, sizeof(information)) != 0 ? information.RegionSize : 0;
+#else
+		int descriptor = shm_open(GetSystemName(name).c_str(), O_RDWR, 0600);
+		if (descriptor < 0)
+			return false;
+
+		//作成直後で大きさが決まる前なら失敗させ、呼び出し元にやり直させる
+		struct stat status;
+		if (fstat(descriptor, &status) != 0 || status.st_size == 0)
+		{
+			close(descriptor);
+			return false;
+		}
+
+		void* address = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+		close(descriptor);
+
+		data = address == MAP_FAILED ? nullptr : static_cast<unsigned char*>(address);
+		size = static_cast<size_t>(status.st_size);
+#endif
+
+		if (data == nullptr || size == 0)
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void SharedMemory::Close()
+	{
+#ifdef _WIN32
+		if (data != nullptr)
+			UnmapViewOfFile(data);
+		if (mapping_handle != nullptr)
+			CloseHandle(mapping_handle);
+
+		mapping_handle = nullptr;
+#else
+		if (data != nullptr)
+			munmap(data, size);
+#endif
+
+		data = nullptr;
+		size = 0;
+	}
+
+	void SharedMemory::Remove(const std::string& name)
+	{
+#ifndef _WIN32
+		shm_unlink(GetSystemName(name).c_str());
+#else
+		(void)name;
+#endif
+	}
+
+	bool SharedMemory::IsOpen() const
+	{
+		return data != nullptr;
+	}
+
+	unsigned char* SharedMemory::GetData() const
+	{
+		return data;
+	}
+
+	size_t SharedMemory::GetSize() const
+	{
+		return size;
+	}
+}
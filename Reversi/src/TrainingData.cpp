@@ -0,0 +1,74 @@
+#include "../include/TrainingData.h"
+#include <cstring>
+
+namespace Reversi
+{
+	bool TrainingData::Append(const std::string& path, const std::vector<TrainingRecord>& records)
+	{
+		//新規ファイルの場合はヘッダーを書き込む
+		bool is_new = !std::ifstream(path, std::ios::binary).good();
+		std::ofstream stream(path, std::ios::binary | std::ios::app);
+		if (!stream)
+			return false;
+
+		if (is_new)
+		{
+			uint32_t header[2] = { FILE_MAGIC, FILE_VERSION };
+			stream.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+		}
+
+		std::vector<char> buffer(records.size() * RECORD_SIZE);
+		char* cursor = buffer.data();
+
+		for (const TrainingRecord& record : records)
+		{
+			std::memcpy(cursor, &record.black, 8);
+			std::memcpy(cursor + 8, &record.white, 8);
+			cursor[16] = static_cast<char>(record.side);
+			cursor[17] = static_cast<char>(record.score);
+			cursor += RECORD_SIZE;
+		}
+
+		stream.write(buffer.data(), buffer.size());
+		return static_cast<bool>(stream);
+	}
+
+	bool TrainingData::Open(const std::string& path)
+	{
+		count = 0;
+
+		if (!file.Open(path) || file.GetSize() < HEADER_SIZE)
+			return false;
+
+		uint32_t header[2];
+		std::memcpy(header, file.GetData(), HEADER_SIZE);
+
+		if (header[0] != FILE_MAGIC || header[1] != FILE_VERSION)
+		{
+			file.Close();
+			return false;
+		}
+
+		//書き込み途中で切れた末尾の局面は無視する
+		count = (file.GetSize() - HEADER_SIZE) / RECORD_SIZE;
+		return true;
+	}
+
+	size_t TrainingData::GetCount() const
+	{
+		return count;
+	}
+
+	TrainingRecord TrainingData::Get(const size_t index) const
+	{
+		const unsigned char* data = file.GetData() + HEADER_SIZE + index * RECORD_SIZE;
+		TrainingRecord record;
+
+		std::memcpy(&record.black, data, 8);
+		std::memcpy(&record.white, data + 8, 8);
+		record.side = static_cast<Side>(data[16]);
+		record.score = static_cast<int8_t>(data[17]);
+
+		return record;
+	}
+}
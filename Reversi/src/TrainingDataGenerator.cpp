@@ -0,0 +1,139 @@
+#include "../include/TrainingDataGenerator.h"
+#include "../include/EndgameSolver.h"
+
+namespace Reversi
+{
+	TrainingDataGenerator::TrainingDataGenerator(const int game_count, const int search_depth, const int random_plies,
+		const int solve_empties, const unsigned int seed) :
+		game_count(game_count),
+		search_depth(search_depth),
+		random_plies(random_plies),
+		solve_empties(solve_empties),
+		seed(seed)
+	{
+
+	}
+
+	bool TrainingDataGenerator::Run(const std::string& path) const
+	{
+		//対局数をスレッド数で分割する
+		int thread_count = (int)std::max(1u, std::thread::hardware_concurrency());
+		std::vector<std::future<std::vector<TrainingRecord>>> futures;
+
+		for (int i = 0; i < thread_count; ++i)
+		{
+			int count = game_count / thread_count + (i < game_count % thread_count ? 1 : 0);
+			if (count == 0)
+				continue;
+
+			futures.emplace_back(std::async(std::launch::async, &TrainingDataGenerator::PlayGames, this, count, seed + i));
+		}
+
+		size_t record_count = 0;
+		for (std::future<std::vector<TrainingRecord>>& future : futures)
+		{
+			std::vector<TrainingRecord> records = future.get();
+			record_count += records.size();
+
+			if (!TrainingData::Append(path, records))
+				return false;
+		}
+
+		std::wcout << L"collected " << record_count << L" positions" << std::endl;
+		return true;
+	}
+
+	std::vector<TrainingRecord> TrainingDataGenerator::PlayGames(const int count, const unsigned int game_seed) const
+	{
+		constexpr int alpha = std::numeric_limits<int>::min();
+		constexpr int beta = std::numeric_limits<int>::max();
+
+		std::mt19937 rand_module(game_seed);
+		std::shared_ptr<Board> board = std::make_shared<Board>();
+		SearchSystem search_system;
+		std::vector<TrainingRecord> records;
+
+		for (int game = 0; game < count; ++game)
+		{
+			board->Reset();
+			Side side = Side::Black;
+			size_t game_begin = records.size();
+
+			//最初に完全読みした局面の黒から見た石差
+			bool is_solved = false;
+			int solved_score = 0;
+
+			for (int ply = 0;; ++ply)
+			{
+				Side other = side == Side::Black ? Side::White : Side::Black;
+				u64 legal_moves = board->GetLegalMoves(side);
+
+				//パス・終局
+				if (legal_moves == 0ull)
+				{
+					if (board->GetLegalMoves(other) == 0ull)
+						break;
+
+					side = other;
+					continue;
+				}
+
+				std::pair<u64, u64> field = board->GetFieldData();
+				TrainingRecord record = { field.first, field.second, side, 0 };
+
+				//空きマスが少なければ完全読みでラベルを付ける
+				int empties = 64 - std::popcount(board->GetAllBoard());
+				if (empties <= solve_empties)
+				{
+					int score = EndgameSolver::Solve(board->GetPosition(side), -64, 64, false);
+					record.score = static_cast<int8_t>(score);
+
+					if (!is_solved)
+					{
+						is_solved = true;
+						solved_score = side == Side::Black ? score : -score;
+					}
+				}
+
+				records.emplace_back(record);
+
+				u64 input;
+				if (ply < random_plies)
+				{
+					//序盤は局面が偏らないようにランダムに打つ
+					std::uniform_int_distribution<int> distribution(0, std::popcount(legal_moves) - 1);
+					for (int skip = distribution(rand_module); skip > 0; --skip)
+					{
+						legal_moves &= legal_moves - 1;
+					}
+					input = legal_moves & (~legal_moves + 1);
+				}
+				else
+				{
+					input = search_system.AlphaBetaSearch(board->GetPosition(side), 0, search_depth, alpha, beta, true).Point;
+				}
+
+				board->Set(input, side);
+				board->Flip(input, side);
+				side = other;
+			}
+
+			//完全読みしていない局面は対局結果(完全読みした局面があればその値)でラベルを付ける
+			std::pair<int, int> counts = board->CountStone();
+			int result = is_solved ? solved_score : counts.first - counts.second;
+
+			for (size_t i = game_begin; i < records.size(); ++i)
+			{
+				TrainingRecord& record = records[i];
+				int empties = 64 - std::popcount(record.black | record.white);
+
+				if (empties > solve_empties)
+				{
+					record.score = static_cast<int8_t>(record.side == Side::Black ? result : -result);
+				}
+			}
+		}
+
+		return records;
+	}
+}
@@ -0,0 +1,358 @@
+#include "../include/TranspositionTable.h"
+#include "../include/CpuTopology.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <new>
+#include <thread>
+
+namespace Reversi
+{
+	TranspositionTable::TranspositionTable(const size_t megabytes) :
+		huge_pages(HugePageMode::Off),
+		node_memory(NodeMemoryPolicy::Local),
+		shared_header(nullptr),
+		shared_fingerprint(0),
+		buckets(nullptr),
+		bucket_mask(0),
+		generation(0)
+	{
+		Resize(megabytes);
+	}
+
+	size_t TranspositionTable::GetBucketCount(const size_t megabytes)
+	{
+		return std::bit_floor(std::max<size_t>(megabytes * 1024 * 1024 / sizeof(Bucket), 1));
+	}
+
+	void TranspositionTable::Resize(const size_t megabytes)
+	{
+		//共有中は古い共有メモリを退役させ、同じ名前で作り直す
+		if (shared_header != nullptr)
+		{
+			std::string name = shared_name;
+			shared_header->is_retired.store(1, std::memory_order_release);
+			RemoveShared(name);
+			ReleaseShared();
+
+			if (AttachShared(name, megabytes, shared_fingerprint))
+				return;
+		}
+
+		size_t bucket_count = GetBucketCount(megabytes);
+		AllocateStorage(bucket_count);
+		bucket_mask = bucket_count - 1;
+	}
+
+	void TranspositionTable::AllocateStorage(const size_t bucket_count)
+	{
+		buckets = nullptr;
+		if (!storage.Allocate(bucket_count * sizeof(Bucket), huge_pages, node_memory, touch_cpus))
+			throw std::bad_alloc();
+
+		//確保した領域は共有メモリと同じく0で埋まっている(空の項目はハッシュ値0と一致しないので使われない)
+		buckets = reinterpret_cast<Bucket*>(storage.GetData());
+	}
+
+	void TranspositionTable::SetMemoryPolicy(const HardwarePolicy& policy, const int thread_count)
+	{
+		huge_pages = policy.huge_pages;
+		node_memory = policy.node_memory;
+
+		//スレッドを固定しなくても、書き込みはノードに振り分けて表をノードに分ける
+		ThreadPlacement placement = policy.thread_placement == ThreadPlacement::None ? ThreadPlacement::Spread : policy.thread_placement;
+		touch_cpus = CpuTopology::Get().GetCpus(thread_count, placement);
+
+		if (shared_header == nullptr)
+			AllocateStorage((size_t)bucket_mask + 1);
+	}
+
+	size_t TranspositionTable::GetHugePageBytes() const
+	{
+		return shared_header == nullptr ? storage.GetHugePageBytes() : 0;
+	}
+
+	bool TranspositionTable::AttachShared(const std::string& name, const size_t megabytes, const u64 fingerprint)
+	{
+		//別の共有メモリに接続していれば離れる(失敗しても今までの大きさの表が残る)
+		DetachShared();
+		shared_fingerprint = fingerprint;
+
+		const size_t bucket_count = GetBucketCount(megabytes);
+		const auto start = std::chrono::steady_clock::now();
+		bool is_stale_removed = false;
+
+		while (true)
+		{
+			if (shared_memory.Open(name))
+			{
+				shared_header = reinterpret_cast<SharedHeader*>(shared_memory.GetData());
+
+				if (shared_memory.GetSize() >= sizeof(SharedHeader) && shared_header->magic.load(std::memory_order_acquire) == SHARED_MAGIC)
+				{
+					//別の形式や設定の表は壊さずに諦める
+					if (!IsValidShared())
+					{
+						shared_memory.Close();
+						shared_header = nullptr;
+						return false;
+					}
+
+					if (shared_header->is_retired.load(std::memory_order_acquire) == 0)
+						break;
+				}
+
+				shared_memory.Close();
+				shared_header = nullptr;
+			}
+			else if (shared_memory.Create(name, sizeof(SharedHeader) + bucket_count * sizeof(Bucket)))
+			{
+				//作った直後は0で埋まっているので、バケットは空のまま使える
+				shared_header = reinterpret_cast<SharedHeader*>(shared_memory.GetData());
+				shared_header->version = SHARED_VERSION;
+				shared_header->bucket_count = bucket_count;
+				shared_header->fingerprint = fingerprint;
+				shared_header->magic.store(SHARED_MAGIC, std::memory_order_release);
+				break;
+			}
+
+			int elapsed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+			//待っても初期化されなければ、作成中に落ちたものとして一度だけ作り直す
+			if (elapsed >= SHARED_INIT_TIMEOUT && !is_stale_removed)
+			{
+				RemoveShared(name);
+				is_stale_removed = true;
+			}
+			else if (elapsed >= SHARED_INIT_TIMEOUT * 2)
+			{
+				return false;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		shared_name = name;
+		buckets = reinterpret_cast<Bucket*>(shared_memory.GetData() + sizeof(SharedHeader));
+		bucket_mask = shared_header->bucket_count - 1;
+		storage.Free();
+		return true;
+	}
+
+	bool TranspositionTable::IsValidShared() const
+	{
+		u64 bucket_count = shared_header->bucket_count;
+		return shared_header->version == SHARED_VERSION && shared_header->fingerprint == shared_fingerprint &&
+			bucket_count != 0 && std::has_single_bit(bucket_count) &&
+			shared_memory.GetSize() >= sizeof(SharedHeader) + bucket_count * sizeof(Bucket);
+	}
+
+	void TranspositionTable::DetachShared()
+	{
+		if (shared_header == nullptr)
+			return;
+
+		size_t bucket_count = (size_t)bucket_mask + 1;
+		ReleaseShared();
+		AllocateStorage(bucket_count);
+	}
+
+	void TranspositionTable::ReleaseShared()
+	{
+		shared_memory.Close();
+		shared_header = nullptr;
+		shared_name.clear();
+		buckets = nullptr;
+	}
+
+	bool TranspositionTable::IsShared() const
+	{
+		return shared_header != nullptr;
+	}
+
+	void TranspositionTable::RemoveShared(const std::string& name)
+	{
+		SharedMemory::Remove(name);
+	}
+
+	void TranspositionTable::Clear()
+	{
+		for (u64 i = 0; i <= bucket_mask; ++i)
+		{
+			for (int j = 0; j < BUCKET_SIZE; ++j)
+			{
+				buckets[i].checks[j].store(0, std::memory_order_relaxed);
+				buckets[i].data[j].store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void TranspositionTable::NewSearch()
+	{
+		AdvanceGeneration();
+
+		//他のプロセスが大きさを変えたら、新しい共有メモリに移る
+		if (shared_header != nullptr && shared_header->is_retired.load(std::memory_order_acquire) != 0)
+		{
+			std::string name = shared_name;
+			size_t megabytes = ((size_t)bucket_mask + 1) * sizeof(Bucket) / (1024 * 1024);
+			ReleaseShared();
+
+			//接続できなければ自分だけの表で続ける
+			if (!AttachShared(name, megabytes, shared_fingerprint))
+				Resize(megabytes);
+		}
+	}
+
+	void TranspositionTable::AdvanceGeneration()
+	{
+		generation.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	size_t TranspositionTable::GetEntryCount() const
+	{
+		return (size_t)(bucket_mask + 1) * BUCKET_SIZE;
+	}
+
+	u64 TranspositionTable::GetBucketCount() const
+	{
+		return bucket_mask + 1;
+	}
+
+	void TranspositionTable::Export(const u64 first, const u64 count, u64* output) const
+	{
+		for (u64 i = 0; i < count; ++i)
+		{
+			const Bucket& bucket = buckets[first + i];
+
+			for (int j = 0; j < BUCKET_SIZE; ++j)
+			{
+				output[i * BUCKET_WORDS + j] = bucket.checks[j].load(std::memory_order_relaxed);
+				output[i * BUCKET_WORDS + BUCKET_SIZE + j] = bucket.data[j].load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	size_t TranspositionTable::Import(const u64* input, const u64 count)
+	{
+		unsigned char previous = generation.load(std::memory_order_relaxed) - 1;
+		size_t imported = 0;
+
+		for (u64 i = 0; i < count; ++i)
+		{
+			for (int j = 0; j < BUCKET_SIZE; ++j)
+			{
+				u64 data = input[i * BUCKET_WORDS + BUCKET_SIZE + j];
+				if (data == 0ull)
+					continue;
+
+				u64 hash = input[i * BUCKET_WORDS + j] ^ data;
+				TranspositionEntry entry = Unpack(data);
+				u64 stamped = Pack(entry.score, entry.depth, entry.bound, entry.move, entry.is_selective, previous);
+
+				//大きさが違ってもハッシュ値から置き場所が決まる
+				Bucket& bucket = buckets[hash & bucket_mask];
+
+				int target = -1;
+
+				for (int k = 0; k < BUCKET_SIZE; ++k)
+				{
+					u64 current = bucket.data[k].load(std::memory_order_relaxed);
+
+					//探索で記録し直した局面はそちらを残す
+					if ((bucket.checks[k].load(std::memory_order_relaxed) ^ current) == hash)
+					{
+						target = -1;
+						break;
+					}
+
+					if (current == 0ull && target < 0)
+						target = k;
+				}
+
+				if (target >= 0)
+				{
+					bucket.checks[target].store(hash ^ stamped, std::memory_order_relaxed);
+					bucket.data[target].store(stamped, std::memory_order_relaxed);
+					++imported;
+				}
+			}
+		}
+
+		return imported;
+	}
+
+	bool TranspositionTable::Probe(const u64 hash, TranspositionEntry& entry) const
+	{
+		const Bucket& bucket = buckets[hash & bucket_mask];
+
+		for (int i = 0; i < BUCKET_SIZE; ++i)
+		{
+			u64 data = bucket.data[i].load(std::memory_order_relaxed);
+
+			//書き込み途中の項目は一致しないので読み飛ばす
+			if ((bucket.checks[i].load(std::memory_order_relaxed) ^ data) == hash && data != 0ull)
+			{
+				entry = Unpack(data);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void TranspositionTable::Store(const u64 hash, const int score, const int depth, const int alpha, const int beta, const int move, const bool is_selective)
+	{
+		TranspositionBound bound = score <= alpha ? TranspositionBound::Upper : (score >= beta ? TranspositionBound::Lower : TranspositionBound::Exact);
+		Bucket& bucket = buckets[hash & bucket_mask];
+		unsigned char current = generation.load(std::memory_order_relaxed);
+
+		//同じ局面があれば上書きし、無ければ古い世代で浅いものを置き換える
+		int target = 0;
+		int worst = INT32_MAX;
+
+		for (int i = 0; i < BUCKET_SIZE; ++i)
+		{
+			u64 data = bucket.data[i].load(std::memory_order_relaxed);
+
+			if ((bucket.checks[i].load(std::memory_order_relaxed) ^ data) == hash)
+			{
+				target = i;
+				break;
+			}
+
+			int age = (unsigned char)(current - GetGeneration(data));
+			int value = (data == 0ull ? -1024 : Unpack(data).depth) - age * 4;
+			if (value < worst)
+			{
+				worst = value;
+				target = i;
+			}
+		}
+
+		u64 data = Pack(score, depth, bound, move, is_selective, current);
+		bucket.checks[target].store(hash ^ data, std::memory_order_relaxed);
+		bucket.data[target].store(data, std::memory_order_relaxed);
+	}
+
+	u64 TranspositionTable::Pack(const int score, const int depth, const TranspositionBound bound, const int move, const bool is_selective, const unsigned char generation)
+	{
+		return (u64)(uint32_t)score |
+			(u64)(std::min(depth, 255) & 0xFF) << 32 |
+			(u64)bound << 40 |
+			(u64)(move & 0x7F) << 42 |
+			(u64)generation << 49 |
+			(u64)is_selective << 57 |
+			1ull << 63;
+	}
+
+	TranspositionEntry TranspositionTable::Unpack(const u64 data)
+	{
+		return { (int)(uint32_t)data, (int)((data >> 32) & 0xFF), (TranspositionBound)((data >> 40) & 0x3), (int)((data >> 42) & 0x7F), ((data >> 57) & 1) != 0 };
+	}
+
+	unsigned char TranspositionTable::GetGeneration(const u64 data)
+	{
+		return (unsigned char)(data >> 49);
+	}
+}